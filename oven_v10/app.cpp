@@ -1,38 +1,208 @@
 #include "app.h"
 #include "hal.h"      
 #include "drivers.h"  
+#include "oven_logic.h"
+#include "recorder.h"
+#include "logger.h"
+#include "wallclock.h"
+#include "autotune.h"
+#include "power_budget.h"
+#include "output_mode.h"
+#include "zone_mode.h"
+#include "control_timer.h"
+#include "profiler.h"
+#include "state_machine.h"
+#include "scheduler.h"
+#include "preheat_model.h"
 
 const long GMT_OFFSET_SEC = 18000; 
 
+// Longest command line accepted, including the terminator
+const size_t COMMAND_LINE_SIZE = 512;
+
+// After an oversized frame its bytes are dropped up to the newline,
+// even when the rest arrives over later loop passes. Per port, since
+// USB and RS485 frames interleave.
+struct PortFraming {
+  Stream* port;
+  bool discarding;
+};
+static PortFraming portFraming[] = { {&SerialUSB, false}, {&Serial1, false} };
+static PortFraming otherPortFraming = {NULL, false};
+
+static bool& discardingFor(Stream &port) {
+  for (uint8_t i = 0; i < sizeof(portFraming) / sizeof(portFraming[0]); i++) {
+    if (portFraming[i].port == &port) return portFraming[i].discarding;
+  }
+  return otherPortFraming.discarding;
+}
+
+// Drop buffered bytes up to and including the next newline; true once it is seen
+static bool skipToNewline(Stream &port) {
+  while (port.available() > 0) {
+    if (port.read() == '\n') return true;
+  }
+  return false;
+}
+
+// RS485 output is queued and fed to the UART as its TX buffer frees
+// up, from serviceTransmitQueue() every pass: at RS485_BAUD a flush()
+// after each frame (a log chunk is ~260 bytes) would hold the loop for
+// a quarter of a second. The driver is released a couple of character
+// times after the UART's buffer has emptied.
+const unsigned long RS485_BAUD = 9600;
+const size_t RS485_QUEUE_SIZE = 1024;                          // Frames waiting, CRLF included
+const unsigned long RS485_RELEASE_US = 2 * 10 * 1000000UL / RS485_BAUD; // Two 10-bit characters
+// Queue space paced multi-frame replies leave free, so the status frame
+// (about 270 bytes with three zones) and a command reply still fit
+const size_t RS485_QUEUE_RESERVE = 256 + 32 * ZONE_COUNT;
+
+static char rs485Queue[RS485_QUEUE_SIZE];
+static size_t rs485QueueLen = 0;       // Bytes queued, 0 = idle (driver off)
+static size_t rs485QueueSent = 0;      // Of those, handed to the UART
+static int rs485IdleFree = 0;          // availableForWrite() with the UART's buffer empty
+static bool rs485Emptied = false;      // UART buffer drained, waiting out RS485_RELEASE_US
+static unsigned long rs485EmptiedAt = 0;
+
+static void feedRs485() {
+  int room = Serial1.availableForWrite();
+  size_t n = rs485QueueLen - rs485QueueSent;
+  if (room <= 0 || n == 0) return;
+  if ((size_t)room < n) n = room;
+  Serial1.write((const uint8_t*)rs485Queue + rs485QueueSent, n);
+  rs485QueueSent += n;
+}
+
+static void releaseRs485() {
+  digitalWrite(RS485_DE_RE_PIN, LOW);
+  rs485QueueLen = 0;
+  rs485QueueSent = 0;
+  rs485Emptied = false;
+}
+
+// Blocking: everything queued leaves the wire before a direct write
+static void finishRs485Queue() {
+  if (rs485QueueLen == 0) return;
+  Serial1.write((const uint8_t*)rs485Queue + rs485QueueSent, rs485QueueLen - rs485QueueSent);
+  Serial1.flush();
+  releaseRs485();
+}
+
+static void queueRs485(const char* message, size_t len) {
+  if (rs485QueueLen + len + 2 > RS485_QUEUE_SIZE && rs485QueueSent > 0) {
+    // Drop what the UART already has
+    memmove(rs485Queue, rs485Queue + rs485QueueSent, rs485QueueLen - rs485QueueSent);
+    rs485QueueLen -= rs485QueueSent;
+    rs485QueueSent = 0;
+  }
+  if (rs485QueueLen + len + 2 > RS485_QUEUE_SIZE) {
+    // Does not fit even then: send it the old way, in order
+    finishRs485Queue();
+    digitalWrite(RS485_DE_RE_PIN, HIGH);
+    Serial1.write((const uint8_t*)message, len);
+    Serial1.write((const uint8_t*)"\r\n", 2);
+    Serial1.flush();
+    digitalWrite(RS485_DE_RE_PIN, LOW);
+    return;
+  }
+  if (rs485QueueLen == 0) {
+    rs485IdleFree = Serial1.availableForWrite();
+    digitalWrite(RS485_DE_RE_PIN, HIGH);
+  }
+  memcpy(rs485Queue + rs485QueueLen, message, len);
+  memcpy(rs485Queue + rs485QueueLen + len, "\r\n", 2);
+  rs485QueueLen += len + 2;
+  rs485Emptied = false;
+  feedRs485();
+}
+
 void initializeCommunication() {
   Serial.begin(9600);
   Serial.println("Arduino Due Oven Controller V6.4 (Individual PID) Initializing...");
 
   SerialUSB.begin(9600);
-  Serial1.begin(9600); // RS485 port
+  Serial1.begin(RS485_BAUD); // RS485 port
+}
+
+void serviceTransmitQueue() {
+  if (rs485QueueLen == 0) return;
+  feedRs485();
+  if (rs485QueueSent < rs485QueueLen) return;
+  if (Serial1.availableForWrite() < rs485IdleFree) return;
+  if (!rs485Emptied) {
+    rs485Emptied = true;
+    rs485EmptiedAt = micros();
+    return;
+  }
+  if (micros() - rs485EmptiedAt >= RS485_RELEASE_US) releaseRs485();
+}
+
+bool isTransmitQueueEmpty() {
+  return rs485QueueLen == 0;
 }
 
-bool isStatusUpdateDue() {
-  if (millis() - lastStatusUpdateTime >= statusUpdateInterval) {
-    lastStatusUpdateTime = millis();
+bool canSendToPort(Stream &port, size_t len) {
+  if (&port != &Serial1 || rs485QueueLen == 0) return true;
+  // Bytes already with the UART are dropped to make room
+  return rs485QueueLen - rs485QueueSent + len + 2 + RS485_QUEUE_RESERVE <= RS485_QUEUE_SIZE;
+}
+
+bool isStatusUpdateDue(OvenController &oven) {
+  if (millis() - oven.lastStatusUpdateTime >= (unsigned long)statusUpdateInterval) {
+    oven.lastStatusUpdateTime = millis();
     return true;
   }
   return false;
 }
 
-void handleIncomingCommands() {
-  if (SerialUSB.available() > 0) processIncomingStream(SerialUSB);
-  if (Serial1.available() > 0) processIncomingStream(Serial1);
+void requestStatusUpdate(OvenController &oven) {
+  oven.lastStatusUpdateTime = millis() - statusUpdateInterval;
+}
+
+void handleIncomingCommands(OvenController &oven) {
+  if (SerialUSB.available() > 0) processIncomingStream(oven, SerialUSB);
+  if (Serial1.available() > 0) processIncomingStream(oven, Serial1);
 }
 
-void processIncomingStream(Stream &port) {
-  String incomingString = port.readStringUntil('\n');
-  if (incomingString.length() == 0) return;
+// "Invalid Target (rod1/rod2/steam)" from the zone table
+static void sendInvalidTarget(Stream &port) {
+  String msg = "Invalid Target (";
+  for (uint8_t z = 0; z < ZONE_COUNT; z++) {
+    if (z > 0) msg += "/";
+    msg += ZONE_TABLE[z].name;
+  }
+  msg += ")";
+  sendErrorToPort(port, msg.c_str());
+}
 
-  Serial.print("Rcvd<- "); Serial.println(incomingString); 
+void processIncomingStream(OvenController &oven, Stream &port) {
+  // Static, not on the stack: only loop() calls in here, one frame at a
+  // time. The document parses in place, so its strings point into 'line'.
+  static char line[COMMAND_LINE_SIZE];
+  static StaticJsonDocument<1024> doc;
+
+  bool &discarding = discardingFor(port);
+  if (discarding) {
+    if (!skipToNewline(port)) return;
+    discarding = false;
+    if (port.available() == 0) return;
+  }
+
+  // Up to a full buffer: COMMAND_LINE_SIZE - 1 characters plus the
+  // newline fit; a full buffer without one is an oversized frame
+  size_t len = port.readBytesUntil('\n', line, sizeof(line));
+  if (len == sizeof(line)) {
+    // Drop the rest of it so it is not parsed as the next frame
+    discarding = !skipToNewline(port);
+    sendErrorToPort(port, "Command too long");
+    return;
+  }
+  if (len == 0) return;
+  line[len] = '\0';
 
-  StaticJsonDocument<1024> doc; 
-  DeserializationError error = deserializeJson(doc, incomingString);
+  Serial.print("Rcvd<- "); Serial.println(line); 
+
+  DeserializationError error = deserializeJson(doc, line);
 
   if (error) {
     sendErrorToPort(port, "Invalid JSON");
@@ -40,66 +210,344 @@ void processIncomingStream(Stream &port) {
   }
 
   const char* command = doc["cmd"];
+  if (command == NULL) {
+    sendErrorToPort(port, "Missing cmd");
+    return;
+  }
 
   if (strcmp(command, "SET_THRESHOLDS") == 0) {
-    settings.thresholds.rod1     = doc["rod1"];
-    settings.thresholds.rod2     = doc["rod2"];
-    settings.thresholds.rodSteam = doc["steam"];
-    settings.recipeTimeMinutes   = doc["time"];
-    
-    if (doc.containsKey("holding")) settings.holdingTimeMinutes = doc["holding"];
-    else settings.holdingTimeMinutes = 30;
+    int recipeMinutes = doc["time"];
+    int holdingMinutes = doc.containsKey("holding") ? (doc["holding"] | 0) : 30;
+    if (!isValidBakeTimes(recipeMinutes, holdingMinutes)) {
+      sendErrorToPort(port, "Invalid time (0..1440) or holding (0..180)");
+      return;
+    }
+    for (uint8_t z = 0; z < ZONE_COUNT; z++) oven.settings.thresholds.zone[z] = doc[ZONE_TABLE[z].name];
+    oven.settings.recipeTimeMinutes   = recipeMinutes;
+    oven.settings.holdingTimeMinutes  = holdingMinutes;
+    if (doc.containsKey("chamber")) oven.settings.cascade.chamberSetpoint = doc["chamber"];
 
+    // "schedule" is the single start of the original HMI: it replaces
+    // any one-shot job (0 just clears them); repeating jobs are kept
+    bool queued = true;
     if (doc.containsKey("schedule")) {
       unsigned long schedTime = doc["schedule"];
+      cancelOneShotJobs(oven);
       if (schedTime > 0) {
-        settings.scheduledUnixTime = schedTime;
-        currentState = AWAITING_SCHEDULE; 
+        ScheduledJob job = makeJobFromSettings(oven);
+        job.startUnix = schedTime;
+        queued = addScheduledJob(oven, job);
         Serial.print("Schedule set for: "); Serial.println(schedTime);
-      } else {
-        settings.scheduledUnixTime = 0;
-        if (currentState == AWAITING_SCHEDULE) currentState = IDLE;
       }
     } else {
-      if (currentState == AWAITING_SCHEDULE) {
-          settings.scheduledUnixTime = 0;
-          currentState = IDLE;
-      }
+      if (oven.currentState == AWAITING_SCHEDULE) cancelOneShotJobs(oven);
     }
 
-    saveSettings();
-    sendToPort(port, "{\"status\":\"ok\", \"msg\":\"Settings Saved\"}");
+    saveSettings(oven);
+    if (queued) sendToPort(port, "{\"status\":\"ok\", \"msg\":\"Settings Saved\"}");
+    else sendErrorToPort(port, "Schedule Full");
   }
 
   // --- NEW: SET INDIVIDUAL PID COMMAND ---
   else if (strcmp(command, "SET_PID") == 0) {
-    const char* target = doc["target"]; // "rod1", "rod2", "steam"
-    double kp = doc["kp"];
-    double ki = doc["ki"];
-    double kd = doc["kd"];
-    
-    PidParams params = {kp, ki, kd};
-    bool updated = false;
-
-    if (strcmp(target, "rod1") == 0) {
-        settings.rod1Pid = params;
-        pidRod1.SetTunings(kp, ki, kd);
-        updated = true;
-    } else if (strcmp(target, "rod2") == 0) {
-        settings.rod2Pid = params;
-        pidRod2.SetTunings(kp, ki, kd);
-        updated = true;
-    } else if (strcmp(target, "steam") == 0) {
-        settings.rodSteamPid = params;
-        pidSteam.SetTunings(kp, ki, kd);
-        updated = true;
+    int zone = zoneByName(doc["target"]); // "rod1", "rod2", "steam"
+    PidParams* params = NULL;
+    QuickPID* pid = NULL;
+
+    if (zone >= 0) {
+        params = &oven.settings.pid[zone];
+        pid = &oven.zonePid[zone];
+    }
+    bool updated = (params != NULL);
+
+    if (updated) {
+      params->kp = doc["kp"];
+      params->ki = doc["ki"];
+      params->kd = doc["kd"];
+      // Optional structure: tt (anti-windup s), n (D filter), b/c (setpoint weights)
+      if (doc.containsKey("tt")) params->tt = doc["tt"];
+      if (doc.containsKey("n"))  params->n  = doc["n"];
+      if (doc.containsKey("b"))  params->b  = doc["b"];
+      if (doc.containsKey("c"))  params->c  = doc["c"];
+      applyPidParams(*pid, *params);
     }
     
     if (updated) {
-      saveSettings();
+      saveSettings(oven);
       sendToPort(port, "{\"status\":\"ok\", \"msg\":\"PID Tuned\"}");
     } else {
-      sendErrorToPort(port, "Invalid Target (rod1/rod2/steam)");
+      sendInvalidTarget(port);
+    }
+  }
+
+  else if (strcmp(command, "SET_GAINS") == 0) {
+    // {"cmd":"SET_GAINS","target":"rod1","key":"setpoint|measurement","points":[[temp,kp,ki,kd],...]}
+    // An empty "points" returns the zone to its fixed SET_PID gains
+    int zone = zoneByName(doc["target"]);
+    if (zone < 0) {
+      sendInvalidTarget(port);
+    } else {
+      GainSchedule* schedule = &oven.settings.gains[zone];
+      JsonArray points = doc["points"];
+      const char* key = doc["key"];
+      schedule->onMeasurement = (key != NULL && strcmp(key, "measurement") == 0);
+      schedule->count = 0;
+      for (size_t i = 0; i < points.size() && schedule->count < PID_MAX_GAIN_POINTS; i++) {
+        JsonArray pt = points[i];
+        GainPoint &gp = schedule->points[schedule->count++];
+        gp.temp = pt[0];
+        gp.kp = pt[1];
+        gp.ki = pt[2];
+        gp.kd = pt[3];
+      }
+      sortGainSchedule(*schedule);
+      applyGainSchedule(oven.zonePid[zone], *schedule);
+      saveSettings(oven);
+      sendToPort(port, "{\"status\":\"ok\", \"msg\":\"Gains Saved\"}");
+    }
+  }
+
+  else if (strcmp(command, "GET_GAINS") == 0) {
+    StaticJsonDocument<256 * ZONE_COUNT> reply;
+    JsonObject gains = reply.createNestedObject("gains");
+    for (uint8_t z = 0; z < ZONE_COUNT; z++) {
+      const GainSchedule &schedule = oven.settings.gains[z];
+      JsonObject zone = gains.createNestedObject(ZONE_TABLE[z].name);
+      zone["key"] = schedule.onMeasurement ? "measurement" : "setpoint";
+      JsonArray points = zone.createNestedArray("points");
+      for (uint8_t i = 0; i < schedule.count; i++) {
+        JsonArray pt = points.createNestedArray();
+        pt.add(schedule.points[i].temp);
+        pt.add(schedule.points[i].kp);
+        pt.add(schedule.points[i].ki);
+        pt.add(schedule.points[i].kd);
+      }
+    }
+    String output;
+    serializeJson(reply, output);
+    sendToPort(port, output);
+  }
+
+  else if (strcmp(command, "SET_MODEL") == 0) {
+    // {"cmd":"SET_MODEL","target":"rod1","gain":K,"tau":s,"dead":s,"weight":0.8,"ambient":25}
+    // gain 0 disables feedforward for the zone; "ambient" alone updates the site ambient
+    int zone = zoneByName(doc["target"]);
+    ThermalModel* model = (zone >= 0) ? &oven.settings.model[zone] : NULL;
+
+    if (doc.containsKey("ambient")) oven.settings.ambientTemp = doc["ambient"];
+    if (model != NULL) {
+      model->gain = doc["gain"];
+      model->tau = doc["tau"];
+      model->deadTime = doc["dead"];
+      if (doc.containsKey("weight")) model->weight = constrain((double)doc["weight"], 0.0, 1.0);
+    }
+
+    if (model != NULL || doc.containsKey("ambient")) {
+      saveSettings(oven);
+      sendToPort(port, "{\"status\":\"ok\", \"msg\":\"Model Saved\"}");
+    } else {
+      sendInvalidTarget(port);
+    }
+  }
+
+  else if (strcmp(command, "SET_OUTPUT_MODE") == 0) {
+    // {"cmd":"SET_OUTPUT_MODE","target":"rod1","mode":"tpc|burst|window"}
+    int channel = zoneByName(doc["target"]);
+
+    bool valid;
+    OutputMode mode = parseOutputMode(doc["mode"], valid);
+    if (channel < 0) {
+      sendInvalidTarget(port);
+    } else if (!valid) {
+      sendErrorToPort(port, "Invalid Mode (tpc/burst/window)");
+    } else {
+      oven.settings.outputMode[channel] = mode;
+      resetSsrOutput(oven, channel);
+      saveSettings(oven);
+      sendToPort(port, "{\"status\":\"ok\", \"msg\":\"Output Mode Set\"}");
+    }
+  }
+
+  else if (strcmp(command, "SET_CASCADE") == 0) {
+    // {"cmd":"SET_CASCADE","enabled":true,"chamber":180,"kp":2,"ki":0.01,"kd":0,"min":0,"max":280}
+    // Missing keys keep their current values; "cascaded" zones follow the outer loop while enabled
+    CascadeSettings cascade = oven.settings.cascade;
+    if (doc.containsKey("enabled")) cascade.enabled = doc["enabled"];
+    if (doc.containsKey("chamber")) cascade.chamberSetpoint = doc["chamber"];
+    if (doc.containsKey("kp")) cascade.pid.kp = doc["kp"];
+    if (doc.containsKey("ki")) cascade.pid.ki = doc["ki"];
+    if (doc.containsKey("kd")) cascade.pid.kd = doc["kd"];
+    if (doc.containsKey("min")) cascade.rodMin = doc["min"];
+    if (doc.containsKey("max")) cascade.rodMax = doc["max"];
+
+    if (cascade.rodMin >= cascade.rodMax || cascade.rodMax > OVERTEMP_LIMIT) {
+      sendErrorToPort(port, "Invalid Rod Limits (min < max <= overtemp)");
+    } else {
+      oven.settings.cascade = cascade;
+      configureCascade(oven);
+      saveSettings(oven);
+      sendToPort(port, "{\"status\":\"ok\", \"msg\":\"Cascade Saved\"}");
+    }
+  }
+
+  else if (strcmp(command, "SET_ZONE_MODE") == 0) {
+    // {"cmd":"SET_ZONE_MODE","target":"rod1","mode":"pid|bang|manual","band":5,"duty":0.4}
+    // Switching is bumpless; "manual" without "duty" holds the current effective duty
+    int zone = zoneByName(doc["target"]);
+
+    bool valid;
+    ZoneMode mode = parseZoneMode(doc["mode"], valid);
+    if (zone < 0) {
+      sendInvalidTarget(port);
+    } else if (!valid) {
+      sendErrorToPort(port, "Invalid Mode (pid/bang/manual)");
+    } else {
+      ZoneControl &ctrl = oven.settings.zoneControl[zone];
+      if (doc.containsKey("band")) ctrl.hysteresis = fabs((double)doc["band"]);
+      if (doc.containsKey("duty")) ctrl.manualDuty = constrain((double)doc["duty"], 0.0, 1.0);
+      else if (mode == ZONE_MODE_MANUAL && ctrl.mode != ZONE_MODE_MANUAL) ctrl.manualDuty = zoneEffectiveDuty(oven, zone);
+      if (mode != ctrl.mode) setZoneMode(oven, zone, mode);
+      saveSettings(oven);
+      sendToPort(port, "{\"status\":\"ok\", \"msg\":\"Zone Mode Set\"}");
+    }
+  }
+
+  else if (strcmp(command, "SET_TUNING") == 0) {
+    // {"cmd":"SET_TUNING","target":"rod1","min_on":3000,"tolerance":3}
+    // {"cmd":"SET_TUNING","target":"chamber","tolerance":3}; missing keys keep their values
+    const char* target = doc["target"];
+    int zone = zoneByName(target);
+    bool chamber = (target != NULL && strcmp(target, "chamber") == 0);
+
+    if (zone < 0 && !chamber) {
+      sendInvalidTarget(port);
+    } else if (doc.containsKey("tolerance") && (double)doc["tolerance"] < 0) {
+      sendErrorToPort(port, "Invalid Tolerance (>= 0)");
+    } else if (zone >= 0 && doc.containsKey("min_on") && (unsigned long)doc["min_on"] > PID_WINDOW_SIZE) {
+      sendErrorToPort(port, "Invalid Min On (0..window)");
+    } else {
+      if (chamber) {
+        if (doc.containsKey("tolerance")) oven.settings.chamberPreheatTolerance = doc["tolerance"];
+      } else {
+        ZoneTuning &tuning = oven.settings.tuning[zone];
+        if (doc.containsKey("min_on")) tuning.minOnMs = doc["min_on"];
+        if (doc.containsKey("tolerance")) tuning.preheatTolerance = doc["tolerance"];
+      }
+      saveSettings(oven);
+      sendToPort(port, "{\"status\":\"ok\", \"msg\":\"Tuning Saved\"}");
+    }
+  }
+
+  else if (strcmp(command, "GET_TUNING") == 0) {
+    StaticJsonDocument<96 + 48 * ZONE_COUNT> reply;
+    JsonObject tuning = reply.createNestedObject("tuning");
+    for (uint8_t z = 0; z < ZONE_COUNT; z++) {
+      JsonObject zone = tuning.createNestedObject(ZONE_TABLE[z].name);
+      zone["min_on"] = oven.settings.tuning[z].minOnMs;
+      zone["tolerance"] = oven.settings.tuning[z].preheatTolerance;
+    }
+    tuning["chamber"]["tolerance"] = oven.settings.chamberPreheatTolerance;
+    String output;
+    serializeJson(reply, output);
+    sendToPort(port, output);
+  }
+
+  else if (strcmp(command, "SET_PREHEAT_MODEL") == 0) {
+    // {"cmd":"SET_PREHEAT_MODEL","margin":300} (s); {"reset":true} forgets the learned rates
+    if (doc["reset"] | false) resetPreheatModel(oven);
+    if (doc.containsKey("margin")) oven.settings.preheat.marginSec = doc["margin"];
+    invalidateScheduledStart(oven);
+    saveSettings(oven);
+    sendToPort(port, "{\"status\":\"ok\", \"msg\":\"Preheat Model Saved\"}");
+  }
+
+  else if (strcmp(command, "GET_PREHEAT_MODEL") == 0) {
+    StaticJsonDocument<128 + 16 * ZONE_COUNT> reply;
+    JsonObject model = reply.createNestedObject("preheat");
+    for (uint8_t z = 0; z < ZONE_COUNT; z++) model[ZONE_TABLE[z].name] = oven.settings.preheat.rate[z];
+    model["chamber"] = oven.settings.preheat.chamberRate;
+    model["samples"] = oven.settings.preheat.samples;
+    model["margin"] = oven.settings.preheat.marginSec;
+    String output;
+    serializeJson(reply, output);
+    sendToPort(port, output);
+  }
+
+  else if (strcmp(command, "SET_RESUME") == 0) {
+    // {"cmd":"SET_RESUME","interval":60,"max_outage":600} (s); interval 0 disables resume
+    ResumeSettings resume = oven.settings.resume;
+    if (doc.containsKey("interval")) resume.checkpointIntervalSec = doc["interval"];
+    if (doc.containsKey("max_outage")) resume.maxOutageSec = doc["max_outage"];
+
+    if (resume.checkpointIntervalSec != 0 && resume.maxOutageSec < resume.checkpointIntervalSec) {
+      sendErrorToPort(port, "Invalid Max Outage (>= interval)");
+    } else {
+      oven.settings.resume = resume;
+      saveSettings(oven);
+      sendToPort(port, "{\"status\":\"ok\", \"msg\":\"Resume Saved\"}");
+    }
+  }
+
+  else if (strcmp(command, "SCHEDULE_ADD") == 0) {
+    // Format in scheduler.h; recipe keys default to the current settings
+    ScheduledJob job = makeJobFromSettings(oven);
+    for (uint8_t z = 0; z < ZONE_COUNT; z++) {
+      if (doc.containsKey(ZONE_TABLE[z].name)) job.thresholds[z] = doc[ZONE_TABLE[z].name];
+    }
+    if (doc.containsKey("time")) job.recipeTimeMinutes = doc["time"];
+    if (doc.containsKey("holding")) job.holdingTimeMinutes = doc["holding"];
+
+    bool readyBy = doc.containsKey("ready") || doc.containsKey("ready_at");
+    if (readyBy) job.repeatDays |= JOB_READY_BY;
+
+    JsonArray days = doc["days"];
+    if (!days.isNull()) {
+      for (JsonVariant d : days) {
+        int day = d | -1;
+        if (day >= 0 && day <= 6) job.repeatDays |= (uint8_t)(1 << day);
+      }
+      job.startMinute = readyBy ? (doc["ready_at"] | 0) : (doc["at"] | 0);
+      job.startUnix = nextOccurrence(job.repeatDays, job.startMinute, wallClockUnix());
+    } else {
+      job.startUnix = readyBy ? (doc["ready"] | 0UL) : (doc["start"] | 0UL);
+    }
+
+    if (!isValidBakeTimes(job.recipeTimeMinutes, job.holdingTimeMinutes)) {
+      sendErrorToPort(port, "Invalid time (0..1440) or holding (0..180)");
+    } else if (job.startUnix == 0 || job.startMinute >= 24 * 60) {
+      sendErrorToPort(port, "Invalid Schedule (start/ready, or days + at/ready_at 0..1439)");
+    } else if (!addScheduledJob(oven, job)) {
+      sendErrorToPort(port, "Schedule Full");
+    } else {
+      saveSettings(oven);
+      StaticJsonDocument<96> reply;
+      reply["status"] = "ok";
+      reply["msg"] = "Job Scheduled";
+      reply["id"] = job.id;
+      String output;
+      serializeJson(reply, output);
+      sendToPort(port, output);
+    }
+  }
+
+  else if (strcmp(command, "SCHEDULE_LIST") == 0) {
+    // Sent by serviceScheduleList() as the port has room
+    ScheduleListing &listing = oven.scheduleListing;
+    listing.count = listScheduledJobs(oven, listing.jobs);
+    listing.index = 0;
+    listing.port = &port;
+  }
+
+  else if (strcmp(command, "SCHEDULE_CANCEL") == 0) {
+    bool cancelled = true;
+    if (doc["all"] | false) cancelAllScheduledJobs(oven);
+    else cancelled = cancelScheduledJob(oven, doc["id"] | 0UL);
+
+    if (cancelled) {
+      saveSettings(oven);
+      sendToPort(port, "{\"status\":\"ok\", \"msg\":\"Job Cancelled\"}");
+    } else {
+      sendErrorToPort(port, "Job not found");
     }
   }
 
@@ -107,118 +555,288 @@ void processIncomingStream(Stream &port) {
     if (doc.containsKey("timestamp")) {
       unsigned long ts = doc["timestamp"];
       rtc.adjust(DateTime(ts + GMT_OFFSET_SEC)); 
+      resyncWallClock();
       sendToPort(port, "{\"status\":\"ok\", \"msg\":\"Time Updated\"}");
     }
   }
   
   else if (strcmp(command, "START_PREHEAT") == 0) {
-    currentState = PREHEATING;
-    settings.scheduledUnixTime = 0; 
-    preheatStartTime = millis(); 
-    preheatComplete = false;
-    saveSettings(); 
+    postOvenEvent(oven, OVEN_EV_START_PREHEAT);
     sendToPort(port, "{\"status\":\"ok\", \"msg\":\"Preheating Started\"}");
   }
 
   else if (strcmp(command, "RUN_RECIPE") == 0) {
-    currentState = RUNNING;
-    recipeStartTime = millis();
+    postOvenEvent(oven, OVEN_EV_RUN_RECIPE);
     sendToPort(port, "{\"status\":\"ok\", \"msg\":\"Recipe Running\"}");
   }
 
   else if (strcmp(command, "STOP") == 0) {
-    currentState = IDLE;
-    settings.scheduledUnixTime = 0;
-    manualControlActive = false;
-    manualValveOverride = false;
-    saveSettings();
+    abortAutotune(oven, "Autotune stopped");
+    postOvenEvent(oven, OVEN_EV_STOP);
     sendToPort(port, "{\"status\":\"ok\", \"msg\":\"Stopped\"}");
   }
 
   else if (strcmp(command, "TOGGLE_VALVE") == 0) {
     bool state = doc["state"];
     if (state) {
-      if (currentTemps[1] > STEAM_SAFETY_THRESHOLD) { 
-        manualValveOverride = true;
-        steamValveOpenTime = millis();
+      if (STEAM_ZONE >= 0 && oven.zones.temp[STEAM_ZONE] > STEAM_SAFETY_THRESHOLD) { 
+        oven.manualValveOverride = true;
+        oven.steamValveOpenTime = millis();
         sendToggleConfirmation(port, "valve", true);
       } else {
         sendErrorToPort(port, "Safety Error: Steam Rod too cold");
       }
     } else {
-      manualValveOverride = false;
+      oven.manualValveOverride = false;
       sendToggleConfirmation(port, "valve", false);
     }
   }
 
   else if (strcmp(command, "TOGGLE_LIGHT") == 0) {
-    relayStates.light = doc["state"];
-    applyRelayStates();
-    sendToggleConfirmation(port, "light", relayStates.light);
+    oven.relayStates.light = doc["state"];
+    applyRelayStates(oven);
+    sendToggleConfirmation(port, "light", oven.relayStates.light);
+  }
+
+  else if (strcmp(command, "DUMP_RECORDER") == 0) {
+    // {"cmd":"DUMP_RECORDER"} streams the buffer; "rearm":true clears a fault capture
+    bool rearm = doc["rearm"];
+    if (rearm) {
+      rearmRecorder(oven);
+      sendToPort(port, "{\"status\":\"ok\", \"msg\":\"Recorder Armed\"}");
+    } else {
+      startRecorderDump(oven, port);
+    }
+  }
+
+  else if (strcmp(command, "AUTOTUNE") == 0) {
+    // {"cmd":"AUTOTUNE","target":"rod1","setpoint":180,"rule":"zn|pi|tl|no_overshoot","commit":true}
+    double setpoint = doc["setpoint"];
+    int zone = zoneByName(doc["target"]);
+    // Default to the zone's current threshold
+    if (setpoint <= 0 && zone >= 0) setpoint = oven.settings.thresholds.zone[zone];
+    bool commit = doc["commit"];
+    const char* msg = "";
+    if (zone < 0) {
+      sendInvalidTarget(port);
+    } else if (startAutotune(oven, port, zone, setpoint, parseAutotuneRule(doc["rule"]), commit, msg)) {
+      sendToPort(port, "{\"status\":\"ok\", \"msg\":\"Autotune Started\"}");
+    } else {
+      sendErrorToPort(port, msg);
+    }
+  }
+
+  else if (strcmp(command, "SET_POWER_BUDGET") == 0) {
+    // {"cmd":"SET_POWER_BUDGET","max_kw":6.0,"max_heaters":2}; 0 = no limit, missing keys keep their values
+    PowerLimits limits = oven.settings.power;
+    if (doc.containsKey("max_kw")) limits.maxKw = doc["max_kw"];
+    long heaters = doc.containsKey("max_heaters") ? (long)doc["max_heaters"] : (long)limits.maxHeaters;
+    float largestKw = 0;
+    for (uint8_t z = 0; z < ZONE_COUNT; z++) {
+      if (ZONE_TABLE[z].powerKw > largestKw) largestKw = ZONE_TABLE[z].powerKw;
+    }
+    // A limit below one heater's rating would never let that heater on
+    if (limits.maxKw < 0 || (limits.maxKw > 0 && limits.maxKw < largestKw)) {
+      sendErrorToPort(port, "Invalid Max kW (0 or >= largest heater)");
+    } else if (heaters < 0 || heaters > 255) {
+      sendErrorToPort(port, "Invalid Max Heaters (0..255)");
+    } else {
+      limits.maxHeaters = (uint8_t)heaters;
+      oven.settings.power = limits;
+      saveSettings(oven);
+      sendToPort(port, "{\"status\":\"ok\", \"msg\":\"Power Budget Saved\"}");
+    }
+  }
+
+  else if (strcmp(command, "GET_POWER") == 0) {
+    const PowerBudgetStats &stats = getPowerBudgetStats(oven);
+    StaticJsonDocument<256> reply;
+    JsonObject power = reply.createNestedObject("power");
+    power["windows"] = stats.windows;
+    power["limited"] = stats.constrainedWindows;
+    JsonArray deferred = power.createNestedArray("deferred_ms");
+    for (uint8_t i = 0; i < ZONE_COUNT; i++) deferred.add(stats.deferredMs[i]);
+    power["max_kw"] = oven.settings.power.maxKw;
+    power["max_heaters"] = oven.settings.power.maxHeaters;
+    String output;
+    serializeJson(reply, output);
+    sendToPort(port, output);
+  }
+
+  else if (strcmp(command, "GET_TIMING") == 0) {
+    const ControlTimingStats &stats = getControlTimingStats(oven);
+    StaticJsonDocument<256> reply;
+    JsonObject timing = reply.createNestedObject("timing");
+    timing["ticks"] = stats.ticks;
+    timing["serviced"] = stats.serviced;
+    timing["missed"] = stats.missed;
+    timing["latency_max_us"] = stats.maxLatencyUs;
+    timing["dt_min_us"] = stats.serviced > 1 ? stats.minDtUs : 0;
+    timing["dt_max_us"] = stats.maxDtUs;
+    timing["dt_mean_us"] = stats.meanDtUs;
+    String output;
+    serializeJson(reply, output);
+    sendToPort(port, output);
+    if (doc["reset"] | false) resetControlTimingStats(oven);
+  }
+
+  else if (strcmp(command, "GET_PROFILE") == 0) {
+    StaticJsonDocument<768> reply;
+    JsonObject profile = reply.createNestedObject("profile");
+    for (uint8_t i = 0; i < PROF_COUNT; i++) {
+      const ProfileStats &s = getProfileStats(oven, (ProfileSection)i);
+      JsonObject section = profile.createNestedObject(profileSectionName((ProfileSection)i));
+      section["n"] = s.count;
+      section["avg_ns"] = s.count ? profileCyclesToNs((uint32_t)(s.totalCycles / s.count)) : 0;
+      section["min_ns"] = s.count ? profileCyclesToNs(s.minCycles) : 0;
+      section["max_ns"] = profileCyclesToNs(s.maxCycles);
+    }
+    String output;
+    serializeJson(reply, output);
+    sendToPort(port, output);
+    if (doc["reset"] | false) resetProfileStats(oven);
+  }
+
+  else if (strcmp(command, "GET_TRANSITIONS") == 0) {
+    // One entry per transition table row: from (or "*"), event, to, times taken, last time
+    StaticJsonDocument<128 + 96 * OVEN_TRANSITION_ROWS> reply;
+    JsonArray rows = reply.createNestedArray("transitions");
+    for (uint8_t i = 0; i < getTransitionCount(); i++) {
+      TransitionInfo info = getTransitionInfo(oven, i);
+      JsonObject row = rows.createNestedObject();
+      row["from"] = (info.from < 0) ? "*" : ovenStateName((OvenState)info.from);
+      row["event"] = ovenEventName(info.event);
+      row["to"] = ovenStateName(info.to);
+      row["n"] = info.count;
+      row["last"] = info.lastUnix;
+    }
+    reply["dropped"] = getDroppedOvenEvents(oven);
+    String output;
+    serializeJson(reply, output);
+    sendToPort(port, output);
+  }
+
+  else if (strcmp(command, "LOG_LIST") == 0) {
+    startLogList(port);
+  }
+
+  else if (strcmp(command, "LOG_READ") == 0) {
+    const char* file = doc["file"];
+    uint32_t offset = doc["offset"];
+    uint32_t len = doc["len"];
+    if (!startLogRead(port, file, offset, len)) {
+      sendErrorToPort(port, "Log file not found");
+    }
+  }
+
+  else if (strcmp(command, "LOG_ACK") == 0) {
+    uint32_t offset = doc["offset"];
+    acknowledgeLogChunk(offset);
+  }
+
+  else if (strcmp(command, "LOG_ABORT") == 0) {
+    abortLogTransfer();
+    sendToPort(port, "{\"status\":\"ok\", \"msg\":\"Log Transfer Aborted\"}");
+  }
+
+  else {
+    sendErrorToPort(port, "Unknown cmd");
   }
 }
 
-void sendStatusUpdate() {
-  StaticJsonDocument<512> doc;
+void sendStatusUpdate(OvenController &oven) {
+  StaticJsonDocument<432 + 32 * ZONE_COUNT> doc;
   
-  String stateStr = "IDLE";
-  if (currentState == PREHEATING) stateStr = "PREHEATING";
-  else if (currentState == READY) stateStr = "READY";
-  else if (currentState == RUNNING) stateStr = "RUNNING";
-  else if (currentState == ALARM_COMPLETION) stateStr = "DONE";
-  else if (currentState == AWAITING_SCHEDULE) stateStr = "SCHEDULED";
-
-  doc["state"] = stateStr;
+  doc["state"] = ovenStateName(oven.currentState);
   
   JsonArray tempArray = doc.createNestedArray("temps");
-  tempArray.add(currentTemps[0]);
-  tempArray.add(currentTemps[1]);
-  tempArray.add(currentTemps[2]);
+  float slotTemps[ZONE_COUNT];
+  for (uint8_t z = 0; z < ZONE_COUNT; z++) slotTemps[ZONE_TABLE[z].statusSlot] = oven.zones.temp[z];
+  for (uint8_t i = 0; i < ZONE_COUNT; i++) tempArray.add(slotTemps[i]);
+  if (oven.settings.cascade.enabled) {
+    doc["chamber"] = oven.chamberTemp;
+    doc["chamberSet"] = oven.settings.cascade.chamberSetpoint;
+  }
 
   long remainingSeconds = 0;
-  if (currentState == RUNNING) {
-    long elapsed = (millis() - recipeStartTime) / 1000;
-    remainingSeconds = (settings.recipeTimeMinutes * 60) - elapsed;
-  } else if (currentState == READY) {
-     long elapsed = (millis() - holdingStartTime) / 1000;
-     remainingSeconds = (settings.holdingTimeMinutes * 60) - elapsed;
-  } else if (currentState == AWAITING_SCHEDULE) {
-     remainingSeconds = settings.scheduledUnixTime - rtc.now().unixtime();
+  if (oven.currentState == RUNNING) {
+    long elapsed = (millis() - oven.recipeStartTime) / 1000;
+    remainingSeconds = (oven.settings.recipeTimeMinutes * 60) - elapsed;
+  } else if (oven.currentState == READY) {
+     long elapsed = (millis() - oven.holdingStartTime) / 1000;
+     remainingSeconds = (oven.settings.holdingTimeMinutes * 60) - elapsed;
+  } else if (oven.currentState == AWAITING_SCHEDULE) {
+     remainingSeconds = (long)(nextScheduledStart(oven) - wallClockUnix());
   }
   
   doc["timer"] = remainingSeconds > 0 ? remainingSeconds : 0;
+
+  // Predicted seconds until READY
+  if (oven.currentState == PREHEATING) {
+    doc["eta"] = predictPreheatSec(oven, oven.settings.thresholds.zone);
+  } else if (oven.currentState == AWAITING_SCHEDULE) {
+    long eta = (long)(nextScheduledReady(oven) - wallClockUnix());
+    doc["eta"] = eta > 0 ? eta : 0;
+  }
   
   JsonObject relays = doc.createNestedObject("relays");
-  relays["rod1"] = relayStates.rod1;
-  relays["rod2"] = relayStates.rod2;
-  relays["rodSteam"] = relayStates.rodSteam;
-  relays["valve"] = manualValveOverride;
-  relays["light"] = relayStates.light;
-  relays["alarm"] = relayStates.alarm;
+  for (uint8_t z = 0; z < ZONE_COUNT; z++) relays[ZONE_TABLE[z].statusKey] = oven.relayStates.zone[z];
+  relays["valve"] = oven.manualValveOverride;
+  relays["light"] = oven.relayStates.light;
+  relays["alarm"] = oven.relayStates.alarm;
   
-  doc["valve"] = manualValveOverride ? "ON" : "OFF"; 
+  doc["valve"] = oven.manualValveOverride ? "ON" : "OFF"; 
   
-  DateTime now = rtc.now();
+  DateTime now = wallClockNow();
   doc["time"] = now.timestamp(DateTime::TIMESTAMP_FULL);
 
   String output;
   serializeJson(doc, output);
   
   if (SerialUSB) SerialUSB.println(output);
-  if (Serial1) {
-    digitalWrite(RS485_DE_RE_PIN, HIGH);
-    Serial1.println(output);
-    Serial1.flush();
-    digitalWrite(RS485_DE_RE_PIN, LOW);
+  if (Serial1) queueRs485(output.c_str(), output.length());
+}
+
+static String scheduledJobFrame(const OvenController &oven, const ScheduledJob &job) {
+  StaticJsonDocument<208 + 16 * ZONE_COUNT> reply;
+  JsonObject entry = reply.createNestedObject("job");
+  bool readyBy = (job.repeatDays & JOB_READY_BY) != 0;
+  entry["id"] = job.id;
+  entry["start"] = scheduledJobStart(oven, job);
+  if (readyBy) entry["ready"] = job.startUnix;
+  if (job.repeatDays & JOB_WEEKDAY_MASK) {
+    JsonArray days = entry.createNestedArray("days");
+    for (uint8_t d = 0; d < 7; d++) {
+      if (job.repeatDays & (1 << d)) days.add(d);
+    }
+    entry[readyBy ? "ready_at" : "at"] = job.startMinute;
+  }
+  for (uint8_t z = 0; z < ZONE_COUNT; z++) entry[ZONE_TABLE[z].name] = job.thresholds[z];
+  entry["time"] = job.recipeTimeMinutes;
+  entry["holding"] = job.holdingTimeMinutes;
+  String output;
+  serializeJson(reply, output);
+  return output;
+}
+
+void serviceScheduleList(OvenController &oven) {
+  ScheduleListing &listing = oven.scheduleListing;
+  if (listing.port == NULL) return;
+  for (; listing.index < listing.count; listing.index++) {
+    String output = scheduledJobFrame(oven, listing.jobs[listing.index]);
+    if (!canSendToPort(*listing.port, output.length())) return;
+    sendToPort(*listing.port, output);
   }
+  char endMarker[40];
+  snprintf(endMarker, sizeof(endMarker), "{\"job\":\"end\",\"count\":%u}", listing.count);
+  if (!canSendToPort(*listing.port, strlen(endMarker))) return;
+  sendToPort(*listing.port, endMarker);
+  listing.port = NULL;
 }
 
 void sendToPort(Stream &port, const String& message) {
-  if (&port == &Serial1) { 
-    digitalWrite(RS485_DE_RE_PIN, HIGH);
-    port.println(message);
-    port.flush(); 
-    digitalWrite(RS485_DE_RE_PIN, LOW);
+  if (&port == &Serial1) {
+    queueRs485(message.c_str(), message.length());
   } else {
     port.println(message);
   }
@@ -244,19 +862,19 @@ void sendErrorToPort(Stream &port, const char* errorMessage) {
   sendToPort(port, output);
 }
 
-void printDebugInfo() {
+void printDebugInfo(const OvenController &oven) {
   Serial.println("---[ DEBUG (Every 3s) ]---");
   
-  DateTime now = rtc.now();
+  DateTime now = wallClockNow();
   Serial.print("  RTC: ");
   Serial.print(now.hour()); Serial.print(':');
   Serial.println(now.minute());
 
   Serial.print("  State: "); 
-  Serial.println(currentState);
+  Serial.println(oven.currentState);
   
-  Serial.print("  T1: "); Serial.print(currentTemps[0]);
-  Serial.print(" | Setpoint: "); Serial.println(pidSetpointRod1);
+  Serial.print("  T1: "); Serial.print(oven.zones.temp[0]);
+  Serial.print(" | Setpoint: "); Serial.println((double)oven.zones.setpoint[0]);
   
   Serial.println("---------------------------");
 }
\ No newline at end of file
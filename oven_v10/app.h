@@ -5,13 +5,27 @@
 
 // Prototypes for application-layer functions
 void initializeCommunication();
-bool isStatusUpdateDue();
-void handleIncomingCommands();
-void processIncomingStream(Stream &port);
-void sendStatusUpdate();
+bool isStatusUpdateDue(OvenController &oven);
+// Make the next isStatusUpdateDue() true (e.g. on a state change)
+void requestStatusUpdate(OvenController &oven);
+void handleIncomingCommands(OvenController &oven);
+void processIncomingStream(OvenController &oven, Stream &port);
+void sendStatusUpdate(OvenController &oven);
+// Called every loop; sends the pending SCHEDULE_LIST frames that fit
+void serviceScheduleList(OvenController &oven);
+// RS485 replies are queued; serviceTransmitQueue() (every loop) feeds
+// them to the UART without waiting for the wire
 void sendToPort(Stream &port, const String& message);
+void serviceTransmitQueue();
+bool isTransmitQueueEmpty();
+// True if sendToPort() can take a 'len'-byte frame without blocking:
+// always off RS485, else when the queue has room for it and for a
+// status frame after it (or is empty, for frames larger than that).
+// Multi-frame replies check it before each frame and continue on a
+// later pass.
+bool canSendToPort(Stream &port, size_t len);
 void sendErrorToPort(Stream &port, const char* errorMessage);
 void sendToggleConfirmation(Stream &port, const char* relayName, bool newState);
-void printDebugInfo();
+void printDebugInfo(const OvenController &oven);
 
 #endif // APP_H
\ No newline at end of file
@@ -0,0 +1,188 @@
+#include "autotune.h"
+#include "app.h"      // Needs sendToPort()
+#include "drivers.h"  // Needs saveSettings()
+#include "oven_logic.h" // Needs applyPidParams()
+#include "zone_mode.h"  // Needs setZoneMode()
+
+struct TuneZone {
+  const char* name;
+  QuickPID* pid;
+  PidReal* input;
+  PidReal* output;
+  PidParams* params;
+  GainSchedule* gains;
+};
+
+static TuneZone zoneFor(OvenController &oven, int zone) {
+  return {ZONE_TABLE[zone].name, &oven.zonePid[zone], &oven.zones.input[zone], &oven.zones.output[zone],
+          &oven.settings.pid[zone], &oven.settings.gains[zone]};
+}
+
+AutotuneRule parseAutotuneRule(const char* name) {
+  if (name == NULL) return AUTOTUNE_RULE_ZN_PID;
+  if (strcmp(name, "pi") == 0) return AUTOTUNE_RULE_ZN_PI;
+  if (strcmp(name, "tl") == 0) return AUTOTUNE_RULE_TYREUS_LUYBEN;
+  if (strcmp(name, "no_overshoot") == 0) return AUTOTUNE_RULE_NO_OVERSHOOT;
+  return AUTOTUNE_RULE_ZN_PID;
+}
+
+// Nothing heating: idle, or waiting for a scheduled bake (which holds
+// off while a tune runs, see jobDue() in state_machine.cpp)
+static bool isOvenQuiet(const OvenController &oven) {
+  return oven.currentState == IDLE || oven.currentState == AWAITING_SCHEDULE;
+}
+
+bool isAutotuneActive(const OvenController &oven, int zone) {
+  return oven.autotune.activeZone == zone;
+}
+
+bool isAutotuneRunning(const OvenController &oven) {
+  return oven.autotune.activeZone >= 0;
+}
+
+bool startAutotune(OvenController &oven, Stream &port, int zone, double setpoint, AutotuneRule rule, bool commit, const char* &msg) {
+  if (zone < 0 || zone >= ZONE_COUNT) { msg = "Invalid Target"; return false; }
+  if (!isOvenQuiet(oven)) { msg = "Autotune requires IDLE"; return false; }
+  if (isAutotuneRunning(oven)) { msg = "Autotune already running"; return false; }
+  if (setpoint <= 0 || setpoint + AUTOTUNE_MAX_OVERSHOOT > OVERTEMP_LIMIT) { msg = "Autotune setpoint out of range"; return false; }
+
+  TuneZone z = zoneFor(oven, zone);
+  z.pid->SetMode(QuickPID::MANUAL);
+  *z.output = (PidReal)PID_WINDOW_SIZE;
+
+  AutotuneState &t = oven.autotune;
+  t.activeZone = zone;
+  t.reportPort = &port;
+  t.setpoint = setpoint;
+  t.rule = rule;
+  t.commitGains = commit;
+  t.startTime = millis();
+  t.outputHigh = true;
+  t.peakMax = t.peakMin = (double)*z.input;
+  t.risingSwitches = 0;
+  t.measuredCycles = 0;
+  t.sumPeriodMs = t.sumAmplitude = 0;
+
+  Serial.print("Autotune started on "); Serial.println(z.name);
+  return true;
+}
+
+// Hand the zone back to its configured mode: bang-bang and manual
+// zones must not be left with their PID switched to AUTOMATIC
+static void finishAutotune(OvenController &oven) {
+  uint8_t zone = (uint8_t)oven.autotune.activeZone;
+  TuneZone z = zoneFor(oven, zone);
+  *z.output = (PidReal)0;
+  oven.autotune.activeZone = -1;
+  setZoneMode(oven, zone, (ZoneMode)oven.settings.zoneControl[zone].mode);
+}
+
+void abortAutotune(OvenController &oven, const char* reason) {
+  if (!isAutotuneRunning(oven)) return;
+  Serial.print("Autotune aborted: "); Serial.println(reason);
+  if (oven.autotune.reportPort != NULL) sendErrorToPort(*oven.autotune.reportPort, reason);
+  finishAutotune(oven);
+}
+
+static void reportResult(const AutotuneState &t, const char* name, double ku, double pu, const PidParams &p) {
+  StaticJsonDocument<256> doc;
+  JsonObject res = doc.createNestedObject("autotune");
+  res["target"] = name;
+  res["ku"] = ku;
+  res["pu"] = pu;
+  res["kp"] = p.kp;
+  res["ki"] = p.ki;
+  res["kd"] = p.kd;
+  res["committed"] = t.commitGains;
+  String output;
+  serializeJson(doc, output);
+  sendToPort(*t.reportPort, output);
+}
+
+static void computeGains(OvenController &oven) {
+  AutotuneState &t = oven.autotune;
+  TuneZone z = zoneFor(oven, t.activeZone);
+
+  // Relay amplitude d is half the output swing; a is half the peak-to-peak input
+  double d = PID_WINDOW_SIZE / 2.0;
+  double a = t.sumAmplitude / t.measuredCycles;
+  double pu = (t.sumPeriodMs / t.measuredCycles) / 1000.0; // seconds
+  if (a <= 0 || pu <= 0) {
+    abortAutotune(oven, "Autotune: no oscillation measured");
+    return;
+  }
+  double ku = (4.0 * d) / (PI * a);
+
+  // Kp, Ti, Td -> Kp, Ki = Kp/Ti, Kd = Kp*Td (per second, as SetTunings expects)
+  double kp, ti, td;
+  switch (t.rule) {
+    case AUTOTUNE_RULE_ZN_PI:          kp = 0.45 * ku;  ti = pu / 1.2; td = 0;          break;
+    case AUTOTUNE_RULE_TYREUS_LUYBEN:  kp = ku / 2.2;   ti = 2.2 * pu; td = pu / 6.3;   break;
+    case AUTOTUNE_RULE_NO_OVERSHOOT:   kp = 0.2 * ku;   ti = pu / 2.0; td = pu / 3.0;   break;
+    default:                           kp = 0.6 * ku;   ti = pu / 2.0; td = pu / 8.0;   break;
+  }
+  // Keep the zone's anti-windup/filter/weights, replace only the gains
+  PidParams p = *z.params;
+  p.kp = kp;
+  p.ki = kp / ti;
+  p.kd = kp * td;
+
+  if (t.commitGains) {
+    *z.params = p;
+    applyPidParams(*z.pid, p);
+    // With a gain table in use, the result becomes the point at this setpoint
+    if (z.gains->count > 0) {
+      GainPoint point = {t.setpoint, p.kp, p.ki, p.kd};
+      upsertGainPoint(*z.gains, point);
+      applyGainSchedule(*z.pid, *z.gains);
+    }
+    saveSettings(oven);
+  }
+  reportResult(t, z.name, ku, pu, p);
+  Serial.print("Autotune done on "); Serial.println(z.name);
+  finishAutotune(oven);
+}
+
+void updateAutotune(OvenController &oven) {
+  if (!isAutotuneRunning(oven)) return;
+
+  AutotuneState &t = oven.autotune;
+  TuneZone z = zoneFor(oven, t.activeZone);
+  double input = (double)*z.input;
+  unsigned long now = millis();
+
+  // --- Safety limits ---
+  if (!isOvenQuiet(oven)) { abortAutotune(oven, "Autotune: oven left IDLE"); return; }
+  if (isnan(input)) { abortAutotune(oven, "Autotune: sensor fault"); return; }
+  if (input > t.setpoint + AUTOTUNE_MAX_OVERSHOOT || input > OVERTEMP_LIMIT) {
+    abortAutotune(oven, "Autotune: overtemperature");
+    return;
+  }
+  if (now - t.startTime > AUTOTUNE_TIMEOUT_MS) { abortAutotune(oven, "Autotune: timed out"); return; }
+
+  if (input > t.peakMax) t.peakMax = input;
+  if (input < t.peakMin) t.peakMin = input;
+
+  if (t.outputHigh && input > t.setpoint + AUTOTUNE_HYSTERESIS) {
+    t.outputHigh = false;
+  } else if (!t.outputHigh && input < t.setpoint - AUTOTUNE_HYSTERESIS) {
+    t.outputHigh = true;
+    // One full cycle lies between consecutive rising switches; the
+    // first one still carries the heat-up transient and is skipped.
+    if (t.risingSwitches > 0) {
+      t.sumPeriodMs += (double)(now - t.lastRiseTime);
+      t.sumAmplitude += (t.peakMax - t.peakMin) / 2.0;
+      t.measuredCycles++;
+    }
+    t.risingSwitches++;
+    t.lastRiseTime = now;
+    t.peakMax = t.peakMin = input;
+
+    if (t.measuredCycles >= AUTOTUNE_CYCLES) {
+      computeGains(oven);
+      return;
+    }
+  }
+
+  *z.output = t.outputHigh ? (PidReal)PID_WINDOW_SIZE : (PidReal)0;
+}
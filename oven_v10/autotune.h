@@ -0,0 +1,31 @@
+#ifndef AUTOTUNE_H
+#define AUTOTUNE_H
+
+#include "config.h"
+
+// =================================================================
+// RELAY-FEEDBACK AUTOTUNE (Astrom-Hagglund)
+// =================================================================
+// Drives one zone's TPC output between 0 and PID_WINDOW_SIZE around a
+// setpoint, measures the ultimate gain Ku and period Pu from the
+// resulting limit cycle, and derives PID gains with a tuning rule.
+// Runs only from IDLE (or waiting for a scheduled bake, which holds
+// off until the tune ends); the tuned zone is exempt from the IDLE
+// heater override while every other zone stays off.
+// Experiment state: oven.autotune (AutotuneState, config.h).
+
+// Returns false (with msg set) if the experiment cannot start
+bool startAutotune(OvenController &oven, Stream &port, int zone, double setpoint, AutotuneRule rule, bool commit, const char* &msg);
+
+void abortAutotune(OvenController &oven, const char* reason);
+
+// Called every loop after the PIDs; owns the tuned zone's output
+void updateAutotune(OvenController &oven);
+
+// True if 'zone' (index into ZONE_TABLE) is being tuned
+bool isAutotuneActive(const OvenController &oven, int zone);
+bool isAutotuneRunning(const OvenController &oven);
+
+AutotuneRule parseAutotuneRule(const char* name);
+
+#endif // AUTOTUNE_H
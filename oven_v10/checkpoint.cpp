@@ -0,0 +1,107 @@
+#include "checkpoint.h"
+#include "state_machine.h" // Needs resumeOvenState()
+#include "wallclock.h"     // Needs wallClockUnix()
+
+const uint32_t CHECKPOINT_MAGIC = 0x42414B45UL; // "BAKE"
+
+static_assert(sizeof(BakeCheckpoint) <= CHECKPOINT_SLOT_STRIDE, "Checkpoint must fit its slot");
+
+static bool isBakeState(OvenState s) {
+  return s == PREHEATING || s == RUNNING || s == READY;
+}
+
+static uint32_t checkWord(const BakeCheckpoint &c) {
+  return c.magic ^ c.sequence ^ c.unixTime ^ c.state ^ c.elapsedMs;
+}
+
+static uint32_t slotAddress(uint16_t slot) {
+  return CHECKPOINT_FLASH_OFFSET + (uint32_t)slot * CHECKPOINT_SLOT_STRIDE;
+}
+
+static unsigned long elapsedInState(const OvenController &oven) {
+  if (oven.currentState == RUNNING) return millis() - oven.recipeStartTime;
+  if (oven.currentState == READY) return millis() - oven.holdingStartTime;
+  return 0;
+}
+
+static void writeCheckpoint(OvenController &oven) {
+  CheckpointState &cp = oven.checkpoint;
+  BakeCheckpoint c;
+  c.magic = CHECKPOINT_MAGIC;
+  c.sequence = cp.nextSequence++;
+  c.unixTime = wallClockUnix();
+  c.state = (uint32_t)oven.currentState;
+  c.elapsedMs = elapsedInState(oven);
+  c.check = checkWord(c);
+  dueFlashStorage.write(slotAddress(cp.nextSlot), (byte*)&c, sizeof(c));
+
+  cp.nextSlot = (cp.nextSlot + 1) % CHECKPOINT_SLOTS;
+  cp.lastWrittenState = oven.currentState;
+  cp.lastWriteTime = millis();
+}
+
+bool resumeFromCheckpoint(OvenController &oven) {
+  // Newest valid slot; the write position continues after it
+  CheckpointState &cp = oven.checkpoint;
+  BakeCheckpoint newest = {};
+  bool found = false;
+  for (uint16_t slot = 0; slot < CHECKPOINT_SLOTS; slot++) {
+    BakeCheckpoint c;
+    memcpy(&c, dueFlashStorage.readAddress(slotAddress(slot)), sizeof(c));
+    if (c.magic != CHECKPOINT_MAGIC || c.check != checkWord(c)) continue;
+    if (!found || (int32_t)(c.sequence - newest.sequence) > 0) {
+      newest = c;
+      found = true;
+      cp.nextSlot = (slot + 1) % CHECKPOINT_SLOTS;
+    }
+  }
+  if (!found) return false;
+  cp.nextSequence = newest.sequence + 1;
+
+  const ResumeSettings &policy = oven.settings.resume;
+  OvenState state = (OvenState)newest.state;
+  if (policy.checkpointIntervalSec == 0 || !isBakeState(state)) return false;
+
+  // Without a trustworthy clock the outage can't be measured
+  if (rtcLostPowerAtBoot) {
+    Serial.println("RTC lost power, bake checkpoint not resumed.");
+    return false;
+  }
+  uint32_t now = wallClockUnix();
+  if (now < newest.unixTime) {
+    Serial.print("Clock is "); Serial.print(newest.unixTime - now);
+    Serial.println(" s behind the bake checkpoint, not resumed.");
+    return false;
+  }
+  uint32_t outageSec = now - newest.unixTime;
+  if (outageSec > policy.maxOutageSec) {
+    Serial.print("Bake checkpoint too old to resume ("); Serial.print(outageSec); Serial.println(" s).");
+    return false;
+  }
+
+  unsigned long elapsedMs = newest.elapsedMs;
+  if (state == READY) elapsedMs += outageSec * 1000UL;
+
+  Serial.print("Resuming bake after "); Serial.print(outageSec); Serial.print(" s outage, elapsed ");
+  Serial.print(elapsedMs / 1000UL); Serial.println(" s.");
+  // lastWrittenState stays IDLE: a fresh checkpoint follows as soon as
+  // the state machine has re-entered the bake
+  resumeOvenState(oven, state, elapsedMs);
+  return true;
+}
+
+void updateCheckpoint(OvenController &oven) {
+  uint32_t intervalSec = oven.settings.resume.checkpointIntervalSec;
+  if (intervalSec == 0) return;
+
+  const CheckpointState &cp = oven.checkpoint;
+  bool baking = isBakeState(oven.currentState);
+  if (baking) {
+    if (oven.currentState != cp.lastWrittenState || millis() - cp.lastWriteTime >= intervalSec * 1000UL) {
+      writeCheckpoint(oven);
+    }
+  } else if (isBakeState(cp.lastWrittenState)) {
+    // Bake over: one closing record so the next boot does not resume it
+    writeCheckpoint(oven);
+  }
+}
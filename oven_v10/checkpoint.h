@@ -0,0 +1,40 @@
+#ifndef CHECKPOINT_H
+#define CHECKPOINT_H
+
+#include "config.h"
+
+// =================================================================
+// POWER-LOSS RESUME
+// =================================================================
+// While a bake runs (PREHEATING, RUNNING, READY) its state and elapsed
+// recipe/holding time are written every checkpointIntervalSec to the
+// next slot of a flash ring (CHECKPOINT_*), plus once on entering and
+// once on leaving those states. Nothing is written while idle.
+//
+// At boot the newest valid slot is resumed if the outage (RTC now -
+// checkpoint time) is within maxOutageSec:
+//  - RUNNING resumes with the checkpointed recipe time; time without
+//    heat does not bake, so the outage is not counted
+//  - READY counts the outage against the holding time, which is a
+//    wall-clock wait for the operator
+//  - PREHEATING starts its preheat over
+// The outage can't be known, so nothing is resumed, when the RTC lost
+// power (its time is the build date) or reads before the checkpoint.
+
+struct BakeCheckpoint {
+  uint32_t magic;     // CHECKPOINT_MAGIC
+  uint32_t sequence;  // Newest valid slot wins
+  uint32_t unixTime;  // Wall clock at the write
+  uint32_t state;     // OvenState
+  uint32_t elapsedMs; // Recipe (RUNNING) or holding (READY) time done
+  uint32_t check;     // XOR of the words above, catches torn writes
+};
+
+// Find the newest slot and resume from it when the policy allows.
+// Called from initializeLogic(); true if a bake was resumed.
+bool resumeFromCheckpoint(OvenController &oven);
+
+// Called every loop
+void updateCheckpoint(OvenController &oven);
+
+#endif // CHECKPOINT_H
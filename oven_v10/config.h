@@ -15,10 +15,88 @@
 const int CTRL_OFFSET = 10;
 // PID Configuration
 const int PID_COMPUTE_FREQ = 100; // Compute every 100ms
-const int PID_WINDOW_SIZE = 6000; // Time Proportional Control Window
+// Build flag -DPID_WINDOW_MS=... (a multiple of POWER_SLOT_MS) for window sweeps
+#ifndef PID_WINDOW_MS
+#define PID_WINDOW_MS 6000
+#endif
+const int PID_WINDOW_SIZE = PID_WINDOW_MS; // Time Proportional Control Window
+
+// Accepted recipe and holding times (minutes)
+const int MAX_RECIPE_MINUTES = 24 * 60;
+const int MAX_HOLDING_MINUTES = 180;
+
+// --- SSR OUTPUT MODES ---
+const unsigned long MAINS_CYCLE_MS = 20;  // 50 Hz mains
+const unsigned long SSR_WINDOW_MS = 1000; // Short window for OUTPUT_MODE_SHORT_WINDOW
+
+// --- CASCADE (chamber air -> rod setpoints) ---
+const unsigned long CASCADE_COMPUTE_FREQ = 1000; // Outer loop period (ms), inner rods stay at PID_COMPUTE_FREQ
+const double CASCADE_DEFAULT_KP = 2.0;    // C of rod setpoint per C of chamber error
+const double CASCADE_DEFAULT_KI = 0.01;
+const double CASCADE_DEFAULT_KD = 0.0;
+const double CASCADE_DEFAULT_ROD_MIN = 0.0;
+const double CASCADE_DEFAULT_ROD_MAX = 280.0; // Keep rod targets clear of OVERTEMP_LIMIT
+const double CASCADE_DEFAULT_PREHEAT_TOLERANCE = 3.0; // C below the chamber setpoint
+
+// --- POWER BUDGET ---
+// Supply limit shared by the zone heaters (ratings in ZONE_TABLE), a
+// setting the installer enters with SET_POWER_BUDGET. 0 = no limit:
+// until the supply is rated the budget holds nothing back.
+const float POWER_BUDGET_DEFAULT_KW = 0;
+const uint8_t POWER_BUDGET_DEFAULT_HEATERS = 0;
+const unsigned long POWER_SLOT_MS = 100; // Packing resolution inside a window
+
+// --- POWER-LOSS RESUME ---
+// Bake checkpoints go to a ring of flash pages after the settings, so
+// a checkpoint never rewrites PersistentSettings and wear is spread
+// over CHECKPOINT_SLOTS pages (SAM3X: ~10k erase cycles per page).
+const uint32_t CHECKPOINT_FLASH_OFFSET = 16384; // DueFlashStorage address of slot 0
+const uint16_t CHECKPOINT_SLOTS = 128;
+const uint16_t CHECKPOINT_SLOT_STRIDE = 256;    // One flash page per slot
+const uint32_t RESUME_DEFAULT_INTERVAL_SEC = 60;
+const uint32_t RESUME_DEFAULT_MAX_OUTAGE_SEC = 600;
+
+// --- SCHEDULED BAKES ---
+const uint8_t MAX_SCHEDULED_JOBS = 16;
+const uint8_t JOB_WEEKDAY_MASK = 0x7F; // ScheduledJob.repeatDays bits 0-6
+const uint8_t JOB_READY_BY = 0x80;     // startUnix/startMinute is when to be READY
+
+// --- READY-BY PREHEAT PREDICTION ---
+const float PREHEAT_DEFAULT_RATE = 2.0;            // C/min until a zone has learned its own
+const float PREHEAT_LEARN_WEIGHT = 0.3;            // EWMA weight of each new preheat
+const float PREHEAT_LEARN_MIN_RISE = 10.0;         // C, smaller rises are too noisy to learn from
+const uint32_t PREHEAT_DEFAULT_MARGIN_SEC = 300;   // Added to every prediction
+const uint32_t PREHEAT_MAX_LEAD_SEC = 4UL * 3600UL; // Cap on a prediction (bad sensor, no model)
+const uint32_t SCHEDULE_REFRESH_SEC = 60;            // Re-predict ready-by starts this often
 
 // --- SAFETY ---
 const float STEAM_SAFETY_THRESHOLD = 160.0;
+const float OVERTEMP_LIMIT = 300.0; // Any rod above this freezes the recorder
+
+// --- FLIGHT RECORDER ---
+// RAM for the PID-tick ring buffer, out of the Due's 96 KB SRAM.
+// 24 bytes per sample with 3 zones: 24576 bytes = 1024 samples = ~100 s at 100 ms.
+const uint32_t RECORDER_BUDGET_BYTES = 24576;
+const unsigned long RECORDER_SAMPLE_INTERVAL = PID_COMPUTE_FREQ;
+const uint16_t RECORDER_POST_TRIGGER_SAMPLES = 50; // Keep recording 5 s after a trigger
+const uint8_t RECORDER_DUMP_ROWS_PER_LOOP = 8;
+
+// --- AUTOTUNE (relay experiment) ---
+const double AUTOTUNE_HYSTERESIS = 1.0;       // C around the setpoint before the relay flips
+const double AUTOTUNE_MAX_OVERSHOOT = 20.0;   // Abort if the zone runs this far above setpoint
+const unsigned long AUTOTUNE_TIMEOUT_MS = 3UL * 3600000UL;
+const uint8_t AUTOTUNE_CYCLES = 3;            // Cycles averaged after the first one
+
+// --- FEEDFORWARD ---
+const double FF_DEFAULT_AMBIENT = 25.0; // C, used until SET_MODEL sets the site value
+const double FF_DEFAULT_WEIGHT = 0.8;   // Leave the rest to the integral so model error can't overshoot
+
+// --- HEATER ZONES ---
+// Every per-zone behaviour is driven by ZONE_TABLE below; a build for
+// another oven only changes ZONE_COUNT and the table.
+#ifndef ZONE_COUNT
+#define ZONE_COUNT 3
+#endif
 
 // --- INDIVIDUAL PID DEFAULTS ---
 
@@ -37,41 +115,198 @@ const double STEAM_DEFAULT_KP = 450.0;
 const double STEAM_DEFAULT_KI = 0.0;  
 const double STEAM_DEFAULT_KD = 0.0;   
 
+// --- SHARED PID STRUCTURE DEFAULTS ---
+const double PID_DEFAULT_TT = 0.0;  // Anti-windup tracking time (s), 0 = clamp iTerm
+const double PID_DEFAULT_N  = 10.0; // Derivative filter, Tf = Td / N
+const double PID_DEFAULT_B  = 1.0;  // Setpoint weight on P
+const double PID_DEFAULT_C  = 0.0;  // Setpoint weight on D (0 = D on measurement)
+
 // =================================================================
 // GLOBAL STRUCTS & ENUMS
 // =================================================================
 
+struct ZoneConfig {
+  const char* name;            // Command target, log and recorder column names
+  const char* statusKey;       // Key in the status "relays" object
+  uint8_t statusSlot;          // Position in the status "temps" array
+  int csPin;                   // MAX6675 chip select
+  int relayPin;
+  float powerKw;               // Heater rating for the power budget
+  unsigned long minOnMs;       // Default shortest TPC run worth switching
+  unsigned long switchDelayMs; // Mechanical relay spacing (inrush)
+  double preheatTolerance;     // Default C below setpoint that counts as preheated
+  double kp, ki, kd;           // Default gains
+  double band;                 // Default bang-bang hysteresis (C)
+  bool cascaded;               // Follows the chamber-air loop when enabled
+};
+
+#if ZONE_COUNT == 3
+// Status keys/slots keep the wire format the HMI already parses
+const ZoneConfig ZONE_TABLE[ZONE_COUNT] = {
+  // name   status      slot  CS pin                   relay pin               kW   minOn switch tol kp                ki                kd                band cascaded
+  {"rod1",  "rod1",     0,    TEMP_CS_PIN_ROD1,        RELAY_PIN_ROD1,         3.0, 2000, 1500,  3,  ROD1_DEFAULT_KP,  ROD1_DEFAULT_KI,  ROD1_DEFAULT_KD,  20,  true},  // Upper (Convection)
+  {"rod2",  "rod2",     2,    TEMP_CS_PIN_ROD2,        RELAY_PIN_ROD2,         3.0, 1000, 1500,  3,  ROD2_DEFAULT_KP,  ROD2_DEFAULT_KI,  ROD2_DEFAULT_KD,  5,   true},  // Lower (Induction)
+  {"steam", "rodSteam", 1,    TEMP_CS_PIN_ROD_STEAM,   RELAY_PIN_STEAM_HEATER, 2.0, 1000, 1500,  3,  STEAM_DEFAULT_KP, STEAM_DEFAULT_KI, STEAM_DEFAULT_KD, 5,   false}, // Steam Generator
+};
+const int STEAM_ZONE = 2; // Zone whose temperature gates the steam valve (-1 = no valve)
+#else
+#error "Add a ZONE_TABLE row per zone (and STEAM_ZONE) for this ZONE_COUNT"
+#endif
+
+struct Zones {
+  // Struct of arrays indexed by zone, in ZONE_TABLE order
+  float temp[ZONE_COUNT];      // Last thermocouple reading
+  PidReal input[ZONE_COUNT];
+  PidReal setpoint[ZONE_COUNT];
+  PidReal output[ZONE_COUNT];  // Effective duty in ms of PID_WINDOW_SIZE
+};
+
 struct PidParams {
   double kp;
   double ki;
   double kd;
+  double tt; // Back-calculation tracking time constant (s)
+  double n;  // Derivative filter factor
+  double b;  // Setpoint weight on P
+  double c;  // Setpoint weight on D
+};
+
+struct GainSchedule {
+  uint8_t count;
+  bool onMeasurement; // Key on live temperature instead of setpoint
+  GainPoint points[PID_MAX_GAIN_POINTS];
+};
+
+// First-order-plus-dead-time zone model, fitted offline from SD logs:
+// T(s) - ambient = gain * e^(-deadTime*s) / (tau*s + 1) * duty
+struct ThermalModel {
+  double gain;     // Steady-state rise above ambient at 100% duty (C), 0 = no model
+  double tau;      // Time constant (s)
+  double deadTime; // Dead time (s)
+  double weight;   // Fraction of the model's steady-state duty fed forward
+};
+
+// Chamber-air outer loop. While enabled (and the probe reads), its
+// output replaces the thresholds of the ZONE_TABLE "cascaded" zones.
+struct CascadeSettings {
+  bool enabled;
+  double chamberSetpoint; // C
+  PidParams pid;
+  double rodMin;          // Limits on the generated rod setpoints (C)
+  double rodMax;
+};
+
+// Per-zone control law, see zone_mode.h
+struct ZoneControl {
+  uint8_t mode;      // ZoneMode
+  double hysteresis; // Bang-bang: switch on this far below setpoint (C)
+  double manualDuty; // Manual: fixed duty, 0..1
+};
+
+// Hand-tuned actuation limits, defaults from ZONE_TABLE
+struct ZoneTuning {
+  unsigned long minOnMs;   // Shortest TPC run worth switching
+  double preheatTolerance; // C below setpoint that counts as preheated
+};
+
+// Installer's supply rating for the power budget, 0 = no limit
+struct PowerLimits {
+  float maxKw;        // Heater load conducting at once
+  uint8_t maxHeaters; // Heaters conducting at once
+};
+
+// Power-loss resume policy, see checkpoint.h
+struct ResumeSettings {
+  uint32_t checkpointIntervalSec; // 0 = no checkpoints, never resume
+  uint32_t maxOutageSec;          // Longer outages boot normally
 };
 
 struct Thresholds {
-  int rod1     = 0;
-  int rod2     = 0;
-  int rodSteam = 0;
+  int zone[ZONE_COUNT] = {};
   int fan      = 0;
   int siren    = 0;
 };
 
+// One calendar entry with its recipe, see scheduler.h
+struct ScheduledJob {
+  uint32_t id;
+  uint32_t startUnix;          // Next start, or READY time with JOB_READY_BY (wall clock)
+  uint8_t repeatDays;          // Bit n = weekday n (0 = Sunday), none = once; | JOB_READY_BY
+  uint16_t startMinute;        // Repeats: minutes after midnight
+  int thresholds[ZONE_COUNT];
+  int recipeTimeMinutes;
+  int holdingTimeMinutes;
+};
+
+struct JobQueue {
+  ScheduledJob jobs[MAX_SCHEDULED_JOBS]; // Min-heap on startUnix
+  uint8_t count;
+  uint32_t nextId;
+};
+
+// Learned preheat heating rates, see preheat_model.h
+struct PreheatModel {
+  float rate[ZONE_COUNT]; // C/min from start to the preheat band, 0 = not learned
+  float chamberRate;      // Same for the cascade chamber probe
+  uint16_t samples;       // Preheats learned from
+  uint32_t marginSec;     // Safety margin on every prediction
+};
+
 struct PersistentSettings {
   Thresholds thresholds;
   int _legacyPreheatTemp; 
   int recipeTimeMinutes;
-  uint32_t scheduledUnixTime; 
+  uint32_t _legacyScheduledUnixTime; // Pre-queue single start, moved into 'schedule'
   int holdingTimeMinutes; 
   
   // Individual PID configurations
-  PidParams rod1Pid;
-  PidParams rod2Pid;
-  PidParams rodSteamPid;
+  PidParams pid[ZONE_COUNT];
+
+  // Temperature-band gain tables (count 0 = fixed gains above)
+  GainSchedule gains[ZONE_COUNT];
+
+  // Identified first-order-plus-dead-time models for feedforward
+  ThermalModel model[ZONE_COUNT];
+  double ambientTemp;
+
+  // OutputMode per heater zone
+  uint8_t outputMode[ZONE_COUNT];
+
+  // Chamber-air cascade
+  CascadeSettings cascade;
+
+  // Control mode per heater zone
+  ZoneControl zoneControl[ZONE_COUNT];
+
+  // Field-tunable actuation limits
+  ZoneTuning tuning[ZONE_COUNT];
+  double chamberPreheatTolerance; // C, cascade preheat check
+
+  // Power-loss resume of a running bake
+  ResumeSettings resume;
+
+  // Pending scheduled bakes
+  JobQueue schedule;
+
+  // Ready-by scheduling
+  PreheatModel preheat;
+
+  // Supply limit for the heater power budget
+  PowerLimits power;
+
+  // Layout check, see loadSettings()
+  uint32_t magic;
+  uint16_t version;
 };
 
+// The layout depends on ZONE_COUNT: other zone counts get their own
+// magic so flash written by a different build is never taken as ours
+const uint32_t SETTINGS_MAGIC = (ZONE_COUNT == 3) ? 0x4F56454EUL        // "OVEN"
+                                                  : 0x4F560000UL | ZONE_COUNT;
+const uint16_t SETTINGS_VERSION = 12;
+
 struct RelayStates {
-  bool rod1       = false;
-  bool rod2       = false;
-  bool rodSteam   = false;
+  bool zone[ZONE_COUNT] = {};
   bool valve      = false;
   bool light      = false;
   bool alarm      = false;
@@ -87,40 +322,287 @@ enum OvenState {
   ALARM_COMPLETION 
 };
 
+// =================================================================
+// MODULE RUNTIME STATE
+// =================================================================
+// Working state of the control modules between loop passes. It lives
+// in OvenController, not in file statics, so that independent
+// controllers (host simulations) never share any of it.
+
+// --- Power budget (power_budget.h) ---
+struct PowerBudgetStats {
+  uint32_t windows;                      // Windows planned
+  uint32_t constrainedWindows;           // Windows where a request was cut
+  uint32_t deferredMs[ZONE_COUNT];       // Total on-time pushed to a later window
+};
+
+struct PowerBudgetState {
+  unsigned long windowStartTime = 0;
+  bool windowPlanned = false;
+  // Planned run per channel, in slots from the window start
+  uint8_t runStart[ZONE_COUNT] = {};
+  uint8_t runLength[ZONE_COUNT] = {};
+  unsigned long carryMs[ZONE_COUNT] = {};
+  unsigned long lastRequestMs[ZONE_COUNT] = {}; // Previous pass, to see a request rise from zero
+  PowerBudgetStats stats = {};
+};
+
+// --- SSR output modes (output_mode.h) ---
+struct SsrOutputState {
+  // Burst: sigma-delta error in permille of a cycle
+  unsigned long lastCycle[ZONE_COUNT] = {};
+  bool cycleOn[ZONE_COUNT] = {};
+  long burstError[ZONE_COUNT] = {};
+  // Short window
+  unsigned long windowStart[ZONE_COUNT] = {};
+  unsigned long windowOnMs[ZONE_COUNT] = {};
+  long windowResidualMs[ZONE_COUNT] = {};
+  bool windowStarted[ZONE_COUNT] = {};
+};
+
+// --- Zone control modes (zone_mode.h) ---
+struct ZoneModeState {
+  bool bangOn[ZONE_COUNT] = {};               // Bang-bang relay state
+  unsigned long lastUpdate[ZONE_COUNT] = {};  // Last duty average update
+};
+
+// --- Relay-feedback autotune (autotune.h) ---
+enum AutotuneRule {
+  AUTOTUNE_RULE_ZN_PID       = 0, // Ziegler-Nichols classic PID
+  AUTOTUNE_RULE_ZN_PI        = 1, // Ziegler-Nichols PI
+  AUTOTUNE_RULE_TYREUS_LUYBEN = 2, // Less aggressive, for lag-dominant zones
+  AUTOTUNE_RULE_NO_OVERSHOOT = 3  // Ziegler-Nichols "no overshoot"
+};
+
+struct AutotuneState {
+  int activeZone = -1;          // -1 = no experiment
+  Stream* reportPort = NULL;
+  double setpoint = 0;
+  AutotuneRule rule = AUTOTUNE_RULE_ZN_PID;
+  bool commitGains = false;
+  unsigned long startTime = 0;
+
+  bool outputHigh = true;
+  double peakMax = 0, peakMin = 0;
+  unsigned long lastRiseTime = 0;
+  uint8_t risingSwitches = 0;
+  double sumPeriodMs = 0, sumAmplitude = 0;
+  uint8_t measuredCycles = 0;
+};
+
+// --- State machine (state_machine.h) ---
+enum OvenEvent {
+  OVEN_EV_START_PREHEAT = 0, // START_PREHEAT command
+  OVEN_EV_RUN_RECIPE,        // RUN_RECIPE command
+  OVEN_EV_STOP,              // STOP command
+  OVEN_EV_RESUME,            // Boot after a power loss, see resumeOvenState()
+  OVEN_EV_TICK,              // Every loop, after the queue
+  OVEN_EV_COUNT
+};
+
+const uint8_t OVEN_EVENT_QUEUE_SIZE = 8;
+// Rows in the transition table
+const uint8_t OVEN_TRANSITION_ROWS = 13;
+
+struct StateMachineState {
+  // Power-loss resume target, set by resumeOvenState()
+  OvenState resumeState = IDLE;
+  unsigned long resumeElapsedMs = 0;
+  // Per-row statistics
+  uint32_t takenCount[OVEN_TRANSITION_ROWS] = {};
+  uint32_t takenUnix[OVEN_TRANSITION_ROWS] = {};
+  // Event queue
+  OvenEvent queue[OVEN_EVENT_QUEUE_SIZE] = {};
+  uint8_t queueHead = 0;
+  uint8_t queueLength = 0;
+  uint32_t droppedEvents = 0;
+};
+
+// --- Power-loss resume (checkpoint.h) ---
+struct CheckpointState {
+  uint16_t nextSlot = 0;
+  uint32_t nextSequence = 1;
+  OvenState lastWrittenState = IDLE;
+  unsigned long lastWriteTime = 0;
+};
+
+// --- Scheduler (scheduler.h) ---
+// The next job and its predicted start, so the per-pass due check does
+// not re-predict every ready-by job
+struct SchedulerState {
+  bool valid = false;
+  int8_t nextIndex = -1;       // Heap slot of the next job, -1 if none
+  uint32_t nextStart = 0;      // Its start, lead included
+  uint32_t refreshedUnix = 0;  // Wall clock of the last prediction
+};
+
+// SCHEDULE_LIST in progress (app.cpp): the jobs as listed, sent a
+// frame at a time as the port has room
+struct ScheduleListing {
+  Stream* port = NULL;         // NULL = not listing
+  uint8_t index = 0;           // Next job to send
+  uint8_t count = 0;
+  ScheduledJob jobs[MAX_SCHEDULED_JOBS];
+};
+
+// --- Preheat learning (preheat_model.h) ---
+// Slots: the zones, then the chamber probe
+const uint8_t PREHEAT_CHAMBER = ZONE_COUNT;
+const uint8_t PREHEAT_SLOTS = ZONE_COUNT + 1;
+
+struct PreheatLearningState {
+  unsigned long startMs = 0;
+  float startTemp[PREHEAT_SLOTS] = {};
+  bool reached[PREHEAT_SLOTS] = {};
+  unsigned long reachedMs[PREHEAT_SLOTS] = {};
+  float reachedTemp[PREHEAT_SLOTS] = {};
+};
+
+// --- Control tick (control_timer.h) ---
+struct ControlTimingStats {
+  uint32_t ticks;        // Timer ticks since reset
+  uint32_t serviced;     // Ticks the loop ran the PIDs for
+  uint32_t missed;       // Ticks that elapsed while the loop was busy
+  uint32_t maxLatencyUs; // Tick -> PID compute
+  uint32_t minDtUs;      // Interval between PID computes
+  uint32_t maxDtUs;
+  uint32_t meanDtUs;
+};
+
+struct ControlTimerState {
+  uint32_t servicedCount = 0;
+  uint32_t lastServiceUs = 0;
+  uint64_t sumDtUs = 0;
+  ControlTimingStats stats = {};
+#if !defined(ARDUINO_ARCH_SAM)
+  // Host builds: virtual tick source on a fixed millis() grid
+  unsigned long nextTickMs = 0;
+  uint32_t virtualTicks = 0;
+  uint32_t virtualStampUs = 0;
+#endif
+};
+
+// --- Flight recorder (recorder.h) ---
+enum RecorderTrigger {
+  REC_TRIGGER_NONE          = 0,
+  REC_TRIGGER_MANUAL        = 1, // DUMP_RECORDER while armed
+  REC_TRIGGER_VALVE_TIMEOUT = 2,
+  REC_TRIGGER_SENSOR_FAULT  = 3, // Thermocouple read NAN (open circuit)
+  REC_TRIGGER_OVERTEMP      = 4  // Any rod above OVERTEMP_LIMIT
+};
+
+// 6 + 6 * ZONE_COUNT bytes per tick (24 with 3 zones). Temperatures
+// in 0.1 C, outputs in ms of the TPC window.
+struct RecorderSample {
+  uint32_t timeMs;
+  int16_t  input[ZONE_COUNT];    // ZONE_TABLE order
+  int16_t  setpoint[ZONE_COUNT];
+  uint16_t output[ZONE_COUNT];
+  uint8_t  relayBits;   // one bit per zone, then valve, light, alarm
+  uint8_t  state;       // OvenState
+};
+static_assert(ZONE_COUNT + 3 <= 8, "Recorder relayBits holds at most 5 zones");
+static_assert(RECORDER_BUDGET_BYTES <= 65536UL, "Recorder budget too large for the Due's 96 KB SRAM");
+
+const uint16_t RECORDER_CAPACITY = RECORDER_BUDGET_BYTES / sizeof(RecorderSample);
+
+struct RecorderState {
+  RecorderSample samples[RECORDER_CAPACITY];
+  uint16_t head = 0;          // Next slot to write
+  uint16_t count = 0;         // Valid samples in the buffer
+  uint16_t postTriggerLeft = 0;
+  RecorderTrigger trigger = REC_TRIGGER_NONE;
+  bool frozen = false;
+  unsigned long lastSampleTime = 0;
+  // Dump cursor
+  Stream* dumpPort = NULL;
+  uint16_t dumpIndex = 0;
+  bool rearmAfterDump = false;
+};
+
+// --- Hot path profiler (profiler.h) ---
+enum ProfileSection {
+  PROF_LOOP = 0,   // Whole loop() pass
+  PROF_COMMANDS,   // handleIncomingCommands()
+  PROF_STATE,      // updateStateMachine()
+  PROF_SENSORS,    // readTemperatureSensors()
+  PROF_STATUS,     // sendStatusUpdate()
+  PROF_LOG,        // logSystemData()
+  PROF_RELAY,      // updateRelayLogic()
+  PROF_PID,        // computePids() on a control tick
+  PROF_COUNT
+};
+
+struct ProfileStats {
+  uint32_t count;
+  uint32_t minCycles;
+  uint32_t maxCycles;
+  uint64_t totalCycles;
+};
+
+// =================================================================
+// CONTROLLER STATE
+// =================================================================
+// Everything the control logic reads and writes between loop passes.
+// The sketch owns one instance ('oven', oven_v10.ino) and passes it to
+// every module; hardware handles and the comms ports stay separate
+// globals below, so host simulations may run several controllers.
+
+struct OvenController {
+  PersistentSettings settings;
+  RelayStates relayStates;
+  bool heaterPinState[ZONE_COUNT] = {}; // Last level written to each heater relay
+  Zones zones;
+  QuickPID zonePid[ZONE_COUNT]; // Attached to 'zones' in initializeLogic()
+
+  // Chamber-air cascade
+  float chamberTemp = NAN;      // NAN unless the cascade is enabled
+  PidReal pidSetpointChamber, pidInputChamber, pidOutputChamber;
+  QuickPID pidChamber;          // Attached in initializeLogic()
+
+  // Manual overrides
+  bool manualControlActive = false;
+  bool manualAlarmActive = false;
+  bool manualValveOverride = false;
+
+  // State machine
+  OvenState currentState = IDLE;
+  unsigned long recipeStartTime = 0;
+  unsigned long preheatStartTime = 0;
+  bool preheatComplete = false;
+  bool steamValveOpened = false;
+  unsigned long steamValveOpenTime = 0;
+  unsigned long alarmStartTime = 0;
+  unsigned long holdingStartTime = 0;
+
+  // Status push (app.h)
+  unsigned long lastStatusUpdateTime = 0;
+
+  // Module state, see MODULE RUNTIME STATE
+  PowerBudgetState budget;
+  SsrOutputState ssr;
+  ZoneModeState zoneModes;
+  AutotuneState autotune;
+  StateMachineState machine;
+  CheckpointState checkpoint;
+  PreheatLearningState preheatLearning;
+  mutable SchedulerState scheduler; // Cache, refreshed by the const queries too
+  ScheduleListing scheduleListing;
+  ControlTimerState timer;
+  RecorderState recorder;
+  ProfileStats profile[PROF_COUNT];
+};
+
 // =================================================================
 // EXTERN DECLARATIONS
 // =================================================================
 
-extern MAX6675 tempSensorRod1;
-extern MAX6675 tempSensorRodSteam;
-extern MAX6675 tempSensorRod2;
+extern MAX6675 tempSensorChamber;
 extern RTC_DS3231 rtc;
+extern bool rtcLostPowerAtBoot; // Set by setHardcodedTime(): the RTC time is a build-date guess
 extern DueFlashStorage dueFlashStorage;
-extern QuickPID pidRod1;
-extern QuickPID pidRod2;
-extern QuickPID pidSteam;
 
 extern Stream* activePort;
-extern unsigned long lastStatusUpdateTime;
 extern const long statusUpdateInterval;
 
-extern PersistentSettings settings;
-extern RelayStates relayStates;
-extern float currentTemps[3]; 
-extern bool manualControlActive;
-extern bool manualAlarmActive; 
-extern bool manualValveOverride; 
-extern unsigned long steamValveOpenTime;
-
-extern double pidSetpointRod1, pidInputRod1, pidOutputRod1;
-extern double pidSetpointRod2, pidInputRod2, pidOutputRod2;
-extern double pidSetpointSteam, pidInputSteam, pidOutputSteam;
-
-extern OvenState currentState;
-extern unsigned long recipeStartTime;
-extern unsigned long preheatStartTime; 
-extern bool preheatComplete;
-extern unsigned long holdingStartTime; 
-extern unsigned long alarmStartTime;
-
 #endif // CONFIG_H
\ No newline at end of file
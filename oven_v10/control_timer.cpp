@@ -0,0 +1,107 @@
+#include "control_timer.h"
+
+#if defined(ARDUINO_ARCH_SAM)
+
+// Written by the timer interrupt; one hardware tick source for the board
+static volatile uint32_t tickCount = 0;
+static volatile uint32_t tickStampUs = 0;
+
+void TC3_Handler() {
+  TC_GetStatus(TC1, 0); // Clear the RC compare flag
+  tickStampUs = micros();
+  tickCount = tickCount + 1;
+}
+
+static void startTickSource(ControlTimerState &timer) {
+  pmc_set_writeprotect(false);
+  pmc_enable_periph_clk((uint32_t)TC3_IRQn);
+  // MCK/128 = 656.25 kHz, up-counting with reset on RC compare
+  TC_Configure(TC1, 0, TC_CMR_WAVE | TC_CMR_WAVSEL_UP_RC | TC_CMR_TCCLKS_TIMER_CLOCK4);
+  TC_SetRC(TC1, 0, (VARIANT_MCK / 128UL / 1000UL) * PID_COMPUTE_FREQ);
+  TC_Start(TC1, 0);
+  TC1->TC_CHANNEL[0].TC_IER = TC_IER_CPCS;
+  TC1->TC_CHANNEL[0].TC_IDR = ~TC_IER_CPCS;
+  NVIC_EnableIRQ(TC3_IRQn);
+}
+
+static void readTickSource(ControlTimerState &timer, uint32_t &ticks, uint32_t &stampUs) {
+  noInterrupts();
+  ticks = tickCount;
+  stampUs = tickStampUs;
+  interrupts();
+}
+
+#else
+
+// Virtual clock: ticks fall due on a fixed millis() grid
+static void startTickSource(ControlTimerState &timer) {
+  timer.nextTickMs = millis() + PID_COMPUTE_FREQ;
+}
+
+static void readTickSource(ControlTimerState &timer, uint32_t &ticks, uint32_t &stampUs) {
+  unsigned long now = millis();
+  while ((long)(now - timer.nextTickMs) >= 0) {
+    timer.virtualStampUs = timer.nextTickMs * 1000UL;
+    timer.virtualTicks++;
+    timer.nextTickMs += PID_COMPUTE_FREQ;
+  }
+  ticks = timer.virtualTicks;
+  stampUs = timer.virtualStampUs;
+}
+
+#endif
+
+void resetControlTimingStats(OvenController &oven) {
+  ControlTimerState &timer = oven.timer;
+  uint32_t ticks, stampUs;
+  readTickSource(timer, ticks, stampUs);
+  timer.servicedCount = ticks;
+  timer.sumDtUs = 0;
+  ControlTimingStats &stats = timer.stats;
+  stats.ticks = 0;
+  stats.serviced = 0;
+  stats.missed = 0;
+  stats.maxLatencyUs = 0;
+  stats.minDtUs = UINT32_MAX;
+  stats.maxDtUs = 0;
+  stats.meanDtUs = 0;
+}
+
+void initializeControlTimer(OvenController &oven) {
+  resetControlTimingStats(oven);
+  oven.timer.lastServiceUs = micros();
+  startTickSource(oven.timer);
+}
+
+bool takeControlTick(OvenController &oven) {
+  ControlTimerState &timer = oven.timer;
+  uint32_t ticks, stampUs;
+  readTickSource(timer, ticks, stampUs);
+
+  if (ticks == timer.servicedCount) return false;
+
+  ControlTimingStats &stats = timer.stats;
+  uint32_t now = micros();
+  uint32_t elapsed = ticks - timer.servicedCount;
+  stats.ticks += elapsed;
+  stats.missed += elapsed - 1;
+  stats.serviced++;
+  timer.servicedCount = ticks;
+
+  uint32_t latency = now - stampUs;
+  if (latency > stats.maxLatencyUs) stats.maxLatencyUs = latency;
+
+  uint32_t dt = now - timer.lastServiceUs;
+  timer.lastServiceUs = now;
+  if (stats.serviced > 1) {
+    if (dt < stats.minDtUs) stats.minDtUs = dt;
+    if (dt > stats.maxDtUs) stats.maxDtUs = dt;
+    timer.sumDtUs += dt;
+    stats.meanDtUs = (uint32_t)(timer.sumDtUs / (stats.serviced - 1));
+  }
+  return true;
+}
+
+const ControlTimingStats& getControlTimingStats(const OvenController &oven) {
+  return oven.timer.stats;
+}
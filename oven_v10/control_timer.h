@@ -0,0 +1,27 @@
+#ifndef CONTROL_TIMER_H
+#define CONTROL_TIMER_H
+
+#include "config.h"
+
+// =================================================================
+// CONTROL TICK
+// =================================================================
+// A hardware timer (TC1 channel 0 on the Due) fires every
+// PID_COMPUTE_FREQ ms. The interrupt only counts the tick and stamps
+// it; the PIDs run from loop() when takeControlTick() returns true and
+// scale their gains by the interval they measure. Host builds have no
+// TC, so a virtual clock per controller derives the same ticks from
+// millis(). The tick count is shared hardware; what each controller
+// has serviced is in oven.timer (config.h).
+
+// Called once at setup
+void initializeControlTimer(OvenController &oven);
+
+// Called every loop. True once per timer tick; ticks missed while the
+// loop was blocked are counted and collapse into one compute.
+bool takeControlTick(OvenController &oven);
+
+const ControlTimingStats& getControlTimingStats(const OvenController &oven);
+void resetControlTimingStats(OvenController &oven);
+
+#endif // CONTROL_TIMER_H
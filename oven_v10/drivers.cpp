@@ -1,89 +1,458 @@
 #include "drivers.h"
+#include <stddef.h>
 
 // =================================================================
 // GLOBAL VARIABLE DEFINITIONS
 // =================================================================
 
-MAX6675 tempSensorRod1(TEMP_SCLK_PIN, TEMP_CS_PIN_ROD1, TEMP_MISO_PIN);
-MAX6675 tempSensorRodSteam(TEMP_SCLK_PIN, TEMP_CS_PIN_ROD_STEAM, TEMP_MISO_PIN);
-MAX6675 tempSensorRod2(TEMP_SCLK_PIN, TEMP_CS_PIN_ROD2, TEMP_MISO_PIN);
+MAX6675 tempSensorChamber(TEMP_SCLK_PIN, TEMP_CS_PIN_CHAMBER, TEMP_MISO_PIN);
 RTC_DS3231 rtc;
+bool rtcLostPowerAtBoot = false;
 DueFlashStorage dueFlashStorage;
 
 Stream* activePort = &SerialUSB; 
-unsigned long lastStatusUpdateTime = 0;
 const long statusUpdateInterval = 3000; 
 
-PersistentSettings settings;
-RelayStates relayStates;
-float currentTemps[3] = {0.0, 0.0, 0.0}; 
-bool manualControlActive = false;
-bool manualAlarmActive = false;
+// =================================================================
+// SETTINGS LAYOUTS
+// =================================================================
+
+#if ZONE_COUNT == 3
+// Original layout (no magic/version): kp/ki/kd only
+struct PidParamsV1 {
+  double kp;
+  double ki;
+  double kd;
+};
+
+struct PersistentSettingsV1 {
+  Thresholds thresholds;
+  int _legacyPreheatTemp;
+  int recipeTimeMinutes;
+  uint32_t scheduledUnixTime;
+  int holdingTimeMinutes;
+  PidParamsV1 rod1Pid;
+  PidParamsV1 rod2Pid;
+  PidParamsV1 rodSteamPid;
+};
+#endif
+
+// Later versions only append fields before the magic/version tail.
+// Each older tailed version is frozen below exactly as it was shipped:
+// the tail's offset comes from its own layout (padding included), never
+// from where the next field happens to start in today's struct.
+struct SettingsTail {
+  uint32_t magic;
+  uint16_t version;
+};
+
+struct PersistentSettingsV2 {
+  Thresholds thresholds;
+  int _legacyPreheatTemp;
+  int recipeTimeMinutes;
+  uint32_t scheduledUnixTime;
+  int holdingTimeMinutes;
+  PidParams pid[ZONE_COUNT];
+  uint32_t magic;
+  uint16_t version;
+};
+
+// + temperature-band gain tables
+struct PersistentSettingsV3 {
+  Thresholds thresholds;
+  int _legacyPreheatTemp;
+  int recipeTimeMinutes;
+  uint32_t scheduledUnixTime;
+  int holdingTimeMinutes;
+  PidParams pid[ZONE_COUNT];
+  GainSchedule gains[ZONE_COUNT];
+  uint32_t magic;
+  uint16_t version;
+};
+
+// + feedforward models
+struct PersistentSettingsV4 {
+  Thresholds thresholds;
+  int _legacyPreheatTemp;
+  int recipeTimeMinutes;
+  uint32_t scheduledUnixTime;
+  int holdingTimeMinutes;
+  PidParams pid[ZONE_COUNT];
+  GainSchedule gains[ZONE_COUNT];
+  ThermalModel model[ZONE_COUNT];
+  double ambientTemp;
+  uint32_t magic;
+  uint16_t version;
+};
+
+// + output modes (the tail packs right after them, not at 8-byte alignment)
+struct PersistentSettingsV5 {
+  Thresholds thresholds;
+  int _legacyPreheatTemp;
+  int recipeTimeMinutes;
+  uint32_t scheduledUnixTime;
+  int holdingTimeMinutes;
+  PidParams pid[ZONE_COUNT];
+  GainSchedule gains[ZONE_COUNT];
+  ThermalModel model[ZONE_COUNT];
+  double ambientTemp;
+  uint8_t outputMode[ZONE_COUNT];
+  uint32_t magic;
+  uint16_t version;
+};
+
+// + chamber-air cascade
+struct PersistentSettingsV6 {
+  Thresholds thresholds;
+  int _legacyPreheatTemp;
+  int recipeTimeMinutes;
+  uint32_t scheduledUnixTime;
+  int holdingTimeMinutes;
+  PidParams pid[ZONE_COUNT];
+  GainSchedule gains[ZONE_COUNT];
+  ThermalModel model[ZONE_COUNT];
+  double ambientTemp;
+  uint8_t outputMode[ZONE_COUNT];
+  CascadeSettings cascade;
+  uint32_t magic;
+  uint16_t version;
+};
+
+// + per-zone control modes
+struct PersistentSettingsV7 {
+  Thresholds thresholds;
+  int _legacyPreheatTemp;
+  int recipeTimeMinutes;
+  uint32_t scheduledUnixTime;
+  int holdingTimeMinutes;
+  PidParams pid[ZONE_COUNT];
+  GainSchedule gains[ZONE_COUNT];
+  ThermalModel model[ZONE_COUNT];
+  double ambientTemp;
+  uint8_t outputMode[ZONE_COUNT];
+  CascadeSettings cascade;
+  ZoneControl zoneControl[ZONE_COUNT];
+  uint32_t magic;
+  uint16_t version;
+};
+
+// + field-tunable actuation limits
+struct PersistentSettingsV8 {
+  Thresholds thresholds;
+  int _legacyPreheatTemp;
+  int recipeTimeMinutes;
+  uint32_t scheduledUnixTime;
+  int holdingTimeMinutes;
+  PidParams pid[ZONE_COUNT];
+  GainSchedule gains[ZONE_COUNT];
+  ThermalModel model[ZONE_COUNT];
+  double ambientTemp;
+  uint8_t outputMode[ZONE_COUNT];
+  CascadeSettings cascade;
+  ZoneControl zoneControl[ZONE_COUNT];
+  ZoneTuning tuning[ZONE_COUNT];
+  double chamberPreheatTolerance;
+  uint32_t magic;
+  uint16_t version;
+};
+
+// + power-loss resume policy
+struct PersistentSettingsV9 {
+  Thresholds thresholds;
+  int _legacyPreheatTemp;
+  int recipeTimeMinutes;
+  uint32_t scheduledUnixTime;
+  int holdingTimeMinutes;
+  PidParams pid[ZONE_COUNT];
+  GainSchedule gains[ZONE_COUNT];
+  ThermalModel model[ZONE_COUNT];
+  double ambientTemp;
+  uint8_t outputMode[ZONE_COUNT];
+  CascadeSettings cascade;
+  ZoneControl zoneControl[ZONE_COUNT];
+  ZoneTuning tuning[ZONE_COUNT];
+  double chamberPreheatTolerance;
+  ResumeSettings resume;
+  uint32_t magic;
+  uint16_t version;
+};
 
-bool manualValveOverride = false;
+// + scheduled bake queue
+struct PersistentSettingsV10 {
+  Thresholds thresholds;
+  int _legacyPreheatTemp;
+  int recipeTimeMinutes;
+  uint32_t _legacyScheduledUnixTime;
+  int holdingTimeMinutes;
+  PidParams pid[ZONE_COUNT];
+  GainSchedule gains[ZONE_COUNT];
+  ThermalModel model[ZONE_COUNT];
+  double ambientTemp;
+  uint8_t outputMode[ZONE_COUNT];
+  CascadeSettings cascade;
+  ZoneControl zoneControl[ZONE_COUNT];
+  ZoneTuning tuning[ZONE_COUNT];
+  double chamberPreheatTolerance;
+  ResumeSettings resume;
+  JobQueue schedule;
+  uint32_t magic;
+  uint16_t version;
+};
 
-double pidSetpointRod1, pidInputRod1, pidOutputRod1;
-double pidSetpointRod2, pidInputRod2, pidOutputRod2;
-double pidSetpointSteam, pidInputSteam, pidOutputSteam;
+// + ready-by preheat model
+struct PersistentSettingsV11 {
+  Thresholds thresholds;
+  int _legacyPreheatTemp;
+  int recipeTimeMinutes;
+  uint32_t _legacyScheduledUnixTime;
+  int holdingTimeMinutes;
+  PidParams pid[ZONE_COUNT];
+  GainSchedule gains[ZONE_COUNT];
+  ThermalModel model[ZONE_COUNT];
+  double ambientTemp;
+  uint8_t outputMode[ZONE_COUNT];
+  CascadeSettings cascade;
+  ZoneControl zoneControl[ZONE_COUNT];
+  ZoneTuning tuning[ZONE_COUNT];
+  double chamberPreheatTolerance;
+  ResumeSettings resume;
+  JobQueue schedule;
+  PreheatModel preheat;
+  uint32_t magic;
+  uint16_t version;
+};
 
-QuickPID pidRod1(&pidInputRod1, &pidOutputRod1, &pidSetpointRod1, 0, 0, 0, QuickPID::DIRECT);
-QuickPID pidRod2(&pidInputRod2, &pidOutputRod2, &pidSetpointRod2, 0, 0, 0, QuickPID::DIRECT);
-QuickPID pidSteam(&pidInputSteam, &pidOutputSteam, &pidSetpointSteam, 0, 0, 0, QuickPID::DIRECT);
+// Each version's fields must still sit where PersistentSettings has
+// them, since migration copies the bytes before its tail as they are
+#define CHECK_SETTINGS_PREFIX(V, lastField)                                          \
+  static_assert(offsetof(V, lastField) == offsetof(PersistentSettings, lastField),    \
+                #V " fields moved in PersistentSettings");                           \
+  static_assert(offsetof(V, magic) <= offsetof(PersistentSettings, magic),             \
+                #V " tail lies past the current tail")
+CHECK_SETTINGS_PREFIX(PersistentSettingsV2, pid);
+CHECK_SETTINGS_PREFIX(PersistentSettingsV3, gains);
+CHECK_SETTINGS_PREFIX(PersistentSettingsV4, ambientTemp);
+CHECK_SETTINGS_PREFIX(PersistentSettingsV5, outputMode);
+CHECK_SETTINGS_PREFIX(PersistentSettingsV6, cascade);
+CHECK_SETTINGS_PREFIX(PersistentSettingsV7, zoneControl);
+CHECK_SETTINGS_PREFIX(PersistentSettingsV8, chamberPreheatTolerance);
+CHECK_SETTINGS_PREFIX(PersistentSettingsV9, resume);
+CHECK_SETTINGS_PREFIX(PersistentSettingsV10, schedule);
+CHECK_SETTINGS_PREFIX(PersistentSettingsV11, preheat);
+#undef CHECK_SETTINGS_PREFIX
 
-OvenState currentState = IDLE;
-unsigned long recipeStartTime = 0;
-unsigned long preheatStartTime = 0; 
-bool preheatComplete = false;
+#if ZONE_COUNT == 3
+// Tail offsets of the 3-zone layouts as shipped (same on the Due's
+// AAPCS and on x86-64: doubles are 8-byte aligned on both)
+static_assert(offsetof(PersistentSettingsV2, magic) == 208, "v2 layout changed");
+static_assert(offsetof(PersistentSettingsV3, magic) == 616, "v3 layout changed");
+static_assert(offsetof(PersistentSettingsV4, magic) == 720, "v4 layout changed");
+static_assert(offsetof(PersistentSettingsV5, magic) == 724, "v5 layout changed");
+static_assert(offsetof(PersistentSettingsV6, magic) == 816, "v6 layout changed");
+static_assert(offsetof(PersistentSettingsV7, magic) == 888, "v7 layout changed");
+static_assert(offsetof(PersistentSettingsV8, magic) == 944, "v8 layout changed");
+static_assert(offsetof(PersistentSettingsV9, magic) == 952, "v9 layout changed");
+static_assert(offsetof(PersistentSettingsV10, magic) == 1472, "v10 layout changed");
+static_assert(offsetof(PersistentSettingsV11, magic) == 1496, "v11 layout changed");
+#endif
 
-bool steamValveOpened = false;
-unsigned long steamValveOpenTime = 0;
-unsigned long alarmStartTime = 0;
-unsigned long holdingStartTime = 0;
+// Bytes before the tail for each older version (index = version)
+static const size_t SETTINGS_PREFIX_SIZE[] = {
+  0, 0,                                    // v0/v1: no tail
+  offsetof(PersistentSettingsV2, magic),
+  offsetof(PersistentSettingsV3, magic),
+  offsetof(PersistentSettingsV4, magic),
+  offsetof(PersistentSettingsV5, magic),
+  offsetof(PersistentSettingsV6, magic),
+  offsetof(PersistentSettingsV7, magic),
+  offsetof(PersistentSettingsV8, magic),
+  offsetof(PersistentSettingsV9, magic),
+  offsetof(PersistentSettingsV10, magic),
+  offsetof(PersistentSettingsV11, magic),
+};
+static_assert(sizeof(PersistentSettings) <= CHECKPOINT_FLASH_OFFSET,
+              "Settings would overlap the checkpoint ring");
+static_assert(sizeof(SETTINGS_PREFIX_SIZE) / sizeof(SETTINGS_PREFIX_SIZE[0]) == SETTINGS_VERSION,
+              "Freeze the previous version's layout when bumping SETTINGS_VERSION");
 
 // =================================================================
 // FUNCTIONS
 // =================================================================
 
-void loadSettings() {
+PidParams makePidParams(double kp, double ki, double kd) {
+  PidParams p = {kp, ki, kd, PID_DEFAULT_TT, PID_DEFAULT_N, PID_DEFAULT_B, PID_DEFAULT_C};
+  return p;
+}
+
+// Insert sorted by temp; an existing point at the same temp is replaced,
+// and a full table replaces its nearest point
+void upsertGainPoint(GainSchedule &schedule, const GainPoint &point) {
+  uint8_t slot = schedule.count;
+  for (uint8_t i = 0; i < schedule.count; i++) {
+    if (schedule.points[i].temp == point.temp) { slot = i; break; }
+  }
+  if (slot == schedule.count && schedule.count == PID_MAX_GAIN_POINTS) {
+    slot = 0;
+    for (uint8_t i = 1; i < schedule.count; i++) {
+      if (fabs(schedule.points[i].temp - point.temp) < fabs(schedule.points[slot].temp - point.temp)) slot = i;
+    }
+  }
+  if (slot == schedule.count) schedule.count++;
+  schedule.points[slot] = point;
+  sortGainSchedule(schedule);
+}
+
+void sortGainSchedule(GainSchedule &schedule) {
+  for (uint8_t i = 1; i < schedule.count; i++) {
+    GainPoint key = schedule.points[i];
+    int j = i - 1;
+    while (j >= 0 && schedule.points[j].temp > key.temp) {
+      schedule.points[j + 1] = schedule.points[j];
+      j--;
+    }
+    schedule.points[j + 1] = key;
+  }
+}
+
+ThermalModel makeThermalModel(double gain, double tau, double deadTime) {
+  ThermalModel m = {gain, tau, deadTime, FF_DEFAULT_WEIGHT};
+  return m;
+}
+
+int zoneByName(const char* name) {
+  if (name == NULL) return -1;
+  for (int z = 0; z < ZONE_COUNT; z++) {
+    if (strcmp(name, ZONE_TABLE[z].name) == 0) return z;
+  }
+  return -1;
+}
+
+static bool isValidHoldingTime(int minutes) {
+  return minutes >= 0 && minutes <= MAX_HOLDING_MINUTES;
+}
+
+bool isValidBakeTimes(int recipeMinutes, int holdingMinutes) {
+  return recipeMinutes >= 0 && recipeMinutes <= MAX_RECIPE_MINUTES && isValidHoldingTime(holdingMinutes);
+}
+
+static void loadDefaultSettings(OvenController &oven) {
+  for (int z = 0; z < ZONE_COUNT; z++) oven.settings.thresholds.zone[z] = 0;
+  oven.settings.thresholds.fan = 0;
+  oven.settings.thresholds.siren = 0;
+  
+  oven.settings.recipeTimeMinutes = 0;
+  oven.settings.holdingTimeMinutes = 30; 
+  oven.settings._legacyScheduledUnixTime = 0;
+
+  for (int z = 0; z < ZONE_COUNT; z++) {
+    // --- APPLY INDIVIDUAL PID DEFAULTS ---
+    oven.settings.pid[z] = makePidParams(ZONE_TABLE[z].kp, ZONE_TABLE[z].ki, ZONE_TABLE[z].kd);
+    memset(&oven.settings.gains[z], 0, sizeof(GainSchedule));
+    // No identified model yet: feedforward off
+    oven.settings.model[z] = makeThermalModel(0, 0, 0);
+    // Mechanical relays unless told otherwise
+    oven.settings.outputMode[z] = 0;
+    // PID everywhere; bang-bang bands from the table
+    oven.settings.zoneControl[z].mode = 0;
+    oven.settings.zoneControl[z].hysteresis = ZONE_TABLE[z].band;
+    oven.settings.zoneControl[z].manualDuty = 0;
+    // Actuation limits as commissioned
+    oven.settings.tuning[z].minOnMs = ZONE_TABLE[z].minOnMs;
+    oven.settings.tuning[z].preheatTolerance = ZONE_TABLE[z].preheatTolerance;
+  }
+  oven.settings.ambientTemp = FF_DEFAULT_AMBIENT;
+
+  // Rods follow their own thresholds until a chamber probe is fitted
+  oven.settings.cascade.enabled = false;
+  oven.settings.cascade.chamberSetpoint = 0;
+  oven.settings.cascade.pid = makePidParams(CASCADE_DEFAULT_KP, CASCADE_DEFAULT_KI, CASCADE_DEFAULT_KD);
+  oven.settings.cascade.rodMin = CASCADE_DEFAULT_ROD_MIN;
+  oven.settings.cascade.rodMax = CASCADE_DEFAULT_ROD_MAX;
+  oven.settings.chamberPreheatTolerance = CASCADE_DEFAULT_PREHEAT_TOLERANCE;
+
+  oven.settings.resume.checkpointIntervalSec = RESUME_DEFAULT_INTERVAL_SEC;
+  oven.settings.resume.maxOutageSec = RESUME_DEFAULT_MAX_OUTAGE_SEC;
+
+  memset(&oven.settings.schedule, 0, sizeof(JobQueue));
+  oven.settings.schedule.nextId = 1;
+
+  // Heating rates are learned from the first preheats
+  memset(&oven.settings.preheat, 0, sizeof(PreheatModel));
+  oven.settings.preheat.marginSec = PREHEAT_DEFAULT_MARGIN_SEC;
+
+  // No supply limit until the installer rates it
+  oven.settings.power.maxKw = POWER_BUDGET_DEFAULT_KW;
+  oven.settings.power.maxHeaters = POWER_BUDGET_DEFAULT_HEATERS;
+}
+
+#if ZONE_COUNT == 3
+// Keep thresholds, times and gains written by the original firmware
+static void migrateSettingsV1(OvenController &oven, const PersistentSettingsV1 &v1) {
+  loadDefaultSettings(oven);
+  oven.settings.thresholds = v1.thresholds;
+  oven.settings._legacyPreheatTemp = v1._legacyPreheatTemp;
+  oven.settings.recipeTimeMinutes = v1.recipeTimeMinutes;
+  oven.settings._legacyScheduledUnixTime = v1.scheduledUnixTime;
+  oven.settings.holdingTimeMinutes = v1.holdingTimeMinutes;
+  oven.settings.pid[0] = makePidParams(v1.rod1Pid.kp, v1.rod1Pid.ki, v1.rod1Pid.kd);
+  oven.settings.pid[1] = makePidParams(v1.rod2Pid.kp, v1.rod2Pid.ki, v1.rod2Pid.kd);
+  oven.settings.pid[2] = makePidParams(v1.rodSteamPid.kp, v1.rodSteamPid.ki, v1.rodSteamPid.kd);
+}
+#endif
+
+void loadSettings(OvenController &oven) {
   Serial.println("Loading settings from Flash...");
   byte* b = dueFlashStorage.readAddress(0);
   PersistentSettings savedSettings; 
   memcpy(&savedSettings, b, sizeof(PersistentSettings));
 
   // Validation Check
-  if (savedSettings.holdingTimeMinutes < 0 || savedSettings.holdingTimeMinutes > 180) { 
-    Serial.println("No valid settings found, loading DEFAULTS.");
-    
-    settings.thresholds.rod1 = 0;
-    settings.thresholds.rod2 = 0;
-    settings.thresholds.rodSteam = 0;
-    settings.thresholds.fan = 0;
-    settings.thresholds.siren = 0;
-    
-    settings.recipeTimeMinutes = 0;
-    settings.holdingTimeMinutes = 30; 
-    settings.scheduledUnixTime = 0;
+  if (savedSettings.magic == SETTINGS_MAGIC && savedSettings.version == SETTINGS_VERSION
+      && isValidHoldingTime(savedSettings.holdingTimeMinutes)) {
+    Serial.println("Settings loaded successfully.");
+    oven.settings = savedSettings;
+    return;
+  }
 
-    // --- APPLY INDIVIDUAL PID DEFAULTS ---
-    settings.rod1Pid = {ROD1_DEFAULT_KP, ROD1_DEFAULT_KI, ROD1_DEFAULT_KD};
-    settings.rod2Pid = {ROD2_DEFAULT_KP, ROD2_DEFAULT_KI, ROD2_DEFAULT_KD};
-    settings.rodSteamPid = {STEAM_DEFAULT_KP, STEAM_DEFAULT_KI, STEAM_DEFAULT_KD};
+  // Older tailed version: keep its prefix, default the appended fields
+  for (uint16_t v = SETTINGS_VERSION - 1; v >= 2; v--) {
+    SettingsTail tail;
+    memcpy(&tail, b + SETTINGS_PREFIX_SIZE[v], sizeof(SettingsTail));
+    if (tail.magic == SETTINGS_MAGIC && tail.version == v) {
+      Serial.print("Migrating settings from version "); Serial.println(v);
+      loadDefaultSettings(oven);
+      memcpy((byte*)&oven.settings, b, SETTINGS_PREFIX_SIZE[v]);
+      saveSettings(oven);
+      return;
+    }
+  }
 
-    saveSettings();
-  } else {
-    Serial.println("Settings loaded successfully.");
-    settings = savedSettings;
+#if ZONE_COUNT == 3
+  PersistentSettingsV1 legacy;
+  memcpy(&legacy, b, sizeof(PersistentSettingsV1));
+  if (savedSettings.magic != SETTINGS_MAGIC && isValidHoldingTime(legacy.holdingTimeMinutes)) {
+    Serial.println("Migrating settings from original layout.");
+    migrateSettingsV1(oven, legacy);
+    saveSettings(oven);
+    return;
   }
+#endif
+  Serial.println("No valid settings found, loading DEFAULTS.");
+  loadDefaultSettings(oven);
+  saveSettings(oven);
 }
 
-void saveSettings() {
+void saveSettings(OvenController &oven) {
   Serial.println("Saving settings to Flash...");
-  dueFlashStorage.write(0, (byte*)&settings, sizeof(settings));
+  oven.settings.magic = SETTINGS_MAGIC;
+  oven.settings.version = SETTINGS_VERSION;
+  dueFlashStorage.write(0, (byte*)&oven.settings, sizeof(oven.settings));
   Serial.println("Settings saved.");
 }
 
 void setHardcodedTime() {
     if (rtc.lostPower()) {
+        rtcLostPowerAtBoot = true;
         Serial.println("RTC lost power, setting default time...");
         rtc.adjust(DateTime(F(__DATE__), F(__TIME__)));
     }
@@ -4,8 +4,16 @@
 #include "config.h"
 
 // Prototypes for driver-specific functions
-void loadSettings();
-void saveSettings();
+void loadSettings(OvenController &oven);
+PidParams makePidParams(double kp, double ki, double kd);
+void upsertGainPoint(GainSchedule &schedule, const GainPoint &point);
+void sortGainSchedule(GainSchedule &schedule);
+ThermalModel makeThermalModel(double gain, double tau, double deadTime);
+void saveSettings(OvenController &oven);
+// Index of the ZONE_TABLE entry with this name, -1 if none
+int zoneByName(const char* name);
+// Recipe 0..MAX_RECIPE_MINUTES and holding 0..MAX_HOLDING_MINUTES
+bool isValidBakeTimes(int recipeMinutes, int holdingMinutes);
 void setHardcodedTime();
 
 #endif // DRIVERS_H
\ No newline at end of file
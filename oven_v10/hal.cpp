@@ -1,14 +1,18 @@
 #include "hal.h"
+#include "output_mode.h"
+#include <new>            // Needs placement new for the zone sensors
 
-#define RELAY_SWITCHING_ROD_1 1500
-#define RELAY_SWITCHING_ROD_2 1500
-#define RELAY_SWITCHING_STEAM 1500
+// One MAX6675 per zone on the shared bus, built from ZONE_TABLE by
+// initializeSensors(). Static storage like tempSensorChamber: no heap
+// on the target.
+alignas(MAX6675) static uint8_t zoneSensorStorage[ZONE_COUNT][sizeof(MAX6675)];
+static MAX6675* zoneSensor[ZONE_COUNT];
 
 void initializePins() {
   Serial.println("Initializing pins...");
-  pinMode(RELAY_PIN_ROD1,         OUTPUT); digitalWrite(RELAY_PIN_ROD1,         RELAY_OFF);
-  pinMode(RELAY_PIN_ROD2,         OUTPUT); digitalWrite(RELAY_PIN_ROD2,         RELAY_OFF);
-  pinMode(RELAY_PIN_STEAM_HEATER, OUTPUT); digitalWrite(RELAY_PIN_STEAM_HEATER, RELAY_OFF);
+  for (uint8_t z = 0; z < ZONE_COUNT; z++) {
+    pinMode(ZONE_TABLE[z].relayPin, OUTPUT); digitalWrite(ZONE_TABLE[z].relayPin, RELAY_OFF);
+  }
   pinMode(RELAY_PIN_VALVE,        OUTPUT); digitalWrite(RELAY_PIN_VALVE,        RELAY_OFF);
   pinMode(RELAY_PIN_ALARM,        OUTPUT); digitalWrite(RELAY_PIN_ALARM,        RELAY_OFF);
   pinMode(RELAY_PIN_LIGHT,        OUTPUT); digitalWrite(RELAY_PIN_LIGHT,        RELAY_OFF);
@@ -26,29 +30,34 @@ void initializeSensors() {
   } else {
     Serial.println("RTC found.");
   }
+  for (uint8_t z = 0; z < ZONE_COUNT; z++) {
+    zoneSensor[z] = new (zoneSensorStorage[z]) MAX6675(TEMP_SCLK_PIN, ZONE_TABLE[z].csPin, TEMP_MISO_PIN);
+  }
   delay(500); 
   Serial.println("MAX6675 sensors ready.");
 }
 
-void readTemperatureSensors() {
-  currentTemps[0] = tempSensorRod1.readCelsius();
-  currentTemps[1] = tempSensorRodSteam.readCelsius();
-  currentTemps[2] = tempSensorRod2.readCelsius();
+void readTemperatureSensors(OvenController &oven) {
+  for (uint8_t z = 0; z < ZONE_COUNT; z++) oven.zones.temp[z] = zoneSensor[z]->readCelsius();
+  // An unfitted CS pin would read a floating bus, so only poll when used
+  oven.chamberTemp = oven.settings.cascade.enabled ? tempSensorChamber.readCelsius() : NAN;
+}
+
+// Mechanical heater relays are spaced by their switching delay to
+// stagger inrush, but only when they actually change state. SSR
+// channels switch every mains cycle and must not block the loop.
+static void writeHeaterRelay(OvenController &oven, uint8_t zone, bool state) {
+  bool changed = (state != oven.heaterPinState[zone]);
+  digitalWrite(ZONE_TABLE[zone].relayPin, state ? RELAY_ON : RELAY_OFF);
+  oven.heaterPinState[zone] = state;
+  if (changed && oven.settings.outputMode[zone] == OUTPUT_MODE_TPC) delay(ZONE_TABLE[zone].switchDelayMs);
 }
 
-void applyRelayStates() {
-  digitalWrite(RELAY_PIN_ROD1,         relayStates.rod1     ? RELAY_ON : RELAY_OFF);
-  //add delay
-  delay(RELAY_SWITCHING_ROD_1);
-  digitalWrite(RELAY_PIN_ROD2,         relayStates.rod2     ? RELAY_ON : RELAY_OFF);
-  //add delay
-  delay(RELAY_SWITCHING_ROD_2);
-  digitalWrite(RELAY_PIN_STEAM_HEATER, relayStates.rodSteam ? RELAY_ON : RELAY_OFF);
-  //add delay
-  delay(RELAY_SWITCHING_STEAM);
-  digitalWrite(RELAY_PIN_VALVE,        relayStates.valve    ? RELAY_ON : RELAY_OFF);
-  digitalWrite(RELAY_PIN_ALARM,        relayStates.alarm    ? RELAY_ON : RELAY_OFF);
-  digitalWrite(RELAY_PIN_LIGHT,        relayStates.light    ? RELAY_ON : RELAY_OFF);
+void applyRelayStates(OvenController &oven) {
+  for (uint8_t z = 0; z < ZONE_COUNT; z++) writeHeaterRelay(oven, z, oven.relayStates.zone[z]);
+  digitalWrite(RELAY_PIN_VALVE,        oven.relayStates.valve    ? RELAY_ON : RELAY_OFF);
+  digitalWrite(RELAY_PIN_ALARM,        oven.relayStates.alarm    ? RELAY_ON : RELAY_OFF);
+  digitalWrite(RELAY_PIN_LIGHT,        oven.relayStates.light    ? RELAY_ON : RELAY_OFF);
 }
 
 void toggleRelay(int pin, bool &stateVariable) {
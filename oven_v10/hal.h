@@ -6,8 +6,8 @@
 // Prototypes for HAL functions
 void initializePins();
 void initializeSensors();
-void readTemperatureSensors();
-void applyRelayStates();
+void readTemperatureSensors(OvenController &oven);
+void applyRelayStates(OvenController &oven);
 void toggleRelay(int pin, bool &stateVariable);
 
 #endif // HAL_H
\ No newline at end of file
@@ -0,0 +1,388 @@
+#include "Arduino.h"
+#include <atomic>
+
+// =================================================================
+// CLOCK
+// =================================================================
+
+static thread_local uint64_t virtualUs = 0;
+static thread_local uint64_t offsetMs = 0;
+
+unsigned long millis() {
+  return (unsigned long)(virtualUs / 1000ULL + offsetMs);
+}
+
+unsigned long micros() {
+  return (unsigned long)(virtualUs + offsetMs * 1000ULL);
+}
+
+void delay(unsigned long ms) {
+  virtualUs += (uint64_t)ms * 1000ULL;
+}
+
+void delayMicroseconds(unsigned int us) {
+  virtualUs += us;
+}
+
+uint64_t hostMicros() {
+  return virtualUs;
+}
+
+void hostResetClock() {
+  virtualUs = 0;
+  offsetMs = 0;
+}
+
+void hostAdvanceMicros(uint64_t us) {
+  virtualUs += us;
+}
+
+void hostAdvanceMillis(uint64_t ms) {
+  virtualUs += ms * 1000ULL;
+}
+
+void hostWrapClockIn(uint64_t ms) {
+  // millis() = 0 (mod 2^N) in 'ms'; micros() is then exactly 1000x
+  // millis() and wraps at the same moment
+  offsetMs = 0 - (virtualUs / 1000ULL + ms);
+}
+
+void noInterrupts() {}
+void interrupts() {}
+
+// =================================================================
+// PINS
+// =================================================================
+
+const uint32_t HOST_PIN_COUNT = 128;
+static thread_local int pinLevel[HOST_PIN_COUNT];
+static thread_local unsigned long pinChanges[HOST_PIN_COUNT];
+
+void pinMode(uint32_t, uint32_t) {}
+
+void digitalWrite(uint32_t pin, uint32_t value) {
+  if (pin >= HOST_PIN_COUNT) return;
+  int level = value ? HIGH : LOW;
+  if (level != pinLevel[pin]) pinChanges[pin]++;
+  pinLevel[pin] = level;
+}
+
+int digitalRead(uint32_t pin) {
+  return pin < HOST_PIN_COUNT ? pinLevel[pin] : LOW;
+}
+
+int hostPinLevel(uint32_t pin) {
+  return pin < HOST_PIN_COUNT ? pinLevel[pin] : LOW;
+}
+
+unsigned long hostPinChanges(uint32_t pin) {
+  return pin < HOST_PIN_COUNT ? pinChanges[pin] : 0;
+}
+
+void hostResetPins() {
+  for (uint32_t i = 0; i < HOST_PIN_COUNT; i++) {
+    pinLevel[i] = LOW;
+    pinChanges[i] = 0;
+  }
+}
+
+// =================================================================
+// STRING
+// =================================================================
+
+static std::atomic<unsigned long> stringAllocations(0);
+
+unsigned long hostStringAllocations() {
+  return stringAllocations.load();
+}
+
+String::String(const char* cstr) : buffer(NULL), capacity(0), len(0) {
+  if (cstr) concat(cstr);
+}
+
+String::String(const String &str) : buffer(NULL), capacity(0), len(0) {
+  concat(str);
+}
+
+String::String(char c) : buffer(NULL), capacity(0), len(0) {
+  concat(c);
+}
+
+static void formatUnsigned(char* buf, unsigned long value, unsigned char base) {
+  char tmp[8 * sizeof(long) + 1];
+  int i = 0;
+  if (base < 2) base = 10;
+  do {
+    unsigned digit = value % base;
+    tmp[i++] = (char)(digit < 10 ? '0' + digit : 'a' + digit - 10);
+    value /= base;
+  } while (value > 0);
+  int o = 0;
+  while (i > 0) buf[o++] = tmp[--i];
+  buf[o] = '\0';
+}
+
+static void formatSigned(char* buf, long value, unsigned char base) {
+  if (base == 10 && value < 0) {
+    buf[0] = '-';
+    formatUnsigned(buf + 1, 0UL - (unsigned long)value, base);
+  } else {
+    formatUnsigned(buf, (unsigned long)value, base);
+  }
+}
+
+String::String(unsigned char value, unsigned char base) : buffer(NULL), capacity(0), len(0) {
+  char buf[8 * sizeof(long) + 2];
+  formatUnsigned(buf, value, base);
+  concat(buf);
+}
+
+String::String(int value, unsigned char base) : buffer(NULL), capacity(0), len(0) {
+  char buf[8 * sizeof(long) + 2];
+  formatSigned(buf, value, base);
+  concat(buf);
+}
+
+String::String(unsigned int value, unsigned char base) : buffer(NULL), capacity(0), len(0) {
+  char buf[8 * sizeof(long) + 2];
+  formatUnsigned(buf, value, base);
+  concat(buf);
+}
+
+String::String(long value, unsigned char base) : buffer(NULL), capacity(0), len(0) {
+  char buf[8 * sizeof(long) + 2];
+  formatSigned(buf, value, base);
+  concat(buf);
+}
+
+String::String(unsigned long value, unsigned char base) : buffer(NULL), capacity(0), len(0) {
+  char buf[8 * sizeof(long) + 2];
+  formatUnsigned(buf, value, base);
+  concat(buf);
+}
+
+String::String(float value, unsigned char decimalPlaces) : buffer(NULL), capacity(0), len(0) {
+  char buf[64];
+  snprintf(buf, sizeof(buf), "%.*f", decimalPlaces, (double)value);
+  concat(buf);
+}
+
+String::String(double value, unsigned char decimalPlaces) : buffer(NULL), capacity(0), len(0) {
+  char buf[64];
+  snprintf(buf, sizeof(buf), "%.*f", decimalPlaces, value);
+  concat(buf);
+}
+
+String::~String() {
+  free(buffer);
+}
+
+bool String::changeBuffer(unsigned int maxStrLen) {
+  char* newBuffer = (char*)realloc(buffer, maxStrLen + 1);
+  if (newBuffer == NULL) return false;
+  stringAllocations++;
+  buffer = newBuffer;
+  capacity = maxStrLen;
+  return true;
+}
+
+bool String::reserve(unsigned int size) {
+  if (buffer && capacity >= size) return true;
+  if (!changeBuffer(size)) return false;
+  if (len == 0) buffer[0] = '\0';
+  return true;
+}
+
+String& String::operator=(const String &rhs) {
+  if (this == &rhs) return *this;
+  return *this = rhs.c_str();
+}
+
+String& String::operator=(const char* cstr) {
+  unsigned int length = cstr ? strlen(cstr) : 0;
+  if (!reserve(length)) return *this;
+  len = length;
+  memmove(buffer, cstr ? cstr : "", length + 1);
+  return *this;
+}
+
+bool String::concat(const char* cstr, unsigned int length) {
+  unsigned int newLen = len + length;
+  if (cstr == NULL) return false;
+  if (length == 0) return true;
+  if (!reserve(newLen)) return false;
+  memmove(buffer + len, cstr, length);
+  len = newLen;
+  buffer[len] = '\0';
+  return true;
+}
+
+bool String::concat(const String &str) { return concat(str.c_str(), str.len); }
+bool String::concat(const char* cstr) { return cstr ? concat(cstr, strlen(cstr)) : false; }
+bool String::concat(char c) { return concat(&c, 1); }
+bool String::concat(int num) { char buf[24]; formatSigned(buf, num, 10); return concat(buf); }
+bool String::concat(unsigned int num) { char buf[24]; formatUnsigned(buf, num, 10); return concat(buf); }
+bool String::concat(long num) { char buf[24]; formatSigned(buf, num, 10); return concat(buf); }
+bool String::concat(unsigned long num) { char buf[24]; formatUnsigned(buf, num, 10); return concat(buf); }
+bool String::concat(double num) { char buf[64]; snprintf(buf, sizeof(buf), "%.2f", num); return concat(buf); }
+
+int String::indexOf(char c) const {
+  const char* p = strchr(c_str(), c);
+  return p ? (int)(p - c_str()) : -1;
+}
+
+String String::substring(unsigned int from, unsigned int to) const {
+  if (from > to) { unsigned int t = from; from = to; to = t; }
+  if (from >= len) return String();
+  if (to > len) to = len;
+  String out;
+  out.concat(buffer + from, to - from);
+  return out;
+}
+
+void String::trim() {
+  if (len == 0) return;
+  unsigned int begin = 0;
+  while (begin < len && isspace((unsigned char)buffer[begin])) begin++;
+  unsigned int end = len;
+  while (end > begin && isspace((unsigned char)buffer[end - 1])) end--;
+  len = end - begin;
+  memmove(buffer, buffer + begin, len);
+  buffer[len] = '\0';
+}
+
+String operator+(const String &lhs, const String &rhs) {
+  String out(lhs);
+  out += rhs;
+  return out;
+}
+
+String operator+(const String &lhs, const char* rhs) {
+  String out(lhs);
+  out += rhs;
+  return out;
+}
+
+// =================================================================
+// PRINT / STREAM
+// =================================================================
+
+size_t Print::write(const uint8_t* buf, size_t size) {
+  size_t n = 0;
+  while (size--) {
+    if (write(*buf++)) n++;
+    else break;
+  }
+  return n;
+}
+
+size_t Print::printNumber(unsigned long n, uint8_t base) {
+  char buf[8 * sizeof(long) + 1];
+  formatUnsigned(buf, n, base);
+  return write(buf);
+}
+
+size_t Print::print(long n, int base) {
+  if (base == 0) return write((uint8_t)n);
+  if (base == 10 && n < 0) {
+    size_t t = print('-');
+    return t + printNumber(0UL - (unsigned long)n, 10);
+  }
+  return printNumber((unsigned long)n, (uint8_t)base);
+}
+
+size_t Print::print(unsigned long n, int base) {
+  if (base == 0) return write((uint8_t)n);
+  return printNumber(n, (uint8_t)base);
+}
+
+// Same algorithm as the core's printFloat(): round at the last digit,
+// integer part, then one digit at a time
+size_t Print::print(double number, int digits) {
+  if (isnan(number)) return print("nan");
+  if (isinf(number)) return print("inf");
+  if (number > 4294967040.0) return print("ovf");
+  if (number < -4294967040.0) return print("ovf");
+
+  size_t n = 0;
+  if (number < 0.0) {
+    n += print('-');
+    number = -number;
+  }
+
+  double rounding = 0.5;
+  for (int i = 0; i < digits; ++i) rounding /= 10.0;
+  number += rounding;
+
+  unsigned long intPart = (unsigned long)number;
+  double remainder = number - (double)intPart;
+  n += print(intPart);
+
+  if (digits > 0) n += print('.');
+  while (digits-- > 0) {
+    remainder *= 10.0;
+    unsigned int toPrint = (unsigned int)remainder;
+    n += print(toPrint);
+    remainder -= toPrint;
+  }
+  return n;
+}
+
+size_t Stream::readBytes(char* buffer, size_t length) {
+  size_t count = 0;
+  while (count < length) {
+    int c = read();
+    if (c < 0) break;
+    *buffer++ = (char)c;
+    count++;
+  }
+  return count;
+}
+
+size_t Stream::readBytesUntil(char terminator, char* buffer, size_t length) {
+  size_t index = 0;
+  while (index < length) {
+    int c = read();
+    if (c < 0 || c == terminator) break;
+    *buffer++ = (char)c;
+    index++;
+  }
+  return index;
+}
+
+String Stream::readStringUntil(char terminator) {
+  String ret;
+  int c = read();
+  while (c >= 0 && c != terminator) {
+    ret += (char)c;
+    c = read();
+  }
+  return ret;
+}
+
+int HostStream::read() {
+  if (rx.empty()) return -1;
+  uint8_t c = (uint8_t)rx.front();
+  rx.pop_front();
+  return c;
+}
+
+size_t HostStream::write(uint8_t c) {
+  if (capture) tx.push_back((char)c);
+  if (txFree > 0) txFree--;
+  return 1;
+}
+
+size_t HostStream::write(const uint8_t* buf, size_t size) {
+  if (capture) tx.append((const char*)buf, size);
+  if (txFree >= 0) txFree = (size_t)txFree > size ? txFree - (int)size : 0;
+  return size;
+}
+
+int HostStream::availableForWrite() {
+  return txFree < 0 ? 4096 : txFree;
+}
+
+HardwareSerial Serial;
+HardwareSerial Serial1;
+HardwareSerial SerialUSB;
@@ -0,0 +1,260 @@
+#ifndef HOST_ARDUINO_H
+#define HOST_ARDUINO_H
+
+// =================================================================
+// HOST ARDUINO CORE
+// =================================================================
+// Just enough of the Due core to build the sketch sources on a PC.
+// Time is virtual: millis()/micros() only move when a test advances
+// them (or the firmware calls delay()). Clock, pins and sensor values
+// are per thread, so independent simulations can run side by side.
+
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+#include <strings.h>
+#include <ctype.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+#include <string>
+#include <deque>
+
+typedef uint8_t byte;
+typedef bool boolean;
+
+#define LOW  0
+#define HIGH 1
+#define INPUT        0
+#define OUTPUT       1
+#define INPUT_PULLUP 2
+#define CHANGE  1
+#define FALLING 2
+#define RISING  3
+
+#define DEC 10
+#define HEX 16
+#define OCT 8
+#define BIN 2
+
+// Due analog pin numbers
+#define A0 54
+#define A1 55
+#define A2 56
+#define A3 57
+#define A4 58
+#define A5 59
+#define A6 60
+#define A7 61
+#define A8 62
+#define A9 63
+#define A10 64
+#define A11 65
+
+#define F(x) (x)
+#define PI 3.1415926535897932384626433832795
+#define constrain(amt, low, high) ((amt) < (low) ? (low) : ((amt) > (high) ? (high) : (amt)))
+
+unsigned long millis();
+unsigned long micros();
+void delay(unsigned long ms);
+void delayMicroseconds(unsigned int us);
+void pinMode(uint32_t pin, uint32_t mode);
+void digitalWrite(uint32_t pin, uint32_t value);
+int digitalRead(uint32_t pin);
+void noInterrupts();
+void interrupts();
+
+// =================================================================
+// STRING (Arduino WString semantics)
+// =================================================================
+// Heap buffer sized exactly to the content, grown with realloc() on
+// every concat that does not fit, like the core's String. Each heap
+// (re)allocation is counted in hostStringAllocations().
+
+class String {
+  public:
+    String(const char* cstr = "");
+    String(const String &str);
+    explicit String(char c);
+    explicit String(unsigned char value, unsigned char base = 10);
+    explicit String(int value, unsigned char base = 10);
+    explicit String(unsigned int value, unsigned char base = 10);
+    explicit String(long value, unsigned char base = 10);
+    explicit String(unsigned long value, unsigned char base = 10);
+    explicit String(float value, unsigned char decimalPlaces = 2);
+    explicit String(double value, unsigned char decimalPlaces = 2);
+    ~String();
+
+    String& operator=(const String &rhs);
+    String& operator=(const char* cstr);
+
+    bool reserve(unsigned int size);
+    unsigned int length() const { return len; }
+    const char* c_str() const { return buffer ? buffer : ""; }
+
+    bool concat(const String &str);
+    bool concat(const char* cstr);
+    bool concat(const char* cstr, unsigned int length);
+    bool concat(char c);
+    bool concat(int num);
+    bool concat(unsigned int num);
+    bool concat(long num);
+    bool concat(unsigned long num);
+    bool concat(double num);
+
+    String& operator+=(const String &rhs) { concat(rhs); return *this; }
+    String& operator+=(const char* cstr)  { concat(cstr); return *this; }
+    String& operator+=(char c)            { concat(c); return *this; }
+    String& operator+=(int num)           { concat(num); return *this; }
+    String& operator+=(unsigned int num)  { concat(num); return *this; }
+    String& operator+=(long num)          { concat(num); return *this; }
+    String& operator+=(unsigned long num) { concat(num); return *this; }
+    String& operator+=(double num)        { concat(num); return *this; }
+
+    bool equals(const char* cstr) const { return strcmp(c_str(), cstr) == 0; }
+    bool operator==(const String &rhs) const { return equals(rhs.c_str()); }
+    bool operator==(const char* cstr) const { return equals(cstr); }
+    bool operator!=(const String &rhs) const { return !equals(rhs.c_str()); }
+    bool operator!=(const char* cstr) const { return !equals(cstr); }
+
+    char charAt(unsigned int index) const { return index < len ? buffer[index] : 0; }
+    char operator[](unsigned int index) const { return charAt(index); }
+    int indexOf(char c) const;
+    bool startsWith(const char* prefix) const { return strncmp(c_str(), prefix, strlen(prefix)) == 0; }
+    String substring(unsigned int from, unsigned int to) const;
+    String substring(unsigned int from) const { return substring(from, len); }
+    long toInt() const { return atol(c_str()); }
+    float toFloat() const { return (float)atof(c_str()); }
+    void trim();
+
+  private:
+    bool changeBuffer(unsigned int maxStrLen);
+    char* buffer;
+    unsigned int capacity;
+    unsigned int len;
+};
+
+String operator+(const String &lhs, const String &rhs);
+String operator+(const String &lhs, const char* rhs);
+
+// Heap allocations made by String since the process started
+unsigned long hostStringAllocations();
+
+// =================================================================
+// PRINT / STREAM
+// =================================================================
+
+class Print {
+  public:
+    virtual ~Print() {}
+    virtual size_t write(uint8_t c) = 0;
+    virtual size_t write(const uint8_t* buf, size_t size);
+    size_t write(const char* str) { return str ? write((const uint8_t*)str, strlen(str)) : 0; }
+    size_t write(const char* buf, size_t size) { return write((const uint8_t*)buf, size); }
+    virtual int availableForWrite() { return 0; }
+    virtual void flush() {}
+
+    size_t print(const char* str) { return write(str); }
+    size_t print(const String &str) { return write((const uint8_t*)str.c_str(), str.length()); }
+    size_t print(char c) { return write((uint8_t)c); }
+    size_t print(unsigned char n, int base = DEC) { return print((unsigned long)n, base); }
+    size_t print(int n, int base = DEC) { return print((long)n, base); }
+    size_t print(unsigned int n, int base = DEC) { return print((unsigned long)n, base); }
+    size_t print(long n, int base = DEC);
+    size_t print(unsigned long n, int base = DEC);
+    size_t print(double n, int digits = 2);
+
+    size_t println() { return write("\r\n"); }
+    template <typename T> size_t println(const T &value) { size_t n = print(value); return n + println(); }
+    template <typename T> size_t println(const T &value, int format) { size_t n = print(value, format); return n + println(); }
+
+  private:
+    size_t printNumber(unsigned long n, uint8_t base);
+};
+
+class Stream : public Print {
+  public:
+    Stream() : timeoutMs(1000) {}
+    virtual int available() = 0;
+    virtual int read() = 0;
+    virtual int peek() = 0;
+
+    void setTimeout(unsigned long timeout) { timeoutMs = timeout; }
+    // No bytes arrive while the host waits, so the timeout expires at
+    // once: these return what is already buffered
+    size_t readBytes(char* buffer, size_t length);
+    size_t readBytesUntil(char terminator, char* buffer, size_t length);
+    String readStringUntil(char terminator);
+
+  protected:
+    unsigned long timeoutMs;
+};
+
+// In-memory serial line for tests: bytes queued with hostFeed() are
+// read by the firmware; everything written is kept (when capturing)
+// for hostTakeOutput(). Flushes are counted: on RS485 each one holds
+// the loop until the frame has left at the line rate.
+class HostStream : public Stream {
+  public:
+    HostStream() : capture(true), flushes(0), txFree(-1) {}
+    int available() override { return (int)rx.size(); }
+    int read() override;
+    int peek() override { return rx.empty() ? -1 : (uint8_t)rx.front(); }
+    size_t write(uint8_t c) override;
+    size_t write(const uint8_t* buf, size_t size) override;
+    using Print::write;
+    int availableForWrite() override;
+    void flush() override { flushes++; }
+
+    void hostFeed(const char* data) { hostFeed(data, strlen(data)); }
+    void hostFeed(const char* data, size_t len) { rx.insert(rx.end(), data, data + len); }
+    std::string hostTakeOutput() { std::string out; out.swap(tx); return out; }
+    const std::string& hostOutput() const { return tx; }
+    void hostClear() { rx.clear(); tx.clear(); flushes = 0; }
+    void hostCapture(bool on) { capture = on; }
+    unsigned long hostFlushCount() const { return flushes; }
+    // Emulate a UART TX buffer: free bytes reported by availableForWrite()
+    // (-1 = unlimited). Writes use it up; hostDrainTx() frees it again.
+    void hostSetTxFree(int bytes) { txFree = bytes; }
+    void hostDrainTx(int bytes) { if (txFree >= 0) txFree += bytes; }
+
+  private:
+    std::deque<char> rx;
+    std::string tx;
+    bool capture;
+    unsigned long flushes;
+    int txFree;
+};
+
+class HardwareSerial : public HostStream {
+  public:
+    HardwareSerial() { hostCapture(false); }
+    void begin(unsigned long) {}
+    void end() {}
+    operator bool() const { return true; }
+};
+
+extern HardwareSerial Serial;
+extern HardwareSerial Serial1;
+extern HardwareSerial SerialUSB;
+
+// =================================================================
+// HOST CONTROLS (tests and tools only)
+// =================================================================
+
+// Virtual time since this thread's clock was reset, unwrapped
+uint64_t hostMicros();
+void hostResetClock();
+void hostAdvanceMicros(uint64_t us);
+void hostAdvanceMillis(uint64_t ms);
+// Shift what millis()/micros() report so that both wrap around
+// 'ms' milliseconds from now (unsigned long arithmetic wraps there)
+void hostWrapClockIn(uint64_t ms);
+
+// Last level written to a pin and the number of level changes
+int hostPinLevel(uint32_t pin);
+unsigned long hostPinChanges(uint32_t pin);
+void hostResetPins();
+
+#endif // HOST_ARDUINO_H
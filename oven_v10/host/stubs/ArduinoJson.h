@@ -0,0 +1,1075 @@
+#ifndef HOST_ARDUINOJSON_H
+#define HOST_ARDUINOJSON_H
+
+#include <Arduino.h>
+#include <errno.h>
+#include <type_traits>
+#include <limits>
+
+// =================================================================
+// ARDUINOJSON 6 (host subset)
+// =================================================================
+// The part of the ArduinoJson 6 API the firmware uses, with the same
+// observable behaviour: fixed-capacity documents, zero-copy parsing of
+// char* input, linked const char* values, NaN serialized as null and
+// the same conversion rules for as<T>() / is<T>() / operator|.
+//
+// Capacity is accounted as on the Due (32-bit, double floats): every
+// value or member takes 16 bytes and every copied string strlen + 1.
+// Writes that do not fit are dropped and overflowed() turns true, so a
+// reply that would be truncated on the board is truncated here too.
+//
+// Not supported: writing through a member that does not exist yet on a
+// member that does not exist yet (doc["a"]["b"] = 1); the firmware uses
+// createNestedObject() for that.
+
+namespace ArduinoJsonHost {
+
+const size_t SLOT_SIZE = 16;
+const uint8_t NESTING_LIMIT = 10;
+
+enum NodeType {
+  NODE_NULL, NODE_BOOL, NODE_INT, NODE_UINT, NODE_FLOAT,
+  NODE_LINKED_STRING, NODE_OWNED_STRING, NODE_ARRAY, NODE_OBJECT
+};
+
+struct Node {
+  uint8_t type;
+  const char* key;   // Object members only
+  union {
+    bool b;
+    int64_t i;
+    uint64_t u;
+    double f;
+    const char* s;
+  } value;
+  Node* first;       // Arrays/objects: first child
+  Node* next;        // Next sibling
+};
+
+} // namespace ArduinoJsonHost
+
+class JsonDocument;
+class JsonVariant;
+class JsonArray;
+class JsonObject;
+
+// =================================================================
+// DESERIALIZATION ERROR
+// =================================================================
+
+class DeserializationError {
+  public:
+    enum Code { Ok, EmptyInput, IncompleteInput, InvalidInput, NoMemory, TooDeep };
+
+    DeserializationError(Code c = Ok) : errorCode(c) {}
+    Code code() const { return errorCode; }
+    explicit operator bool() const { return errorCode != Ok; }
+    bool operator==(Code c) const { return errorCode == c; }
+    bool operator!=(Code c) const { return errorCode != c; }
+    const char* c_str() const {
+      static const char* const NAMES[] = {"Ok", "EmptyInput", "IncompleteInput", "InvalidInput", "NoMemory", "TooDeep"};
+      return NAMES[errorCode];
+    }
+
+  private:
+    Code errorCode;
+};
+
+// =================================================================
+// DOCUMENT
+// =================================================================
+
+class JsonDocument {
+  public:
+    void clear() {
+      nodesUsed = 0;
+      stringsUsed = 0;
+      memory = 0;
+      failed = false;
+      resetNode(&root);
+    }
+    size_t capacity() const { return cap; }
+    size_t memoryUsage() const { return memory; }
+    bool overflowed() const { return failed; }
+
+    bool containsKey(const char* key) const;
+    JsonVariant operator[](const char* key);
+    JsonVariant operator[](const String &key);
+    template <typename T>
+    typename std::enable_if<std::is_integral<T>::value, JsonVariant>::type operator[](T index);
+
+    template <typename T> T as() const;
+    template <typename T> bool is() const;
+    bool isNull() const { return root.type == ArduinoJsonHost::NODE_NULL; }
+    size_t size() const;
+
+    JsonArray createNestedArray();
+    JsonArray createNestedArray(const char* key);
+    JsonObject createNestedObject();
+    JsonObject createNestedObject(const char* key);
+    JsonArray to_array();
+    JsonObject to_object();
+
+    // --- Used by the variant classes and the parser ---
+    ArduinoJsonHost::Node* rootNode() { return &root; }
+    const ArduinoJsonHost::Node* rootNode() const { return &root; }
+    ArduinoJsonHost::Node* allocNode() {
+      if (nodesUsed >= nodeCap || memory + ArduinoJsonHost::SLOT_SIZE > cap) { failed = true; return NULL; }
+      memory += ArduinoJsonHost::SLOT_SIZE;
+      ArduinoJsonHost::Node* n = &nodes[nodesUsed++];
+      resetNode(n);
+      return n;
+    }
+    const char* copyString(const char* s, size_t len) {
+      if (stringsUsed + len + 1 > stringCap || memory + len + 1 > cap) { failed = true; return NULL; }
+      char* dst = strings + stringsUsed;
+      memcpy(dst, s, len);
+      dst[len] = '\0';
+      stringsUsed += len + 1;
+      memory += len + 1;
+      return dst;
+    }
+
+    static void resetNode(ArduinoJsonHost::Node* n) {
+      n->type = ArduinoJsonHost::NODE_NULL;
+      n->key = NULL;
+      n->value.u = 0;
+      n->first = NULL;
+      n->next = NULL;
+    }
+
+  protected:
+    JsonDocument(ArduinoJsonHost::Node* nodePool, size_t nodeCount, char* stringPool, size_t capacity)
+      : nodes(nodePool), nodeCap(nodeCount), strings(stringPool), stringCap(capacity), cap(capacity) {
+      clear();
+    }
+
+  private:
+    JsonDocument(const JsonDocument &);
+    JsonDocument& operator=(const JsonDocument &);
+
+    ArduinoJsonHost::Node root;
+    ArduinoJsonHost::Node* nodes;
+    size_t nodeCap;
+    size_t nodesUsed;
+    char* strings;
+    size_t stringCap;
+    size_t stringsUsed;
+    size_t cap;
+    size_t memory;
+    bool failed;
+};
+
+template <size_t N>
+class StaticJsonDocument : public JsonDocument {
+  public:
+    StaticJsonDocument() : JsonDocument(pool, N / ArduinoJsonHost::SLOT_SIZE + 1, stringPool, N) {}
+
+    template <typename T> JsonVariant operator=(const T &value);
+
+  private:
+    ArduinoJsonHost::Node pool[N / ArduinoJsonHost::SLOT_SIZE + 1];
+    char stringPool[N];
+};
+
+// =================================================================
+// VARIANT
+// =================================================================
+// A reference to a node in a document. A variant obtained with
+// operator[] for a member that does not exist remembers its parent
+// and key, so assigning to it adds the member.
+
+class JsonVariant {
+  public:
+    JsonVariant() : doc(NULL), node(NULL), parent(NULL), pendingKey(NULL), ownKey(false) {}
+    JsonVariant(JsonDocument* d, ArduinoJsonHost::Node* n) : doc(d), node(n), parent(NULL), pendingKey(NULL), ownKey(false) {}
+    JsonVariant(JsonDocument* d, ArduinoJsonHost::Node* p, const char* key, bool copyKey)
+      : doc(d), node(NULL), parent(p), pendingKey(key), ownKey(copyKey) {}
+
+    bool isNull() const { return node == NULL || node->type == ArduinoJsonHost::NODE_NULL; }
+    size_t size() const;
+    bool containsKey(const char* key) const { return findMember(node, key) != NULL; }
+
+    template <typename T> T as() const;
+    template <typename T> bool is() const;
+    template <typename T> operator T() const { return as<T>(); }
+
+    // ArduinoJson 6: the value if it has the type of 'def', else 'def'
+    template <typename T> T operator|(const T &def) const { return is<T>() ? as<T>() : def; }
+    const char* operator|(const char* def) const { return is<const char*>() ? as<const char*>() : def; }
+
+    JsonVariant operator[](const char* key) const;
+    JsonVariant operator[](const String &key) const;
+    template <typename T>
+    typename std::enable_if<std::is_integral<T>::value, JsonVariant>::type operator[](T index) const;
+
+    // --- Assignment ---
+    JsonVariant& operator=(bool v) { if (ArduinoJsonHost::Node* n = target()) { n->type = ArduinoJsonHost::NODE_BOOL; n->value.b = v; } return *this; }
+    JsonVariant& operator=(char v) { return setSigned(v); }
+    JsonVariant& operator=(signed char v) { return setSigned(v); }
+    JsonVariant& operator=(unsigned char v) { return setUnsigned(v); }
+    JsonVariant& operator=(short v) { return setSigned(v); }
+    JsonVariant& operator=(unsigned short v) { return setUnsigned(v); }
+    JsonVariant& operator=(int v) { return setSigned(v); }
+    JsonVariant& operator=(unsigned int v) { return setUnsigned(v); }
+    JsonVariant& operator=(long v) { return setSigned(v); }
+    JsonVariant& operator=(unsigned long v) { return setUnsigned(v); }
+    JsonVariant& operator=(long long v) { return setSigned(v); }
+    JsonVariant& operator=(unsigned long long v) { return setUnsigned(v); }
+    JsonVariant& operator=(float v) { return setFloat(v); }
+    JsonVariant& operator=(double v) { return setFloat(v); }
+    // const char* is stored by pointer, char* and String are copied
+    JsonVariant& operator=(const char* v) { return setString(v, false); }
+    JsonVariant& operator=(char* v) { return setString(v, true); }
+    JsonVariant& operator=(const String &v) { return setString(v.c_str(), true); }
+    JsonVariant& operator=(const JsonVariant &v);
+
+    JsonVariant(const JsonVariant &) = default;
+
+    // --- Used by the container classes and serializer ---
+    JsonDocument* document() const { return doc; }
+    ArduinoJsonHost::Node* data() const { return node; }
+    ArduinoJsonHost::Node* target();
+    static ArduinoJsonHost::Node* findMember(const ArduinoJsonHost::Node* obj, const char* key);
+
+  private:
+    JsonVariant& setSigned(long long v) {
+      if (ArduinoJsonHost::Node* n = target()) { n->type = ArduinoJsonHost::NODE_INT; n->value.i = v; }
+      return *this;
+    }
+    JsonVariant& setUnsigned(unsigned long long v) {
+      if (ArduinoJsonHost::Node* n = target()) { n->type = ArduinoJsonHost::NODE_UINT; n->value.u = v; }
+      return *this;
+    }
+    JsonVariant& setFloat(double v) {
+      if (ArduinoJsonHost::Node* n = target()) { n->type = ArduinoJsonHost::NODE_FLOAT; n->value.f = v; }
+      return *this;
+    }
+    JsonVariant& setString(const char* v, bool copy);
+
+    JsonDocument* doc;
+    ArduinoJsonHost::Node* node;
+    ArduinoJsonHost::Node* parent;
+    const char* pendingKey;
+    bool ownKey;
+};
+
+class JsonArray {
+  public:
+    JsonArray() : doc(NULL), node(NULL) {}
+    JsonArray(JsonDocument* d, ArduinoJsonHost::Node* n) : doc(d), node(n) {}
+
+    bool isNull() const { return node == NULL; }
+    size_t size() const;
+    JsonVariant operator[](size_t index) const;
+    template <typename T> bool add(const T &value) {
+      JsonVariant v = addElement();
+      if (v.data() == NULL) return false;
+      v = value;
+      return true;
+    }
+    JsonArray createNestedArray();
+    JsonObject createNestedObject();
+
+    class iterator {
+      public:
+        iterator(JsonDocument* d, ArduinoJsonHost::Node* n) : doc(d), node(n) {}
+        JsonVariant operator*() const { return JsonVariant(doc, node); }
+        iterator& operator++() { node = node->next; return *this; }
+        bool operator!=(const iterator &other) const { return node != other.node; }
+      private:
+        JsonDocument* doc;
+        ArduinoJsonHost::Node* node;
+    };
+    iterator begin() const { return iterator(doc, node ? node->first : NULL); }
+    iterator end() const { return iterator(doc, NULL); }
+
+    operator JsonVariant() const { return JsonVariant(doc, node); }
+
+  private:
+    JsonVariant addElement() const;
+    JsonDocument* doc;
+    ArduinoJsonHost::Node* node;
+};
+
+class JsonObject {
+  public:
+    JsonObject() : doc(NULL), node(NULL) {}
+    JsonObject(JsonDocument* d, ArduinoJsonHost::Node* n) : doc(d), node(n) {}
+
+    bool isNull() const { return node == NULL; }
+    size_t size() const;
+    bool containsKey(const char* key) const { return JsonVariant::findMember(node, key) != NULL; }
+    JsonVariant operator[](const char* key) const;
+    JsonVariant operator[](const String &key) const;
+    JsonArray createNestedArray(const char* key) const;
+    JsonObject createNestedObject(const char* key) const;
+
+    operator JsonVariant() const { return JsonVariant(doc, node); }
+
+  private:
+    JsonDocument* doc;
+    ArduinoJsonHost::Node* node;
+};
+
+// =================================================================
+// CONVERSIONS
+// =================================================================
+
+namespace ArduinoJsonHost {
+
+inline bool isString(const Node* n) {
+  return n && (n->type == NODE_LINKED_STRING || n->type == NODE_OWNED_STRING);
+}
+
+template <typename T>
+struct Converter {
+  // Integers: any integer or float in range, truncated; 0 otherwise
+  static T as(JsonDocument*, const Node* n) {
+    if (n == NULL) return T();
+    switch (n->type) {
+      case NODE_BOOL: return (T)n->value.b;
+      case NODE_INT: return inRange(n) ? (T)n->value.i : T();
+      case NODE_UINT: return inRange(n) ? (T)n->value.u : T();
+      case NODE_FLOAT:
+        if (std::is_floating_point<T>::value) return (T)n->value.f;
+        if (n->value.f != n->value.f) return T();
+        if (n->value.f < (double)std::numeric_limits<T>::min() || n->value.f > (double)std::numeric_limits<T>::max()) return T();
+        return (T)n->value.f;
+      default: return T();
+    }
+  }
+  static bool is(const Node* n) {
+    if (n == NULL) return false;
+    if (std::is_floating_point<T>::value) return n->type == NODE_INT || n->type == NODE_UINT || n->type == NODE_FLOAT;
+    return (n->type == NODE_INT || n->type == NODE_UINT) && inRange(n);
+  }
+  static bool inRange(const Node* n) {
+    if (std::is_floating_point<T>::value) return true;
+    if (n->type == NODE_INT) {
+      if (n->value.i < 0) return std::is_signed<T>::value && n->value.i >= (int64_t)std::numeric_limits<T>::min();
+      return (uint64_t)n->value.i <= (uint64_t)std::numeric_limits<T>::max();
+    }
+    return n->value.u <= (uint64_t)std::numeric_limits<T>::max();
+  }
+};
+
+template <>
+struct Converter<bool> {
+  static bool as(JsonDocument*, const Node* n) {
+    if (n == NULL) return false;
+    switch (n->type) {
+      case NODE_BOOL: return n->value.b;
+      case NODE_INT: return n->value.i != 0;
+      case NODE_UINT: return n->value.u != 0;
+      case NODE_FLOAT: return n->value.f != 0;
+      default: return false;
+    }
+  }
+  static bool is(const Node* n) { return n && n->type == NODE_BOOL; }
+};
+
+template <>
+struct Converter<const char*> {
+  static const char* as(JsonDocument*, const Node* n) { return isString(n) ? n->value.s : NULL; }
+  static bool is(const Node* n) { return isString(n); }
+};
+
+template <>
+struct Converter<String> {
+  static String as(JsonDocument*, const Node* n) { return String(isString(n) ? n->value.s : ""); }
+  static bool is(const Node* n) { return isString(n); }
+};
+
+template <>
+struct Converter<JsonArray> {
+  static JsonArray as(JsonDocument* d, const Node* n) {
+    return (n && n->type == NODE_ARRAY) ? JsonArray(d, const_cast<Node*>(n)) : JsonArray();
+  }
+  static bool is(const Node* n) { return n && n->type == NODE_ARRAY; }
+};
+
+template <>
+struct Converter<JsonObject> {
+  static JsonObject as(JsonDocument* d, const Node* n) {
+    return (n && n->type == NODE_OBJECT) ? JsonObject(d, const_cast<Node*>(n)) : JsonObject();
+  }
+  static bool is(const Node* n) { return n && n->type == NODE_OBJECT; }
+};
+
+template <>
+struct Converter<JsonVariant> {
+  static JsonVariant as(JsonDocument* d, const Node* n) { return JsonVariant(d, const_cast<Node*>(n)); }
+  static bool is(const Node*) { return true; }
+};
+
+inline Node* lastChild(Node* parent) {
+  Node* n = parent->first;
+  while (n && n->next) n = n->next;
+  return n;
+}
+
+inline void appendChild(Node* parent, Node* child) {
+  Node* last = lastChild(parent);
+  if (last) last->next = child;
+  else parent->first = child;
+}
+
+inline size_t childCount(const Node* n) {
+  if (n == NULL || (n->type != NODE_ARRAY && n->type != NODE_OBJECT)) return 0;
+  size_t count = 0;
+  for (const Node* c = n->first; c; c = c->next) count++;
+  return count;
+}
+
+} // namespace ArduinoJsonHost
+
+// =================================================================
+// INLINE DEFINITIONS
+// =================================================================
+
+template <typename T> T JsonVariant::as() const {
+  return ArduinoJsonHost::Converter<typename std::decay<T>::type>::as(doc, node);
+}
+
+template <typename T> bool JsonVariant::is() const {
+  return ArduinoJsonHost::Converter<typename std::decay<T>::type>::is(node);
+}
+
+inline size_t JsonVariant::size() const {
+  return ArduinoJsonHost::childCount(node);
+}
+
+inline ArduinoJsonHost::Node* JsonVariant::findMember(const ArduinoJsonHost::Node* obj, const char* key) {
+  if (obj == NULL || obj->type != ArduinoJsonHost::NODE_OBJECT || key == NULL) return NULL;
+  for (ArduinoJsonHost::Node* n = obj->first; n; n = n->next) {
+    if (strcmp(n->key, key) == 0) return n;
+  }
+  return NULL;
+}
+
+// The node to write: the existing one, or a new member of 'parent'
+inline ArduinoJsonHost::Node* JsonVariant::target() {
+  using namespace ArduinoJsonHost;
+  if (node) {
+    // Overwriting a container drops its children (their slots stay used, as on the board)
+    node->first = NULL;
+    return node;
+  }
+  if (parent == NULL || doc == NULL) return NULL;
+  if (parent->type == NODE_NULL) parent->type = NODE_OBJECT;
+  if (parent->type != NODE_OBJECT) return NULL;
+  const char* key = pendingKey;
+  if (ownKey) {
+    key = doc->copyString(pendingKey, strlen(pendingKey));
+    if (key == NULL) return NULL;
+  }
+  Node* n = doc->allocNode();
+  if (n == NULL) return NULL;
+  n->key = key;
+  appendChild(parent, n);
+  node = n;
+  return node;
+}
+
+inline JsonVariant& JsonVariant::setString(const char* v, bool copy) {
+  using namespace ArduinoJsonHost;
+  if (v == NULL) {
+    if (Node* n = target()) n->type = NODE_NULL;
+    return *this;
+  }
+  if (copy) {
+    if (doc == NULL) return *this;
+    const char* s = doc->copyString(v, strlen(v));
+    if (s == NULL) return *this;
+    if (Node* n = target()) { n->type = NODE_OWNED_STRING; n->value.s = s; }
+  } else {
+    if (Node* n = target()) { n->type = NODE_LINKED_STRING; n->value.s = v; }
+  }
+  return *this;
+}
+
+inline JsonVariant& JsonVariant::operator=(const JsonVariant &v) {
+  using namespace ArduinoJsonHost;
+  const Node* src = v.node;
+  if (src == NULL || src->type == NODE_NULL) {
+    if (Node* n = target()) n->type = NODE_NULL;
+    return *this;
+  }
+  switch (src->type) {
+    case NODE_BOOL: return *this = src->value.b;
+    case NODE_INT: return setSigned(src->value.i);
+    case NODE_UINT: return setUnsigned(src->value.u);
+    case NODE_FLOAT: return setFloat(src->value.f);
+    case NODE_LINKED_STRING: return setString(src->value.s, false);
+    case NODE_OWNED_STRING: return setString(src->value.s, true);
+    default: return *this; // Deep copies of containers are not needed on the board
+  }
+}
+
+inline JsonVariant JsonVariant::operator[](const char* key) const {
+  ArduinoJsonHost::Node* member = findMember(node, key);
+  if (member) return JsonVariant(doc, member);
+  if (node && (node->type == ArduinoJsonHost::NODE_OBJECT || node->type == ArduinoJsonHost::NODE_NULL)) {
+    return JsonVariant(doc, node, key, false);
+  }
+  return JsonVariant();
+}
+
+inline JsonVariant JsonVariant::operator[](const String &key) const {
+  ArduinoJsonHost::Node* member = findMember(node, key.c_str());
+  // The String may not outlive the variant: writes copy the key
+  if (member) return JsonVariant(doc, member);
+  return JsonVariant();
+}
+
+template <typename T>
+typename std::enable_if<std::is_integral<T>::value, JsonVariant>::type JsonVariant::operator[](T index) const {
+  if (node == NULL || node->type != ArduinoJsonHost::NODE_ARRAY || index < 0) return JsonVariant();
+  ArduinoJsonHost::Node* n = node->first;
+  for (T i = 0; n && i < index; i++) n = n->next;
+  return n ? JsonVariant(doc, n) : JsonVariant();
+}
+
+// --- JsonArray ---
+
+inline size_t JsonArray::size() const {
+  return ArduinoJsonHost::childCount(node);
+}
+
+inline JsonVariant JsonArray::operator[](size_t index) const {
+  return JsonVariant(doc, node)[index];
+}
+
+inline JsonVariant JsonArray::addElement() const {
+  if (node == NULL || doc == NULL) return JsonVariant();
+  ArduinoJsonHost::Node* n = doc->allocNode();
+  if (n == NULL) return JsonVariant();
+  ArduinoJsonHost::appendChild(node, n);
+  return JsonVariant(doc, n);
+}
+
+inline JsonArray JsonArray::createNestedArray() {
+  JsonVariant v = addElement();
+  if (v.data() == NULL) return JsonArray();
+  v.data()->type = ArduinoJsonHost::NODE_ARRAY;
+  return JsonArray(doc, v.data());
+}
+
+inline JsonObject JsonArray::createNestedObject() {
+  JsonVariant v = addElement();
+  if (v.data() == NULL) return JsonObject();
+  v.data()->type = ArduinoJsonHost::NODE_OBJECT;
+  return JsonObject(doc, v.data());
+}
+
+// --- JsonObject ---
+
+inline size_t JsonObject::size() const {
+  return ArduinoJsonHost::childCount(node);
+}
+
+inline JsonVariant JsonObject::operator[](const char* key) const {
+  if (node == NULL) return JsonVariant();
+  return JsonVariant(doc, node)[key];
+}
+
+inline JsonVariant JsonObject::operator[](const String &key) const {
+  if (node == NULL) return JsonVariant();
+  ArduinoJsonHost::Node* member = JsonVariant::findMember(node, key.c_str());
+  if (member) return JsonVariant(doc, member);
+  return JsonVariant(doc, node, key.c_str(), true);
+}
+
+inline JsonArray JsonObject::createNestedArray(const char* key) const {
+  JsonVariant v = (*this)[key];
+  ArduinoJsonHost::Node* n = v.target();
+  if (n == NULL) return JsonArray();
+  n->type = ArduinoJsonHost::NODE_ARRAY;
+  return JsonArray(doc, n);
+}
+
+inline JsonObject JsonObject::createNestedObject(const char* key) const {
+  JsonVariant v = (*this)[key];
+  ArduinoJsonHost::Node* n = v.target();
+  if (n == NULL) return JsonObject();
+  n->type = ArduinoJsonHost::NODE_OBJECT;
+  return JsonObject(doc, n);
+}
+
+// --- JsonDocument ---
+
+inline bool JsonDocument::containsKey(const char* key) const {
+  return JsonVariant::findMember(&root, key) != NULL;
+}
+
+inline JsonVariant JsonDocument::operator[](const char* key) {
+  return JsonVariant(this, &root)[key];
+}
+
+inline JsonVariant JsonDocument::operator[](const String &key) {
+  if (root.type == ArduinoJsonHost::NODE_NULL) root.type = ArduinoJsonHost::NODE_OBJECT;
+  return JsonObject(this, &root)[key];
+}
+
+template <typename T>
+typename std::enable_if<std::is_integral<T>::value, JsonVariant>::type JsonDocument::operator[](T index) {
+  return JsonVariant(this, &root)[index];
+}
+
+template <typename T> T JsonDocument::as() const {
+  return JsonVariant(const_cast<JsonDocument*>(this), const_cast<ArduinoJsonHost::Node*>(&root)).as<T>();
+}
+
+template <typename T> bool JsonDocument::is() const {
+  return JsonVariant(const_cast<JsonDocument*>(this), const_cast<ArduinoJsonHost::Node*>(&root)).is<T>();
+}
+
+inline size_t JsonDocument::size() const {
+  return ArduinoJsonHost::childCount(&root);
+}
+
+inline JsonArray JsonDocument::to_array() {
+  clear();
+  root.type = ArduinoJsonHost::NODE_ARRAY;
+  return JsonArray(this, &root);
+}
+
+inline JsonObject JsonDocument::to_object() {
+  clear();
+  root.type = ArduinoJsonHost::NODE_OBJECT;
+  return JsonObject(this, &root);
+}
+
+inline JsonArray JsonDocument::createNestedArray() {
+  if (root.type == ArduinoJsonHost::NODE_NULL) root.type = ArduinoJsonHost::NODE_ARRAY;
+  return JsonArray(this, &root).createNestedArray();
+}
+
+inline JsonObject JsonDocument::createNestedObject() {
+  if (root.type == ArduinoJsonHost::NODE_NULL) root.type = ArduinoJsonHost::NODE_ARRAY;
+  return JsonArray(this, &root).createNestedObject();
+}
+
+inline JsonArray JsonDocument::createNestedArray(const char* key) {
+  if (root.type == ArduinoJsonHost::NODE_NULL) root.type = ArduinoJsonHost::NODE_OBJECT;
+  return JsonObject(this, &root).createNestedArray(key);
+}
+
+inline JsonObject JsonDocument::createNestedObject(const char* key) {
+  if (root.type == ArduinoJsonHost::NODE_NULL) root.type = ArduinoJsonHost::NODE_OBJECT;
+  return JsonObject(this, &root).createNestedObject(key);
+}
+
+// =================================================================
+// SERIALIZATION
+// =================================================================
+
+namespace ArduinoJsonHost {
+
+// Output sink that only counts, or appends to a String/Print/buffer
+struct Writer {
+  String* str;
+  Print* print;
+  char* buf;
+  size_t bufSize;
+  size_t count;
+
+  Writer() : str(NULL), print(NULL), buf(NULL), bufSize(0), count(0) {}
+  void write(const char* s, size_t len) {
+    if (str) str->concat(s, (unsigned int)len);
+    if (print) print->write((const uint8_t*)s, len);
+    if (buf) {
+      for (size_t i = 0; i < len && count + i + 1 < bufSize; i++) buf[count + i] = s[i];
+    }
+    count += len;
+  }
+  void write(const char* s) { write(s, strlen(s)); }
+  void write(char c) { write(&c, 1); }
+};
+
+inline void writeString(Writer &w, const char* s) {
+  w.write('"');
+  for (; *s; s++) {
+    char c = *s;
+    switch (c) {
+      case '"': w.write("\\\""); break;
+      case '\\': w.write("\\\\"); break;
+      case '\b': w.write("\\b"); break;
+      case '\f': w.write("\\f"); break;
+      case '\n': w.write("\\n"); break;
+      case '\r': w.write("\\r"); break;
+      case '\t': w.write("\\t"); break;
+      default: w.write(c); break;
+    }
+  }
+  w.write('"');
+}
+
+// ArduinoJson 6 float format: 9 decimal places with trailing zeros
+// removed, exponent notation outside [1e-5, 1e7)
+inline void writeFloat(Writer &w, double value) {
+  if (value != value || value == INFINITY || value == -INFINITY) { w.write("null"); return; }
+  if (value == 0) { w.write("0"); return; }
+  if (value < 0) { w.write('-'); value = -value; }
+
+  int exponent = 0;
+  if (value >= 1e7) {
+    while (value >= 10) { value /= 10; exponent++; }
+  } else if (value < 1e-5) {
+    while (value < 1) { value *= 10; exponent--; }
+  }
+
+  uint32_t integral = (uint32_t)value;
+  double remainder = (value - integral) * 1e9;
+  uint32_t decimal = (uint32_t)remainder;
+  if (remainder - decimal >= 0.5) decimal++;
+  if (decimal >= 1000000000UL) {
+    decimal = 0;
+    integral++;
+    if (exponent != 0 && integral >= 10) { exponent++; integral = 1; }
+  }
+
+  char tmp[32];
+  snprintf(tmp, sizeof(tmp), "%lu", (unsigned long)integral);
+  w.write(tmp);
+  if (decimal) {
+    int places = 9;
+    while (decimal % 10 == 0) { decimal /= 10; places--; }
+    snprintf(tmp, sizeof(tmp), ".%0*lu", places, (unsigned long)decimal);
+    w.write(tmp);
+  }
+  if (exponent) {
+    snprintf(tmp, sizeof(tmp), "e%d", exponent);
+    w.write(tmp);
+  }
+}
+
+inline void writeNode(Writer &w, const Node* n) {
+  char tmp[32];
+  if (n == NULL) { w.write("null"); return; }
+  switch (n->type) {
+    case NODE_BOOL: w.write(n->value.b ? "true" : "false"); break;
+    case NODE_INT: snprintf(tmp, sizeof(tmp), "%lld", (long long)n->value.i); w.write(tmp); break;
+    case NODE_UINT: snprintf(tmp, sizeof(tmp), "%llu", (unsigned long long)n->value.u); w.write(tmp); break;
+    case NODE_FLOAT: writeFloat(w, n->value.f); break;
+    case NODE_LINKED_STRING:
+    case NODE_OWNED_STRING: writeString(w, n->value.s); break;
+    case NODE_ARRAY:
+      w.write('[');
+      for (const Node* c = n->first; c; c = c->next) {
+        writeNode(w, c);
+        if (c->next) w.write(',');
+      }
+      w.write(']');
+      break;
+    case NODE_OBJECT:
+      w.write('{');
+      for (const Node* c = n->first; c; c = c->next) {
+        writeString(w, c->key);
+        w.write(':');
+        writeNode(w, c);
+        if (c->next) w.write(',');
+      }
+      w.write('}');
+      break;
+    default: w.write("null"); break;
+  }
+}
+
+} // namespace ArduinoJsonHost
+
+inline size_t serializeJson(const JsonDocument &doc, String &output) {
+  ArduinoJsonHost::Writer w;
+  output = "";
+  w.str = &output;
+  ArduinoJsonHost::writeNode(w, doc.rootNode());
+  return w.count;
+}
+
+inline size_t serializeJson(const JsonDocument &doc, Print &output) {
+  ArduinoJsonHost::Writer w;
+  w.print = &output;
+  ArduinoJsonHost::writeNode(w, doc.rootNode());
+  return w.count;
+}
+
+inline size_t serializeJson(const JsonDocument &doc, char* output, size_t size) {
+  ArduinoJsonHost::Writer w;
+  w.buf = output;
+  w.bufSize = size;
+  ArduinoJsonHost::writeNode(w, doc.rootNode());
+  if (size > 0) output[w.count < size ? w.count : size - 1] = '\0';
+  return w.count < size ? w.count : (size > 0 ? size - 1 : 0);
+}
+
+inline size_t measureJson(const JsonDocument &doc) {
+  ArduinoJsonHost::Writer w;
+  ArduinoJsonHost::writeNode(w, doc.rootNode());
+  return w.count;
+}
+
+// =================================================================
+// DESERIALIZATION
+// =================================================================
+
+namespace ArduinoJsonHost {
+
+class Parser {
+  public:
+    // 'inPlace': unescape strings into the input itself (char* input)
+    Parser(JsonDocument &d, char* input, const char* end, bool inPlace)
+      : doc(d), p(input), limit(end), zeroCopy(inPlace) {}
+
+    DeserializationError parse() {
+      doc.clear();
+      skipSpace();
+      if (p >= limit) return DeserializationError::EmptyInput;
+      return parseValue(doc.rootNode(), 0);
+    }
+
+  private:
+    void skipSpace() {
+      while (p < limit && (*p == ' ' || *p == '\t' || *p == '\r' || *p == '\n')) p++;
+    }
+
+    DeserializationError parseValue(Node* n, uint8_t depth) {
+      skipSpace();
+      if (p >= limit) return DeserializationError::IncompleteInput;
+      switch (*p) {
+        case '{': return depth >= NESTING_LIMIT ? DeserializationError::TooDeep : parseObject(n, depth + 1);
+        case '[': return depth >= NESTING_LIMIT ? DeserializationError::TooDeep : parseArray(n, depth + 1);
+        case '"':
+        case '\'': {
+          const char* s = NULL;
+          DeserializationError err = parseString(s);
+          if (err) return err;
+          n->type = zeroCopy ? NODE_LINKED_STRING : NODE_OWNED_STRING;
+          n->value.s = s;
+          return DeserializationError::Ok;
+        }
+        default: return parseLiteral(n);
+      }
+    }
+
+    DeserializationError parseArray(Node* n, uint8_t depth) {
+      n->type = NODE_ARRAY;
+      p++; // '['
+      skipSpace();
+      if (p >= limit) return DeserializationError::IncompleteInput;
+      if (*p == ']') { p++; return DeserializationError::Ok; }
+      while (true) {
+        Node* child = doc.allocNode();
+        if (child == NULL) return DeserializationError::NoMemory;
+        appendChild(n, child);
+        DeserializationError err = parseValue(child, depth);
+        if (err) return err;
+        skipSpace();
+        if (p >= limit) return DeserializationError::IncompleteInput;
+        if (*p == ']') { p++; return DeserializationError::Ok; }
+        if (*p != ',') return DeserializationError::InvalidInput;
+        p++;
+      }
+    }
+
+    DeserializationError parseObject(Node* n, uint8_t depth) {
+      n->type = NODE_OBJECT;
+      p++; // '{'
+      skipSpace();
+      if (p >= limit) return DeserializationError::IncompleteInput;
+      if (*p == '}') { p++; return DeserializationError::Ok; }
+      while (true) {
+        skipSpace();
+        if (p >= limit) return DeserializationError::IncompleteInput;
+        if (*p != '"' && *p != '\'') return DeserializationError::InvalidInput;
+        const char* key = NULL;
+        DeserializationError err = parseString(key);
+        if (err) return err;
+        skipSpace();
+        if (p >= limit) return DeserializationError::IncompleteInput;
+        if (*p != ':') return DeserializationError::InvalidInput;
+        p++;
+
+        // A repeated key replaces the earlier value
+        Node* child = JsonVariant::findMember(n, key);
+        if (child == NULL) {
+          child = doc.allocNode();
+          if (child == NULL) return DeserializationError::NoMemory;
+          child->key = key;
+          appendChild(n, child);
+        } else {
+          child->type = NODE_NULL;
+          child->first = NULL;
+        }
+        err = parseValue(child, depth);
+        if (err) return err;
+        skipSpace();
+        if (p >= limit) return DeserializationError::IncompleteInput;
+        if (*p == '}') { p++; return DeserializationError::Ok; }
+        if (*p != ',') return DeserializationError::InvalidInput;
+        p++;
+      }
+    }
+
+    static int hexValue(char c) {
+      if (c >= '0' && c <= '9') return c - '0';
+      if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+      if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+      return -1;
+    }
+
+    DeserializationError parseString(const char* &out) {
+      char quote = *p++;
+      char* start = p;
+      char* w = p; // In-place write position
+      std::string copy;
+      while (true) {
+        if (p >= limit) return DeserializationError::IncompleteInput;
+        char c = *p++;
+        if (c == quote) break;
+        if (c == '\0') return DeserializationError::IncompleteInput;
+        if (c == '\\') {
+          if (p >= limit) return DeserializationError::IncompleteInput;
+          char e = *p++;
+          switch (e) {
+            case '"': c = '"'; break;
+            case '\'': c = '\''; break;
+            case '\\': c = '\\'; break;
+            case '/': c = '/'; break;
+            case 'b': c = '\b'; break;
+            case 'f': c = '\f'; break;
+            case 'n': c = '\n'; break;
+            case 'r': c = '\r'; break;
+            case 't': c = '\t'; break;
+            case 'u': {
+              if (limit - p < 4) return DeserializationError::IncompleteInput;
+              uint32_t cp = 0;
+              for (int i = 0; i < 4; i++) {
+                int h = hexValue(p[i]);
+                if (h < 0) return DeserializationError::InvalidInput;
+                cp = (cp << 4) | (uint32_t)h;
+              }
+              p += 4;
+              // UTF-8 (at most 3 bytes for \uXXXX, never longer than the 6 bytes it replaces)
+              char utf8[3];
+              int len = 0;
+              if (cp < 0x80) { utf8[len++] = (char)cp; }
+              else if (cp < 0x800) { utf8[len++] = (char)(0xC0 | (cp >> 6)); utf8[len++] = (char)(0x80 | (cp & 0x3F)); }
+              else {
+                utf8[len++] = (char)(0xE0 | (cp >> 12));
+                utf8[len++] = (char)(0x80 | ((cp >> 6) & 0x3F));
+                utf8[len++] = (char)(0x80 | (cp & 0x3F));
+              }
+              for (int i = 0; i < len; i++) {
+                if (zeroCopy) *w++ = utf8[i];
+                else copy.push_back(utf8[i]);
+              }
+              continue;
+            }
+            default: return DeserializationError::InvalidInput;
+          }
+        }
+        if (zeroCopy) *w++ = c;
+        else copy.push_back(c);
+      }
+      if (zeroCopy) {
+        *w = '\0'; // At most overwrites the closing quote
+        out = start;
+        return DeserializationError::Ok;
+      }
+      out = doc.copyString(copy.data(), copy.size());
+      return out ? DeserializationError::Ok : DeserializationError::NoMemory;
+    }
+
+    static bool matches(const char* p, const char* limit, const char* word) {
+      size_t len = strlen(word);
+      return (size_t)(limit - p) >= len && strncmp(p, word, len) == 0;
+    }
+
+    // The input ends part way through 'word'
+    static bool truncated(const char* p, const char* limit, const char* word) {
+      size_t len = strlen(word);
+      size_t left = (size_t)(limit - p);
+      return left < len && strncmp(p, word, left) == 0;
+    }
+
+    DeserializationError parseLiteral(Node* n) {
+      if (matches(p, limit, "true")) { p += 4; n->type = NODE_BOOL; n->value.b = true; return DeserializationError::Ok; }
+      if (matches(p, limit, "false")) { p += 5; n->type = NODE_BOOL; n->value.b = false; return DeserializationError::Ok; }
+      if (matches(p, limit, "null")) { p += 4; n->type = NODE_NULL; return DeserializationError::Ok; }
+
+      // Number: copy the token so strtod() cannot run past 'limit'
+      char token[64];
+      size_t len = 0;
+      while (p + len < limit && len < sizeof(token) - 1) {
+        char c = p[len];
+        if (!(isdigit((unsigned char)c) || c == '-' || c == '+' || c == '.' || c == 'e' || c == 'E')) break;
+        token[len++] = c;
+      }
+      token[len] = '\0';
+      if (len == 0) {
+        // A prefix of a literal cut off by the end of input
+        if (truncated(p, limit, "true") || truncated(p, limit, "false") || truncated(p, limit, "null")) {
+          return DeserializationError::IncompleteInput;
+        }
+        return DeserializationError::InvalidInput;
+      }
+
+      bool isFloat = strpbrk(token, ".eE") != NULL;
+      char* endp = NULL;
+      if (!isFloat) {
+        errno = 0;
+        if (token[0] == '-') {
+          long long v = strtoll(token, &endp, 10);
+          if (*endp == '\0' && errno == 0) { p += len; n->type = NODE_INT; n->value.i = v; return DeserializationError::Ok; }
+        } else {
+          unsigned long long v = strtoull(token, &endp, 10);
+          if (*endp == '\0' && errno == 0) { p += len; n->type = NODE_UINT; n->value.u = v; return DeserializationError::Ok; }
+        }
+      }
+      double d = strtod(token, &endp);
+      if (*endp != '\0') return (p + len >= limit) ? DeserializationError::IncompleteInput : DeserializationError::InvalidInput;
+      p += len;
+      n->type = NODE_FLOAT;
+      n->value.f = d;
+      return DeserializationError::Ok;
+    }
+
+    JsonDocument &doc;
+    char* p;
+    const char* limit;
+    bool zeroCopy;
+};
+
+} // namespace ArduinoJsonHost
+
+// Writable input is parsed in place: strings in the document point into it
+inline DeserializationError deserializeJson(JsonDocument &doc, char* input) {
+  return ArduinoJsonHost::Parser(doc, input, input + strlen(input), true).parse();
+}
+
+// Read-only input: strings are copied into the document
+inline DeserializationError deserializeJson(JsonDocument &doc, const char* input, size_t length) {
+  std::string tmp(input, length);
+  return ArduinoJsonHost::Parser(doc, &tmp[0], tmp.data() + tmp.size(), false).parse();
+}
+
+inline DeserializationError deserializeJson(JsonDocument &doc, const char* input) {
+  return deserializeJson(doc, input, strlen(input));
+}
+
+inline DeserializationError deserializeJson(JsonDocument &doc, const String &input) {
+  return deserializeJson(doc, input.c_str(), input.length());
+}
+
+template <size_t N>
+template <typename T>
+JsonVariant StaticJsonDocument<N>::operator=(const T &value) {
+  clear();
+  JsonVariant v(this, rootNode());
+  v = value;
+  return v;
+}
+
+#endif // HOST_ARDUINOJSON_H
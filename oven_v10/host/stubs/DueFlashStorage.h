@@ -0,0 +1,22 @@
+#ifndef HOST_DUE_FLASH_STORAGE_H
+#define HOST_DUE_FLASH_STORAGE_H
+
+#include <Arduino.h>
+
+// Flash emulation: erased bytes read 0xFF. The contents are per
+// thread, like the host clock, so parallel simulations don't share it.
+const uint32_t HOST_FLASH_SIZE = 65536;
+
+class DueFlashStorage {
+  public:
+    byte read(uint32_t address);
+    byte* readAddress(uint32_t address);
+    bool write(uint32_t address, byte value);
+    bool write(uint32_t address, byte* data, uint32_t dataLength);
+};
+
+// Back to erased, and the number of write() calls since
+void hostFlashErase();
+unsigned long hostFlashWrites();
+
+#endif // HOST_DUE_FLASH_STORAGE_H
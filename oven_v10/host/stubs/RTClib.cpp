@@ -0,0 +1,101 @@
+#include "RTClib.h"
+
+const uint32_t SECONDS_PER_DAY = 86400UL;
+
+static bool isLeap(uint16_t y) {
+  return (y % 4 == 0 && y % 100 != 0) || y % 400 == 0;
+}
+
+static uint8_t daysInMonth(uint16_t y, uint8_t m) {
+  static const uint8_t DAYS[12] = {31, 28, 31, 30, 31, 30, 31, 31, 30, 31, 30, 31};
+  return (m == 2 && isLeap(y)) ? 29 : DAYS[m - 1];
+}
+
+DateTime::DateTime(uint32_t t) {
+  ss = t % 60; t /= 60;
+  mm = t % 60; t /= 60;
+  hh = t % 24;
+  uint32_t days = t / 24;
+  y = 1970;
+  while (true) {
+    uint16_t yearDays = isLeap(y) ? 366 : 365;
+    if (days < yearDays) break;
+    days -= yearDays;
+    y++;
+  }
+  m = 1;
+  while (days >= daysInMonth(y, m)) {
+    days -= daysInMonth(y, m);
+    m++;
+  }
+  d = (uint8_t)(days + 1);
+}
+
+DateTime::DateTime(uint16_t year, uint8_t month, uint8_t day, uint8_t hour, uint8_t min, uint8_t sec)
+  : y(year), m(month), d(day), hh(hour), mm(min), ss(sec) {
+  if (y < 100) y += 2000;
+}
+
+DateTime::DateTime(const char* date, const char* time) {
+  static const char MONTHS[] = "JanFebMarAprMayJunJulAugSepOctNovDec";
+  m = 1;
+  for (uint8_t i = 0; i < 12; i++) {
+    if (strncmp(date, MONTHS + 3 * i, 3) == 0) { m = i + 1; break; }
+  }
+  d = (uint8_t)atoi(date + 4);
+  y = (uint16_t)atoi(date + 7);
+  hh = (uint8_t)atoi(time);
+  mm = (uint8_t)atoi(time + 3);
+  ss = (uint8_t)atoi(time + 6);
+}
+
+uint32_t DateTime::unixtime() const {
+  uint32_t days = 0;
+  for (uint16_t year = 1970; year < y; year++) days += isLeap(year) ? 366 : 365;
+  for (uint8_t month = 1; month < m; month++) days += daysInMonth(y, month);
+  days += d - 1;
+  return days * SECONDS_PER_DAY + hh * 3600UL + mm * 60UL + ss;
+}
+
+uint8_t DateTime::dayOfTheWeek() const {
+  return (uint8_t)((unixtime() / SECONDS_PER_DAY + 4) % 7); // 1970-01-01 was a Thursday
+}
+
+String DateTime::timestamp(timestampOpt opt) const {
+  // Valid dates need 20 bytes; sized for any field values so the
+  // formats can never truncate (-Wformat-truncation)
+  char buf[32];
+  switch (opt) {
+    case TIMESTAMP_TIME: snprintf(buf, sizeof(buf), "%02u:%02u:%02u", hh, mm, ss); break;
+    case TIMESTAMP_DATE: snprintf(buf, sizeof(buf), "%u-%02u-%02u", y, m, d); break;
+    default: snprintf(buf, sizeof(buf), "%u-%02u-%02uT%02u:%02u:%02u", y, m, d, hh, mm, ss); break;
+  }
+  return String(buf);
+}
+
+// --- DS3231: 'base' at virtual time 'baseUs' ---
+static thread_local uint32_t rtcBase = 1767225600UL; // 2026-01-01
+static thread_local uint64_t rtcBaseUs = 0;
+static thread_local bool rtcLostPower = false;
+
+void hostSetRtc(uint32_t unixTime) {
+  rtcBase = unixTime;
+  rtcBaseUs = hostMicros();
+}
+
+void hostSetRtcLostPower(bool lost) {
+  rtcLostPower = lost;
+}
+
+bool RTC_DS3231::lostPower() {
+  return rtcLostPower;
+}
+
+void RTC_DS3231::adjust(const DateTime &dt) {
+  hostSetRtc(dt.unixtime());
+  rtcLostPower = false;
+}
+
+DateTime RTC_DS3231::now() {
+  return DateTime(rtcBase + (uint32_t)((hostMicros() - rtcBaseUs) / 1000000ULL));
+}
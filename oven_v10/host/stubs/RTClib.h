@@ -0,0 +1,67 @@
+#ifndef HOST_RTCLIB_H
+#define HOST_RTCLIB_H
+
+#include <Arduino.h>
+
+// =================================================================
+// RTClib (DateTime, TimeSpan, RTC_DS3231)
+// =================================================================
+// Calendar math as in RTClib: seconds since 1970 without time zones.
+// The DS3231 keeps counting with the thread's virtual clock.
+
+class TimeSpan {
+  public:
+    TimeSpan(int32_t seconds = 0) : secs(seconds) {}
+    TimeSpan(int16_t days, int8_t hours, int8_t minutes, int8_t seconds)
+      : secs((int32_t)days * 86400L + (int32_t)hours * 3600 + (int32_t)minutes * 60 + seconds) {}
+    int32_t totalseconds() const { return secs; }
+
+  private:
+    int32_t secs;
+};
+
+class DateTime {
+  public:
+    DateTime(uint32_t t = 0);
+    DateTime(uint16_t year, uint8_t month, uint8_t day, uint8_t hour = 0, uint8_t min = 0, uint8_t sec = 0);
+    // Compiler __DATE__ ("Oct 19 2026") and __TIME__ ("12:34:56")
+    DateTime(const char* date, const char* time);
+
+    uint16_t year() const { return y; }
+    uint8_t month() const { return m; }
+    uint8_t day() const { return d; }
+    uint8_t hour() const { return hh; }
+    uint8_t minute() const { return mm; }
+    uint8_t second() const { return ss; }
+    uint8_t dayOfTheWeek() const;
+    uint32_t unixtime() const;
+
+    enum timestampOpt { TIMESTAMP_FULL, TIMESTAMP_TIME, TIMESTAMP_DATE };
+    String timestamp(timestampOpt opt = TIMESTAMP_FULL) const;
+
+    DateTime operator+(const TimeSpan &span) const { return DateTime(unixtime() + span.totalseconds()); }
+    DateTime operator-(const TimeSpan &span) const { return DateTime(unixtime() - span.totalseconds()); }
+
+  private:
+    uint16_t y;
+    uint8_t m, d, hh, mm, ss;
+};
+
+enum Ds3231SqwPinMode { DS3231_OFF = 0x1C, DS3231_SquareWave1Hz = 0x00 };
+
+class RTC_DS3231 {
+  public:
+    bool begin() { return true; }
+    bool lostPower();
+    // Sets the time and clears the oscillator-stop (lost power) flag
+    void adjust(const DateTime &dt);
+    DateTime now();
+    void writeSqwPinMode(Ds3231SqwPinMode) {}
+};
+
+// The RTC reads 'unixTime' now and counts on from there
+void hostSetRtc(uint32_t unixTime);
+// Oscillator-stop flag, as after the backup battery ran flat
+void hostSetRtcLostPower(bool lost);
+
+#endif // HOST_RTCLIB_H
@@ -0,0 +1,192 @@
+#include "SD.h"
+#include <map>
+#include <algorithm>
+
+struct HostSdFile {
+  std::string path;
+  std::string name;
+  bool directory;
+  std::string data;
+};
+
+struct HostSdCard {
+  bool present;
+  uint32_t capacity;
+  std::map<std::string, std::shared_ptr<HostSdFile> > files;
+  HostSdCard() : present(true), capacity(0) {}
+};
+
+static thread_local HostSdCard card;
+
+SDClass SD;
+
+static std::string normalize(const char* path) {
+  std::string p = path ? path : "";
+  if (p.empty() || p[0] != '/') p = "/" + p;
+  while (p.size() > 1 && p[p.size() - 1] == '/') p.erase(p.size() - 1);
+  std::transform(p.begin(), p.end(), p.begin(), ::toupper); // FAT names
+  return p;
+}
+
+static std::string parentOf(const std::string &path) {
+  size_t slash = path.rfind('/');
+  return slash == 0 ? "/" : path.substr(0, slash);
+}
+
+static uint32_t usedBytes() {
+  uint32_t used = 0;
+  for (auto &f : card.files) used += f.second->data.size();
+  return used;
+}
+
+static std::shared_ptr<HostSdFile> makeNode(const std::string &path, bool directory) {
+  std::shared_ptr<HostSdFile> f = std::make_shared<HostSdFile>();
+  f->path = path;
+  f->name = path == "/" ? "/" : path.substr(path.rfind('/') + 1);
+  f->directory = directory;
+  card.files[path] = f;
+  return f;
+}
+
+// --- File ---
+
+File::File(std::shared_ptr<HostSdFile> f) : file(f), pos(0) {}
+
+size_t File::write(uint8_t c) {
+  return write(&c, 1);
+}
+
+size_t File::write(const uint8_t* buf, size_t size) {
+  if (!file || file->directory) return 0;
+  if (card.capacity != 0) {
+    uint32_t used = usedBytes();
+    if (used >= card.capacity) return 0;
+    if (used + size > card.capacity) size = card.capacity - used;
+  }
+  // Writes always append (FILE_WRITE positions at EOF)
+  file->data.append((const char*)buf, size);
+  pos = file->data.size();
+  return size;
+}
+
+int File::available() {
+  return (file && !file->directory) ? (int)(file->data.size() - pos) : 0;
+}
+
+int File::read() {
+  if (available() <= 0) return -1;
+  return (uint8_t)file->data[pos++];
+}
+
+int File::peek() {
+  if (available() <= 0) return -1;
+  return (uint8_t)file->data[pos];
+}
+
+int File::read(void* buf, uint16_t nbyte) {
+  if (!file || file->directory) return -1;
+  uint32_t n = std::min<uint32_t>(nbyte, file->data.size() - pos);
+  memcpy(buf, file->data.data() + pos, n);
+  pos += n;
+  return (int)n;
+}
+
+bool File::seek(uint32_t p) {
+  if (!file || p > file->data.size()) return false;
+  pos = p;
+  return true;
+}
+
+uint32_t File::size() const {
+  return file ? (uint32_t)file->data.size() : 0;
+}
+
+const char* File::name() const {
+  return file ? file->name.c_str() : "";
+}
+
+bool File::isDirectory() const {
+  return file && file->directory;
+}
+
+File File::openNextFile(uint8_t) {
+  if (!file || !file->directory) return File();
+  std::string prefix = file->path == "/" ? "/" : file->path + "/";
+  // pos counts the children already returned
+  uint32_t index = 0;
+  for (auto &f : card.files) {
+    const std::string &p = f.first;
+    if (p.size() <= prefix.size() || p.compare(0, prefix.size(), prefix) != 0) continue;
+    if (p.find('/', prefix.size()) != std::string::npos) continue;
+    if (index++ == pos) {
+      pos++;
+      return File(f.second);
+    }
+  }
+  return File();
+}
+
+// --- SDClass ---
+
+bool SDClass::begin(uint8_t) {
+  if (!card.present) return false;
+  if (card.files.find("/") == card.files.end()) makeNode("/", true);
+  return true;
+}
+
+File SDClass::open(const char* path, uint8_t mode) {
+  std::string p = normalize(path);
+  auto it = card.files.find(p);
+  if (it != card.files.end()) {
+    File f(it->second);
+    if (mode == FILE_WRITE) f.seek(f.size());
+    return f;
+  }
+  if (mode != FILE_WRITE) return File();
+  auto parent = card.files.find(parentOf(p));
+  if (parent == card.files.end() || !parent->second->directory) return File();
+  return File(makeNode(p, false));
+}
+
+bool SDClass::exists(const char* path) {
+  return card.files.count(normalize(path)) != 0;
+}
+
+bool SDClass::mkdir(const char* path) {
+  std::string p = normalize(path);
+  if (card.files.count(p)) return card.files[p]->directory;
+  makeNode(p, true);
+  return true;
+}
+
+bool SDClass::remove(const char* path) {
+  auto it = card.files.find(normalize(path));
+  if (it == card.files.end() || it->second->directory) return false;
+  card.files.erase(it);
+  return true;
+}
+
+// --- Host controls ---
+
+void hostSdReset(bool present) {
+  card = HostSdCard();
+  card.present = present;
+}
+
+void hostSdSetCapacity(uint32_t bytes) {
+  card.capacity = bytes;
+}
+
+std::string hostSdRead(const char* path) {
+  auto it = card.files.find(normalize(path));
+  return it == card.files.end() ? std::string() : it->second->data;
+}
+
+void hostSdWrite(const char* path, const std::string &content) {
+  std::string p = normalize(path);
+  std::string parent = parentOf(p);
+  if (!card.files.count(parent)) makeNode(parent, true);
+  if (!card.files.count("/")) makeNode("/", true);
+  std::shared_ptr<HostSdFile> f = card.files.count(p) ? card.files[p] : makeNode(p, false);
+  f->data = content;
+}
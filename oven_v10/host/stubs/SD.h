@@ -0,0 +1,68 @@
+#ifndef HOST_SD_H
+#define HOST_SD_H
+
+#include <Arduino.h>
+#include <memory>
+#include <vector>
+
+// =================================================================
+// SD LIBRARY (in-memory card)
+// =================================================================
+// A per-thread card with flat directories. FILE_WRITE opens for
+// append, like the Arduino SD library. Directory listings come back
+// sorted by name so tests are deterministic.
+
+#define FILE_READ  0x01
+#define FILE_WRITE 0x13
+
+struct HostSdFile;
+
+class File : public Stream {
+  public:
+    File() : pos(0) {}
+    explicit File(std::shared_ptr<HostSdFile> f);
+
+    size_t write(uint8_t c) override;
+    size_t write(const uint8_t* buf, size_t size) override;
+    using Print::write;
+    int available() override;
+    int read() override;
+    int peek() override;
+    int read(void* buf, uint16_t nbyte);
+    void flush() override {}
+
+    bool seek(uint32_t p);
+    uint32_t position() const { return pos; }
+    uint32_t size() const;
+    void close() { file.reset(); }
+    operator bool() const { return (bool)file; }
+    const char* name() const;
+    bool isDirectory() const;
+    File openNextFile(uint8_t mode = FILE_READ);
+    void rewindDirectory() { pos = 0; }
+
+  private:
+    std::shared_ptr<HostSdFile> file;
+    uint32_t pos;
+};
+
+class SDClass {
+  public:
+    bool begin(uint8_t csPin = 0);
+    File open(const char* path, uint8_t mode = FILE_READ);
+    bool exists(const char* path);
+    bool mkdir(const char* path);
+    bool remove(const char* path);
+};
+
+extern SDClass SD;
+
+// Empty card; begin() fails while 'present' is false
+void hostSdReset(bool present = true);
+// Total bytes the card accepts before writes start failing (0 = no limit)
+void hostSdSetCapacity(uint32_t bytes);
+// Whole content of a file ("" if missing); lets tests put files in place
+std::string hostSdRead(const char* path);
+void hostSdWrite(const char* path, const std::string &content);
+
+#endif // HOST_SD_H
@@ -0,0 +1,13 @@
+#ifndef HOST_SPI_H
+#define HOST_SPI_H
+
+#include <Arduino.h>
+
+class SPIClass {
+  public:
+    void begin() {}
+};
+
+extern SPIClass SPI;
+
+#endif // HOST_SPI_H
@@ -0,0 +1,13 @@
+#ifndef HOST_WIRE_H
+#define HOST_WIRE_H
+
+#include <Arduino.h>
+
+class TwoWire {
+  public:
+    void begin() {}
+};
+
+extern TwoWire Wire;
+
+#endif // HOST_WIRE_H
@@ -0,0 +1,74 @@
+#include "max6675.h"
+#include "DueFlashStorage.h"
+#include "SPI.h"
+#include "Wire.h"
+
+SPIClass SPI;
+TwoWire Wire;
+
+// =================================================================
+// THERMOCOUPLES
+// =================================================================
+
+const int HOST_CS_PINS = 128;
+static thread_local float thermocouple[HOST_CS_PINS];
+static thread_local bool thermocoupleSet[HOST_CS_PINS];
+
+void hostSetThermocouple(int csPin, float celsius) {
+  if (csPin < 0 || csPin >= HOST_CS_PINS) return;
+  thermocouple[csPin] = celsius;
+  thermocoupleSet[csPin] = true;
+}
+
+float hostThermocouple(int csPin) {
+  if (csPin < 0 || csPin >= HOST_CS_PINS || !thermocoupleSet[csPin]) return 25.0f;
+  return thermocouple[csPin];
+}
+
+float MAX6675::readCelsius() {
+  return hostThermocouple(csPin);
+}
+
+// =================================================================
+// FLASH
+// =================================================================
+
+static thread_local byte flash[HOST_FLASH_SIZE];
+static thread_local bool flashInitialized = false;
+static thread_local unsigned long flashWrites = 0;
+
+static byte* flashData() {
+  if (!flashInitialized) {
+    memset(flash, 0xFF, sizeof(flash));
+    flashInitialized = true;
+  }
+  return flash;
+}
+
+void hostFlashErase() {
+  flashInitialized = false;
+  flashWrites = 0;
+}
+
+unsigned long hostFlashWrites() {
+  return flashWrites;
+}
+
+byte DueFlashStorage::read(uint32_t address) {
+  return address < HOST_FLASH_SIZE ? flashData()[address] : 0xFF;
+}
+
+byte* DueFlashStorage::readAddress(uint32_t address) {
+  return flashData() + (address < HOST_FLASH_SIZE ? address : 0);
+}
+
+bool DueFlashStorage::write(uint32_t address, byte value) {
+  return write(address, &value, 1);
+}
+
+bool DueFlashStorage::write(uint32_t address, byte* data, uint32_t dataLength) {
+  if (address + dataLength > HOST_FLASH_SIZE) return false;
+  memcpy(flashData() + address, data, dataLength);
+  flashWrites++;
+  return true;
+}
@@ -0,0 +1,21 @@
+#ifndef HOST_MAX6675_H
+#define HOST_MAX6675_H
+
+#include <Arduino.h>
+
+// Reads the temperature a test has set for the chip select pin
+class MAX6675 {
+  public:
+    MAX6675(int8_t sclk, int8_t cs, int8_t miso) : csPin(cs) { (void)sclk; (void)miso; }
+    float readCelsius();
+    float readFahrenheit() { return readCelsius() * 9.0f / 5.0f + 32.0f; }
+
+  private:
+    int8_t csPin;
+};
+
+// Temperature returned for a chip select pin (NAN = open thermocouple)
+void hostSetThermocouple(int csPin, float celsius);
+float hostThermocouple(int csPin);
+
+#endif // HOST_MAX6675_H
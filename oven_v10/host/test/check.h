@@ -0,0 +1,55 @@
+#ifndef HOST_TEST_CHECK_H
+#define HOST_TEST_CHECK_H
+
+// =================================================================
+// HOST TEST HELPERS
+// =================================================================
+// Each test is a plain executable: CHECK* report and count failures,
+// main() ends with 'return checkResult("name");' (non-zero on failure).
+
+#include <stdio.h>
+#include <math.h>
+#include <string>
+#include <vector>
+
+static int checkFailures = 0;
+
+#define CHECK(cond) do { \
+    if (!(cond)) { \
+      fprintf(stderr, "%s:%d: CHECK(%s) failed\n", __FILE__, __LINE__, #cond); \
+      checkFailures++; \
+    } \
+  } while (0)
+
+#define CHECK_NEAR(actual, expected, tol) do { \
+    double a_ = (double)(actual), e_ = (double)(expected); \
+    if (!(fabs(a_ - e_) <= (tol))) { \
+      fprintf(stderr, "%s:%d: %s = %.17g, expected %.17g (tol %g)\n", \
+              __FILE__, __LINE__, #actual, a_, e_, (double)(tol)); \
+      checkFailures++; \
+    } \
+  } while (0)
+
+static inline int checkResult(const char* name) {
+  if (checkFailures > 0) {
+    fprintf(stderr, "%s: %d check(s) failed\n", name, checkFailures);
+    return 1;
+  }
+  printf("%s: ok\n", name);
+  return 0;
+}
+
+// Split one CSV line (no quoting in the traces)
+static inline std::vector<std::string> splitCsv(const std::string &line) {
+  std::vector<std::string> fields;
+  size_t start = 0;
+  while (true) {
+    size_t comma = line.find(',', start);
+    fields.push_back(line.substr(start, comma == std::string::npos ? std::string::npos : comma - start));
+    if (comma == std::string::npos) break;
+    start = comma + 1;
+  }
+  return fields;
+}
+
+#endif // HOST_TEST_CHECK_H
@@ -0,0 +1,114 @@
+// =================================================================
+// AUTOTUNE AGAINST A KNOWN PLANT
+// =================================================================
+// The sketch relay-tunes one zone on a FOPDT plant. For
+// G(s) = K e^(-theta s) / (tau s + 1) the ultimate point is where the
+// phase reaches -180 degrees,
+//
+//   theta wu + atan(tau wu) = pi,  Pu = 2 pi / wu,  Ku = sqrt(1 + (tau wu)^2) / K
+//
+// (Ku per unit of duty; the firmware's output is ms of PID_WINDOW_SIZE).
+// The controller sees a temperature every statusUpdateInterval, which
+// adds about half of it to theta for the loop as a whole.
+//
+// The relay test only approximates that point. On a lag-dominant plant
+// the input is a triangle, not a sine: the describing function reads
+// its peak for the fundamental's amplitude (8 / pi^2 of it) and Ku
+// comes out ~20% low. The hysteresis switches late, which lengthens Pu
+// and lowers Ku a little more. Both err on the soft side, so Ku must
+// not read high.
+
+#include "../../oven_v10.ino"
+#include "autotune.h"
+#include "check.h"
+#include "thermal_plant.h"
+#include <SD.h>
+#include <max6675.h>
+#include <stdlib.h>
+#include <string>
+
+const double KU_TOLERANCE = 0.30; // Relative, below only
+const double PU_TOLERANCE = 0.15;
+
+static double ultimateFrequency(double tau, double theta) {
+  // theta w + atan(tau w) rises monotonically from 0: bisect for pi
+  double lo = 0, hi = M_PI / theta;
+  for (int i = 0; i < 100; i++) {
+    double w = (lo + hi) / 2;
+    if (theta * w + atan(tau * w) < M_PI) lo = w;
+    else hi = w;
+  }
+  return (lo + hi) / 2;
+}
+
+static double jsonNumber(const std::string &text, const char* key) {
+  size_t at = text.find(std::string("\"") + key + "\":");
+  if (at == std::string::npos) return NAN;
+  return strtod(text.c_str() + at + strlen(key) + 3, NULL);
+}
+
+static void checkTune(const PlantParams &params, double setpoint) {
+  const uint8_t zone = 0;
+  ThermalPlant plant(params, 0.02);
+
+  hostResetClock();
+  hostFlashErase();
+  hostSdReset();
+  for (uint8_t z = 0; z < ZONE_COUNT; z++) hostSetThermocouple(ZONE_TABLE[z].csPin, (float)params.ambient);
+  setup();
+  SerialUSB.hostCapture(true);
+  // SSR output: the heater is on exactly while the relay test asks for it
+  SerialUSB.hostFeed((std::string("{\"cmd\":\"SET_OUTPUT_MODE\",\"target\":\"") + ZONE_TABLE[zone].name
+                      + "\",\"mode\":\"window\"}\n").c_str());
+  SerialUSB.hostFeed((std::string("{\"cmd\":\"AUTOTUNE\",\"target\":\"") + ZONE_TABLE[zone].name
+                      + "\",\"setpoint\":" + std::to_string(setpoint) + ",\"rule\":\"zn\"}\n").c_str());
+  for (int i = 0; i < 10 && !isAutotuneRunning(oven); i++) {
+    loop();
+    hostAdvanceMillis(20);
+  }
+  CHECK(isAutotuneRunning(oven));
+
+  unsigned long simulated = millis();
+  while (isAutotuneRunning(oven) && millis() < 3 * 3600000UL) {
+    for (; simulated + 20 <= millis(); simulated += 20) plant.step(oven.heaterPinState[zone] ? 1.0 : 0.0);
+    hostSetThermocouple(ZONE_TABLE[zone].csPin, (float)plant.temp());
+    loop();
+    hostAdvanceMillis(20);
+  }
+  CHECK(!isAutotuneRunning(oven));
+
+  std::string out = SerialUSB.hostTakeOutput();
+  size_t report = out.find("\"autotune\"");
+  CHECK(report != std::string::npos);
+  if (report == std::string::npos) return;
+  double ku = jsonNumber(out.substr(report), "ku");
+  double pu = jsonNumber(out.substr(report), "pu");
+
+  double wu = ultimateFrequency(params.tau, params.deadTime + statusUpdateInterval / 2000.0);
+  double expectedPu = 2 * M_PI / wu;
+  double expectedKu = sqrt(1 + params.tau * wu * params.tau * wu) / params.gain * PID_WINDOW_SIZE;
+  printf("tau %.0f dead %.0f: ku %.2f (expected %.2f), pu %.1f s (expected %.1f s)\n",
+         params.tau, params.deadTime, ku, expectedKu, pu, expectedPu);
+  CHECK(ku <= expectedKu);
+  CHECK(ku >= (1 - KU_TOLERANCE) * expectedKu);
+  CHECK_NEAR(pu, expectedPu, PU_TOLERANCE * expectedPu);
+  // ZN PID: Kp = 0.6 Ku
+  CHECK_NEAR(jsonNumber(out.substr(report), "kp"), 0.6 * ku, 1e-3 * ku);
+}
+
+int main() {
+  // Relay centred on the plant's range (ambient + gain / 2), so the
+  // heating and cooling half-cycles are symmetric
+  PlantParams slow;
+  slow.gain = 400;
+  slow.tau = 600;
+  slow.deadTime = 20;
+  checkTune(slow, 225);
+
+  PlantParams fast;
+  fast.gain = 300;
+  fast.tau = 240;
+  fast.deadTime = 15;
+  checkTune(fast, 175);
+  return checkResult("test_autotune_fopdt");
+}
@@ -0,0 +1,42 @@
+// =================================================================
+// AUTOTUNE HANDS BACK THE ZONE MODE
+// =================================================================
+// A tune switches the zone's PID to MANUAL and drives the relay
+// itself. Afterwards the zone returns to its configured mode: a
+// bang-bang or manual zone keeps its PID in MANUAL, a PID zone is
+// AUTOMATIC again.
+
+#include <Arduino.h>
+#include <DueFlashStorage.h>
+#include <memory>
+#include "check.h"
+#include "config.h"
+#include "autotune.h"
+#include "oven_logic.h"
+#include "zone_mode.h"
+
+static void checkRestored(ZoneMode mode, int expectedPidMode) {
+  hostResetClock();
+  hostFlashErase();
+  std::unique_ptr<OvenController> oven(new OvenController());
+  initializeLogic(*oven);
+  setZoneMode(*oven, 1, mode);
+
+  const char* msg = NULL;
+  CHECK(startAutotune(*oven, SerialUSB, 1, 150, AUTOTUNE_RULE_ZN_PID, false, msg));
+  CHECK(oven->zonePid[1].GetMode() == QuickPID::MANUAL);
+  abortAutotune(*oven, "test");
+
+  CHECK(!isAutotuneRunning(*oven));
+  CHECK(oven->settings.zoneControl[1].mode == mode);
+  CHECK(oven->zonePid[1].GetMode() == expectedPidMode);
+  CHECK_NEAR((double)oven->zones.output[1], 0.0, 0);
+  CHECK(!oven->zoneModes.bangOn[1]);
+}
+
+int main() {
+  checkRestored(ZONE_MODE_PID, QuickPID::AUTOMATIC);
+  checkRestored(ZONE_MODE_BANG_BANG, QuickPID::MANUAL);
+  checkRestored(ZONE_MODE_MANUAL, QuickPID::MANUAL);
+  return checkResult("test_autotune_zone_mode");
+}
@@ -0,0 +1,53 @@
+// =================================================================
+// CHECKPOINT RESUME
+// =================================================================
+// A bake checkpoint is resumed only when the outage can be measured:
+// not after the RTC lost power, and not when the clock reads earlier
+// than the checkpoint.
+
+#include <Arduino.h>
+#include <DueFlashStorage.h>
+#include <memory>
+#include "check.h"
+#include "config.h"
+#include "checkpoint.h"
+#include "drivers.h"
+#include "wallclock.h"
+
+const uint32_t CHECKPOINT_TIME = 1792411200UL; // 2026-10-19 12:00:00
+
+static void writeRunningCheckpoint() {
+  BakeCheckpoint c;
+  c.magic = 0x42414B45UL; // "BAKE"
+  c.sequence = 5;
+  c.unixTime = CHECKPOINT_TIME;
+  c.state = RUNNING;
+  c.elapsedMs = 120000;
+  c.check = c.magic ^ c.sequence ^ c.unixTime ^ c.state ^ c.elapsedMs;
+  dueFlashStorage.write(CHECKPOINT_FLASH_OFFSET, (byte*)&c, sizeof(c));
+}
+
+// Boot with the RTC at 'rtcNow' (lost power: reset to the build date)
+static bool bootAndResume(uint32_t rtcNow, bool lostPower) {
+  hostResetClock();
+  hostFlashErase();
+  hostSetRtc(rtcNow);
+  hostSetRtcLostPower(lostPower);
+  rtcLostPowerAtBoot = false;
+  setHardcodedTime();
+  initializeWallClock();
+
+  std::unique_ptr<OvenController> oven(new OvenController());
+  loadSettings(*oven);
+  writeRunningCheckpoint();
+  return resumeFromCheckpoint(*oven);
+}
+
+int main() {
+  CHECK(bootAndResume(CHECKPOINT_TIME + 60, false));
+  CHECK(!bootAndResume(CHECKPOINT_TIME + 60, true));
+  CHECK(rtcLostPowerAtBoot);
+  CHECK(!bootAndResume(CHECKPOINT_TIME - 3600, false));
+  CHECK(!bootAndResume(CHECKPOINT_TIME + 3600, false)); // Outage too long
+  return checkResult("test_checkpoint_resume");
+}
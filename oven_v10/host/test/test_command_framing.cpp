@@ -0,0 +1,82 @@
+// =================================================================
+// COMMAND FRAMING
+// =================================================================
+// A command line holds up to 511 characters plus its newline. Longer
+// frames are rejected and dropped up to their newline, even when the
+// rest only arrives over later reads, and each port keeps its own
+// framing so a long frame on one never eats a command on the other.
+
+#include <Arduino.h>
+#include <DueFlashStorage.h>
+#include <memory>
+#include <string>
+#include "check.h"
+#include "config.h"
+#include "app.h"
+#include "oven_logic.h"
+
+// GET_POWER padded with spaces to 'length' characters (still valid JSON)
+static std::string paddedFrame(size_t length) {
+  std::string s = "{\"cmd\":\"GET_POWER\"}";
+  s.insert(1, length - s.size(), ' ');
+  return s;
+}
+
+// Process everything queued, one frame per call as loop() would
+static std::string drain(OvenController &oven, HardwareSerial &port) {
+  for (int i = 0; i < 100 && port.available() > 0; i++) processIncomingStream(oven, port);
+  return port.hostTakeOutput();
+}
+
+static bool answered(const std::string &out) {
+  return out.find("{\"power\":") != std::string::npos;
+}
+
+static bool rejected(const std::string &out) {
+  return out.find("Command too long") != std::string::npos;
+}
+
+int main() {
+  hostResetClock();
+  hostFlashErase();
+  std::unique_ptr<OvenController> oven(new OvenController());
+  initializeLogic(*oven);
+  SerialUSB.hostCapture(true);
+  Serial1.hostCapture(true);
+
+  // 511 characters + newline fill the buffer exactly: accepted
+  SerialUSB.hostFeed((paddedFrame(511) + "\n").c_str());
+  std::string out = drain(*oven, SerialUSB);
+  CHECK(answered(out));
+  CHECK(!rejected(out));
+
+  // 512 characters: rejected, and the next frame still works
+  SerialUSB.hostFeed((paddedFrame(512) + "\n" + paddedFrame(20) + "\n").c_str());
+  out = drain(*oven, SerialUSB);
+  CHECK(rejected(out));
+  CHECK(answered(out));
+
+  // Oversized frame whose tail arrives later: the tail is dropped,
+  // not parsed as a frame of its own
+  std::string big = paddedFrame(1500);
+  SerialUSB.hostFeed(big.substr(0, 700).c_str());
+  out = drain(*oven, SerialUSB);
+  CHECK(rejected(out));
+  SerialUSB.hostFeed(big.substr(700, 400).c_str());
+  out = drain(*oven, SerialUSB);
+  CHECK(out.empty());
+  SerialUSB.hostFeed((big.substr(1100) + "\n" + paddedFrame(20) + "\n").c_str());
+  out = drain(*oven, SerialUSB);
+  CHECK(!rejected(out));
+  CHECK(answered(out));
+
+  // USB dropping an oversized frame does not affect RS485
+  SerialUSB.hostFeed(big.substr(0, 600).c_str());
+  CHECK(rejected(drain(*oven, SerialUSB)));
+  Serial1.hostFeed((paddedFrame(20) + "\n").c_str());
+  CHECK(answered(drain(*oven, Serial1)));
+  SerialUSB.hostFeed((big.substr(600) + "\n" + paddedFrame(20) + "\n").c_str());
+  CHECK(answered(drain(*oven, SerialUSB)));
+
+  return checkResult("test_command_framing");
+}
@@ -0,0 +1,223 @@
+// =================================================================
+// GOLDEN TRACES
+// =================================================================
+// Replays golden/*.csv (recorded from the baseline controller by
+// tools/record_golden) against BasicQuickPID<double> and the power
+// budget's TPC windows: every Compute() result, output and relay
+// state must match.
+//
+// Deliberate changes from the baseline are not in the traces; they
+// are pinned at the end of this file instead:
+//  - Compute() integrates over the interval actually measured, so a
+//    late compute (loop stall) gets a proportionally larger I step.
+//  - SetMode(AUTOMATIC) computes at once, not up to one sample later.
+//  - On-time below the minimum actuation time is carried into the
+//    next window instead of being dropped.
+
+#include <Arduino.h>
+#include <fstream>
+#include <memory>
+#include "check.h"
+#include "config.h"
+#include "power_budget.h"
+#include "../tools/baseline_reference.h"
+
+// Only its power budget state is used here
+static OvenController oven;
+
+// Outputs must match to the last few bits of a double
+static bool sameDouble(double a, double b) {
+  return fabs(a - b) <= 1e-9 * (fabs(b) > 1.0 ? fabs(b) : 1.0);
+}
+
+static void advanceTo(unsigned long long tMs) {
+  uint64_t target = tMs * 1000ULL;
+  if (target > hostMicros()) hostAdvanceMicros(target - hostMicros());
+}
+
+static std::vector<std::vector<std::string> > loadTrace(const char* name) {
+  std::string path = std::string(GOLDEN_DIR) + "/" + name;
+  std::ifstream in(path.c_str());
+  std::vector<std::vector<std::string> > rows;
+  std::string line;
+  if (!std::getline(in, line)) {
+    fprintf(stderr, "Missing trace %s\n", path.c_str());
+    checkFailures++;
+    return rows;
+  }
+  while (std::getline(in, line)) {
+    if (!line.empty()) rows.push_back(splitCsv(line));
+  }
+  return rows;
+}
+
+// t_ms,input,setpoint,op,a,b,c,ret,output
+static void replayPid(const char* name) {
+  std::vector<std::vector<std::string> > rows = loadTrace(name);
+  CHECK(rows.size() > 100);
+
+  hostResetClock();
+  double input = 0, output = 0, setpoint = 0;
+  std::unique_ptr<BasicQuickPID<double> > pid;
+  int mismatches = 0;
+
+  for (size_t i = 0; i < rows.size(); i++) {
+    const std::vector<std::string> &r = rows[i];
+    if (r.size() != 9) { checkFailures++; break; }
+    advanceTo(strtoull(r[0].c_str(), NULL, 10));
+    input = atof(r[1].c_str());
+    setpoint = atof(r[2].c_str());
+    const std::string &op = r[3];
+    double a = atof(r[4].c_str()), b = atof(r[5].c_str()), c = atof(r[6].c_str());
+    int expectedRet = atoi(r[7].c_str());
+    double expectedOutput = atof(r[8].c_str());
+    int ret = 0;
+
+    if (op == "wrap") hostWrapClockIn((uint64_t)a);
+    else if (op == "new") pid.reset(new BasicQuickPID<double>(&input, &output, &setpoint, a, b, c, BasicQuickPID<double>::DIRECT));
+    else if (op == "force") output = a;
+    else if (!pid) { checkFailures++; break; }
+    else if (op == "mode") pid->SetMode((int)a);
+    else if (op == "limits") pid->SetOutputLimits(a, b);
+    else if (op == "tunings") pid->SetTunings(a, b, c);
+    else if (op == "pon") pid->SetPOn((int)a);
+    else if (op == "compute") ret = pid->Compute() ? 1 : 0;
+    else { fprintf(stderr, "%s: unknown op %s\n", name, op.c_str()); checkFailures++; break; }
+
+    if (ret != expectedRet || !sameDouble(output, expectedOutput)) {
+      if (mismatches++ < 5) {
+        fprintf(stderr, "%s row %zu (t=%s %s): ret %d output %.17g, expected %d %.17g\n",
+                name, i + 2, r[0].c_str(), op.c_str(), ret, output, expectedRet, expectedOutput);
+      }
+    }
+  }
+  CHECK(mismatches == 0);
+}
+
+// t_ms,op,output,min_on,relay
+static void replayTpc(const char* name) {
+  std::vector<std::vector<std::string> > rows = loadTrace(name);
+  CHECK(rows.size() > 100);
+
+  hostResetClock();
+  unsigned long request[ZONE_COUNT] = {0};
+  unsigned long minOn[ZONE_COUNT] = {0};
+  bool relayOn[ZONE_COUNT];
+  int mismatches = 0;
+
+  for (size_t i = 0; i < rows.size(); i++) {
+    const std::vector<std::string> &r = rows[i];
+    if (r.size() != 5) { checkFailures++; break; }
+    advanceTo(strtoull(r[0].c_str(), NULL, 10));
+    const std::string &op = r[1];
+    double value = atof(r[2].c_str());
+
+    if (op == "wrap") { hostWrapClockIn((uint64_t)value); continue; }
+    if (op == "init") { initializePowerBudget(oven); continue; }
+
+    request[0] = (unsigned long)value;
+    minOn[0] = strtoul(r[3].c_str(), NULL, 10);
+    updatePowerBudget(oven, request, minOn, relayOn);
+    bool expected = atoi(r[4].c_str()) != 0;
+    if (relayOn[0] != expected) {
+      if (mismatches++ < 5) {
+        fprintf(stderr, "%s row %zu (t=%s): relay %d, expected %d\n", name, i + 2, r[0].c_str(), relayOn[0], expected);
+      }
+    }
+    for (uint8_t z = 1; z < ZONE_COUNT; z++) CHECK(!relayOn[z]);
+  }
+  CHECK(mismatches == 0);
+}
+
+// =================================================================
+// DELIBERATE CHANGES
+// =================================================================
+
+static double refInput, refOutput, refSetpoint;
+
+// After a stall the I step covers the whole interval (baseline: one sample)
+static void checkStallIntegratesMeasuredInterval() {
+  hostResetClock();
+  static baseline::QuickPID ref(&refInput, &refOutput, &refSetpoint, 0.0, 1.0, 0.0, baseline::QuickPID::DIRECT);
+  double input = 100, output = 0, setpoint = 110;
+  BasicQuickPID<double> pid(&input, &output, &setpoint, 0.0, 1.0, 0.0, BasicQuickPID<double>::DIRECT);
+  refInput = input; refSetpoint = setpoint; refOutput = 0;
+  ref.SetMode(baseline::QuickPID::AUTOMATIC);
+  pid.SetMode(BasicQuickPID<double>::AUTOMATIC);
+
+  CHECK(ref.Compute());
+  CHECK(pid.Compute());
+  CHECK(sameDouble(output, refOutput));
+  CHECK_NEAR(output, 1.0, 1e-12); // ki * h * error = 1 * 0.1 * 10
+
+  hostAdvanceMillis(1000); // Ten samples late
+  CHECK(ref.Compute());
+  CHECK(pid.Compute());
+  CHECK_NEAR(refOutput, 2.0, 1e-12);
+  CHECK_NEAR(output, 11.0, 1e-9);
+  CHECK(pid.GetLastDt() == 1000000UL);
+
+  // Capped at PID_MAX_DT_RATIO samples
+  hostAdvanceMillis(60000);
+  CHECK(pid.Compute());
+  CHECK_NEAR(output, 11.0 + 50.0, 1e-9);
+}
+
+// The first compute after MANUAL -> AUTOMATIC is immediate
+static void checkAutomaticComputesAtOnce() {
+  hostResetClock();
+  double input = 50, output = 20, setpoint = 60;
+  BasicQuickPID<double> pid(&input, &output, &setpoint, 1.0, 0.0, 0.0, BasicQuickPID<double>::DIRECT);
+  pid.SetMode(BasicQuickPID<double>::AUTOMATIC);
+  CHECK(pid.Compute());
+  hostAdvanceMillis(30);
+  pid.SetMode(BasicQuickPID<double>::MANUAL);
+  pid.SetMode(BasicQuickPID<double>::AUTOMATIC);
+  CHECK(pid.Compute());
+  CHECK(pid.GetLastDt() == PID_COMPUTE_FREQ * 1000UL);
+}
+
+// Sub-minimum on-time accumulates until it is worth switching
+static void checkSubMinimumCarry() {
+  hostResetClock();
+  initializePowerBudget(oven);
+  unsigned long request[ZONE_COUNT] = {0};
+  unsigned long minOn[ZONE_COUNT] = {0};
+  bool relayOn[ZONE_COUNT];
+  minOn[0] = 500;
+
+  request[0] = 300; // Below the minimum: no switching, carried
+  unsigned long onMs = 0;
+  for (unsigned long t = 0; t < PID_WINDOW_SIZE; t += 50) {
+    updatePowerBudget(oven, request, minOn, relayOn);
+    if (relayOn[0]) onMs += 50;
+    hostAdvanceMillis(50);
+  }
+  CHECK(onMs == 0);
+
+  onMs = 0; // 300 + 300 carried: one 600 ms run (baseline: off again)
+  for (unsigned long t = 0; t < PID_WINDOW_SIZE; t += 50) {
+    updatePowerBudget(oven, request, minOn, relayOn);
+    if (relayOn[0]) onMs += 50;
+    hostAdvanceMillis(50);
+  }
+  CHECK(onMs == 600);
+}
+
+int main() {
+  replayPid("pid_step.csv");
+  replayPid("pid_mode.csv");
+  replayPid("pid_limits.csv");
+  replayPid("pid_pon_m.csv");
+  replayPid("pid_wrap.csv");
+
+  replayTpc("tpc_window.csv");
+  replayTpc("tpc_stall.csv");
+  replayTpc("tpc_min_on.csv");
+  replayTpc("tpc_wrap.csv");
+
+  checkStallIntegratesMeasuredInterval();
+  checkAutomaticComputesAtOnce();
+  checkSubMinimumCarry();
+  return checkResult("test_golden_traces");
+}
@@ -0,0 +1,178 @@
+// =================================================================
+// LOG DOWNLOAD OVER RS485
+// =================================================================
+// The host client (tools/log_client.h) downloads a day log from the
+// firmware over Serial1 with a 128-byte UART buffer drained at the
+// 9600 baud line rate. Chunks must go out from the loop a buffer-full
+// at a time, never through a blocking flush(), and the file must come
+// back intact through a corrupted chunk, a lost chunk, a dropped link
+// and a resumed partial download.
+
+#include <Arduino.h>
+#include <DueFlashStorage.h>
+#include <SD.h>
+#include <memory>
+#include <string>
+#include "check.h"
+#include "config.h"
+#include "app.h"
+#include "drivers.h"
+#include "logger.h"
+#include "wallclock.h"
+#include "../tools/log_client.h"
+
+const char* LOG_NAME = "20261018.CSV";
+const int UART_BUFFER = 127;           // Due TX ring: availableForWrite() when empty
+const unsigned long PASS_MS = 1;       // One loop pass, and ~one byte at 9600 baud
+
+static std::unique_ptr<OvenController> oven;
+static std::string wireIn;             // Bytes from the oven not yet split into lines
+static bool deSeenHigh = false;
+
+static void boot() {
+  hostResetClock();
+  hostFlashErase();
+  hostSdReset();
+  hostSetRtc(1792411200UL); // 2026-10-19 12:00:00
+  initializeWallClock();
+  oven.reset(new OvenController());
+  loadSettings(*oven);
+  initializeLogger(*oven);
+  Serial1.hostClear();
+  Serial1.hostCapture(true);
+  Serial1.hostSetTxFree(UART_BUFFER);
+  wireIn.clear();
+}
+
+static std::string makeLog() {
+  std::string content = std::string(logHeader()) + "\r\n";
+  for (int i = 0; i < 60; i++) {
+    char row[64];
+    snprintf(row, sizeof(row), "2026-10-18,10:%02d:00,PREHEATING,%d,%d\r\n", i, 200 + i, 180 + i);
+    content += row;
+  }
+  return content;
+}
+
+// The loop's share of the download, then a millisecond on the wire
+static void pass() {
+  if (Serial1.available() > 0) processIncomingStream(*oven, Serial1);
+  serviceLogTransfer();
+  serviceTransmitQueue();
+  if (hostPinLevel(RS485_DE_RE_PIN)) deSeenHigh = true;
+  hostAdvanceMillis(PASS_MS);
+  Serial1.hostDrainTx(1);
+  if (Serial1.availableForWrite() > UART_BUFFER) Serial1.hostSetTxFree(UART_BUFFER);
+  wireIn += Serial1.hostTakeOutput();
+}
+
+static bool nextLine(std::string &line) {
+  size_t nl = wireIn.find('\n');
+  if (nl == std::string::npos) return false;
+  line = wireIn.substr(0, nl);
+  if (!line.empty() && line[line.size() - 1] == '\r') line.erase(line.size() - 1);
+  wireIn.erase(0, nl + 1);
+  return true;
+}
+
+static void send(const std::string &line) {
+  if (!line.empty()) Serial1.hostFeed((line + "\n").c_str());
+}
+
+// Runs until the client finishes; 'tamper' may change or drop (return
+// false) the n-th chunk line before the client sees it
+template <typename Tamper>
+static void download(LogClient &client, unsigned long maxMs, Tamper tamper) {
+  unsigned long chunkLines = 0;
+  for (unsigned long t = 0; t < maxMs && !client.done() && !client.failed(); t += PASS_MS) {
+    pass();
+    std::string line;
+    while (nextLine(line)) {
+      if (line.find("{\"chunk\":") == 0 && !tamper(chunkLines++, line)) continue;
+      send(client.receive(line));
+    }
+  }
+}
+
+static bool untouched(unsigned long, std::string &) { return true; }
+
+static void checkPacedDownload() {
+  boot();
+  std::string content = makeLog();
+  hostSdWrite("/LOGS/20261018.CSV", content);
+
+  LogClient client(LOG_NAME);
+  send(client.readCommand());
+  deSeenHigh = false;
+  download(client, 120000, untouched);
+  CHECK(client.done());
+  CHECK(std::string(client.data().begin(), client.data().end()) == content);
+  CHECK(client.fileCrc() == logCrc32((const uint8_t*)content.data(), content.size()));
+  CHECK(client.rejected == 0);
+
+  // Fed from the loop, never flushed; the driver is let go afterwards
+  CHECK(Serial1.hostFlushCount() == 0);
+  CHECK(deSeenHigh);
+  for (int i = 0; i < 10; i++) pass();
+  CHECK(isTransmitQueueEmpty());
+  CHECK(hostPinLevel(RS485_DE_RE_PIN) == LOW);
+}
+
+static void checkDamagedChunks() {
+  boot();
+  std::string content = makeLog();
+  hostSdWrite("/LOGS/20261018.CSV", content);
+
+  LogClient client(LOG_NAME);
+  send(client.readCommand());
+  download(client, 120000, [](unsigned long n, std::string &line) {
+    if (n == 2) line[line.size() - 10] ^= 0x01; // One bit flipped in the data
+    return n != 5;                              // One chunk lost on the wire
+  });
+  CHECK(client.done());
+  CHECK(std::string(client.data().begin(), client.data().end()) == content);
+  CHECK(client.rejected == 1);
+  CHECK(Serial1.hostFlushCount() == 0);
+}
+
+static void checkResume() {
+  boot();
+  std::string content = makeLog();
+  hostSdWrite("/LOGS/20261018.CSV", content);
+
+  // The link drops after three chunks: the oven gives up, the client resumes
+  LogClient client(LOG_NAME);
+  send(client.readCommand());
+  download(client, 120000, [](unsigned long n, std::string &) { return n < 3; });
+  CHECK(!client.done());
+  uint32_t kept = client.offset();
+  CHECK(kept > 0 && kept < content.size());
+  send(client.readCommand());
+  download(client, 120000, untouched);
+  CHECK(client.done());
+  CHECK(std::string(client.data().begin(), client.data().end()) == content);
+
+  // A new client continuing a saved partial file gets only the rest
+  LogClient rest(LOG_NAME, kept);
+  send(rest.readCommand());
+  download(rest, 120000, untouched);
+  CHECK(rest.done());
+  CHECK(std::string(rest.data().begin(), rest.data().end()) == content.substr(kept));
+}
+
+static void checkMissingFile() {
+  boot();
+  LogClient client("20200101.CSV");
+  send(client.readCommand());
+  download(client, 2000, untouched);
+  CHECK(client.failed());
+  CHECK(client.errorMessage() == "Log file not found");
+}
+
+int main() {
+  checkPacedDownload();
+  checkDamagedChunks();
+  checkResume();
+  checkMissingFile();
+  return checkResult("test_log_download");
+}
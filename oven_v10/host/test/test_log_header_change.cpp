@@ -0,0 +1,52 @@
+// =================================================================
+// LOG HEADER CHANGE
+// =================================================================
+// A day file started by a firmware with other columns is left alone:
+// the day continues in YYYYMMDD.CS1 under the current header, and a
+// later boot of the same firmware appends to that part.
+
+#include <Arduino.h>
+#include <DueFlashStorage.h>
+#include <SD.h>
+#include <algorithm>
+#include <memory>
+#include <string>
+#include "check.h"
+#include "config.h"
+#include "drivers.h"
+#include "logger.h"
+#include "wallclock.h"
+
+static bool startsWithHeader(const std::string &content) {
+  return content.compare(0, strlen(logHeader()), logHeader()) == 0;
+}
+
+int main() {
+  hostResetClock();
+  hostFlashErase();
+  hostSdReset();
+  hostSetRtc(1792411200UL); // 2026-10-19 12:00:00
+  initializeWallClock();
+  std::unique_ptr<OvenController> oven(new OvenController());
+  loadSettings(*oven);
+
+  const std::string oldFile = "date,time,state,set_rod1\r\n2026-10-19,11:00:00,IDLE,0\r\n";
+  hostSdWrite("/LOGS/20261019.CSV", oldFile);
+
+  initializeLogger(*oven);
+  logSystemData(*oven);
+  CHECK(hostSdRead("/LOGS/20261019.CSV") == oldFile);
+  std::string part1 = hostSdRead("/LOGS/20261019.CS1");
+  CHECK(startsWithHeader(part1));
+  CHECK(std::count(part1.begin(), part1.end(), '\n') == 2);
+
+  // Same firmware again: appends to .CS1, no .CS2
+  initializeLogger(*oven);
+  logSystemData(*oven);
+  part1 = hostSdRead("/LOGS/20261019.CS1");
+  CHECK(startsWithHeader(part1));
+  CHECK(std::count(part1.begin(), part1.end(), '\n') == 3);
+  CHECK(hostSdRead("/LOGS/20261019.CS2").empty());
+
+  return checkResult("test_log_header_change");
+}
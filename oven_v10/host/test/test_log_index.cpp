@@ -0,0 +1,116 @@
+// =================================================================
+// LOG INDEX
+// =================================================================
+// Pruning old day files takes their entries out of INDEX.BIN, a reset
+// in the middle of that rewrite loses nothing, and after the clock is
+// set back the search still finds rows on both sides of the step.
+
+#include <Arduino.h>
+#include <DueFlashStorage.h>
+#include <SD.h>
+#include <memory>
+#include <string>
+#include <vector>
+#include "check.h"
+#include "config.h"
+#include "drivers.h"
+#include "logger.h"
+#include "wallclock.h"
+
+const uint32_t DAY_SEC = 86400UL;
+const uint32_t NOON_0601 = 1780315200UL; // 2026-06-01 12:00:00
+const uint32_t NOON_1019 = 1792411200UL; // 2026-10-19 12:00:00
+
+static std::unique_ptr<OvenController> oven;
+
+static std::vector<LogIndexEntry> readIndex() {
+  std::string raw = hostSdRead("/LOGS/INDEX.BIN");
+  std::vector<LogIndexEntry> entries(raw.size() / sizeof(LogIndexEntry));
+  if (!entries.empty()) memcpy(entries.data(), raw.data(), entries.size() * sizeof(LogIndexEntry));
+  return entries;
+}
+
+// Set the RTC and log 'rows' rows a second apart, the state flipping
+// each row so every row gets an index entry
+static void logAt(uint32_t unixTime, int rows) {
+  hostSetRtc(unixTime);
+  resyncWallClock();
+  for (int i = 0; i < rows; i++) {
+    oven->currentState = (i % 2) ? PREHEATING : IDLE;
+    logSystemData(*oven);
+    hostAdvanceMillis(1000);
+  }
+}
+
+static void boot(uint32_t unixTime) {
+  hostSetRtc(unixTime);
+  initializeWallClock();
+  oven.reset(new OvenController());
+  loadSettings(*oven);
+  initializeLogger(*oven);
+}
+
+static void checkPrune() {
+  hostResetClock();
+  hostFlashErase();
+  hostSdReset();
+  boot(NOON_0601);
+  logAt(NOON_0601, 4);
+  logAt(NOON_0601 + DAY_SEC, 4);
+  size_t before = readIndex().size();
+  CHECK(before >= 8);
+
+  // 140 days on: both June files are past retention
+  logAt(NOON_1019, 2);
+  std::vector<LogIndexEntry> index = readIndex();
+  CHECK(hostSdRead("/LOGS/20260601.CSV").empty());
+  CHECK(!index.empty() && index.size() < before);
+  for (size_t i = 0; i < index.size(); i++) CHECK(index[i].fileDate == 20261019UL);
+  CHECK(hostSdRead("/LOGS/INDEX.TMP").empty());
+
+  // Reset after the old index was removed: the pruned copy is restored
+  std::string pruned = hostSdRead("/LOGS/INDEX.BIN");
+  hostSdWrite("/LOGS/INDEX.TMP", pruned);
+  hostSdWrite("/LOGS/INDEX.BIN", pruned.substr(0, sizeof(LogIndexEntry)));
+  boot(NOON_1019 + 60);
+  CHECK(hostSdRead("/LOGS/INDEX.BIN").compare(0, pruned.size(), pruned) == 0); // Then the boot's own entry
+  CHECK(hostSdRead("/LOGS/INDEX.TMP").empty());
+}
+
+static void checkClockStep() {
+  hostResetClock();
+  hostFlashErase();
+  hostSdReset();
+  boot(NOON_1019);
+  logAt(NOON_1019, 6);           // 12:00:00 .. 12:00:05
+  logAt(NOON_1019 - 3600, 6);    // Set back to 11:00:00
+
+  std::vector<LogIndexEntry> index = readIndex();
+  CHECK(index.back().segment == 1);
+
+  LogIndexEntry entry;
+  // After the step: the new segment
+  CHECK(findLogPosition(NOON_1019 - 3600 + 3, entry));
+  CHECK(entry.segment == 1 && entry.unixTime == NOON_1019 - 3600 + 3);
+  // Before both segments: nothing
+  CHECK(findLogPosition(NOON_1019 - 7200, entry) == false);
+  // Inside the old segment's span: that row
+  CHECK(findLogPosition(NOON_1019 + 2, entry));
+  CHECK(entry.segment == 0 && entry.unixTime == NOON_1019 + 2);
+  // Past both: the newest segment's last row
+  CHECK(findLogPosition(NOON_1019 + 600, entry));
+  CHECK(entry.segment == 1 && entry.unixTime == NOON_1019 - 3600 + 5);
+
+  // A reboot carries on in the same segment
+  boot(NOON_1019 - 3000);
+  logAt(NOON_1019 - 3000, 2);
+  CHECK(readIndex().back().segment == 1);
+  CHECK(findLogPosition(NOON_1019 - 3000, entry));
+  CHECK(entry.unixTime == NOON_1019 - 3000);
+}
+
+int main() {
+  checkPrune();
+  checkClockStep();
+  return checkResult("test_log_index");
+}
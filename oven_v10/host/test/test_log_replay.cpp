@@ -0,0 +1,139 @@
+// =================================================================
+// LOG REPLAY
+// =================================================================
+// The sketch preheats a simulated oven and logs its day file; replaying
+// that file against the same firmware must land on the logged states
+// and PID outputs, and close to the logged relay duty.
+
+#include "../../oven_v10.ino"
+#include "check.h"
+#include "log_replay.h"
+#include <SD.h>
+#include <max6675.h>
+#include <string>
+#include <vector>
+
+// Each zone heats 1.5 C/s with its relay on and leaks toward 25 C
+static float plantTemp[ZONE_COUNT];
+
+static void runPlant(unsigned long ms, unsigned long stepMs = 10) {
+  for (unsigned long t = 0; t < ms; t += stepMs) {
+    for (uint8_t z = 0; z < ZONE_COUNT; z++) {
+      double rate = (oven.relayStates.zone[z] ? 1.5 : 0.0) - (plantTemp[z] - 25.0) * 0.004;
+      plantTemp[z] += (float)(rate * stepMs / 1000.0);
+      hostSetThermocouple(ZONE_TABLE[z].csPin, plantTemp[z]);
+    }
+    loop();
+    hostAdvanceMillis(stepMs);
+  }
+}
+
+// The same rows under the baseline firmware's header: no sp_, iterm_
+// or mode_ columns, and the steam zone named rod3
+static std::string baselineLog(const std::string &log) {
+  std::vector<bool> keep;
+  std::string out;
+  size_t start = 0;
+  while (start < log.size()) {
+    size_t end = log.find('\n', start);
+    if (end == std::string::npos) end = log.size();
+    std::string line = log.substr(start, end - start);
+    start = end + 1;
+    std::vector<std::string> fields;
+    for (size_t p = 0, comma; p <= line.size(); p = comma + 1) {
+      comma = line.find(',', p);
+      if (comma == std::string::npos) comma = line.size();
+      fields.push_back(line.substr(p, comma - p));
+    }
+    if (fields[0] == "date") {
+      keep.clear();
+      for (size_t i = 0; i < fields.size(); i++) {
+        const std::string &f = fields[i];
+        keep.push_back(f.compare(0, 3, "sp_") != 0 && f.compare(0, 6, "iterm_") != 0 && f.compare(0, 5, "mode_") != 0);
+        size_t steam = f.find("_steam");
+        if (steam != std::string::npos) fields[i] = f.substr(0, steam) + "_rod3";
+      }
+    }
+    std::string row;
+    for (size_t i = 0; i < fields.size() && i < keep.size(); i++) {
+      if (!keep[i]) continue;
+      if (!row.empty()) row += ",";
+      row += fields[i];
+    }
+    out += row + "\n";
+  }
+  return out;
+}
+
+static bool replay(const std::string &log, const ReplayOptions &options, ReplayReport &report, std::string &error) {
+  FILE* f = tmpfile();
+  fwrite(log.data(), 1, log.size(), f);
+  rewind(f);
+  bool ok = replayLog(f, options, report, error);
+  fclose(f);
+  return ok;
+}
+
+int main() {
+  hostResetClock();
+  hostFlashErase();
+  hostSdReset();
+  hostSetRtc(1792411200UL); // 2026-10-19 12:00:00
+  for (uint8_t z = 0; z < ZONE_COUNT; z++) plantTemp[z] = 25.0f;
+  setup();
+  // A rated supply, so at most two relays switch together: three
+  // switching at a window start block the loop longer than the log
+  // interval, and the sampled rel_ columns no longer follow the duty
+  SerialUSB.hostFeed("{\"cmd\":\"SET_POWER_BUDGET\",\"max_kw\":6,\"max_heaters\":2}\n");
+  SerialUSB.hostFeed("{\"cmd\":\"SET_THRESHOLDS\",\"rod1\":220,\"rod2\":200,\"steam\":150,\"time\":25,\"holding\":30}\n");
+  runPlant(5000);
+  SerialUSB.hostFeed("{\"cmd\":\"START_PREHEAT\"}\n");
+  runPlant(8 * 60000UL);
+
+  std::string log = hostSdRead("/LOGS/20261019.CSV");
+  ReplayOptions options;
+  options.maxKw = 6;
+  options.maxHeaters = 2;
+  ReplayReport report;
+  std::string error;
+  CHECK(replay(log, options, report, error));
+  CHECK(report.rows >= 160);
+  CHECK(report.compared == report.rows - 1);
+  CHECK(report.reseeds == 0);
+  // START_PREHEAT came in as a command: the one state change not replayed
+  CHECK(report.columns[0].mismatches == 1);
+  for (uint8_t z = 0; z < ZONE_COUNT; z++) {
+    CHECK(report.columns[1 + z].mismatches == 0);
+    CHECK(report.columns[1 + ZONE_COUNT + z].maxError < 0.25);
+  }
+  CHECK(report.columns[1 + 2 * ZONE_COUNT].mismatches == 0);
+
+  // A baseline-firmware log of the same bake replays alike
+  ReplayReport legacy;
+  std::string legacyLog = baselineLog(log);
+  CHECK(legacyLog.find(",set_rod3,") != std::string::npos);
+  CHECK(legacyLog.find("iterm_") == std::string::npos);
+  CHECK(replay(legacyLog, options, legacy, error));
+  CHECK(legacy.rows == report.rows);
+  CHECK(legacy.reseeds == 0);
+  CHECK(legacy.columns[0].mismatches == 1);
+  for (uint8_t z = 0; z < ZONE_COUNT; z++) {
+    CHECK(legacy.columns[1 + z].mismatches == 0);
+    CHECK(legacy.columns[1 + ZONE_COUNT + z].maxError < 0.25);
+  }
+
+  // Joined mid-bake: seeded from the first row's output
+  size_t cut = 0;
+  for (int i = 0; i < 60; i++) cut = legacyLog.find('\n', cut) + 1;
+  std::string midBake = legacyLog.substr(0, legacyLog.find('\n') + 1) + legacyLog.substr(cut);
+  CHECK(midBake.find("IDLE") == std::string::npos);
+  CHECK(replay(midBake, options, legacy, error));
+  CHECK(legacy.reseeds == 0);
+  for (uint8_t z = 0; z < ZONE_COUNT; z++) CHECK(legacy.columns[1 + z].mismatches == 0);
+
+  // A log without this firmware's columns is refused
+  CHECK(!replay("date,time,state\n2026-10-19,12:00:00,IDLE\n", options, report, error));
+  CHECK(error.find("no column") != std::string::npos);
+
+  return checkResult("test_log_replay");
+}
@@ -0,0 +1,155 @@
+// =================================================================
+// THERMAL MODEL FIT
+// =================================================================
+// tools/model_fit recovers known plants: a FOPDT and a 2-node zone
+// driven by a stepped duty and sampled like the log, and the zones of
+// a simulated bake logged by the sketch itself.
+
+#include "../../oven_v10.ino"
+#include "check.h"
+#include "model_fit.h"
+#include "thermal_plant.h"
+#include <SD.h>
+#include <max6675.h>
+#include <memory>
+#include <string>
+
+const double SAMPLE_SEC = 3.0;
+const double PLANT_STEP_SEC = 0.1;
+
+// Duty stepped every 'holdSec' through a fixed pseudo-random sequence
+static ZoneSeries excite(const PlantParams &params, double seconds, double holdSec) {
+  ThermalPlant plant(params, PLANT_STEP_SEC);
+  ZoneSeries s;
+  s.zone = "test";
+  s.sampleSec = SAMPLE_SEC;
+  s.temp.resize(1);
+  s.duty.resize(1);
+  uint32_t seed = 12345;
+  double u = 1.0;
+  int perSample = (int)(SAMPLE_SEC / PLANT_STEP_SEC + 0.5);
+  int perHold = (int)(holdSec / PLANT_STEP_SEC + 0.5);
+  for (int i = 0; i < (int)(seconds / PLANT_STEP_SEC); i++) {
+    if (i % perHold == 0 && i > 0) {
+      seed = seed * 1103515245u + 12345u;
+      u = ((seed >> 16) % 11) / 10.0;
+    }
+    if (i % perSample == 0) {
+      s.temp[0].push_back(plant.temp());
+      s.duty[0].push_back(u);
+    }
+    plant.step(u);
+  }
+  return s;
+}
+
+static void checkFopdt() {
+  PlantParams p;
+  p.gain = 380;
+  p.tau = 240;
+  p.deadTime = 12;
+  p.ambient = 22;
+  ModelFit fit = fitFopdt(excite(p, 4 * 3600, 150));
+  CHECK(fit.ok);
+  CHECK_NEAR(fit.gain, p.gain, 0.03 * p.gain);
+  CHECK_NEAR(fit.tau, p.tau, 0.03 * p.tau);
+  CHECK_NEAR(fit.deadTime, p.deadTime, SAMPLE_SEC);
+  CHECK_NEAR(fit.ambient, p.ambient, 1.0);
+  CHECK(fit.rmsError < 1.0);
+
+  // A known ambient is used as given
+  ModelFit fixed = fitFopdt(excite(p, 4 * 3600, 150), 22.0);
+  CHECK(fixed.ok);
+  CHECK(fixed.ambient == 22.0);
+  CHECK_NEAR(fixed.gain, p.gain, 0.03 * p.gain);
+}
+
+static void checkTwoNode() {
+  PlantParams p;
+  p.gain = 420;
+  p.tau = 300;
+  p.tau2 = 60;
+  p.deadTime = 6;
+  ZoneSeries s = excite(p, 4 * 3600, 180);
+  ModelFit two = fitTwoNode(s);
+  CHECK(two.ok);
+  CHECK_NEAR(two.gain, p.gain, 0.05 * p.gain);
+  CHECK_NEAR(two.tau, p.tau, 0.10 * p.tau);
+  CHECK_NEAR(two.tau2, p.tau2, 0.25 * p.tau2);
+  // FOPDT folds the heater lag into a longer dead time and fits worse
+  ModelFit one = fitFopdt(s);
+  CHECK(one.ok);
+  CHECK(one.deadTime > p.deadTime + 20);
+  CHECK(two.rmsError < one.rmsError);
+}
+
+// The sketch preheats and holds three FOPDT zones on SSRs; fit its day log
+static void checkFromLog() {
+  PlantParams params[ZONE_COUNT];
+  for (uint8_t z = 0; z < ZONE_COUNT; z++) {
+    params[z].gain = 350 + 50 * z;
+    params[z].tau = 200 + 60 * z;
+    params[z].deadTime = 9;
+  }
+  std::vector<ThermalPlant> plants;
+  for (uint8_t z = 0; z < ZONE_COUNT; z++) plants.push_back(ThermalPlant(params[z], 0.02));
+
+  hostResetClock();
+  hostFlashErase();
+  hostSdReset();
+  hostSetRtc(1792411200UL); // 2026-10-19 12:00:00
+  for (uint8_t z = 0; z < ZONE_COUNT; z++) hostSetThermocouple(ZONE_TABLE[z].csPin, 25.0f);
+  setup();
+  // SSR output: the delivered duty is the logged one (TPC relays also
+  // get the power budget's shifts and the switching delays)
+  for (uint8_t z = 0; z < ZONE_COUNT; z++) {
+    SerialUSB.hostFeed((std::string("{\"cmd\":\"SET_OUTPUT_MODE\",\"target\":\"") + ZONE_TABLE[z].name
+                        + "\",\"mode\":\"window\"}\n").c_str());
+  }
+  SerialUSB.hostFeed("{\"cmd\":\"SET_THRESHOLDS\",\"rod1\":220,\"rod2\":200,\"steam\":150,\"time\":40,\"holding\":30}\n");
+  SerialUSB.hostFeed("{\"cmd\":\"START_PREHEAT\"}\n");
+  // The plant follows the virtual clock, which relay switching delays move too
+  unsigned long simulated = millis();
+  while (millis() < 45 * 60000UL) {
+    for (; simulated + 20 <= millis(); simulated += 20) {
+      for (uint8_t z = 0; z < ZONE_COUNT; z++) plants[z].step(oven.heaterPinState[z] ? 1.0 : 0.0);
+    }
+    for (uint8_t z = 0; z < ZONE_COUNT; z++) hostSetThermocouple(ZONE_TABLE[z].csPin, (float)plants[z].temp());
+    loop();
+    hostAdvanceMillis(20);
+  }
+
+  std::string log = hostSdRead("/LOGS/20261019.CSV");
+  FILE* f = tmpfile();
+  fwrite(log.data(), 1, log.size(), f);
+  rewind(f);
+  std::vector<ZoneSeries> zones;
+  std::string error;
+  CHECK(loadZoneSeries(f, PID_WINDOW_SIZE, zones, error));
+  fclose(f);
+  CHECK(zones.size() == ZONE_COUNT);
+  for (uint8_t z = 0; z < ZONE_COUNT && z < zones.size(); z++) {
+    CHECK(zones[z].zone == ZONE_TABLE[z].name);
+    CHECK(zones[z].sampleSec == 3.0);
+    ModelFit fit = fitFopdt(zones[z], 25.0);
+    CHECK(fit.ok);
+    CHECK_NEAR(fit.gain, params[z].gain, 0.10 * params[z].gain);
+    CHECK_NEAR(fit.tau, params[z].tau, 0.15 * params[z].tau);
+    CHECK_NEAR(fit.deadTime, params[z].deadTime, 2 * SAMPLE_SEC);
+  }
+
+  // No zone columns: refused
+  FILE* bad = tmpfile();
+  fputs("date,time,state\n2026-10-19,12:00:00,IDLE\n", bad);
+  rewind(bad);
+  std::vector<ZoneSeries> none;
+  CHECK(!loadZoneSeries(bad, PID_WINDOW_SIZE, none, error));
+  fclose(bad);
+}
+
+int main() {
+  checkFopdt();
+  checkTwoNode();
+  checkFromLog();
+  return checkResult("test_model_fit");
+}
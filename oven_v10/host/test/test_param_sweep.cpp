@@ -0,0 +1,131 @@
+// =================================================================
+// PARAMETER SWEEP
+// =================================================================
+// The sweep optimizer's parts: the grid, Nelder-Mead, the Pareto
+// filter, the worker pool, and bakes that give the same costs on
+// parallel workers as alone.
+
+#include <math.h>
+#include <atomic>
+#include <thread>
+#include <vector>
+#include "bake_sim.h"
+#include "check.h"
+#include "param_search.h"
+
+static void checkGrid() {
+  // Two zones of two dimensions on two axes
+  std::vector<int> axisOf = {0, 1, 0, 1};
+  std::vector<std::vector<double> > grid = unitGrid(axisOf, 2, 3);
+  CHECK(grid.size() == 9);
+  bool corner = false;
+  for (size_t i = 0; i < grid.size(); i++) {
+    CHECK(grid[i][0] == grid[i][2]);
+    CHECK(grid[i][1] == grid[i][3]);
+    if (grid[i][0] == 1.0 && grid[i][1] == 0.0) corner = true;
+  }
+  CHECK(corner);
+
+  SweepDim ms = {"min_on", 0, 3000, true};
+  CHECK(sweepValue(ms, 0.33333) == 1000);
+  CHECK(sweepValue(ms, 1.5) == 3000);
+}
+
+static void checkNelderMead() {
+  // Bowl inside the box
+  std::vector<double> centre = {0.3, 0.7, 0.2};
+  auto bowl = [&](const std::vector<double> &x) {
+    double sum = 0;
+    for (size_t i = 0; i < x.size(); i++) sum += (i + 1) * (x[i] - centre[i]) * (x[i] - centre[i]);
+    return sum;
+  };
+  std::vector<double> best = nelderMead(bowl, {0.9, 0.1, 0.9}, 0.15, 400);
+  for (size_t i = 0; i < best.size(); i++) CHECK_NEAR(best[i], centre[i], 0.01);
+
+  // Minimum outside: ends on the edge
+  int evals = 0;
+  auto slope = [&](const std::vector<double> &x) { evals++; return x[0] - x[1]; };
+  std::vector<double> edge = nelderMead(slope, {0.5, 0.5}, 0.2, 100);
+  CHECK_NEAR(edge[0], 0.0, 0.01);
+  CHECK_NEAR(edge[1], 1.0, 0.01);
+  CHECK(evals <= 100);
+}
+
+static SweepPoint point(double a, double b, double c, double d) {
+  SweepPoint p;
+  p.cost[0] = a;
+  p.cost[1] = b;
+  p.cost[2] = c;
+  p.cost[3] = d;
+  return p;
+}
+
+static void checkPareto() {
+  std::vector<SweepPoint> points = {
+    point(1, 5, 5, 5),  // Best overshoot
+    point(5, 1, 5, 5),  // Best settle
+    point(2, 6, 6, 6),  // Dominated by the first
+    point(3, 3, 3, 3),  // Balanced
+    point(3, 3, 3, 3),  // Same again
+    point(3, 3, 3, 4),  // Dominated by the balanced one
+  };
+  std::vector<size_t> front = paretoFront(points);
+  CHECK(front.size() == 3);
+  CHECK(front.size() == 3 && front[0] == 0 && front[1] == 1 && front[2] == 3);
+  CHECK(dominates(points[0], points[2]));
+  CHECK(!dominates(points[0], points[1]));
+  CHECK(!dominates(points[3], points[4]));
+}
+
+static void checkPool() {
+  std::vector<std::atomic<int> > runs(1000);
+  for (size_t i = 0; i < runs.size(); i++) runs[i] = 0;
+  parallelFor(runs.size(), 8, [&](size_t i) { runs[i]++; });
+  bool once = true;
+  for (size_t i = 0; i < runs.size(); i++) once = once && runs[i] == 1;
+  CHECK(once);
+}
+
+static void checkBakes() {
+  BakeScenario scenario = defaultBakeScenario();
+  scenario.minutes = 30;
+  BakeParams stock = defaultBakeParams();
+  BakeParams integral = stock;
+  for (uint8_t z = 0; z < ZONE_COUNT; z++) integral.ki[z] = 3.0;
+  BakeParams soft = stock;
+  for (uint8_t z = 0; z < ZONE_COUNT; z++) soft.kp[z] = stock.kp[z] / 4;
+
+  double alone[SWEEP_COST_COUNT], integralAlone[SWEEP_COST_COUNT], softAlone[SWEEP_COST_COUNT];
+  simulateBake(scenario, stock, alone);
+  simulateBake(scenario, integral, integralAlone);
+  simulateBake(scenario, soft, softAlone);
+  // The stock gains are P only: the zones droop below the band and
+  // never settle. An integral term brings them in.
+  CHECK(alone[COST_SETTLE] == scenario.minutes * 60);
+  CHECK(integralAlone[COST_SETTLE] < scenario.minutes * 60 / 2);
+  CHECK(integralAlone[COST_CYCLES] > 0);
+  CHECK(integralAlone[COST_ENERGY] > 0);
+  // Less gain overshoots less
+  CHECK(softAlone[COST_OVERSHOOT] < alone[COST_OVERSHOOT]);
+
+  // Bakes on parallel workers score as they did alone
+  double costs[4][SWEEP_COST_COUNT];
+  std::vector<std::thread> workers;
+  for (int t = 0; t < 4; t++) {
+    workers.push_back(std::thread([&, t] { simulateBake(scenario, t % 2 ? integral : stock, costs[t]); }));
+  }
+  for (size_t t = 0; t < workers.size(); t++) workers[t].join();
+  for (int t = 0; t < 4; t++) {
+    const double* expected = t % 2 ? integralAlone : alone;
+    for (int c = 0; c < SWEEP_COST_COUNT; c++) CHECK(costs[t][c] == expected[c]);
+  }
+}
+
+int main() {
+  checkGrid();
+  checkNelderMead();
+  checkPareto();
+  checkPool();
+  checkBakes();
+  return checkResult("test_param_sweep");
+}
@@ -0,0 +1,52 @@
+// =================================================================
+// PID HANDOVER
+// =================================================================
+// Manual -> auto with SeedOutput() must continue from the manual duty
+// even when kp * e alone is past an output limit: the iTerm that holds
+// the duty is then outside [outMin, outMax] and used to be clipped,
+// so the first Compute() jumped to the limit.
+
+#include <Arduino.h>
+#include "check.h"
+#include "config.h"
+
+const double OUT_MAX = 5000.0;
+
+// Hold y and sp, seed 'duty' and run a few computes: each may move the
+// output by no more than the integral step ki * h * e
+template <typename T>
+static void checkHandover(double y, double sp, double duty, double tol) {
+  hostResetClock();
+  T input = T(y), setpoint = T(sp), output = T(duty);
+  BasicQuickPID<T> pid(&input, &output, &setpoint, 50.0, 0.2, 0.0, BasicQuickPID<T>::DIRECT);
+  pid.SetOutputLimits(0, OUT_MAX);
+  pid.SetMode(BasicQuickPID<T>::AUTOMATIC);
+  pid.SeedOutput(T(duty));
+
+  double expected = duty;
+  for (int i = 0; i < 5; i++) {
+    CHECK(pid.Compute());
+    expected += 0.2 * PID_COMPUTE_FREQ / 1000.0 * (sp - y);
+    if (expected < 0) expected = 0;
+    if (expected > OUT_MAX) expected = OUT_MAX;
+    CHECK_NEAR((double)output, expected, tol);
+    hostAdvanceMillis(PID_COMPUTE_FREQ);
+  }
+}
+
+template <typename T>
+static void checkBackend(double tol) {
+  // Cold oven, heaters held low by hand: kp * e = 9000 > outMax
+  checkHandover<T>(20.0, 200.0, 1000.0, tol);
+  // Overshoot with heaters held high: kp * e = -5000 < outMin
+  checkHandover<T>(200.0, 100.0, 4000.0, tol);
+  // Small error: unchanged
+  checkHandover<T>(148.0, 150.0, 2500.0, tol);
+}
+
+int main() {
+  checkBackend<double>(1e-6);
+  checkBackend<float>(1e-2);
+  checkBackend<Fix16>(0.5);
+  return checkResult("test_pid_handover");
+}
@@ -0,0 +1,89 @@
+// =================================================================
+// PID DIRECTION
+// =================================================================
+// The baseline constructor assigned controllerDirection to itself, so
+// REVERSE was silently ignored. A REVERSE controller must mirror a
+// DIRECT one: same output for y' = k - y, sp' = k - sp.
+
+#include <Arduino.h>
+#include "check.h"
+#include "config.h"
+#include "../tools/baseline_reference.h"
+
+// Mirrored inputs over a run with P, I, D and a setpoint change
+template <typename T>
+static void checkMirror(double tol) {
+  hostResetClock();
+  T yd = T(20.0), spd = T(150.0), outd = T(0);
+  T yr = T(200.0 - 20.0), spr = T(200.0 - 150.0), outr = T(0);
+  BasicQuickPID<T> direct(&yd, &outd, &spd, 3.0, 0.2, 1.0, BasicQuickPID<T>::DIRECT);
+  BasicQuickPID<T> reverse(&yr, &outr, &spr, 3.0, 0.2, 1.0, BasicQuickPID<T>::REVERSE);
+  direct.SetMode(BasicQuickPID<T>::AUTOMATIC);
+  reverse.SetMode(BasicQuickPID<T>::AUTOMATIC);
+
+  double y = 20.0;
+  for (int i = 0; i < 600; i++) {
+    if (i == 300) { spd = T(100.0); spr = T(200.0 - 100.0); }
+    yd = T(y);
+    yr = T(200.0 - y);
+    CHECK(direct.Compute());
+    CHECK(reverse.Compute());
+    CHECK_NEAR((double)outr, (double)outd, tol);
+    // Simple plant so D and I see changing inputs
+    y += ((double)outd / 255.0 * 200.0 + 20.0 - y) * 0.01;
+    hostAdvanceMillis(PID_COMPUTE_FREQ);
+  }
+  // Gains read back in SetTunings() units, positive either way
+  CHECK_NEAR(reverse.GetKp(), 3.0, 1e-4);
+  CHECK_NEAR(reverse.GetKi(), 0.2, 1e-4);
+  CHECK_NEAR(reverse.GetKd(), 1.0, 1e-4);
+}
+
+// Measurement above setpoint drives a REVERSE output up, DIRECT to 0
+static void checkSign() {
+  hostResetClock();
+  double y = 120, sp = 100, out = 0;
+  BasicQuickPID<double> reverse(&y, &out, &sp, 2.0, 0.0, 0.0, BasicQuickPID<double>::REVERSE);
+  reverse.SetMode(BasicQuickPID<double>::AUTOMATIC);
+  CHECK(reverse.Compute());
+  CHECK_NEAR(out, 40.0, 1e-12);
+
+  double yd = 120, spd = 100, outd = 0;
+  BasicQuickPID<double> direct(&yd, &outd, &spd, 2.0, 0.0, 0.0, BasicQuickPID<double>::DIRECT);
+  direct.SetMode(BasicQuickPID<double>::AUTOMATIC);
+  CHECK(direct.Compute());
+  CHECK_NEAR(outd, 0.0, 1e-12);
+}
+
+// The scheduled gains take the direction too
+static void checkScheduleSign() {
+  hostResetClock();
+  double y = 120, sp = 100, out = 0;
+  BasicQuickPID<double> reverse(&y, &out, &sp, 1.0, 0.0, 0.0, BasicQuickPID<double>::REVERSE);
+  GainPoint points[2] = {{0, 2.0, 0, 0}, {200, 2.0, 0, 0}};
+  reverse.SetGainSchedule(points, 2, false);
+  reverse.SetMode(BasicQuickPID<double>::AUTOMATIC);
+  CHECK(reverse.Compute());
+  CHECK(out > 0);
+  CHECK_NEAR(reverse.GetKp(), 2.0, 1e-9);
+}
+
+// What the fix changed: the baseline ran REVERSE as DIRECT
+static double refY = 120, refSp = 100, refOut = 0;
+static void checkBaselineIgnoredReverse() {
+  hostResetClock();
+  static baseline::QuickPID ref(&refY, &refOut, &refSp, 2.0, 0.0, 0.0, baseline::QuickPID::REVERSE);
+  ref.SetMode(baseline::QuickPID::AUTOMATIC);
+  CHECK(ref.Compute());
+  CHECK_NEAR(refOut, 0.0, 1e-12); // Clamped at 0 like a DIRECT controller
+}
+
+int main() {
+  checkMirror<double>(1e-9);
+  checkMirror<float>(1e-2);
+  checkMirror<Fix16>(0.5);
+  checkSign();
+  checkScheduleSign();
+  checkBaselineIgnoredReverse();
+  return checkResult("test_pid_reverse");
+}
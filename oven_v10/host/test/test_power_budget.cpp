@@ -0,0 +1,156 @@
+// =================================================================
+// POWER BUDGET
+// =================================================================
+// With no installer rating every heater runs its full request; with
+// one the concurrent load stays inside it, and an SSR channel holds
+// its rating for the whole window so the relay runs pack around it.
+// A zone coming on mid-window does not wait for the next window.
+
+#include <Arduino.h>
+#include <DueFlashStorage.h>
+#include <memory>
+#include "check.h"
+#include "config.h"
+#include "oven_logic.h"
+#include "output_mode.h"
+#include "power_budget.h"
+
+struct WindowTrace {
+  unsigned long onMs[ZONE_COUNT];
+  float peakKw;
+  uint8_t peakHeaters;
+};
+
+// One whole window of updatePowerBudget from a fresh plan
+static WindowTrace runWindow(OvenController &oven, const unsigned long requestMs[]) {
+  unsigned long minOn[ZONE_COUNT] = {};
+  WindowTrace trace = {};
+  initializePowerBudget(oven);
+  for (unsigned long t = 0; t < PID_WINDOW_SIZE; t += 10) {
+    bool on[ZONE_COUNT];
+    updatePowerBudget(oven, requestMs, minOn, on);
+    float kw = 0;
+    uint8_t heaters = 0;
+    for (uint8_t z = 0; z < ZONE_COUNT; z++) {
+      if (!on[z]) continue;
+      trace.onMs[z] += 10;
+      kw += ZONE_TABLE[z].powerKw;
+      heaters++;
+    }
+    if (kw > trace.peakKw) trace.peakKw = kw;
+    if (heaters > trace.peakHeaters) trace.peakHeaters = heaters;
+    hostAdvanceMillis(10);
+  }
+  return trace;
+}
+
+static std::unique_ptr<OvenController> bootOven() {
+  hostResetClock();
+  hostResetPins();
+  hostFlashErase();
+  std::unique_ptr<OvenController> oven(new OvenController());
+  initializeLogic(*oven);
+  return oven;
+}
+
+// Fresh settings: no limit, every heater on at once
+static void checkUnlimited() {
+  std::unique_ptr<OvenController> oven = bootOven();
+  CHECK(oven->settings.power.maxKw == 0);
+  CHECK(oven->settings.power.maxHeaters == 0);
+
+  unsigned long full[ZONE_COUNT];
+  for (uint8_t z = 0; z < ZONE_COUNT; z++) full[z] = PID_WINDOW_SIZE;
+  WindowTrace w = runWindow(*oven, full);
+  CHECK(w.peakHeaters == ZONE_COUNT);
+  for (uint8_t z = 0; z < ZONE_COUNT; z++) CHECK(w.onMs[z] == PID_WINDOW_SIZE);
+  CHECK(getPowerBudgetStats(*oven).constrainedWindows == 0);
+}
+
+// Relay channels under a kW and a count limit
+static void checkLimits() {
+  std::unique_ptr<OvenController> oven = bootOven();
+  unsigned long half[ZONE_COUNT];
+  for (uint8_t z = 0; z < ZONE_COUNT; z++) half[z] = PID_WINDOW_SIZE / 2;
+
+  oven->settings.power.maxKw = 6.0f;
+  WindowTrace w = runWindow(*oven, half);
+  CHECK(w.peakKw <= 6.0f);
+  for (uint8_t z = 0; z < ZONE_COUNT; z++) CHECK(w.onMs[z] == PID_WINDOW_SIZE / 2);
+
+  oven->settings.power.maxKw = 0;
+  oven->settings.power.maxHeaters = 1;
+  w = runWindow(*oven, half);
+  CHECK(w.peakHeaters == 1);
+  CHECK(getPowerBudgetStats(*oven).constrainedWindows == 1);
+}
+
+// An SSR zone with any request keeps its rating reserved all window
+static void checkSsrReserves() {
+  std::unique_ptr<OvenController> oven = bootOven();
+  oven->settings.outputMode[0] = OUTPUT_MODE_SHORT_WINDOW;
+  oven->settings.power.maxKw = 6.0f;
+  unsigned long request[ZONE_COUNT] = {};
+  request[0] = PID_WINDOW_SIZE / 10;
+  request[1] = PID_WINDOW_SIZE / 2;
+  request[2] = PID_WINDOW_SIZE / 2;
+
+  WindowTrace w = runWindow(*oven, request);
+  CHECK(w.peakKw <= 6.0f);
+  CHECK(w.onMs[0] == PID_WINDOW_SIZE);
+  // rod2 and steam share the 3 kW left, one after the other
+  CHECK(w.onMs[1] + w.onMs[2] <= PID_WINDOW_SIZE);
+  CHECK(w.onMs[1] > 0 && w.onMs[2] > 0);
+
+  // A limit too tight for the SSR and a relay together: the SSR runs first
+  oven->settings.power.maxHeaters = 1;
+  request[0] = PID_WINDOW_SIZE;
+  w = runWindow(*oven, request);
+  CHECK(w.peakHeaters == 1);
+  CHECK(w.onMs[0] == PID_WINDOW_SIZE);
+  CHECK(w.onMs[1] == 0 && w.onMs[2] == 0);
+}
+
+// A zone off at the window start that comes on mid-window: on at the
+// next pass, for what the planned runs leave
+static void checkMidWindowRise() {
+  std::unique_ptr<OvenController> oven = bootOven();
+  unsigned long minOn[ZONE_COUNT] = {};
+  unsigned long request[ZONE_COUNT] = {};
+  request[1] = PID_WINDOW_SIZE;
+  bool on[ZONE_COUNT];
+  initializePowerBudget(*oven);
+  updatePowerBudget(*oven, request, minOn, on);
+  CHECK(!on[0] && on[1]);
+
+  hostAdvanceMillis(PID_WINDOW_SIZE / 3);
+  request[0] = PID_WINDOW_SIZE / 2;
+  updatePowerBudget(*oven, request, minOn, on);
+  CHECK(on[0] && on[1]);
+  unsigned long onMs = 0;
+  while (millis() - oven->budget.windowStartTime < PID_WINDOW_SIZE && oven->budget.windowPlanned) {
+    updatePowerBudget(*oven, request, minOn, on);
+    if (on[0]) onMs += 10;
+    hostAdvanceMillis(10);
+  }
+  CHECK(onMs == PID_WINDOW_SIZE / 2);
+
+  // One heater allowed and rod2 holding the window: rod1 waits
+  oven = bootOven();
+  oven->settings.power.maxHeaters = 1;
+  request[0] = 0;
+  initializePowerBudget(*oven);
+  updatePowerBudget(*oven, request, minOn, on);
+  hostAdvanceMillis(PID_WINDOW_SIZE / 3);
+  request[0] = PID_WINDOW_SIZE / 2;
+  updatePowerBudget(*oven, request, minOn, on);
+  CHECK(!on[0] && on[1]);
+}
+
+int main() {
+  checkUnlimited();
+  checkLimits();
+  checkSsrReserves();
+  checkMidWindowRise();
+  return checkResult("test_power_budget");
+}
@@ -0,0 +1,78 @@
+// =================================================================
+// RS485 PACING
+// =================================================================
+// Multi-frame replies (DUMP_RECORDER, LOG_LIST, SCHEDULE_LIST) asked
+// for over RS485, with a 128-byte UART buffer drained at the 9600 baud
+// line rate: every frame must arrive, and none may go out through the
+// blocking flush() a full transmit queue falls back to.
+
+#include "../../oven_v10.ino"
+#include "check.h"
+#include <SD.h>
+#include <string>
+
+const int UART_BUFFER = 127;       // Due TX ring: availableForWrite() when empty
+const unsigned long PASS_MS = 1;   // One loop pass, and ~one byte at 9600 baud
+
+static std::string wireIn;
+
+static void pass() {
+  loop();
+  hostAdvanceMillis(PASS_MS);
+  Serial1.hostDrainTx(1);
+  if (Serial1.availableForWrite() > UART_BUFFER) Serial1.hostSetTxFree(UART_BUFFER);
+  wireIn += Serial1.hostTakeOutput();
+}
+
+static size_t countOf(const std::string &text, const std::string &what) {
+  size_t n = 0;
+  for (size_t at = text.find(what); at != std::string::npos; at = text.find(what, at + 1)) n++;
+  return n;
+}
+
+// Send 'command' on RS485 and pass until 'endMarker' has come back
+static std::string ask(const char* command, const char* endMarker) {
+  wireIn.clear();
+  Serial1.hostFeed(command);
+  for (int i = 0; i < 600000 && wireIn.find(endMarker) == std::string::npos; i++) pass();
+  size_t end = wireIn.find(endMarker);
+  CHECK(end != std::string::npos);
+  return wireIn.substr(0, end);
+}
+
+int main() {
+  hostResetClock();
+  hostFlashErase();
+  hostSdReset();
+  hostSetRtc(1792411200UL); // 2026-10-19 12:00:00
+  setup();
+  Serial1.hostClear();
+  Serial1.hostCapture(true);
+  Serial1.hostSetTxFree(UART_BUFFER);
+
+  // A full schedule and a month of day logs
+  for (int i = 0; i < MAX_SCHEDULED_JOBS; i++) {
+    char command[64];
+    snprintf(command, sizeof(command), "{\"cmd\":\"SCHEDULE_ADD\",\"start\":%lu}\n", 1792500000UL + i * 3600UL);
+    SerialUSB.hostFeed(command);
+    for (int p = 0; p < 10; p++) pass();
+  }
+  for (int d = 1; d <= 30; d++) {
+    char path[32];
+    snprintf(path, sizeof(path), "/LOGS/202609%02d.CSV", d);
+    hostSdWrite(path, "date,time,state\r\n");
+  }
+  // Two minutes of PID ticks for the recorder
+  for (int i = 0; i < 120000; i++) pass();
+  Serial1.hostClear();
+
+  std::string reply = ask("{\"cmd\":\"DUMP_RECORDER\"}\n", "{\"recorder\":\"end\"}");
+  CHECK(countOf(reply, "\r\n") >= 1000);
+  reply = ask("{\"cmd\":\"LOG_LIST\"}\n", "{\"log\":\"end\"");
+  CHECK(countOf(reply, "{\"log\":{\"name\"") >= 30);
+  reply = ask("{\"cmd\":\"SCHEDULE_LIST\"}\n", "{\"job\":\"end\",\"count\":16}");
+  CHECK(countOf(reply, "{\"job\":{\"id\"") == MAX_SCHEDULED_JOBS);
+
+  CHECK(Serial1.hostFlushCount() == 0);
+  return checkResult("test_rs485_pacing");
+}
@@ -0,0 +1,92 @@
+// =================================================================
+// SCHEDULED BAKES AND AUTOTUNE
+// =================================================================
+// With jobs queued the oven idles in AWAITING_SCHEDULE: autotune must
+// run from there, a job falling due must wait for the tune, and an
+// operator START_PREHEAT drops the one-shot jobs but keeps repeats.
+
+#include <Arduino.h>
+#include <DueFlashStorage.h>
+#include <memory>
+#include "check.h"
+#include "config.h"
+#include "autotune.h"
+#include "drivers.h"
+#include "oven_logic.h"
+#include "scheduler.h"
+#include "state_machine.h"
+#include "wallclock.h"
+
+const uint32_t NOW = 1792411200UL; // 2026-10-19 12:00:00 (Monday)
+
+static OvenController* boot() {
+  hostResetClock();
+  hostFlashErase();
+  hostSetRtc(NOW);
+  hostSetRtcLostPower(false);
+  initializeWallClock();
+  OvenController* oven = new OvenController();
+  initializeLogic(*oven);
+  for (uint8_t z = 0; z < ZONE_COUNT; z++) {
+    oven->zones.temp[z] = 25.0f;
+    oven->settings.thresholds.zone[z] = 200;
+  }
+  return oven;
+}
+
+static void queueJob(OvenController &oven, uint32_t startUnix, uint8_t repeatDays) {
+  ScheduledJob job = makeJobFromSettings(oven);
+  job.startUnix = startUnix;
+  job.repeatDays = repeatDays;
+  CHECK(addScheduledJob(oven, job));
+}
+
+static void runFor(OvenController &oven, unsigned long ms) {
+  for (unsigned long t = 0; t < ms; t += 10) {
+    updateStateMachine(oven);
+    updateRelayLogic(oven);
+    hostAdvanceMillis(10);
+  }
+}
+
+static void checkTuneWhileScheduled() {
+  std::unique_ptr<OvenController> oven(boot());
+  queueJob(*oven, NOW + 60, 0);
+  runFor(*oven, 100);
+  CHECK(oven->currentState == AWAITING_SCHEDULE);
+
+  const char* msg = NULL;
+  CHECK(startAutotune(*oven, SerialUSB, 0, 150, AUTOTUNE_RULE_ZN_PID, false, msg));
+
+  // The job falls due during the tune and waits for it
+  runFor(*oven, 90000);
+  CHECK(isAutotuneRunning(*oven));
+  CHECK(oven->currentState == AWAITING_SCHEDULE);
+  CHECK(isScheduledJobDue(*oven));
+
+  // Tune over: the job starts
+  abortAutotune(*oven, "test");
+  runFor(*oven, 100);
+  CHECK(oven->currentState == PREHEATING);
+  CHECK(!hasScheduledJobs(*oven));
+}
+
+static void checkManualPreheatDropsOneShots() {
+  std::unique_ptr<OvenController> oven(boot());
+  queueJob(*oven, NOW + 3600, 0);
+  queueJob(*oven, NOW + 7200, 0x02); // Mondays
+  runFor(*oven, 100);
+  CHECK(oven->settings.schedule.count == 2);
+
+  postOvenEvent(*oven, OVEN_EV_START_PREHEAT);
+  runFor(*oven, 100);
+  CHECK(oven->currentState == PREHEATING);
+  CHECK(oven->settings.schedule.count == 1);
+  CHECK(oven->settings.schedule.jobs[0].repeatDays == 0x02);
+}
+
+int main() {
+  checkTuneWhileScheduled();
+  checkManualPreheatDropsOneShots();
+  return checkResult("test_schedule_autotune");
+}
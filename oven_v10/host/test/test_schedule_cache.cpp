@@ -0,0 +1,99 @@
+// =================================================================
+// CACHED NEXT SCHEDULED START
+// =================================================================
+// The next job and its predicted start are kept between passes: a
+// ready-by lead follows the temperatures only every
+// SCHEDULE_REFRESH_SEC, while adding, cancelling or taking a job and a
+// preheat model change show at once.
+
+#include <Arduino.h>
+#include <DueFlashStorage.h>
+#include <memory>
+#include "check.h"
+#include "config.h"
+#include "drivers.h"
+#include "oven_logic.h"
+#include "scheduler.h"
+#include "wallclock.h"
+
+const uint32_t NOW = 1792411200UL; // 2026-10-19 12:00:00 (Monday)
+
+static OvenController* boot() {
+  hostResetClock();
+  hostFlashErase();
+  hostSetRtc(NOW);
+  hostSetRtcLostPower(false);
+  initializeWallClock();
+  OvenController* oven = new OvenController();
+  initializeLogic(*oven);
+  for (uint8_t z = 0; z < ZONE_COUNT; z++) {
+    oven->zones.temp[z] = 25.0f;
+    oven->settings.thresholds.zone[z] = 200;
+  }
+  return oven;
+}
+
+static uint32_t queueJob(OvenController &oven, uint32_t startUnix, uint8_t repeatDays) {
+  ScheduledJob job = makeJobFromSettings(oven);
+  job.startUnix = startUnix;
+  job.repeatDays = repeatDays;
+  CHECK(addScheduledJob(oven, job));
+  return job.id;
+}
+
+static void checkLeadRefresh() {
+  std::unique_ptr<OvenController> oven(boot());
+  uint32_t ready = NOW + 6 * 3600UL;
+  queueJob(*oven, ready, JOB_READY_BY);
+  uint32_t cold = nextScheduledStart(*oven);
+  CHECK(cold < ready);
+
+  // Warmer zones shorten the lead, but not before the next refresh
+  for (uint8_t z = 0; z < ZONE_COUNT; z++) oven->zones.temp[z] = 150.0f;
+  hostAdvanceMillis((SCHEDULE_REFRESH_SEC - 2) * 1000UL);
+  CHECK(nextScheduledStart(*oven) == cold);
+  hostAdvanceMillis(3000);
+  uint32_t warm = nextScheduledStart(*oven);
+  CHECK(warm > cold);
+  CHECK(nextScheduledReady(*oven) == ready);
+
+  // A model change applies at once
+  oven->settings.preheat.marginSec += 600;
+  invalidateScheduledStart(*oven);
+  CHECK(nextScheduledStart(*oven) == warm - 600);
+}
+
+static void checkQueueChanges() {
+  std::unique_ptr<OvenController> oven(boot());
+  uint32_t later = queueJob(*oven, NOW + 3600, 0);
+  CHECK(nextScheduledStart(*oven) == NOW + 3600);
+
+  uint32_t sooner = queueJob(*oven, NOW + 600, 0);
+  CHECK(nextScheduledStart(*oven) == NOW + 600);
+  CHECK(cancelScheduledJob(*oven, sooner));
+  CHECK(nextScheduledStart(*oven) == NOW + 3600);
+
+  // Taking the due job moves on to the next one straight away
+  queueJob(*oven, NOW + 5, 0);
+  CHECK(!isScheduledJobDue(*oven));
+  hostAdvanceMillis(6000);
+  CHECK(isScheduledJobDue(*oven));
+  ScheduledJob job;
+  CHECK(takeDueJob(*oven, job));
+  CHECK(job.startUnix == NOW + 5);
+  CHECK(!isScheduledJobDue(*oven));
+  CHECK(nextScheduledStart(*oven) == NOW + 3600);
+
+  CHECK(cancelScheduledJob(*oven, later));
+  CHECK(!hasScheduledJobs(*oven));
+  CHECK(nextScheduledStart(*oven) == 0);
+  queueJob(*oven, NOW + 900, 0);
+  cancelAllScheduledJobs(*oven);
+  CHECK(nextScheduledStart(*oven) == 0);
+}
+
+int main() {
+  checkLeadRefresh();
+  checkQueueChanges();
+  return checkResult("schedule_cache");
+}
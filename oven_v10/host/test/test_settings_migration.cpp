@@ -0,0 +1,103 @@
+// =================================================================
+// SETTINGS MIGRATION
+// =================================================================
+// Flash written by an older firmware keeps everything its layout had.
+// The tail offsets are the shipped 3-zone ones: v5 ends in a uint8_t
+// array, so its tail sits at 724, not where 'cascade' starts (728).
+
+#include <Arduino.h>
+#include <DueFlashStorage.h>
+#include <memory>
+#include <string.h>
+#include "check.h"
+#include "config.h"
+#include "drivers.h"
+
+// An older image: the current struct's bytes up to 'tailAt', then the tail
+static void writeImage(const PersistentSettings &fields, size_t tailAt, uint16_t version) {
+  std::vector<byte> image(tailAt + 6, 0xFF);
+  memcpy(image.data(), &fields, tailAt);
+  uint32_t magic = SETTINGS_MAGIC;
+  memcpy(&image[tailAt], &magic, sizeof(magic));
+  memcpy(&image[tailAt + 4], &version, sizeof(version));
+  hostFlashErase();
+  dueFlashStorage.write(0, image.data(), (uint32_t)image.size());
+}
+
+static void fillCommon(PersistentSettings &s) {
+  memset(&s, 0, sizeof(s));
+  s.thresholds.zone[0] = 210;
+  s.recipeTimeMinutes = 25;
+  s.holdingTimeMinutes = 40;
+  s.pid[1] = makePidParams(7.0, 0.5, 2.0);
+}
+
+static void checkV5() {
+  PersistentSettings old;
+  fillCommon(old);
+  old.model[2] = makeThermalModel(300, 600, 30);
+  old.ambientTemp = 21.0;
+  old.outputMode[0] = 1;
+  old.outputMode[2] = 2;
+  writeImage(old, 724, 5);
+
+  std::unique_ptr<OvenController> oven(new OvenController());
+  loadSettings(*oven);
+  CHECK(oven->settings.version == SETTINGS_VERSION);
+  CHECK(oven->settings.thresholds.zone[0] == 210);
+  CHECK(oven->settings.holdingTimeMinutes == 40);
+  CHECK_NEAR(oven->settings.pid[1].kp, 7.0, 0);
+  CHECK_NEAR(oven->settings.model[2].tau, 600, 0);
+  CHECK_NEAR(oven->settings.ambientTemp, 21.0, 0);
+  CHECK(oven->settings.outputMode[0] == 1);
+  CHECK(oven->settings.outputMode[2] == 2);
+  // Appended since v5: defaults
+  CHECK(!oven->settings.cascade.enabled);
+  CHECK_NEAR(oven->settings.cascade.rodMax, CASCADE_DEFAULT_ROD_MAX, 0);
+  CHECK(oven->settings.tuning[0].minOnMs == ZONE_TABLE[0].minOnMs);
+  CHECK(oven->settings.schedule.nextId == 1);
+
+  // Saved back in the current layout
+  std::unique_ptr<OvenController> again(new OvenController());
+  loadSettings(*again);
+  CHECK(memcmp(&again->settings, &oven->settings, sizeof(PersistentSettings)) == 0);
+}
+
+static void checkV10() {
+  PersistentSettings old;
+  fillCommon(old);
+  old.resume.maxOutageSec = 900;
+  old.schedule.count = 1;
+  old.schedule.nextId = 8;
+  old.schedule.jobs[0].id = 7;
+  old.schedule.jobs[0].startUnix = 1792411200UL;
+  writeImage(old, 1472, 10);
+
+  std::unique_ptr<OvenController> oven(new OvenController());
+  loadSettings(*oven);
+  CHECK(oven->settings.resume.maxOutageSec == 900);
+  CHECK(oven->settings.schedule.count == 1);
+  CHECK(oven->settings.schedule.jobs[0].id == 7);
+  CHECK(oven->settings.preheat.marginSec == PREHEAT_DEFAULT_MARGIN_SEC);
+}
+
+static void checkV11() {
+  PersistentSettings old;
+  fillCommon(old);
+  old.preheat.marginSec = 120;
+  writeImage(old, 1496, 11);
+
+  std::unique_ptr<OvenController> oven(new OvenController());
+  loadSettings(*oven);
+  CHECK(oven->settings.preheat.marginSec == 120);
+  // No supply limit until the installer sets one
+  CHECK(oven->settings.power.maxKw == 0);
+  CHECK(oven->settings.power.maxHeaters == 0);
+}
+
+int main() {
+  checkV5();
+  checkV10();
+  checkV11();
+  return checkResult("test_settings_migration");
+}
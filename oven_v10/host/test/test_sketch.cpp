@@ -0,0 +1,79 @@
+// =================================================================
+// SKETCH SMOKE TEST
+// =================================================================
+// Builds oven_v10.ino as-is and runs setup()/loop() on the virtual
+// clock: boots from blank flash, answers a command over USB, reports
+// status and writes the day log.
+
+#include "../../oven_v10.ino"
+#include "check.h"
+#include <SD.h>
+#include <algorithm>
+#include <memory>
+
+// Run loop() for 'ms' of virtual time, 'stepMs' per pass
+static void runFor(unsigned long ms, unsigned long stepMs = 5) {
+  for (unsigned long t = 0; t < ms; t += stepMs) {
+    loop();
+    hostAdvanceMillis(stepMs);
+  }
+}
+
+int main() {
+  hostResetClock();
+  hostFlashErase();
+  hostSdReset();
+  hostSetRtc(1792411200UL); // 2026-10-19 12:00:00
+  SerialUSB.hostCapture(true);
+
+  setup();
+  runFor(1000);
+  SerialUSB.hostTakeOutput();
+
+  SerialUSB.hostFeed("{\"cmd\":\"GET_POWER\"}\n");
+  runFor(100);
+  std::string reply = SerialUSB.hostTakeOutput();
+  CHECK(reply.find("{\"power\":{\"windows\":") != std::string::npos);
+  CHECK(reply.find("\"max_kw\":0") != std::string::npos);
+
+  // Installer's supply rating: kept in flash, below one heater refused
+  SerialUSB.hostFeed("{\"cmd\":\"SET_POWER_BUDGET\",\"max_kw\":1.5}\n");
+  runFor(100);
+  reply = SerialUSB.hostTakeOutput();
+  CHECK(reply.find("Invalid Max kW") != std::string::npos);
+  SerialUSB.hostFeed("{\"cmd\":\"SET_POWER_BUDGET\",\"max_kw\":6,\"max_heaters\":2}\n");
+  runFor(100);
+  reply = SerialUSB.hostTakeOutput();
+  CHECK(reply.find("Power Budget Saved") != std::string::npos);
+  std::unique_ptr<OvenController> reloaded(new OvenController());
+  loadSettings(*reloaded);
+  CHECK(reloaded->settings.power.maxKw == 6.0f);
+  CHECK(reloaded->settings.power.maxHeaters == 2);
+  SerialUSB.hostFeed("{\"cmd\":\"GET_POWER\"}\n");
+  runFor(100);
+  reply = SerialUSB.hostTakeOutput();
+  CHECK(reply.find("\"max_kw\":6,\"max_heaters\":2") != std::string::npos);
+
+  // A pass held up 4.5 s by relay switching delays is reported whole
+  profileEnd(oven, PROF_RELAY, profileStart() - 4500000UL);
+  SerialUSB.hostFeed("{\"cmd\":\"GET_PROFILE\"}\n");
+  runFor(100);
+  reply = SerialUSB.hostTakeOutput();
+  CHECK(reply.find("\"max_ns\":4500000000") != std::string::npos);
+
+  SerialUSB.hostFeed("{\"cmd\":\"NOPE\"}\n");
+  runFor(100);
+  reply = SerialUSB.hostTakeOutput();
+  CHECK(reply.find("Unknown cmd") != std::string::npos);
+
+  // Status every 3 s, with one row per update in today's log
+  runFor(7000);
+  reply = SerialUSB.hostTakeOutput();
+  CHECK(reply.find("\"state\":\"IDLE\"") != std::string::npos);
+  CHECK(reply.find("\"time\":\"2026-10-19T12:00:0") != std::string::npos);
+  std::string log = hostSdRead("/LOGS/20261019.CSV");
+  CHECK(log.compare(0, 15, "date,time,state") == 0);
+  CHECK(std::count(log.begin(), log.end(), '\n') >= 3);
+
+  return checkResult("test_sketch");
+}
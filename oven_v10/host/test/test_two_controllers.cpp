@@ -0,0 +1,129 @@
+// =================================================================
+// TWO CONTROLLERS
+// =================================================================
+// Every per-oven variable lives in OvenController, so controllers
+// never see each other: one preheating next to one idle in the same
+// thread, and identical simulations on two threads at once give the
+// same trace as a run on its own.
+
+#include <Arduino.h>
+#include <DueFlashStorage.h>
+#include <memory>
+#include <thread>
+#include <vector>
+#include "check.h"
+#include "config.h"
+#include "oven_logic.h"
+#include "state_machine.h"
+#include "power_budget.h"
+
+// Heater relay on = RELAY_ON (active low)
+static bool relayOn(uint8_t zone) {
+  return hostPinLevel(ZONE_TABLE[zone].relayPin) == RELAY_ON;
+}
+
+// First-order zone: 400 C rise at full power, 120 s time constant
+static void stepPlant(OvenController &oven, double dtSec) {
+  for (uint8_t z = 0; z < ZONE_COUNT; z++) {
+    double heat = oven.relayStates.zone[z] ? 400.0 : 0.0;
+    double temp = oven.zones.temp[z];
+    oven.zones.temp[z] = (float)(temp + (heat + 25.0 - temp) * dtSec / 120.0);
+  }
+}
+
+static void startBake(OvenController &oven, int threshold) {
+  for (uint8_t z = 0; z < ZONE_COUNT; z++) oven.settings.thresholds.zone[z] = threshold;
+  postOvenEvent(oven, OVEN_EV_START_PREHEAT);
+}
+
+static void boot(OvenController &oven) {
+  initializeLogic(oven);
+  for (uint8_t z = 0; z < ZONE_COUNT; z++) oven.zones.temp[z] = 25.0f;
+}
+
+// Same thread: one oven preheats, the other stays idle and dark
+static void checkSideBySide() {
+  hostResetClock();
+  hostResetPins();
+  hostFlashErase();
+  std::unique_ptr<OvenController> a(new OvenController());
+  std::unique_ptr<OvenController> b(new OvenController());
+  boot(*a);
+  boot(*b);
+  startBake(*a, 200);
+
+  bool bHeated = false;
+  for (int i = 0; i < 6000; i++) {
+    updateStateMachine(*a);
+    updateRelayLogic(*a);
+    updateStateMachine(*b);
+    updateRelayLogic(*b);
+    for (uint8_t z = 0; z < ZONE_COUNT; z++) bHeated = bHeated || b->relayStates.zone[z];
+    stepPlant(*a, 0.01);
+    stepPlant(*b, 0.01);
+    hostAdvanceMillis(10);
+  }
+  CHECK(a->currentState == PREHEATING);
+  CHECK(b->currentState == IDLE);
+  CHECK(!bHeated);
+  CHECK(a->zones.temp[0] > 30.0f);
+  CHECK(b->zones.temp[0] < 26.0f);
+  CHECK(getTransitionInfo(*a, 0).count == 1);
+  CHECK(getTransitionInfo(*b, 0).count == 0);
+  // Each controller ran its own control ticks and budget windows (A's
+  // relay switching delays share the thread clock, so counts differ)
+  CHECK(a->timer.stats.serviced > 500);
+  CHECK(b->timer.stats.serviced > 500);
+  CHECK(getPowerBudgetStats(*a).windows > 0);
+  CHECK(getPowerBudgetStats(*b).windows > 0);
+}
+
+// One full simulation on the calling thread's clock, pins and flash
+static std::vector<float> simulate(int threshold) {
+  hostResetClock();
+  hostResetPins();
+  hostFlashErase();
+  std::unique_ptr<OvenController> oven(new OvenController());
+  boot(*oven);
+  startBake(*oven, threshold);
+
+  std::vector<float> trace;
+  for (int i = 0; i < 30000; i++) {
+    updateStateMachine(*oven);
+    updateRelayLogic(*oven);
+    stepPlant(*oven, 0.01);
+    hostAdvanceMillis(10);
+    if (i % 100 == 0) {
+      for (uint8_t z = 0; z < ZONE_COUNT; z++) {
+        trace.push_back(oven->zones.temp[z]);
+        trace.push_back((float)oven->zones.output[z]);
+        trace.push_back(relayOn(z) ? 1.0f : 0.0f);
+      }
+      trace.push_back((float)oven->currentState);
+    }
+  }
+  return trace;
+}
+
+static void checkThreads() {
+  std::vector<float> reference = simulate(180);
+  std::vector<float> other = simulate(120);
+  CHECK(reference != other);
+
+  std::vector<float> t1, t2, t3;
+  std::thread a([&] { t1 = simulate(180); });
+  std::thread b([&] { t2 = simulate(120); });
+  std::thread c([&] { t3 = simulate(180); });
+  a.join();
+  b.join();
+  c.join();
+  CHECK(t1 == reference);
+  CHECK(t2 == other);
+  CHECK(t3 == reference);
+}
+
+int main() {
+  checkSideBySide();
+  checkThreads();
+  return checkResult("test_two_controllers");
+}
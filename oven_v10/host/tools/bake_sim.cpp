@@ -0,0 +1,123 @@
+#include "bake_sim.h"
+#include <DueFlashStorage.h>
+#include <math.h>
+#include <memory>
+#include <vector>
+#include "oven_logic.h"
+#include "state_machine.h"
+
+const unsigned long LOOP_MS = 10;   // One sketch loop() pass
+const double PLANT_STEP_SEC = 0.1;
+const size_t SETTLE_READS = 20;     // Readings averaged for the settle band (one minute)
+
+BakeScenario defaultBakeScenario() {
+  BakeScenario s;
+  const int thresholds[3] = {220, 200, 150};
+  for (uint8_t z = 0; z < ZONE_COUNT; z++) {
+    s.plant[z].gain = 350 + 50 * z;
+    s.plant[z].tau = 200 + 60 * z;
+    s.plant[z].deadTime = 9;
+    s.threshold[z] = thresholds[z % 3];
+  }
+  s.minutes = 40;
+  s.settleBand = 5.0;
+  return s;
+}
+
+BakeParams defaultBakeParams() {
+  BakeParams p;
+  for (uint8_t z = 0; z < ZONE_COUNT; z++) {
+    p.kp[z] = ZONE_TABLE[z].kp;
+    p.ki[z] = ZONE_TABLE[z].ki;
+    p.kd[z] = ZONE_TABLE[z].kd;
+    p.minOnMs[z] = ZONE_TABLE[z].minOnMs;
+    p.preheatTolerance[z] = ZONE_TABLE[z].preheatTolerance;
+  }
+  return p;
+}
+
+static void applyParams(OvenController &oven, const BakeScenario &scenario, const BakeParams &params) {
+  for (uint8_t z = 0; z < ZONE_COUNT; z++) {
+    PidParams &pid = oven.settings.pid[z];
+    pid.kp = params.kp[z];
+    pid.ki = params.ki[z];
+    pid.kd = params.kd[z];
+    oven.settings.gains[z].count = 0;
+    applyPidParams(oven.zonePid[z], pid);
+    oven.settings.tuning[z].minOnMs = params.minOnMs[z];
+    oven.settings.tuning[z].preheatTolerance = params.preheatTolerance[z];
+    oven.settings.thresholds.zone[z] = scenario.threshold[z];
+  }
+  // Hold for the whole run
+  oven.settings.holdingTimeMinutes = MAX_HOLDING_MINUTES;
+}
+
+void simulateBake(const BakeScenario &scenario, const BakeParams &params, double cost[SWEEP_COST_COUNT]) {
+  hostResetClock();
+  hostResetPins();
+  hostFlashErase();
+  std::unique_ptr<OvenController> oven(new OvenController());
+  initializeLogic(*oven);
+  applyParams(*oven, scenario, params);
+
+  std::vector<ThermalPlant> plants;
+  for (uint8_t z = 0; z < ZONE_COUNT; z++) {
+    plants.push_back(ThermalPlant(scenario.plant[z], PLANT_STEP_SEC));
+    oven->zones.temp[z] = (float)plants[z].temp();
+  }
+  postOvenEvent(*oven, OVEN_EV_START_PREHEAT);
+
+  const unsigned long start = millis();
+  const unsigned long runMs = (unsigned long)(scenario.minutes * 60000.0);
+  const unsigned long stepMs = (unsigned long)(PLANT_STEP_SEC * 1000);
+  unsigned long simulated = start, lastRead = start;
+  unsigned long readyAt = 0, settledAt = 0;
+  bool ready = false;
+  bool wasOn[ZONE_COUNT] = {};
+  double recent[ZONE_COUNT][SETTLE_READS] = {};
+  size_t reads = 0;
+  double overshoot = 0, cycles = 0;
+
+  while (millis() - start < runMs) {
+    updateStateMachine(*oven);
+    updateRelayLogic(*oven); // Relay switching delays move the clock too
+    hostAdvanceMillis(LOOP_MS);
+
+    for (uint8_t z = 0; z < ZONE_COUNT; z++) {
+      if (oven->heaterPinState[z] && !wasOn[z]) cycles++;
+      wasOn[z] = oven->heaterPinState[z];
+    }
+    for (; simulated + stepMs <= millis(); simulated += stepMs) {
+      for (uint8_t z = 0; z < ZONE_COUNT; z++) plants[z].step(oven->heaterPinState[z] ? 1.0 : 0.0);
+    }
+    if (!ready && oven->currentState == READY) {
+      ready = true;
+      readyAt = millis() - start;
+    }
+    if (millis() - lastRead >= (unsigned long)statusUpdateInterval) {
+      lastRead = millis();
+      bool inBand = true;
+      for (uint8_t z = 0; z < ZONE_COUNT; z++) {
+        double t = plants[z].temp();
+        oven->zones.temp[z] = (float)t;
+        if (t - scenario.threshold[z] > overshoot) overshoot = t - scenario.threshold[z];
+        // Relay ripple averages out over the last minute of readings
+        recent[z][reads % SETTLE_READS] = t;
+        double mean = 0;
+        for (size_t i = 0; i < SETTLE_READS; i++) mean += recent[z][i] / SETTLE_READS;
+        if (reads + 1 < SETTLE_READS || fabs(mean - scenario.threshold[z]) > scenario.settleBand) inBand = false;
+      }
+      reads++;
+      if (!inBand) settledAt = 0;
+      else if (settledAt == 0) settledAt = millis() - start;
+    }
+  }
+
+  double energyKwh = 0;
+  for (uint8_t z = 0; z < ZONE_COUNT; z++) energyKwh += plants[z].dutySeconds() * ZONE_TABLE[z].powerKw / 3600.0;
+  bool settled = ready && settledAt > 0;
+  cost[COST_OVERSHOOT] = overshoot;
+  cost[COST_SETTLE] = settled ? fmin(fmax(readyAt, settledAt), runMs) / 1000.0 : runMs / 1000.0;
+  cost[COST_CYCLES] = cycles;
+  cost[COST_ENERGY] = energyKwh;
+}
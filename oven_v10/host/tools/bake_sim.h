@@ -0,0 +1,46 @@
+#ifndef HOST_BAKE_SIM_H
+#define HOST_BAKE_SIM_H
+
+// =================================================================
+// BAKE SIMULATION
+// =================================================================
+// One preheat-and-hold of the real control code (state machine, PIDs,
+// power budget, relay output) on ThermalPlant zones, scored by the
+// sweep's cost terms. Everything lives in the call: its own
+// OvenController and plants, and the calling thread's virtual clock,
+// pins and flash (thread_local in the stubs), so workers may each run
+// one at a time in parallel and get the same result as alone.
+//
+// The sensors are read every statusUpdateInterval as in the sketch's
+// loop; the window is the one this build was compiled with
+// (PID_WINDOW_MS).
+
+#include "config.h"
+#include "param_search.h"
+#include "thermal_plant.h"
+
+struct BakeScenario {
+  PlantParams plant[ZONE_COUNT];
+  int threshold[ZONE_COUNT];
+  double minutes;      // Run length from START_PREHEAT, at most MAX_HOLDING_MINUTES
+  double settleBand;   // C either side of the threshold for the minute's mean reading
+};
+
+struct BakeParams {
+  double kp[ZONE_COUNT], ki[ZONE_COUNT], kd[ZONE_COUNT];
+  unsigned long minOnMs[ZONE_COUNT];
+  double preheatTolerance[ZONE_COUNT];
+};
+
+// Firmware defaults: ZONE_TABLE gains and tuning, thresholds of a
+// bread bake, and the plants of the host tests
+BakeScenario defaultBakeScenario();
+BakeParams defaultBakeParams();
+
+// Costs in SweepCost order. Settle time is when the oven is both READY
+// and every zone's mean over the last minute (TPC ripple averaged out)
+// has stayed within the band since; a run that ends before both scores
+// its full length.
+void simulateBake(const BakeScenario &scenario, const BakeParams &params, double cost[SWEEP_COST_COUNT]);
+
+#endif // HOST_BAKE_SIM_H
@@ -0,0 +1,198 @@
+#ifndef BASELINE_REFERENCE_H
+#define BASELINE_REFERENCE_H
+
+// =================================================================
+// BASELINE CONTROLLER (reference copy)
+// =================================================================
+// QuickPID and calculateTpcState() exactly as they were before the
+// controller rework, wrapped in a namespace. record_golden runs these
+// to produce golden/*.csv; the host tests replay those traces against
+// the current code. Do not "fix" anything in here: the constructor
+// still assigns controllerDirection to itself, so objects must have
+// static storage (zeroed member = DIRECT) to behave deterministically.
+
+#include <Arduino.h>
+
+namespace baseline {
+
+const int PID_COMPUTE_FREQ = 100; // Compute every 100ms
+const int PID_WINDOW_SIZE = 6000; // Time Proportional Control Window
+const int RELAY_ON  = LOW;
+const int RELAY_OFF = HIGH;
+
+class QuickPID {
+  public:
+    QuickPID(double* input, double* output, double* setpoint, double kp, double ki, double kd, int controllerDirection);
+    
+    // Configuration
+    void SetMode(int mode); // AUTOMATIC = 1, MANUAL = 0
+    void SetOutputLimits(double min, double max);
+    void SetTunings(double kp, double ki, double kd);
+    void SetPOn(int pOn);
+    
+    // Calculation (call this frequently)
+    bool Compute();
+
+    // Constants
+    static const int AUTOMATIC = 1;
+    static const int MANUAL    = 0;
+    static const int DIRECT    = 0;
+    static const int REVERSE   = 1;
+
+    static const int P_ON_E    = 1; // Proportional on Error (Default)
+    static const int P_ON_M    = 0; // Proportional on Measurement
+
+  private:
+    double dispKp, dispKi, dispKd;
+    double kp, ki, kd;
+    int controllerDirection;
+    
+    double *myInput;
+    double *myOutput;
+    double *mySetpoint;
+    
+    double iTerm, lastInput;
+    
+    unsigned long lastTime;
+    double outMin, outMax;
+    bool inAuto;
+    // Tracker for the mode
+    bool pOnE;
+};
+
+inline QuickPID::QuickPID(double* input, double* output, double* setpoint, double kp, double ki, double kd, int controllerDirection) {
+  myOutput = output;
+  myInput = input;
+  mySetpoint = setpoint;
+  inAuto = false;
+  
+  // Default to Standard PID
+  pOnE = true;
+
+  QuickPID::SetOutputLimits(0, 255); // Default PWM limits
+  controllerDirection = controllerDirection;
+  QuickPID::SetTunings(kp, ki, kd);
+  
+  lastTime = millis() - PID_COMPUTE_FREQ;
+}
+
+inline bool QuickPID::Compute() {
+  if (!inAuto) return false;
+  
+  unsigned long now = millis();
+  unsigned long timeChange = (now - lastTime);
+  
+  if (timeChange >= PID_COMPUTE_FREQ) { // Compute every x ms
+    // Inputs
+    double input = *myInput;
+    double error = *mySetpoint - input;
+    // Derivative DonM
+    double dInput = (input - lastInput);
+    // --- INTEGRAL & PROPORTIONAL CALCULATION ---
+    if (pOnE) {
+        // Standard PID: iTerm only holds Integral
+        iTerm += (ki * error);
+    } else {
+        // PonM: iTerm holds Integral MINUS Proportional change
+        // This effectively moves the P term into the storage
+        iTerm += (ki * error - kp * dInput);
+    }
+    if (iTerm > outMax) iTerm = outMax;
+    else if (iTerm < outMin) iTerm = outMin;
+    
+    // --- FINAL OUTPUT CALCULATION ---
+    double output;
+    if (pOnE) {
+        // Standard: P + I - D
+        output = kp * error + iTerm - kd * dInput;
+    } else {
+        // PonM: (I - P_accumulated) - D
+        // Since P is already inside iTerm, we just subtract D
+        output = iTerm - kd * dInput;
+    }
+    
+    // Clamp Output
+    if (output > outMax) output = outMax;
+    else if (output < outMin) output = outMin;
+    
+    *myOutput = output;
+    
+    // Save history
+    lastInput = input;
+    lastTime = now;
+    return true;
+  }
+  return false;
+}
+
+inline void QuickPID::SetTunings(double Kp, double Ki, double Kd) {
+  if (Kp < 0 || Ki < 0 || Kd < 0) return;
+  
+  dispKp = Kp; dispKi = Ki; dispKd = Kd;
+  
+  double SampleTimeInSec = (double)PID_COMPUTE_FREQ / 1000.0;
+  kp = Kp;
+  ki = Ki * SampleTimeInSec;
+  kd = Kd / SampleTimeInSec;
+  
+  if (controllerDirection == REVERSE) {
+    kp = (0 - kp);
+    ki = (0 - ki);
+    kd = (0 - kd);
+  }
+}
+// output clamping
+inline void QuickPID::SetOutputLimits(double Min, double Max) {
+  if (Min >= Max) return;
+  outMin = Min;
+  outMax = Max;
+  
+  if (inAuto) {
+    if (*myOutput > outMax) *myOutput = outMax;
+    else if (*myOutput < outMin) *myOutput = outMin;
+    
+    if (iTerm > outMax) iTerm = outMax;
+    else if (iTerm < outMin) iTerm = outMin;
+  }
+}
+
+inline void QuickPID::SetPOn(int pOn) {
+   pOnE = (pOn == P_ON_E);
+}
+
+inline void QuickPID::SetMode(int Mode) {
+  bool newAuto = (Mode == AUTOMATIC);
+  if (newAuto && !inAuto) {
+    // Initialize
+    iTerm = *myOutput;
+    lastInput = *myInput;
+    if (iTerm > outMax) iTerm = outMax;
+    else if (iTerm < outMin) iTerm = outMin;
+  }
+  inAuto = newAuto;
+}
+
+inline bool calculateTpcState(double pidOutput, unsigned long &windowStartTime, unsigned long min_actuation_time) {
+  unsigned long now = millis();
+  unsigned long relay_status = 0;
+  if (now - windowStartTime >= PID_WINDOW_SIZE) {
+    windowStartTime += PID_WINDOW_SIZE;
+  }
+  if (now - windowStartTime >= PID_WINDOW_SIZE) {
+      windowStartTime = now;
+  }
+  if (pidOutput > (now - windowStartTime)){
+    if(pidOutput >= min_actuation_time){
+      relay_status=RELAY_ON;
+    }
+    else{ relay_status=RELAY_OFF;}
+  }
+  else{
+     relay_status=RELAY_OFF;
+  } 
+  return relay_status; 
+}
+
+} // namespace baseline
+
+#endif // BASELINE_REFERENCE_H
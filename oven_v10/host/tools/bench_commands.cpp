@@ -0,0 +1,100 @@
+// =================================================================
+// COMMAND THROUGHPUT AND STACK DEPTH
+// =================================================================
+// For every command in command_corpus.h:
+//  - frames/s through processIncomingStream(), parse to reply, with
+//    the frames queued on USB as a burst from the HMI would be
+//  - peak stack the command needs: it runs once on a thread whose
+//    stack is painted with a pattern, and the bytes overwritten below
+//    the thread's own entry cost are counted
+// Host numbers (x86-64 frames, -O2): compare commands with each other
+// and runs with each other, not with the Due's cycle counts.
+//
+//   bench_commands [frames per command]
+//
+// Output is CSV on stdout: command,frames_per_sec,stack_bytes
+
+#include <Arduino.h>
+#include <DueFlashStorage.h>
+#include <chrono>
+#include <pthread.h>
+#include <string>
+#include <vector>
+#include "config.h"
+#include "app.h"
+#include "oven_logic.h"
+#include "command_corpus.h"
+
+const size_t STACK_SIZE = 256 * 1024;
+const uint8_t STACK_PAINT = 0xA5;
+
+static OvenController* oven = NULL;
+
+static double framesPerSec(const char* frame, unsigned long frames) {
+  std::string line = std::string(frame) + "\n";
+  std::string burst;
+  for (unsigned long i = 0; i < frames; i++) burst += line;
+  SerialUSB.hostClear();
+  SerialUSB.hostFeed(burst.data(), burst.size());
+
+  std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+  while (SerialUSB.available() > 0) processIncomingStream(*oven, SerialUSB);
+  double sec = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+  return sec > 0 ? frames / sec : 0;
+}
+
+struct StackRun {
+  const char* frame; // NULL: measure the thread's own entry cost
+};
+
+static void* runOnPaintedStack(void* arg) {
+  const StackRun* run = (const StackRun*)arg;
+  if (run->frame != NULL) {
+    hostResetClock();
+    SerialUSB.hostFeed((std::string(run->frame) + "\n").c_str());
+    processIncomingStream(*oven, SerialUSB);
+  }
+  return NULL;
+}
+
+// Deepest byte written below the top of a fresh, painted stack
+static size_t stackUsed(const char* frame) {
+  std::vector<uint8_t> stack(STACK_SIZE, STACK_PAINT);
+  pthread_attr_t attr;
+  pthread_attr_init(&attr);
+  pthread_attr_setstack(&attr, stack.data(), stack.size());
+  StackRun run = {frame};
+  pthread_t thread;
+  if (pthread_create(&thread, &attr, runOnPaintedStack, &run) != 0) {
+    fprintf(stderr, "bench_commands: cannot start the stack thread\n");
+    exit(1);
+  }
+  pthread_join(thread, NULL);
+  pthread_attr_destroy(&attr);
+
+  size_t untouched = 0;
+  while (untouched < stack.size() && stack[untouched] == STACK_PAINT) untouched++;
+  return stack.size() - untouched;
+}
+
+int main(int argc, char** argv) {
+  unsigned long frames = argc > 1 ? strtoul(argv[1], NULL, 10) : 2000;
+  if (frames == 0) frames = 1;
+
+  hostResetClock();
+  hostFlashErase();
+  oven = new OvenController();
+  initializeLogic(*oven);
+  SerialUSB.hostCapture(false);
+
+  size_t entryCost = stackUsed(NULL);
+  printf("command,frames_per_sec,stack_bytes\n");
+  for (size_t i = 0; i < COMMAND_CORPUS_SIZE; i++) {
+    const CorpusFrame &c = COMMAND_CORPUS[i];
+    double rate = framesPerSec(c.frame, frames);
+    size_t used = stackUsed(c.frame);
+    printf("%s,%.0f,%zu\n", c.command, rate, used > entryCost ? used - entryCost : 0);
+  }
+  delete oven;
+  return 0;
+}
@@ -0,0 +1,249 @@
+// =================================================================
+// CONTROL-LOOP HOT PATH BENCHMARK
+// =================================================================
+// Times, on the host build of the real sources, what runs per tick:
+//  - pid_compute       one zone QuickPID ComputeTick()
+//  - tpc_path          PID output -> on-time -> power budget -> relay
+//                      states, all zones (the old calculateTpcState())
+//  - relay_logic       updateRelayLogic(), relay pins stubbed
+//  - cmd_<COMMAND>     processIncomingStream() per command_corpus.h frame
+//  - status_update     sendStatusUpdate() serialization
+//  - log_row           logSystemData() formatting into the SD stub
+// and counts heap allocations per operation (malloc/calloc/realloc,
+// which String and operator new go through; the stubs' own are
+// included, so compare runs with each other).
+//
+//   bench_hotpaths [iterations] [baseline.csv [max_slowdown]]
+//
+// Output is CSV on stdout: name,ns_per_op,allocs_per_op. With a
+// baseline (a saved run of this tool) each row also gets the baseline
+// numbers and ok/REGRESSED: slower than max_slowdown times the
+// baseline (default 1.5, host timing is noisy), or more allocations
+// per op. Any regression makes the exit status 1. Refresh the stored
+// baseline with
+//
+//   bench_hotpaths 20000 > tools/bench_baseline.csv
+
+#include "../../oven_v10.ino"
+#include <DueFlashStorage.h>
+#include <SD.h>
+#include <chrono>
+#include <map>
+#include <string>
+#include "power_budget.h"
+#include "command_corpus.h"
+
+// Amortized growth of host containers (SD stub file, serial buffers)
+// shows as a few hundredths of an allocation per op
+const double ALLOC_SLACK = 0.05;
+const unsigned long MEASURE_BATCHES = 10;
+
+// =================================================================
+// ALLOCATION COUNTING
+// =================================================================
+// glibc lets the program replace malloc; these forward to it and count
+// while a benchmark is being measured.
+
+extern "C" void* __libc_malloc(size_t size);
+extern "C" void* __libc_calloc(size_t n, size_t size);
+extern "C" void* __libc_realloc(void* p, size_t size);
+extern "C" void __libc_free(void* p);
+
+static bool countingAllocs = false;
+static unsigned long allocCount = 0;
+
+extern "C" void* malloc(size_t size) {
+  if (countingAllocs) allocCount++;
+  return __libc_malloc(size);
+}
+
+extern "C" void* calloc(size_t n, size_t size) {
+  if (countingAllocs) allocCount++;
+  return __libc_calloc(n, size);
+}
+
+extern "C" void* realloc(void* p, size_t size) {
+  if (countingAllocs) allocCount++;
+  return __libc_realloc(p, size);
+}
+
+extern "C" void free(void* p) {
+  __libc_free(p);
+}
+
+// =================================================================
+// BENCHMARKS
+// =================================================================
+
+// Run one command to completion outside the measurements
+static void command(const char* frame) {
+  SerialUSB.hostFeed((std::string(frame) + "\n").c_str());
+  while (SerialUSB.available() > 0) processIncomingStream(oven, SerialUSB);
+}
+
+struct Result {
+  std::string name;
+  double nsPerOp;
+  double allocsPerOp;
+};
+
+static std::vector<Result> results;
+
+// Times 'iterations' calls of op() after a warm-up of the same length,
+// in MEASURE_BATCHES batches: the fastest batch gives ns/op, so a
+// batch the scheduler interrupted does not count
+template <typename Op>
+static void measure(const std::string &name, unsigned long iterations, Op op) {
+  for (unsigned long i = 0; i < iterations; i++) op();
+
+  unsigned long perBatch = iterations / MEASURE_BATCHES > 0 ? iterations / MEASURE_BATCHES : 1;
+  double best = 0;
+  allocCount = 0;
+  countingAllocs = true;
+  for (unsigned long b = 0; b < MEASURE_BATCHES; b++) {
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    for (unsigned long i = 0; i < perBatch; i++) op();
+    double ns = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+    if (b == 0 || ns < best) best = ns;
+  }
+  countingAllocs = false;
+
+  Result r = {name, best / perBatch, (double)allocCount / (perBatch * MEASURE_BATCHES)};
+  results.push_back(r);
+}
+
+static void benchPid(unsigned long iterations) {
+  PidReal input = (PidReal)180.0, output = (PidReal)0, setpoint = (PidReal)200.0;
+  QuickPID pid(&input, &output, &setpoint, ROD1_DEFAULT_KP, ROD1_DEFAULT_KI, ROD1_DEFAULT_KD, QuickPID::DIRECT);
+  pid.SetOutputLimits(0, PID_WINDOW_SIZE);
+  pid.SetAntiWindup(oven.settings.pid[0].tt);
+  pid.SetDerivativeFilter(oven.settings.pid[0].n);
+  pid.SetMode(QuickPID::AUTOMATIC);
+  unsigned long n = 0;
+  measure("pid_compute", iterations, [&]() {
+    // Input wanders so P, I and D all move
+    input = (PidReal)(180.0 + (double)(n++ % 40) * 0.5);
+    hostAdvanceMillis(PID_COMPUTE_FREQ);
+    pid.ComputeTick();
+  });
+}
+
+static void benchTpc(unsigned long iterations) {
+  unsigned long minOn[ZONE_COUNT];
+  for (uint8_t z = 0; z < ZONE_COUNT; z++) minOn[z] = oven.settings.tuning[z].minOnMs;
+  PidReal duty[ZONE_COUNT];
+  for (uint8_t z = 0; z < ZONE_COUNT; z++) duty[z] = (PidReal)(1500.0 + 1000.0 * z);
+  bool relayOn[ZONE_COUNT];
+  measure("tpc_path", iterations, [&]() {
+    hostAdvanceMillis(10);
+    unsigned long request[ZONE_COUNT];
+    for (uint8_t z = 0; z < ZONE_COUNT; z++) request[z] = outputToOnTime(duty[z]);
+    updatePowerBudget(oven, request, minOn, relayOn);
+  });
+}
+
+static void benchRelayLogic(unsigned long iterations) {
+  measure("relay_logic", iterations, [&]() {
+    hostAdvanceMillis(10);
+    updateRelayLogic(oven);
+  });
+}
+
+// One frame per op, queued up front as a burst from the HMI would be
+static void benchCommands(unsigned long iterations) {
+  for (size_t c = 0; c < COMMAND_CORPUS_SIZE; c++) {
+    const CorpusFrame &frame = COMMAND_CORPUS[c];
+    std::string line = std::string(frame.frame) + "\n";
+    std::string burst;
+    for (unsigned long i = 0; i < 2 * iterations; i++) burst += line;
+    SerialUSB.hostClear();
+    SerialUSB.hostFeed(burst.data(), burst.size());
+    measure(std::string("cmd_") + frame.command, iterations, [&]() {
+      processIncomingStream(oven, SerialUSB);
+    });
+    SerialUSB.hostClear();
+    // Leave the controller as the next command expects it
+    command("{\"cmd\":\"STOP\"}");
+    command("{\"cmd\":\"LOG_ABORT\"}");
+  }
+}
+
+static void benchStatus(unsigned long iterations) {
+  measure("status_update", iterations, [&]() { sendStatusUpdate(oven); });
+}
+
+static void benchLog(unsigned long iterations) {
+  measure("log_row", iterations, [&]() { logSystemData(oven); });
+}
+
+// =================================================================
+// BASELINE
+// =================================================================
+
+// name -> {ns_per_op, allocs_per_op} from a saved run
+static bool readBaseline(const char* path, std::map<std::string, Result> &baseline) {
+  FILE* f = fopen(path, "r");
+  if (f == NULL) return false;
+  char line[256];
+  while (fgets(line, sizeof(line), f) != NULL) {
+    char name[128];
+    double ns, allocs;
+    if (sscanf(line, "%127[^,],%lf,%lf", name, &ns, &allocs) != 3) continue; // Header
+    Result r = {name, ns, allocs};
+    baseline[name] = r;
+  }
+  fclose(f);
+  return true;
+}
+
+int main(int argc, char** argv) {
+  unsigned long iterations = argc > 1 ? strtoul(argv[1], NULL, 10) : 20000;
+  if (iterations == 0) iterations = 1;
+  const char* baselinePath = argc > 2 ? argv[2] : NULL;
+  double maxSlowdown = argc > 3 ? strtod(argv[3], NULL) : 1.5;
+
+  std::map<std::string, Result> baseline;
+  if (baselinePath != NULL && !readBaseline(baselinePath, baseline)) {
+    fprintf(stderr, "bench_hotpaths: cannot read %s\n", baselinePath);
+    return 1;
+  }
+
+  hostResetClock();
+  hostFlashErase();
+  hostSdReset();
+  hostSetRtc(1792411200UL); // 2026-10-19 12:00:00
+  setup();
+  SerialUSB.hostCapture(false);
+  Serial1.hostCapture(false);
+  command("{\"cmd\":\"SET_THRESHOLDS\",\"rod1\":220,\"rod2\":200,\"steam\":150,\"time\":25,\"holding\":30}");
+  command("{\"cmd\":\"START_PREHEAT\"}");
+  for (int i = 0; i < 100; i++) { loop(); hostAdvanceMillis(10); }
+
+  benchPid(iterations);
+  benchTpc(iterations);
+  benchRelayLogic(iterations);
+  benchStatus(iterations);
+  benchLog(iterations);
+  benchCommands(iterations);
+
+  bool regressed = false;
+  printf(baselinePath ? "name,ns_per_op,allocs_per_op,baseline_ns_per_op,baseline_allocs_per_op,status\n"
+                      : "name,ns_per_op,allocs_per_op\n");
+  for (size_t i = 0; i < results.size(); i++) {
+    const Result &r = results[i];
+    printf("%s,%.1f,%.2f", r.name.c_str(), r.nsPerOp, r.allocsPerOp);
+    if (baselinePath != NULL) {
+      std::map<std::string, Result>::const_iterator b = baseline.find(r.name);
+      if (b == baseline.end()) {
+        printf(",,,new");
+      } else {
+        bool slower = r.nsPerOp > b->second.nsPerOp * maxSlowdown;
+        bool allocs = r.allocsPerOp > b->second.allocsPerOp + ALLOC_SLACK;
+        printf(",%.1f,%.2f,%s", b->second.nsPerOp, b->second.allocsPerOp, slower || allocs ? "REGRESSED" : "ok");
+        regressed = regressed || slower || allocs;
+      }
+    }
+    printf("\n");
+  }
+  return regressed ? 1 : 0;
+}
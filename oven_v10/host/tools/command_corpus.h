@@ -0,0 +1,63 @@
+#ifndef HOST_COMMAND_CORPUS_H
+#define HOST_COMMAND_CORPUS_H
+
+// =================================================================
+// COMMAND CORPUS
+// =================================================================
+// One well-formed frame per command processIncomingStream() knows, as
+// the HMI sends them. The fuzzer mutates these; the benchmarks time
+// them one command at a time.
+
+struct CorpusFrame {
+  const char* command;
+  const char* frame; // Without the trailing newline
+};
+
+static const CorpusFrame COMMAND_CORPUS[] = {
+  {"SET_THRESHOLDS",    "{\"cmd\":\"SET_THRESHOLDS\",\"rod1\":220,\"rod2\":200,\"steam\":110,\"time\":25,\"holding\":30}"},
+  {"SET_PID",           "{\"cmd\":\"SET_PID\",\"target\":\"rod1\",\"kp\":8.5,\"ki\":0.05,\"kd\":2.0}"},
+  {"SET_GAINS",         "{\"cmd\":\"SET_GAINS\",\"target\":\"rod2\",\"key\":\"setpoint\",\"points\":[[100,6,0.04,1],[200,9,0.06,2]]}"},
+  {"GET_GAINS",         "{\"cmd\":\"GET_GAINS\"}"},
+  {"SET_MODEL",         "{\"cmd\":\"SET_MODEL\",\"target\":\"steam\",\"gain\":310,\"tau\":540,\"dead\":25,\"weight\":0.8,\"ambient\":24}"},
+  {"SET_OUTPUT_MODE",   "{\"cmd\":\"SET_OUTPUT_MODE\",\"target\":\"rod1\",\"mode\":\"tpc\"}"},
+  {"SET_CASCADE",       "{\"cmd\":\"SET_CASCADE\",\"enabled\":false,\"chamber\":180,\"kp\":2,\"ki\":0.01,\"kd\":0,\"min\":0,\"max\":260}"},
+  {"SET_ZONE_MODE",     "{\"cmd\":\"SET_ZONE_MODE\",\"target\":\"rod2\",\"mode\":\"pid\",\"band\":5}"},
+  {"SET_TUNING",        "{\"cmd\":\"SET_TUNING\",\"target\":\"rod1\",\"min_on\":2000,\"tolerance\":3}"},
+  {"GET_TUNING",        "{\"cmd\":\"GET_TUNING\"}"},
+  {"SET_PREHEAT_MODEL", "{\"cmd\":\"SET_PREHEAT_MODEL\",\"margin\":300}"},
+  {"GET_PREHEAT_MODEL", "{\"cmd\":\"GET_PREHEAT_MODEL\"}"},
+  {"SET_RESUME",        "{\"cmd\":\"SET_RESUME\",\"interval\":60,\"max_outage\":600}"},
+  {"SCHEDULE_ADD",      "{\"cmd\":\"SCHEDULE_ADD\",\"days\":[1,3,5],\"at\":420,\"rod1\":220,\"rod2\":200,\"steam\":110,\"time\":25}"},
+  {"SCHEDULE_LIST",     "{\"cmd\":\"SCHEDULE_LIST\"}"},
+  {"SCHEDULE_CANCEL",   "{\"cmd\":\"SCHEDULE_CANCEL\",\"id\":1}"},
+  {"SET_TIME",          "{\"cmd\":\"SET_TIME\",\"timestamp\":1792411200}"},
+  {"START_PREHEAT",     "{\"cmd\":\"START_PREHEAT\"}"},
+  {"RUN_RECIPE",        "{\"cmd\":\"RUN_RECIPE\"}"},
+  {"STOP",              "{\"cmd\":\"STOP\"}"},
+  {"TOGGLE_VALVE",      "{\"cmd\":\"TOGGLE_VALVE\",\"state\":false}"},
+  {"TOGGLE_LIGHT",      "{\"cmd\":\"TOGGLE_LIGHT\",\"state\":true}"},
+  {"DUMP_RECORDER",     "{\"cmd\":\"DUMP_RECORDER\",\"rearm\":true}"},
+  {"AUTOTUNE",          "{\"cmd\":\"AUTOTUNE\",\"target\":\"rod1\",\"setpoint\":150,\"commit\":false}"},
+  {"SET_POWER_BUDGET",  "{\"cmd\":\"SET_POWER_BUDGET\",\"max_kw\":6,\"max_heaters\":2}"},
+  {"GET_POWER",         "{\"cmd\":\"GET_POWER\"}"},
+  {"GET_TIMING",        "{\"cmd\":\"GET_TIMING\"}"},
+  {"GET_PROFILE",       "{\"cmd\":\"GET_PROFILE\"}"},
+  {"GET_TRANSITIONS",   "{\"cmd\":\"GET_TRANSITIONS\"}"},
+  {"LOG_LIST",          "{\"cmd\":\"LOG_LIST\"}"},
+  {"LOG_READ",          "{\"cmd\":\"LOG_READ\",\"file\":\"20261019.CSV\",\"offset\":0,\"len\":256}"},
+  {"LOG_ACK",           "{\"cmd\":\"LOG_ACK\",\"offset\":256}"},
+  {"LOG_ABORT",         "{\"cmd\":\"LOG_ABORT\"}"},
+};
+static const size_t COMMAND_CORPUS_SIZE = sizeof(COMMAND_CORPUS) / sizeof(COMMAND_CORPUS[0]);
+
+// Every key any command reads, for the fuzzer's generated objects
+static const char* const CORPUS_KEYS[] = {
+  "cmd", "target", "kp", "ki", "kd", "tt", "n", "b", "c", "key", "points", "gain", "tau",
+  "dead", "weight", "ambient", "mode", "enabled", "chamber", "min", "max", "band", "duty",
+  "min_on", "tolerance", "margin", "reset", "interval", "max_outage", "days", "at", "start",
+  "ready", "ready_at", "time", "holding", "schedule", "id", "all", "timestamp", "state",
+  "rearm", "setpoint", "rule", "commit", "file", "offset", "len", "rod1", "rod2", "steam",
+};
+static const size_t CORPUS_KEY_COUNT = sizeof(CORPUS_KEYS) / sizeof(CORPUS_KEYS[0]);
+
+#endif // HOST_COMMAND_CORPUS_H
@@ -0,0 +1,208 @@
+// =================================================================
+// PID BACKEND COMPARISON
+// =================================================================
+// Replays every golden/pid_*.csv (see test_golden_traces.cpp) through
+// BasicQuickPID<double>, <float> and <Fix16> and reports, per backend
+// and trace:
+//  - computes          Compute() calls in the trace
+//  - ret_mismatches    calls whose "computed" result differs from the golden
+//  - max_error         largest |output - golden| (ms of window for the
+//    rms_error         oven traces), and its RMS over the calls
+//  - cycles_per_call   TSC cycles (x86; 0 elsewhere) and ns per Compute()
+//    ns_per_call       over the whole replay: best of REPLAY_REPEATS
+//                      runs, clock stepping and input conversion included
+//
+//   compare_pid_backends [golden_dir] [max_float_error] [max_fix16_error]
+//
+// Output is CSV on stdout. With the limits given, a backend whose
+// max_error exceeds its limit on any trace, or any ret_mismatches for
+// double, makes the exit status 1.
+
+#include <Arduino.h>
+#include <algorithm>
+#include <chrono>
+#include <dirent.h>
+#include <fstream>
+#include <math.h>
+#include <memory>
+#include <stdlib.h>
+#include <string>
+#include <vector>
+#include "pid_lib.h"
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+
+const int REPLAY_REPEATS = 20;
+
+static uint64_t readCycles() {
+#if defined(__x86_64__) || defined(__i386__)
+  return __rdtsc();
+#else
+  return 0;
+#endif
+}
+
+// One trace row: t_ms,input,setpoint,op,a,b,c,ret,output
+enum TraceOp { OP_WRAP, OP_NEW, OP_FORCE, OP_MODE, OP_LIMITS, OP_TUNINGS, OP_PON, OP_COMPUTE };
+
+struct TraceRow {
+  unsigned long long tMs;
+  double input, setpoint;
+  TraceOp op;
+  double a, b, c;
+  int ret;
+  double output;
+};
+
+static bool parseOp(const std::string &s, TraceOp &op) {
+  static const char* const NAMES[] = {"wrap", "new", "force", "mode", "limits", "tunings", "pon", "compute"};
+  for (int i = 0; i < 8; i++) {
+    if (s == NAMES[i]) { op = (TraceOp)i; return true; }
+  }
+  return false;
+}
+
+static bool loadTrace(const std::string &path, std::vector<TraceRow> &rows) {
+  std::ifstream in(path.c_str());
+  std::string line;
+  if (!std::getline(in, line)) return false; // Header
+  while (std::getline(in, line)) {
+    if (line.empty()) continue;
+    std::vector<std::string> f;
+    size_t start = 0;
+    while (true) {
+      size_t comma = line.find(',', start);
+      f.push_back(line.substr(start, comma == std::string::npos ? std::string::npos : comma - start));
+      if (comma == std::string::npos) break;
+      start = comma + 1;
+    }
+    TraceRow r;
+    if (f.size() != 9 || !parseOp(f[3], r.op)) return false;
+    r.tMs = strtoull(f[0].c_str(), NULL, 10);
+    r.input = atof(f[1].c_str());
+    r.setpoint = atof(f[2].c_str());
+    r.a = atof(f[4].c_str());
+    r.b = atof(f[5].c_str());
+    r.c = atof(f[6].c_str());
+    r.ret = atoi(f[7].c_str());
+    r.output = atof(f[8].c_str());
+    rows.push_back(r);
+  }
+  return !rows.empty();
+}
+
+struct Comparison {
+  unsigned long computes = 0;
+  unsigned long retMismatches = 0;
+  double maxError = 0;
+  double sumSquares = 0;
+  double cyclesPerCall = 0;
+  double nsPerCall = 0;
+};
+
+// Runs the trace once; with 'result' set the outputs are scored
+template <typename T>
+static void replay(const std::vector<TraceRow> &rows, Comparison* result) {
+  typedef BasicQuickPID<T> Pid;
+  hostResetClock();
+  T input = T(0.0), output = T(0.0), setpoint = T(0.0);
+  std::unique_ptr<Pid> pid;
+
+  for (size_t i = 0; i < rows.size(); i++) {
+    const TraceRow &r = rows[i];
+    uint64_t target = r.tMs * 1000ULL;
+    if (target > hostMicros()) hostAdvanceMicros(target - hostMicros());
+    input = T(r.input);
+    setpoint = T(r.setpoint);
+    int ret = 0;
+
+    switch (r.op) {
+      case OP_WRAP:    hostWrapClockIn((uint64_t)r.a); break;
+      case OP_NEW:     pid.reset(new Pid(&input, &output, &setpoint, r.a, r.b, r.c, Pid::DIRECT)); break;
+      case OP_FORCE:   output = T(r.a); break;
+      case OP_MODE:    pid->SetMode((int)r.a); break;
+      case OP_LIMITS:  pid->SetOutputLimits(r.a, r.b); break;
+      case OP_TUNINGS: pid->SetTunings(r.a, r.b, r.c); break;
+      case OP_PON:     pid->SetPOn((int)r.a); break;
+      case OP_COMPUTE: ret = pid->Compute() ? 1 : 0; break;
+    }
+
+    if (result != NULL && r.op == OP_COMPUTE) {
+      double error = fabs((double)output - r.output);
+      result->computes++;
+      if (ret != r.ret) result->retMismatches++;
+      if (error > result->maxError) result->maxError = error;
+      result->sumSquares += error * error;
+    }
+  }
+}
+
+template <typename T>
+static Comparison compare(const std::vector<TraceRow> &rows) {
+  Comparison result;
+  replay<T>(rows, &result);
+  if (result.computes == 0) return result;
+
+  double bestNs = 0, bestCycles = 0;
+  for (int i = 0; i < REPLAY_REPEATS; i++) {
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    uint64_t startCycles = readCycles();
+    replay<T>(rows, NULL);
+    double cycles = (double)(readCycles() - startCycles);
+    double ns = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+    if (i == 0 || ns < bestNs) bestNs = ns;
+    if (i == 0 || cycles < bestCycles) bestCycles = cycles;
+  }
+  result.nsPerCall = bestNs / result.computes;
+  result.cyclesPerCall = bestCycles / result.computes;
+  return result;
+}
+
+static bool report(const char* backend, const std::string &trace, const Comparison &c, double maxError) {
+  double rms = c.computes > 0 ? sqrt(c.sumSquares / c.computes) : 0;
+  printf("%s,%s,%lu,%lu,%.6g,%.6g,%.1f,%.1f\n", backend, trace.c_str(), c.computes, c.retMismatches,
+         c.maxError, rms, c.cyclesPerCall, c.nsPerCall);
+  return maxError < 0 || c.maxError <= maxError;
+}
+
+int main(int argc, char** argv) {
+  std::string dir = argc > 1 ? argv[1] : GOLDEN_DIR;
+  double maxFloatError = argc > 2 ? strtod(argv[2], NULL) : -1;
+  double maxFix16Error = argc > 3 ? strtod(argv[3], NULL) : -1;
+
+  std::vector<std::string> traces;
+  DIR* d = opendir(dir.c_str());
+  if (d == NULL) {
+    fprintf(stderr, "compare_pid_backends: cannot open %s\n", dir.c_str());
+    return 1;
+  }
+  while (struct dirent* e = readdir(d)) {
+    std::string name = e->d_name;
+    if (name.compare(0, 4, "pid_") == 0 && name.size() > 4 && name.compare(name.size() - 4, 4, ".csv") == 0) {
+      traces.push_back(name);
+    }
+  }
+  closedir(d);
+  std::sort(traces.begin(), traces.end());
+
+  bool ok = true;
+  printf("backend,trace,computes,ret_mismatches,max_error,rms_error,cycles_per_call,ns_per_call\n");
+  for (size_t i = 0; i < traces.size(); i++) {
+    std::vector<TraceRow> rows;
+    if (!loadTrace(dir + "/" + traces[i], rows)) {
+      fprintf(stderr, "compare_pid_backends: cannot parse %s\n", traces[i].c_str());
+      return 1;
+    }
+    std::string name = traces[i].substr(0, traces[i].size() - 4);
+    Comparison exact = compare<double>(rows);
+    ok = report("double", name, exact, 1e-6) && exact.retMismatches == 0 && ok;
+    ok = report("float", name, compare<float>(rows), maxFloatError) && ok;
+    ok = report("fix16", name, compare<Fix16>(rows), maxFix16Error) && ok;
+  }
+  if (traces.empty()) {
+    fprintf(stderr, "compare_pid_backends: no pid_*.csv in %s\n", dir.c_str());
+    return 1;
+  }
+  return ok ? 0 : 1;
+}
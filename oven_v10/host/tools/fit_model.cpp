@@ -0,0 +1,78 @@
+// =================================================================
+// THERMAL MODEL FIT TOOL
+// =================================================================
+// Fits FOPDT and 2-node models per zone to one or more day logs (see
+// model_fit.h) and prints them, or the SET_MODEL commands that load
+// the FOPDT fits into the firmware's feedforward.
+//
+//   fit_model [--ambient C] [--max-dead s] [--commands] <log.csv>...
+//
+// Output is CSV on stdout:
+//   zone,model,samples,gain,tau,tau2,dead,ambient,rms
+// A zone whose data does not give a stable model is reported with
+// model "none". With --commands, one SET_MODEL line per fitted zone.
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <string>
+#include <vector>
+#include "model_fit.h"
+#include "config.h" // PID_WINDOW_SIZE
+
+static void printFit(const std::string &zone, const char* model, const ModelFit &fit) {
+  if (!fit.ok) {
+    printf("%s,none,%lu,,,,,,\n", zone.c_str(), fit.samples);
+    return;
+  }
+  printf("%s,%s,%lu,%.2f,%.1f,%.1f,%.1f,%.2f,%.3f\n", zone.c_str(), model, fit.samples,
+         fit.gain, fit.tau, fit.tau2, fit.deadTime, fit.ambient, fit.rmsError);
+}
+
+int main(int argc, char** argv) {
+  double ambient = NAN, maxDead = 180;
+  bool commands = false;
+  std::vector<const char*> paths;
+  for (int i = 1; i < argc; i++) {
+    if (strcmp(argv[i], "--ambient") == 0 && i + 1 < argc) ambient = strtod(argv[++i], NULL);
+    else if (strcmp(argv[i], "--max-dead") == 0 && i + 1 < argc) maxDead = strtod(argv[++i], NULL);
+    else if (strcmp(argv[i], "--commands") == 0) commands = true;
+    else paths.push_back(argv[i]);
+  }
+  if (paths.empty()) {
+    fprintf(stderr, "usage: fit_model [--ambient C] [--max-dead s] [--commands] <log.csv>...\n");
+    return 2;
+  }
+
+  std::vector<ZoneSeries> zones;
+  for (size_t i = 0; i < paths.size(); i++) {
+    FILE* in = fopen(paths[i], "r");
+    if (in == NULL) {
+      fprintf(stderr, "fit_model: cannot open %s\n", paths[i]);
+      return 1;
+    }
+    std::string error;
+    bool ok = loadZoneSeries(in, PID_WINDOW_SIZE, zones, error);
+    fclose(in);
+    if (!ok) {
+      fprintf(stderr, "fit_model: %s: %s\n", paths[i], error.c_str());
+      return 1;
+    }
+  }
+
+  if (!commands) printf("zone,model,samples,gain,tau,tau2,dead,ambient,rms\n");
+  for (size_t z = 0; z < zones.size(); z++) {
+    ModelFit fopdt = fitFopdt(zones[z], ambient, maxDead);
+    if (commands) {
+      if (fopdt.ok) {
+        printf("{\"cmd\":\"SET_MODEL\",\"target\":\"%s\",\"gain\":%.2f,\"tau\":%.1f,\"dead\":%.1f}\n",
+               zones[z].zone.c_str(), fopdt.gain, fopdt.tau, fopdt.deadTime);
+      }
+      continue;
+    }
+    printFit(zones[z].zone, "fopdt", fopdt);
+    printFit(zones[z].zone, "2node", fitTwoNode(zones[z], ambient, maxDead));
+  }
+  return 0;
+}
@@ -0,0 +1,202 @@
+// =================================================================
+// COMMAND FRAME FUZZER
+// =================================================================
+// Feeds generated, mutated and random frames to the sketch over USB
+// and RS485, split at random points as they arrive over the wire, and
+// runs loop() between the pieces. The fuzz_commands target is built
+// with AddressSanitizer and UBSan, so any memory error or undefined
+// behaviour aborts the run (non-zero exit, failed test). The run also
+// fails when, after any frame, a known command no longer gets its
+// reply on that port: a torn or oversized frame must never swallow
+// the next one.
+//
+// LLVMFuzzerTestOneInput() takes one input as a frame: the first byte
+// picks the port (bit 0) and seeds how the rest is split on the wire.
+// The sketch boots on the first input and carries its state from one
+// input to the next, as it does over a long session. Built with
+// -fsanitize=fuzzer (FUZZ_COMMANDS_LIBFUZZER) libFuzzer drives it;
+// otherwise main() below generates the frames and feeds them in:
+//
+//   fuzz_commands [frames] [seed]
+
+#include "../../oven_v10.ino"
+#include <DueFlashStorage.h>
+#include <SD.h>
+#include <random>
+#include <string>
+#include "command_corpus.h"
+
+static std::mt19937 rng;       // Frame generator (main() only)
+static std::mt19937 splitRng;  // Wire splits, seeded per input
+
+static uint32_t pick(uint32_t n, std::mt19937 &from = rng) {
+  return std::uniform_int_distribution<uint32_t>(0, n - 1)(from);
+}
+
+static std::string randomNumber() {
+  static const char* const EDGES[] = {
+    "0", "-1", "1e308", "-1e308", "1e-320", "4294967295", "4294967296", "-2147483649",
+    "18446744073709551615", "99999999999999999999999", "0.5", "-0", "1e", "NaN", "Infinity",
+  };
+  if (pick(3) == 0) return EDGES[pick(sizeof(EDGES) / sizeof(EDGES[0]))];
+  return std::to_string((int32_t)rng() >> pick(31));
+}
+
+static std::string randomValue(int depth);
+
+static std::string randomString() {
+  static const char* const WORDS[] = {
+    "rod1", "rod2", "steam", "chamber", "pid", "bang", "manual", "tpc", "burst", "window",
+    "pi", "tl", "no_overshoot", "measurement", "setpoint", "20261019.CSV", "../../x", "", "ON",
+  };
+  if (pick(4) > 0) return "\"" + std::string(WORDS[pick(sizeof(WORDS) / sizeof(WORDS[0]))]) + "\"";
+  std::string s = "\"";
+  for (uint32_t i = pick(40); i > 0; i--) {
+    char c = (char)(32 + pick(95));
+    if (c == '"' || c == '\\') s += '\\';
+    s += c;
+  }
+  if (pick(8) == 0) s += "\\u0000";
+  return s + "\"";
+}
+
+static std::string randomObject(int depth, bool withCmd) {
+  std::string s = "{";
+  if (withCmd) s += "\"cmd\":\"" + std::string(COMMAND_CORPUS[pick(COMMAND_CORPUS_SIZE)].command) + "\"";
+  for (uint32_t i = pick(6); i > 0; i--) {
+    if (s.size() > 1) s += ",";
+    s += "\"" + std::string(CORPUS_KEYS[pick(CORPUS_KEY_COUNT)]) + "\":" + randomValue(depth + 1);
+  }
+  return s + "}";
+}
+
+static std::string randomValue(int depth) {
+  switch (depth > 3 ? pick(4) : pick(7)) {
+    case 0: return randomNumber();
+    case 1: return randomString();
+    case 2: return pick(2) ? "true" : "false";
+    case 3: return "null";
+    case 4: case 5: {
+      std::string s = "[";
+      for (uint32_t i = pick(8); i > 0; i--) {
+        if (s.size() > 1) s += ",";
+        s += randomValue(depth + 1);
+      }
+      return s + "]";
+    }
+    default: return randomObject(depth, false);
+  }
+}
+
+static void mutate(std::string &s) {
+  for (uint32_t n = 1 + pick(8); n > 0; n--) {
+    size_t at = s.empty() ? 0 : pick((uint32_t)s.size());
+    switch (pick(5)) {
+      case 0: if (!s.empty()) s[at] = (char)(s[at] ^ (1 << pick(8))); break;
+      case 1: s.insert(at, 1, (char)pick(256)); break;
+      case 2: if (!s.empty()) s.erase(at, 1 + pick(8)); break;
+      case 3: s.insert(at, s.substr(pick((uint32_t)s.size() + 1), pick(64))); break;
+      default: s.insert(at, randomValue(2)); break;
+    }
+  }
+}
+
+static std::string nextFrame() {
+  std::string s;
+  switch (pick(6)) {
+    case 0: case 1:
+      s = randomObject(0, true);
+      break;
+    case 2: case 3:
+      s = COMMAND_CORPUS[pick(COMMAND_CORPUS_SIZE)].frame;
+      mutate(s);
+      break;
+    case 4:
+      for (uint32_t i = pick(600); i > 0; i--) s += (char)pick(256);
+      break;
+    default:
+      // Around and far past the line limit, padded so it stays valid JSON
+      s = COMMAND_CORPUS[pick(COMMAND_CORPUS_SIZE)].frame;
+      s.insert(1, 500 + pick(24) - s.size() + (pick(4) == 0 ? pick(2000) : 0), ' ');
+      break;
+  }
+  if (pick(10) > 0) s += '\n';
+  return s;
+}
+
+// Deliver in random pieces, one loop() pass per piece
+static void deliver(HardwareSerial &port, const std::string &data) {
+  size_t at = 0;
+  while (at < data.size()) {
+    size_t len = pick(3, splitRng) == 0 ? data.size() - at : 1 + pick((uint32_t)(data.size() - at), splitRng);
+    port.hostFeed(data.data() + at, len);
+    at += len;
+    loop();
+    hostAdvanceMillis(1 + pick(50, splitRng));
+  }
+}
+
+// A known command on a fresh line must be answered once the lines
+// still queued ahead of it (one per loop() pass) are through
+static bool probe(HardwareSerial &port) {
+  port.hostTakeOutput();
+  port.hostFeed("\n{\"cmd\":\"GET_TIMING\"}\n");
+  for (int i = 0; i < 1000 && port.available() > 0; i++) loop();
+  return port.hostTakeOutput().find("{\"timing\":") != std::string::npos;
+}
+
+static void bootSketch() {
+  hostResetClock();
+  hostFlashErase();
+  hostSdReset();
+  hostSetRtc(1792411200UL); // 2026-10-19 12:00:00
+  SerialUSB.hostCapture(true);
+  Serial1.hostCapture(true);
+  setup();
+}
+
+static HardwareSerial &inputPort(const uint8_t* data) {
+  return (data[0] & 1) ? Serial1 : SerialUSB;
+}
+
+// One input through the sketch; false if the probe got no reply
+static bool runInput(const uint8_t* data, size_t size) {
+  static bool booted = false;
+  if (size == 0) return true;
+  if (!booted) {
+    bootSketch();
+    booted = true;
+  }
+  HardwareSerial &port = inputPort(data);
+  splitRng.seed(data[0] >> 1);
+  deliver(port, std::string((const char*)data + 1, size - 1));
+  return probe(port);
+}
+
+extern "C" int LLVMFuzzerTestOneInput(const uint8_t* data, size_t size) {
+  if (!runInput(data, size)) {
+    fprintf(stderr, "fuzz_commands: no reply on %s\n", &inputPort(data) == &SerialUSB ? "USB" : "RS485");
+    abort();
+  }
+  return 0;
+}
+
+#ifndef FUZZ_COMMANDS_LIBFUZZER
+int main(int argc, char** argv) {
+  unsigned long frames = argc > 1 ? strtoul(argv[1], NULL, 10) : 20000;
+  unsigned long seed = argc > 2 ? strtoul(argv[2], NULL, 10) : 1;
+  rng.seed(seed);
+
+  for (unsigned long i = 0; i < frames; i++) {
+    std::string input(1, (char)pick(256));
+    input += nextFrame();
+    if (!runInput((const uint8_t*)input.data(), input.size())) {
+      fprintf(stderr, "fuzz_commands: no reply on %s after frame %lu (seed %lu)\n",
+              &inputPort((const uint8_t*)input.data()) == &SerialUSB ? "USB" : "RS485", i, seed);
+      return 1;
+    }
+  }
+  printf("fuzz_commands: %lu frames, seed %lu: ok\n", frames, seed);
+  return 0;
+}
+#endif
@@ -0,0 +1,137 @@
+#include "log_client.h"
+#include <stdio.h>
+#include <stdlib.h>
+
+// =================================================================
+// HELPERS
+// =================================================================
+
+uint32_t logCrc32(const uint8_t* data, size_t len, uint32_t crc) {
+  crc = ~crc;
+  for (size_t i = 0; i < len; i++) {
+    crc ^= data[i];
+    for (int b = 0; b < 8; b++) crc = (crc >> 1) ^ (0xEDB88320UL & (0 - (crc & 1)));
+  }
+  return ~crc;
+}
+
+static int base64Value(char c) {
+  if (c >= 'A' && c <= 'Z') return c - 'A';
+  if (c >= 'a' && c <= 'z') return c - 'a' + 26;
+  if (c >= '0' && c <= '9') return c - '0' + 52;
+  if (c == '+') return 62;
+  if (c == '/') return 63;
+  return -1;
+}
+
+bool logBase64Decode(const std::string &in, std::vector<uint8_t> &out) {
+  out.clear();
+  if (in.size() % 4 != 0) return false;
+  for (size_t i = 0; i < in.size(); i += 4) {
+    int pad = (in[i + 3] == '=') + (in[i + 2] == '=');
+    if (pad > 0 && i + 4 != in.size()) return false;
+    uint32_t v = 0;
+    for (int k = 0; k < 4; k++) {
+      int d = (k >= 4 - pad) ? 0 : base64Value(in[i + k]);
+      if (d < 0) return false;
+      v = (v << 6) | (uint32_t)d;
+    }
+    out.push_back((uint8_t)(v >> 16));
+    if (pad < 2) out.push_back((uint8_t)(v >> 8));
+    if (pad < 1) out.push_back((uint8_t)v);
+  }
+  return true;
+}
+
+// Value of "key" in a flat firmware frame: a string without escapes,
+// or a number up to the next ',' / '}'
+static bool field(const std::string &line, const char* key, std::string &value) {
+  std::string tag = std::string("\"") + key + "\":";
+  size_t at = line.find(tag);
+  if (at == std::string::npos) return false;
+  at += tag.size();
+  if (at < line.size() && line[at] == '"') {
+    size_t end = line.find('"', at + 1);
+    if (end == std::string::npos) return false;
+    value = line.substr(at + 1, end - at - 1);
+  } else {
+    size_t end = line.find_first_of(",}", at);
+    if (end == std::string::npos) return false;
+    value = line.substr(at, end - at);
+  }
+  return true;
+}
+
+// =================================================================
+// CLIENT
+// =================================================================
+
+LogClient::LogClient(const std::string &file, uint32_t offset)
+  : file(file), startOffset(offset), finished(false) {}
+
+std::string LogClient::readCommand() {
+  error.clear();
+  char line[128];
+  snprintf(line, sizeof(line), "{\"cmd\":\"LOG_READ\",\"file\":\"%s\",\"offset\":%lu,\"len\":0}",
+           file.c_str(), (unsigned long)offset());
+  return line;
+}
+
+std::string LogClient::ackCommand() const {
+  char line[64];
+  snprintf(line, sizeof(line), "{\"cmd\":\"LOG_ACK\",\"offset\":%lu}", (unsigned long)offset());
+  return line;
+}
+
+uint32_t LogClient::fileCrc() const {
+  return bytes.empty() ? 0 : logCrc32(bytes.data(), bytes.size());
+}
+
+std::string LogClient::receive(const std::string &line) {
+  if (finished || failed()) return "";
+  std::string value;
+
+  if (line.find("{\"chunk\":") == 0) {
+    std::string name, off, len, crc, data;
+    if (!field(line, "file", name) || !field(line, "off", off) || !field(line, "len", len)
+        || !field(line, "crc", crc) || !field(line, "data", data)) {
+      rejected++;
+      return ackCommand();
+    }
+    if (name != file) return "";
+    uint32_t chunkOffset = strtoul(off.c_str(), NULL, 10);
+    if (chunkOffset < offset()) {
+      // A resend of something already held (our ACK was lost)
+      duplicates++;
+      return ackCommand();
+    }
+    std::vector<uint8_t> decoded;
+    if (chunkOffset != offset() || !logBase64Decode(data, decoded)
+        || decoded.size() != strtoul(len.c_str(), NULL, 10)
+        || logCrc32(decoded.data(), decoded.size()) != strtoul(crc.c_str(), NULL, 16)) {
+      rejected++;
+      return ackCommand();
+    }
+    bytes.insert(bytes.end(), decoded.begin(), decoded.end());
+    chunks++;
+    return ackCommand();
+  }
+
+  if (field(line, "log_read", value) && value == "done") {
+    std::string name, size;
+    if (!field(line, "file", name) || name != file || !field(line, "size", size)) return "";
+    if (strtoul(size.c_str(), NULL, 10) != offset()) {
+      error = "oven reported size " + size + " but " + std::to_string(offset()) + " bytes were verified";
+      return "";
+    }
+    finished = true;
+    return "";
+  }
+
+  // The oven's own errors for this transfer
+  if (field(line, "status", value) && value == "error" && field(line, "msg", value)
+      && value.compare(0, 4, "Log ") == 0) {
+    error = value;
+  }
+  return "";
+}
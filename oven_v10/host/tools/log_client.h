@@ -0,0 +1,60 @@
+#ifndef HOST_LOG_CLIENT_H
+#define HOST_LOG_CLIENT_H
+
+// =================================================================
+// LOG DOWNLOAD CLIENT
+// =================================================================
+// The app side of LOG_READ / LOG_ACK (protocol in logger.h), without
+// any I/O: feed it every line the oven sends and write back what it
+// returns. A chunk is only taken at the offset it expects and when its
+// base64 decodes to 'len' bytes with the given CRC32; anything else is
+// answered with an ACK of the current offset, which makes the oven
+// resend from there. After a dropped link (no line for a while) send
+// readCommand() again: it resumes at the last verified offset.
+//
+// Done means the oven's final size was reached with every byte
+// verified; fileCrc() is then the CRC32 of everything received.
+
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+class LogClient {
+  public:
+    // 'file' as LOG_LIST names it; 'offset' > 0 appends to a partial download
+    explicit LogClient(const std::string &file, uint32_t offset = 0);
+
+    // LOG_READ from the current offset: the first request, and a resume
+    // (also after the oven gave up with "Log transfer timed out")
+    std::string readCommand();
+    // One line from the oven; returns the line to send back ("" = none)
+    std::string receive(const std::string &line);
+
+    bool done() const { return finished; }
+    bool failed() const { return !error.empty(); }
+    const std::string& errorMessage() const { return error; }
+
+    const std::vector<uint8_t>& data() const { return bytes; }
+    uint32_t offset() const { return startOffset + (uint32_t)bytes.size(); }
+    uint32_t fileCrc() const;
+
+    unsigned long chunks = 0;     // Chunks accepted
+    unsigned long rejected = 0;   // Bad CRC/length/encoding, answered with a re-ACK
+    unsigned long duplicates = 0; // Resent chunks already held
+
+  private:
+    std::string ackCommand() const;
+
+    std::string file;
+    uint32_t startOffset;
+    std::vector<uint8_t> bytes;
+    bool finished;
+    std::string error;
+};
+
+// CRC-32 (IEEE, as logger.cpp computes it per chunk)
+uint32_t logCrc32(const uint8_t* data, size_t len, uint32_t crc = 0);
+// False on a character outside the base64 alphabet or a bad length
+bool logBase64Decode(const std::string &in, std::vector<uint8_t> &out);
+
+#endif // HOST_LOG_CLIENT_H
@@ -0,0 +1,150 @@
+// =================================================================
+// LOG DOWNLOAD TOOL
+// =================================================================
+// Downloads a day log from the oven over its USB or RS485 serial port
+// (see log_client.h), verifying every chunk, and writes it to a file.
+//
+//   log_download <port> <YYYYMMDD.CSV> [out_file] [baud]
+//
+// 'port' is the serial device (/dev/ttyACM0, or the RS485 adapter at
+// 9600 baud, the default). If out_file already holds part of the log
+// the download resumes after it. A link silent for LINK_TIMEOUT_MS
+// gets a fresh LOG_READ at the last verified offset, up to
+// LINK_MAX_RESUMES times. Prints the size and CRC32 of the file.
+
+#include <errno.h>
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <string>
+#include <sys/select.h>
+#include <termios.h>
+#include <unistd.h>
+#include "log_client.h"
+
+const int LINK_TIMEOUT_MS = 5000;
+const int LINK_MAX_RESUMES = 10;
+
+static speed_t baudConstant(unsigned long baud) {
+  switch (baud) {
+    case 9600:   return B9600;
+    case 19200:  return B19200;
+    case 38400:  return B38400;
+    case 57600:  return B57600;
+    case 115200: return B115200;
+    default:     return 0;
+  }
+}
+
+static int openPort(const char* path, unsigned long baud) {
+  int fd = open(path, O_RDWR | O_NOCTTY);
+  if (fd < 0) return -1;
+  struct termios tio;
+  if (tcgetattr(fd, &tio) == 0) {
+    cfmakeraw(&tio);
+    cfsetispeed(&tio, baudConstant(baud));
+    cfsetospeed(&tio, baudConstant(baud));
+    tio.c_cflag |= CLOCAL | CREAD;
+    tcsetattr(fd, TCSANOW, &tio);
+  }
+  tcflush(fd, TCIOFLUSH);
+  return fd;
+}
+
+static bool sendLine(int fd, const std::string &line) {
+  std::string out = line + "\n";
+  return write(fd, out.data(), out.size()) == (ssize_t)out.size();
+}
+
+// Next complete line into 'line'; false after timeoutMs of silence
+static bool readLine(int fd, std::string &pending, std::string &line, int timeoutMs) {
+  while (true) {
+    size_t nl = pending.find('\n');
+    if (nl != std::string::npos) {
+      line = pending.substr(0, nl);
+      if (!line.empty() && line[line.size() - 1] == '\r') line.erase(line.size() - 1);
+      pending.erase(0, nl + 1);
+      return true;
+    }
+    fd_set fds;
+    FD_ZERO(&fds);
+    FD_SET(fd, &fds);
+    struct timeval tv = {timeoutMs / 1000, (timeoutMs % 1000) * 1000};
+    if (select(fd + 1, &fds, NULL, NULL, &tv) <= 0) return false;
+    char buf[512];
+    ssize_t n = read(fd, buf, sizeof(buf));
+    if (n <= 0) return false;
+    pending.append(buf, n);
+  }
+}
+
+int main(int argc, char** argv) {
+  if (argc < 3) {
+    fprintf(stderr, "usage: log_download <port> <YYYYMMDD.CSV> [out_file] [baud]\n");
+    return 2;
+  }
+  const char* name = argv[2];
+  std::string outPath = argc > 3 ? argv[3] : name;
+  unsigned long baud = argc > 4 ? strtoul(argv[4], NULL, 10) : 9600;
+  if (baudConstant(baud) == 0) {
+    fprintf(stderr, "log_download: unsupported baud %lu\n", baud);
+    return 2;
+  }
+
+  // Resume after whatever a previous run saved
+  std::string previous;
+  if (FILE* f = fopen(outPath.c_str(), "rb")) {
+    char buf[4096];
+    size_t n;
+    while ((n = fread(buf, 1, sizeof(buf), f)) > 0) previous.append(buf, n);
+    fclose(f);
+  }
+  LogClient client(name, (uint32_t)previous.size());
+
+  int fd = openPort(argv[1], baud);
+  if (fd < 0) {
+    fprintf(stderr, "log_download: cannot open %s: %s\n", argv[1], strerror(errno));
+    return 1;
+  }
+
+  std::string pending, line;
+  int resumes = 0;
+  sendLine(fd, client.readCommand());
+  while (!client.done()) {
+    // The oven gives up on a link that stopped acknowledging: resume too
+    bool gaveUp = client.failed() && client.errorMessage() == "Log transfer timed out";
+    if (client.failed() && !gaveUp) break;
+    if (gaveUp || !readLine(fd, pending, line, LINK_TIMEOUT_MS)) {
+      if (++resumes > LINK_MAX_RESUMES) break;
+      fprintf(stderr, "log_download: no reply, resuming at %lu\n", (unsigned long)client.offset());
+      sendLine(fd, client.readCommand());
+      continue;
+    }
+    std::string reply = client.receive(line);
+    if (!reply.empty()) sendLine(fd, reply);
+  }
+  if (!client.done()) sendLine(fd, "{\"cmd\":\"LOG_ABORT\"}");
+  close(fd);
+
+  // Keep what was verified even on failure, so the next run resumes
+  FILE* out = fopen(outPath.c_str(), "ab");
+  if (out == NULL) {
+    fprintf(stderr, "log_download: cannot write %s\n", outPath.c_str());
+    return 1;
+  }
+  fwrite(client.data().data(), 1, client.data().size(), out);
+  fclose(out);
+
+  if (!client.done()) {
+    fprintf(stderr, "log_download: %s: %s (kept %lu bytes)\n", name,
+            client.failed() ? client.errorMessage().c_str() : "link lost", (unsigned long)client.offset());
+    return 1;
+  }
+  std::vector<uint8_t> all(previous.begin(), previous.end());
+  all.insert(all.end(), client.data().begin(), client.data().end());
+  printf("%s %lu bytes crc32 %08lx (%lu chunks, %lu rejected, %lu resent)\n", outPath.c_str(),
+         (unsigned long)all.size(), (unsigned long)(all.empty() ? 0 : logCrc32(all.data(), all.size())),
+         client.chunks, client.rejected, client.duplicates);
+  return 0;
+}
@@ -0,0 +1,475 @@
+#include "log_replay.h"
+#include <Arduino.h>
+#include <DueFlashStorage.h>
+#include <RTClib.h>
+#include <limits.h>
+#include <math.h>
+#include <memory>
+#include <string.h>
+#include "config.h"
+#include "app.h"         // Needs isStatusUpdateDue()
+#include "oven_logic.h"
+#include "state_machine.h"
+#include "wallclock.h"
+#include "zone_mode.h"
+
+const size_t REPLAY_LINE_SIZE = 4096;
+const int REPLAY_MAX_FIELDS = 128;
+// Gains are logged with 4 decimals (2 in the baseline log), temperatures with 2
+const double REPLAY_GAIN_EPSILON = 1e-4;
+const double REPLAY_LEGACY_GAIN_EPSILON = 0.005;
+const double REPLAY_TEMP_ROUNDING = 0.005;
+// TPC window phase search: candidates this far apart, scored on the
+// relay columns of the first rows of each section
+const unsigned long REPLAY_PHASE_STEP_MS = 500;
+const size_t REPLAY_ALIGN_ROWS = 100;
+// Relay on-fraction is compared over blocks of this many rows (10 min)
+const unsigned long REPLAY_DUTY_ROWS = 200;
+
+// Field index of every column the replay reads
+struct ReplayLayout {
+  int date, time, state;
+  int set[ZONE_COUNT], live[ZONE_COUNT];
+  int kp[ZONE_COUNT], ki[ZONE_COUNT], kd[ZONE_COUNT], pid[ZONE_COUNT], sp[ZONE_COUNT], iterm[ZONE_COUNT];
+  int mode[ZONE_COUNT];
+  int rel[ZONE_COUNT];
+  int valve;
+  int fieldCount;
+  bool legacy; // Baseline header: no sp_, iterm_ or mode_ columns
+};
+
+struct ReplayRow {
+  uint32_t unixTime;
+  OvenState state;
+  int threshold[ZONE_COUNT];
+  float temp[ZONE_COUNT];
+  double kp[ZONE_COUNT], ki[ZONE_COUNT], kd[ZONE_COUNT];
+  double pid[ZONE_COUNT], sp[ZONE_COUNT], iterm[ZONE_COUNT];
+  ZoneMode mode[ZONE_COUNT];
+  bool relay[ZONE_COUNT];
+  bool valve;
+  bool seedFromOutput; // No iterm_ logged: seed the PIDs from pid_
+  double gainEpsilon;
+};
+
+struct StateName {
+  const char* name;
+  OvenState state;
+};
+
+struct LegacyZoneName {
+  const char* name;
+  const char* legacy;
+};
+
+// Zones the baseline log named differently
+static const LegacyZoneName LEGACY_ZONE_NAMES[] = {
+  {"steam", "rod3"},
+};
+
+// As logSystemData() writes them
+static const StateName STATE_NAMES[] = {
+  {"IDLE", IDLE}, {"PREHEAT", PREHEATING}, {"READY", READY},
+  {"RUNNING", RUNNING}, {"DONE", ALARM_COMPLETION}, {"SCHED", AWAITING_SCHEDULE},
+};
+
+// =================================================================
+// PARSING
+// =================================================================
+
+// Split 'line' in place at commas, dropping the line ending
+static int splitFields(char* line, char** fields, int maxFields) {
+  size_t len = strlen(line);
+  while (len > 0 && (line[len - 1] == '\n' || line[len - 1] == '\r')) line[--len] = '\0';
+  if (len == 0) return 0;
+
+  int count = 0;
+  char* p = line;
+  while (count < maxFields) {
+    fields[count++] = p;
+    char* comma = strchr(p, ',');
+    if (comma == NULL) break;
+    *comma = '\0';
+    p = comma + 1;
+  }
+  return count;
+}
+
+static bool findColumn(char** fields, int count, const char* prefix, const char* zone, int &index, std::string &error) {
+  std::string name = std::string(prefix) + zone;
+  for (int i = 0; i < count; i++) {
+    if (name == fields[i]) {
+      index = i;
+      return true;
+    }
+  }
+  error = "log has no column " + name;
+  return false;
+}
+
+// Column name of zone 'z' in this header: its ZONE_TABLE name, or
+// the name the baseline log gave it
+static const char* zoneColumnName(char** fields, int count, uint8_t z) {
+  const char* zone = ZONE_TABLE[z].name;
+  int index;
+  std::string unused;
+  if (findColumn(fields, count, "set_", zone, index, unused)) return zone;
+  for (size_t i = 0; i < sizeof(LEGACY_ZONE_NAMES) / sizeof(LEGACY_ZONE_NAMES[0]); i++) {
+    if (strcmp(zone, LEGACY_ZONE_NAMES[i].name) == 0) return LEGACY_ZONE_NAMES[i].legacy;
+  }
+  return zone;
+}
+
+static bool readLayout(char** fields, int count, ReplayLayout &layout, std::string &error) {
+  layout.fieldCount = count;
+  bool ok = findColumn(fields, count, "date", "", layout.date, error) &&
+            findColumn(fields, count, "time", "", layout.time, error) &&
+            findColumn(fields, count, "state", "", layout.state, error) &&
+            findColumn(fields, count, "rel_valve", "", layout.valve, error);
+  // The baseline firmware logged set/live/K*/pid/rel only
+  int index;
+  std::string unused;
+  layout.legacy = ok && !findColumn(fields, count, "sp_", zoneColumnName(fields, count, 0), index, unused);
+  for (uint8_t z = 0; ok && z < ZONE_COUNT; z++) {
+    const char* zone = zoneColumnName(fields, count, z);
+    ok = findColumn(fields, count, "set_", zone, layout.set[z], error) &&
+         findColumn(fields, count, "live_", zone, layout.live[z], error) &&
+         findColumn(fields, count, "Kp_", zone, layout.kp[z], error) &&
+         findColumn(fields, count, "Ki_", zone, layout.ki[z], error) &&
+         findColumn(fields, count, "Kd_", zone, layout.kd[z], error) &&
+         findColumn(fields, count, "pid_", zone, layout.pid[z], error) &&
+         findColumn(fields, count, "rel_", zone, layout.rel[z], error);
+    if (layout.legacy) {
+      layout.sp[z] = layout.iterm[z] = layout.mode[z] = -1;
+    } else {
+      ok = ok && findColumn(fields, count, "sp_", zone, layout.sp[z], error) &&
+           findColumn(fields, count, "iterm_", zone, layout.iterm[z], error) &&
+           findColumn(fields, count, "mode_", zone, layout.mode[z], error);
+    }
+  }
+  return ok;
+}
+
+static bool parseNumber(const char* field, double &value) {
+  char* end;
+  value = strtod(field, &end);
+  return end != field && *end == '\0';
+}
+
+static bool parseRow(char** fields, int count, const ReplayLayout &layout, ReplayRow &row) {
+  if (count != layout.fieldCount) return false;
+
+  int y, mo, d, h, mi, s;
+  if (sscanf(fields[layout.date], "%d-%d-%d", &y, &mo, &d) != 3) return false;
+  if (sscanf(fields[layout.time], "%d:%d:%d", &h, &mi, &s) != 3) return false;
+  row.unixTime = DateTime(y, mo, d, h, mi, s).unixtime();
+
+  bool known = false;
+  for (size_t i = 0; i < sizeof(STATE_NAMES) / sizeof(STATE_NAMES[0]); i++) {
+    if (strcmp(fields[layout.state], STATE_NAMES[i].name) == 0) {
+      row.state = STATE_NAMES[i].state;
+      known = true;
+    }
+  }
+  if (!known) return false;
+  bool heating = row.state == PREHEATING || row.state == READY || row.state == RUNNING;
+  row.seedFromOutput = layout.legacy;
+  row.gainEpsilon = layout.legacy ? REPLAY_LEGACY_GAIN_EPSILON : REPLAY_GAIN_EPSILON;
+
+  for (uint8_t z = 0; z < ZONE_COUNT; z++) {
+    double set, live;
+    if (!parseNumber(fields[layout.set[z]], set)) return false;
+    // A faulted probe is logged as "nan"
+    if (!parseNumber(fields[layout.live[z]], live)) live = NAN;
+    row.threshold[z] = (int)set;
+    row.temp[z] = (float)live;
+    if (!parseNumber(fields[layout.kp[z]], row.kp[z]) || !parseNumber(fields[layout.ki[z]], row.ki[z]) ||
+        !parseNumber(fields[layout.kd[z]], row.kd[z]) || !parseNumber(fields[layout.pid[z]], row.pid[z])) {
+      return false;
+    }
+    if (layout.legacy) {
+      // Baseline zones were all PID, aiming at the threshold while heating
+      row.sp[z] = heating ? set : 0;
+      row.iterm[z] = 0;
+      row.mode[z] = ZONE_MODE_PID;
+      row.relay[z] = fields[layout.rel[z]][0] == '1';
+      continue;
+    }
+    if (!parseNumber(fields[layout.sp[z]], row.sp[z]) || !parseNumber(fields[layout.iterm[z]], row.iterm[z])) return false;
+    bool valid;
+    row.mode[z] = parseZoneMode(fields[layout.mode[z]], valid);
+    if (!valid) return false;
+    row.relay[z] = fields[layout.rel[z]][0] == '1';
+  }
+  row.valve = fields[layout.valve][0] == '1';
+  return true;
+}
+
+// =================================================================
+// SIMULATION
+// =================================================================
+
+// One replay of a section of log (rows under one header)
+struct ReplayRun {
+  std::unique_ptr<OvenController> oven;
+  bool seeded = false;
+  uint32_t lastTime = 0;     // Wall clock of the previous row
+  unsigned long lastRowMs = 0; // millis() the previous row fell on
+  // Current duty block: rows, and relay-on rows replayed/logged per zone
+  unsigned long dutyRows = 0;
+  unsigned long replayedOn[ZONE_COUNT] = {};
+  unsigned long loggedOn[ZONE_COUNT] = {};
+};
+
+// Fresh controller with its TPC window 'phaseMs' along when the first
+// row is applied
+static void startController(ReplayRun &run, uint32_t unixTime, unsigned long phaseMs, const ReplayOptions &options) {
+  hostResetClock();
+  hostFlashErase();
+  hostSetRtc(unixTime);
+  hostSetRtcLostPower(false);
+  initializeWallClock();
+  run.oven.reset(new OvenController());
+  initializeLogic(*run.oven);
+  // The log holds the gains in use; schedules would move them again
+  for (uint8_t z = 0; z < ZONE_COUNT; z++) {
+    run.oven->settings.gains[z].count = 0;
+    applyGainSchedule(run.oven->zonePid[z], run.oven->settings.gains[z]);
+  }
+  run.oven->settings.power.maxKw = (float)options.maxKw;
+  run.oven->settings.power.maxHeaters = (uint8_t)options.maxHeaters;
+  hostAdvanceMillis(phaseMs);
+  run.seeded = false;
+}
+
+// Move to a logged state the state machine did not reach by itself,
+// stamping the timers its entry action would have
+static void enterState(OvenController &oven, OvenState state) {
+  oven.currentState = state;
+  unsigned long now = millis();
+  if (state == PREHEATING) { oven.preheatStartTime = now; oven.preheatComplete = false; }
+  else if (state == READY) oven.holdingStartTime = now;
+  else if (state == RUNNING) oven.recipeStartTime = now;
+  else if (state == ALARM_COMPLETION) oven.alarmStartTime = now;
+}
+
+static bool gainChanged(double current, double logged, double epsilon) {
+  return fabs(current - logged) > epsilon;
+}
+
+// What the firmware had after this row's sensor read
+static void applyRow(OvenController &oven, const ReplayRow &row) {
+  if (oven.currentState != row.state) enterState(oven, row.state);
+  for (uint8_t z = 0; z < ZONE_COUNT; z++) {
+    oven.settings.thresholds.zone[z] = row.threshold[z];
+    oven.zones.temp[z] = row.temp[z];
+
+    PidParams &params = oven.settings.pid[z];
+    if (gainChanged(params.kp, row.kp[z], row.gainEpsilon) || gainChanged(params.ki, row.ki[z], row.gainEpsilon) ||
+        gainChanged(params.kd, row.kd[z], row.gainEpsilon)) {
+      params.kp = row.kp[z];
+      params.ki = row.ki[z];
+      params.kd = row.kd[z];
+      applyPidParams(oven.zonePid[z], params);
+    }
+    // A manual zone's output is its duty
+    if (row.mode[z] == ZONE_MODE_MANUAL) oven.settings.zoneControl[z].manualDuty = row.pid[z] / PID_WINDOW_SIZE;
+    if (oven.settings.zoneControl[z].mode != row.mode[z]) setZoneMode(oven, z, row.mode[z]);
+  }
+}
+
+static void seedPids(OvenController &oven, const ReplayRow &row) {
+  for (uint8_t z = 0; z < ZONE_COUNT; z++) {
+    oven.zones.input[z] = (PidReal)row.temp[z];
+    oven.zones.setpoint[z] = (PidReal)row.sp[z];
+    oven.zones.output[z] = (PidReal)row.pid[z];
+    // Without a logged I-term, the one that reproduces the logged
+    // output; a zone that is not heating has none. The baseline
+    // firmware kept its I-term inside the output range, and the
+    // logged output is a tick older than the logged temperature
+    if (row.seedFromOutput && row.sp[z] > 0) {
+      oven.zonePid[z].SeedOutput((PidReal)row.pid[z]);
+      oven.zonePid[z].SeedIterm((PidReal)oven.zonePid[z].GetIterm());
+    } else {
+      oven.zonePid[z].SeedIterm((PidReal)row.iterm[z]);
+    }
+  }
+}
+
+// loop() passes up to the next row. The firmware logs on the pass
+// where isStatusUpdateDue() fires, after updateStateMachine() and
+// before updateRelayLogic(); that tick is taken as the row when it
+// agrees with the row's whole-second time, else the row is placed at
+// the latest time that second allows. Relay switching delays move
+// millis() on as they do on the board.
+static void runUntilRow(OvenController &oven, unsigned long fromMs, unsigned long rowSec, unsigned long stepMs) {
+  unsigned long earliest = rowSec > 0 ? (rowSec - 1) * 1000UL : 0;
+  unsigned long latest = (rowSec + 1) * 1000UL;
+  while (true) {
+    unsigned long elapsed = millis() - fromMs;
+    if (elapsed < latest) hostAdvanceMillis(latest - elapsed < stepMs ? latest - elapsed : stepMs);
+    updateStateMachine(oven);
+    elapsed = millis() - fromMs;
+    if (elapsed >= earliest && isStatusUpdateDue(oven)) return;
+    if (elapsed >= latest) return;
+    updateRelayLogic(oven);
+  }
+}
+
+static void noteMismatch(ReplayColumn &column, bool mismatch, double error) {
+  if (mismatch) column.mismatches++;
+  if (error > column.maxError) column.maxError = error;
+}
+
+// rel_ columns: an instant mismatch is counted per row, max_error is
+// the largest on-fraction difference over a block of rows
+static void compareDuty(ReplayRun &run, const ReplayRow &row, ReplayReport &report) {
+  for (uint8_t z = 0; z < ZONE_COUNT; z++) {
+    if (run.oven->relayStates.zone[z]) run.replayedOn[z]++;
+    if (row.relay[z]) run.loggedOn[z]++;
+  }
+  if (++run.dutyRows < REPLAY_DUTY_ROWS) return;
+  for (uint8_t z = 0; z < ZONE_COUNT; z++) {
+    double error = fabs((double)run.replayedOn[z] - (double)run.loggedOn[z]) / run.dutyRows;
+    ReplayColumn &column = report.columns[1 + ZONE_COUNT + z];
+    if (error > column.maxError) column.maxError = error;
+    run.replayedOn[z] = run.loggedOn[z] = 0;
+  }
+  run.dutyRows = 0;
+}
+
+static void compareRow(const OvenController &oven, const ReplayRow &row, const ReplayOptions &options,
+                       ReplayReport &report) {
+  std::vector<ReplayColumn> &columns = report.columns;
+  bool stateDiffers = oven.currentState != row.state;
+  noteMismatch(columns[0], stateDiffers, stateDiffers ? 1 : 0);
+  for (uint8_t z = 0; z < ZONE_COUNT; z++) {
+    double error = fabs((double)oven.zones.output[z] - row.pid[z]);
+    double tolerance = options.pidTolerance + row.kp[z] * REPLAY_TEMP_ROUNDING;
+    noteMismatch(columns[1 + z], error > tolerance, error);
+    if (oven.relayStates.zone[z] != row.relay[z]) columns[1 + ZONE_COUNT + z].mismatches++;
+  }
+  bool valveDiffers = oven.relayStates.valve != row.valve;
+  noteMismatch(columns[1 + 2 * ZONE_COUNT], valveDiffers, valveDiffers ? 1 : 0);
+}
+
+static void initReport(ReplayReport &report) {
+  report = ReplayReport();
+  report.columns.resize(2 + 2 * ZONE_COUNT);
+  report.columns[0].name = "state";
+  for (uint8_t z = 0; z < ZONE_COUNT; z++) {
+    report.columns[1 + z].name = std::string("pid_") + ZONE_TABLE[z].name;
+    report.columns[1 + ZONE_COUNT + z].name = std::string("rel_") + ZONE_TABLE[z].name;
+  }
+  report.columns[1 + 2 * ZONE_COUNT].name = "rel_valve";
+}
+
+static void replayRow(ReplayRun &run, const ReplayRow &row, const ReplayOptions &options, ReplayReport &report) {
+  OvenController &oven = *run.oven;
+  report.rows++;
+  if (run.seeded && row.unixTime >= run.lastTime && row.unixTime - run.lastTime <= REPLAY_MAX_GAP_SEC) {
+    runUntilRow(oven, run.lastRowMs, row.unixTime - run.lastTime, options.stepMs > 0 ? options.stepMs : 1);
+    run.lastRowMs = millis();
+    compareRow(oven, row, options, report);
+    compareDuty(run, row, report);
+    report.compared++;
+    applyRow(oven, row);
+  } else {
+    if (run.seeded) report.reseeds++;
+    applyRow(oven, row);
+    seedPids(oven, row);
+    run.seeded = true;
+    run.lastRowMs = millis();
+    oven.lastStatusUpdateTime = run.lastRowMs; // This row was a status tick
+  }
+  updateRelayLogic(oven);
+  run.lastTime = row.unixTime;
+}
+
+static unsigned long relayMismatches(const ReplayReport &report) {
+  unsigned long n = 0;
+  for (uint8_t z = 0; z < ZONE_COUNT; z++) n += report.columns[1 + ZONE_COUNT + z].mismatches;
+  return n;
+}
+
+// The log does not say where in its TPC window the firmware was: try
+// each phase on the section's first rows and keep the best match
+static unsigned long findWindowPhase(const std::vector<ReplayRow> &rows, const ReplayOptions &options) {
+  unsigned long bestPhase = 0;
+  unsigned long bestMismatches = ULONG_MAX;
+  for (unsigned long phase = 0; phase < (unsigned long)PID_WINDOW_SIZE; phase += REPLAY_PHASE_STEP_MS) {
+    ReplayRun run;
+    ReplayReport scratch;
+    initReport(scratch);
+    startController(run, rows[0].unixTime, phase, options);
+    for (size_t i = 0; i < rows.size(); i++) replayRow(run, rows[i], options, scratch);
+    unsigned long mismatches = relayMismatches(scratch);
+    if (mismatches < bestMismatches) {
+      bestMismatches = mismatches;
+      bestPhase = phase;
+    }
+  }
+  return bestPhase;
+}
+
+// Align on the buffered rows, then replay them for the report
+static void startSection(ReplayRun &run, std::vector<ReplayRow> &pending, const ReplayOptions &options,
+                         ReplayReport &report) {
+  startController(run, pending[0].unixTime, findWindowPhase(pending, options), options);
+  for (size_t i = 0; i < pending.size(); i++) replayRow(run, pending[i], options, report);
+  pending.clear();
+}
+
+bool replayLog(FILE* in, const ReplayOptions &options, ReplayReport &report, std::string &error) {
+  initReport(report);
+
+  static char line[REPLAY_LINE_SIZE];
+  char* fields[REPLAY_MAX_FIELDS];
+  ReplayLayout layout;
+  bool haveLayout = false;
+  ReplayRun run;
+  std::vector<ReplayRow> pending; // Section rows kept for the phase search
+  unsigned long lineNumber = 0;
+
+  while (fgets(line, sizeof(line), in) != NULL) {
+    lineNumber++;
+    if (strchr(line, '\n') == NULL && !feof(in)) {
+      error = "line " + std::to_string(lineNumber) + " is too long";
+      return false;
+    }
+    int count = splitFields(line, fields, REPLAY_MAX_FIELDS);
+    if (count == 0) continue;
+
+    // Concatenated day files: each header starts a new section
+    if (strcmp(fields[0], "date") == 0) {
+      if (!pending.empty()) startSection(run, pending, options, report);
+      if (!readLayout(fields, count, layout, error)) return false;
+      haveLayout = true;
+      run.oven.reset();
+      continue;
+    }
+    if (!haveLayout) {
+      error = "no header before line " + std::to_string(lineNumber);
+      return false;
+    }
+    ReplayRow row;
+    if (!parseRow(fields, count, layout, row)) {
+      error = "cannot parse line " + std::to_string(lineNumber);
+      return false;
+    }
+
+    if (run.oven) {
+      replayRow(run, row, options, report);
+    } else {
+      pending.push_back(row);
+      if (pending.size() == REPLAY_ALIGN_ROWS) startSection(run, pending, options, report);
+    }
+  }
+  if (!pending.empty()) startSection(run, pending, options, report);
+
+  if (!haveLayout) {
+    error = "no header";
+    return false;
+  }
+  return true;
+}
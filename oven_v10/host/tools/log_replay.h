@@ -0,0 +1,69 @@
+#ifndef HOST_LOG_REPLAY_H
+#define HOST_LOG_REPLAY_H
+
+// =================================================================
+// LOG REPLAY
+// =================================================================
+// Streams a day log (logger.cpp columns) through a fresh controller
+// on the virtual clock. Each row's inputs are applied as the firmware
+// saw them after that row's sensor read: state, thresholds, live
+// temperatures, gains in use and zone mode. loop()'s order is then
+// re-run up to the next row, updateStateMachine() then
+// updateRelayLogic() per pass, and the state, pid_<zone>, rel_<zone>
+// and rel_valve the replay arrives at are diffed against that row.
+//
+// The PIDs are seeded once from the first row (output and iterm_) and
+// run free after it, so a pid_ drift means this firmware would have
+// decided differently; errors within what the 0.01 C logging of the
+// temperatures explains are not counted. State changes made by
+// commands are not in the log and show as a state mismatch on their
+// row.
+//
+// Relay states are sampled, and the power budget's carried shortfall
+// and the TPC window phase are not logged (the phase is searched on
+// the first rows), so rel_ columns are judged by their on-fraction
+// over blocks of rows; the per-row mismatch count is informational.
+//
+// Logs of the baseline firmware (no sp_, iterm_ or mode_ columns, the
+// steam zone named rod3) replay too: every zone is PID, the setpoint
+// is set_ while heating, and the PIDs are seeded with the I-term that
+// reproduces the first row's pid_. Their gains are logged with 2
+// decimals and compared at that precision.
+//
+// Rows further apart than REPLAY_MAX_GAP_SEC (reboot, clock set) or
+// going back in time are not diffed; the controller is reseeded there.
+
+#include <stdio.h>
+#include <string>
+#include <vector>
+
+const unsigned long REPLAY_MAX_GAP_SEC = 60;
+
+struct ReplayOptions {
+  unsigned long stepMs = 10;  // Virtual time per loop() pass
+  double pidTolerance = 1.0;  // pid_ error (ms of PID_WINDOW_SIZE) still counted as a match
+  // Installer's power budget the log was made under (SET_POWER_BUDGET;
+  // not logged), 0 = no limit
+  double maxKw = 0;
+  unsigned maxHeaters = 0;
+};
+
+struct ReplayColumn {
+  std::string name;
+  unsigned long mismatches = 0;
+  double maxError = 0;        // pid_: largest |replayed - logged|; rel_: largest on-fraction
+                              // difference over a block of rows; state, rel_valve: 1 once any mismatch
+};
+
+struct ReplayReport {
+  unsigned long rows = 0;      // Data rows read
+  unsigned long compared = 0;  // Rows diffed (all but the first after each reseed)
+  unsigned long reseeds = 0;
+  std::vector<ReplayColumn> columns; // state, pid_<zone>..., rel_<zone>..., rel_valve
+};
+
+// False (and 'error' set) if the file has no usable header or a row
+// cannot be parsed
+bool replayLog(FILE* in, const ReplayOptions &options, ReplayReport &report, std::string &error);
+
+#endif // HOST_LOG_REPLAY_H
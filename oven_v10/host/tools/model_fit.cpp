@@ -0,0 +1,361 @@
+#include "model_fit.h"
+#include <algorithm>
+#include <stdlib.h>
+#include <string.h>
+
+const size_t FIT_LINE_SIZE = 4096;
+const int FIT_MAX_FIELDS = 128;
+// Dead time search step, in sample intervals
+const double FIT_DEAD_STEP = 0.1;
+// Rows further apart than this many intervals start a new segment
+const double FIT_MAX_GAP_RATIO = 4.0;
+
+// =================================================================
+// LOG READING
+// =================================================================
+
+// Days since 1970-01-01 of a civil date
+static long daysFromCivil(int y, int m, int d) {
+  y -= m <= 2;
+  long era = (y >= 0 ? y : y - 399) / 400;
+  long yoe = y - era * 400;
+  long doy = (153 * (m + (m > 2 ? -3 : 9)) + 2) / 5 + d - 1;
+  long doe = yoe * 365 + yoe / 4 - yoe / 100 + doy;
+  return era * 146097 + doe - 719468;
+}
+
+// "2026-10-19" "12:00:03" -> unix seconds, -1 if malformed
+static long parseTime(const char* date, const char* time) {
+  int y, mo, d, h, mi, s;
+  if (sscanf(date, "%d-%d-%d", &y, &mo, &d) != 3 || sscanf(time, "%d:%d:%d", &h, &mi, &s) != 3) return -1;
+  return daysFromCivil(y, mo, d) * 86400L + h * 3600L + mi * 60L + s;
+}
+
+static int splitFields(char* line, char** fields) {
+  int n = 0;
+  char* p = line;
+  while (n < FIT_MAX_FIELDS) {
+    fields[n++] = p;
+    char* comma = strchr(p, ',');
+    if (comma == NULL) break;
+    *comma = '\0';
+    p = comma + 1;
+  }
+  // Strip the line ending from the last field
+  char* end = fields[n - 1] + strcspn(fields[n - 1], "\r\n");
+  *end = '\0';
+  return n;
+}
+
+struct FitColumns {
+  std::vector<std::string> names;
+  std::vector<int> live, pid;
+  int date = -1, time = -1;
+};
+
+static bool readHeader(char** fields, int count, FitColumns &cols) {
+  cols = FitColumns();
+  for (int i = 0; i < count; i++) {
+    if (strcmp(fields[i], "date") == 0) cols.date = i;
+    if (strcmp(fields[i], "time") == 0) cols.time = i;
+  }
+  for (int i = 0; i < count; i++) {
+    if (strncmp(fields[i], "live_", 5) != 0) continue;
+    std::string pidName = std::string("pid_") + (fields[i] + 5);
+    for (int j = 0; j < count; j++) {
+      if (pidName == fields[j]) {
+        cols.names.push_back(fields[i] + 5);
+        cols.live.push_back(i);
+        cols.pid.push_back(j);
+      }
+    }
+  }
+  return cols.date >= 0 && cols.time >= 0 && !cols.names.empty();
+}
+
+struct FitRow {
+  long t;
+  std::vector<double> temp, duty;
+};
+
+// Rows under one header
+struct FitSection {
+  std::vector<std::string> names;
+  std::vector<FitRow> rows;
+};
+
+bool loadZoneSeries(FILE* in, unsigned long windowMs, std::vector<ZoneSeries> &zones, std::string &error) {
+  static char line[FIT_LINE_SIZE];
+  char* fields[FIT_MAX_FIELDS];
+  FitColumns cols;
+  bool haveHeader = false;
+  std::vector<FitSection> sections;
+
+  while (fgets(line, sizeof(line), in) != NULL) {
+    if (strncmp(line, "date", 4) == 0) {
+      int n = splitFields(line, fields);
+      haveHeader = readHeader(fields, n, cols);
+      if (haveHeader) {
+        sections.push_back(FitSection());
+        sections.back().names = cols.names;
+      }
+      continue;
+    }
+    if (!haveHeader) continue;
+    int n = splitFields(line, fields);
+    FitRow row;
+    row.t = (cols.date < n && cols.time < n) ? parseTime(fields[cols.date], fields[cols.time]) : -1;
+    if (row.t < 0) continue;
+    for (size_t z = 0; z < cols.names.size(); z++) {
+      bool present = cols.live[z] < n && cols.pid[z] < n;
+      double temp = present ? strtod(fields[cols.live[z]], NULL) : NAN;
+      double duty = present ? strtod(fields[cols.pid[z]], NULL) / windowMs : NAN;
+      row.temp.push_back(temp);
+      row.duty.push_back(isfinite(duty) ? std::min(1.0, std::max(0.0, duty)) : NAN);
+    }
+    sections.back().rows.push_back(row);
+  }
+  if (sections.empty()) {
+    error = "no header with date, time and live_/pid_ zone columns";
+    return false;
+  }
+
+  // Interval: the median spacing over the file
+  std::vector<long> gaps;
+  for (size_t s = 0; s < sections.size(); s++) {
+    const std::vector<FitRow> &rows = sections[s].rows;
+    for (size_t i = 1; i < rows.size(); i++) {
+      long gap = rows[i].t - rows[i - 1].t;
+      if (gap > 0) gaps.push_back(gap);
+    }
+  }
+  if (gaps.empty()) {
+    error = "fewer than two rows";
+    return false;
+  }
+  std::nth_element(gaps.begin(), gaps.begin() + gaps.size() / 2, gaps.end());
+  double sample = (double)gaps[gaps.size() / 2];
+
+  for (size_t s = 0; s < sections.size(); s++) {
+    const std::vector<FitRow> &rows = sections[s].rows;
+    for (size_t z = 0; z < sections[s].names.size(); z++) {
+      ZoneSeries* series = NULL;
+      const std::string &name = sections[s].names[z];
+      for (size_t i = 0; i < zones.size(); i++) {
+        if (zones[i].zone == name) series = &zones[i];
+      }
+      if (series == NULL) {
+        zones.push_back(ZoneSeries());
+        series = &zones.back();
+        series->zone = name;
+      }
+      if (series->sampleSec == 0) series->sampleSec = sample;
+
+      // Resampled on an even grid: temperature interpolated, duty held
+      // from the row at or before each point
+      std::vector<double> temp, duty;
+      size_t i = 0;
+      double t = 0;
+      while (i < rows.size()) {
+        bool valid = isfinite(rows[i].temp[z]) && isfinite(rows[i].duty[z]);
+        long gap = (i > 0) ? rows[i].t - rows[i - 1].t : 0;
+        bool broken = i > 0 && (gap <= 0 || gap > sample * FIT_MAX_GAP_RATIO);
+        if (i == 0 || broken || !valid) {
+          if (temp.size() > 2) {
+            series->temp.push_back(temp);
+            series->duty.push_back(duty);
+          }
+          temp.clear();
+          duty.clear();
+          if (!valid) { i++; continue; }
+          t = (double)rows[i].t;
+          temp.push_back(rows[i].temp[z]);
+          duty.push_back(rows[i].duty[z]);
+          t += sample;
+          i++;
+          continue;
+        }
+        // Grid points up to this row
+        const FitRow &prev = rows[i - 1];
+        while (t <= (double)rows[i].t) {
+          double f = (t - prev.t) / (double)(rows[i].t - prev.t);
+          temp.push_back(prev.temp[z] + f * (rows[i].temp[z] - prev.temp[z]));
+          duty.push_back(t < (double)rows[i].t ? prev.duty[z] : rows[i].duty[z]);
+          t += sample;
+        }
+        i++;
+      }
+      if (temp.size() > 2) {
+        series->temp.push_back(temp);
+        series->duty.push_back(duty);
+      }
+    }
+  }
+  return true;
+}
+
+// =================================================================
+// LEAST SQUARES
+// =================================================================
+
+// Normal equations of up to 5 regressors
+struct NormalEquations {
+  int n;
+  double xtx[5][5];
+  double xty[5];
+  double yty;
+  unsigned long count;
+
+  explicit NormalEquations(int size) : n(size), yty(0), count(0) {
+    memset(xtx, 0, sizeof(xtx));
+    memset(xty, 0, sizeof(xty));
+  }
+
+  void add(const double* x, double y) {
+    for (int i = 0; i < n; i++) {
+      for (int j = 0; j < n; j++) xtx[i][j] += x[i] * x[j];
+      xty[i] += x[i] * y;
+    }
+    yty += y * y;
+    count++;
+  }
+
+  // Coefficients into 'beta' and the residual sum of squares; false if singular
+  bool solve(double* beta, double &sse) const {
+    double a[5][6];
+    for (int i = 0; i < n; i++) {
+      for (int j = 0; j < n; j++) a[i][j] = xtx[i][j];
+      a[i][n] = xty[i];
+    }
+    for (int c = 0; c < n; c++) {
+      int pivot = c;
+      for (int r = c + 1; r < n; r++) if (fabs(a[r][c]) > fabs(a[pivot][c])) pivot = r;
+      if (fabs(a[pivot][c]) < 1e-12) return false;
+      for (int k = 0; k <= n; k++) std::swap(a[c][k], a[pivot][k]);
+      for (int r = 0; r < n; r++) {
+        if (r == c) continue;
+        double f = a[r][c] / a[c][c];
+        for (int k = c; k <= n; k++) a[r][k] -= f * a[c][k];
+      }
+    }
+    for (int i = 0; i < n; i++) beta[i] = a[i][n] / a[i][i];
+    sse = yty;
+    for (int i = 0; i < n; i++) {
+      sse -= 2 * beta[i] * xty[i];
+      for (int j = 0; j < n; j++) sse += beta[i] * beta[j] * xtx[i][j];
+    }
+    return true;
+  }
+};
+
+// Duty 'lag' samples (fractional) before k
+static double delayedDuty(const std::vector<double> &u, size_t k, double lag) {
+  size_t whole = (size_t)lag;
+  double frac = lag - whole;
+  double now = u[k - whole];
+  return (frac > 0) ? (1 - frac) * now + frac * u[k - whole - 1] : now;
+}
+
+// order 1: x = [T[k], u_d(k), 1]; order 2: x = [T[k], T[k-1], u_d(k), u_d(k-1), 1].
+// With a known ambient, temperatures are taken relative to it and the
+// constant is dropped.
+static int regressors(const std::vector<double> &y, const std::vector<double> &u, size_t k,
+                      double lag, int order, double ambient, double* x) {
+  bool fixed = !isnan(ambient);
+  double base = fixed ? ambient : 0;
+  int n = 0;
+  x[n++] = y[k] - base;
+  if (order == 2) x[n++] = y[k - 1] - base;
+  x[n++] = delayedDuty(u, k, lag);
+  if (order == 2) x[n++] = delayedDuty(u, k - 1, lag);
+  if (!fixed) x[n++] = 1;
+  return n;
+}
+
+// Free run of the fitted recursion from each segment's first samples
+static double freeRunRms(const ZoneSeries &s, const double* beta, double lag, int order, double ambient, size_t first) {
+  double sum = 0;
+  unsigned long count = 0;
+  for (size_t g = 0; g < s.temp.size(); g++) {
+    const std::vector<double> &y = s.temp[g];
+    const std::vector<double> &u = s.duty[g];
+    if (y.size() <= first + 1) continue;
+    std::vector<double> sim(y.begin(), y.begin() + first + 1);
+    for (size_t k = first; k + 1 < y.size(); k++) {
+      double x[5];
+      int n = regressors(sim, u, k, lag, order, ambient, x);
+      double next = isnan(ambient) ? 0 : ambient;
+      for (int i = 0; i < n; i++) next += beta[i] * x[i];
+      sim.push_back(next);
+      sum += (next - y[k + 1]) * (next - y[k + 1]);
+      count++;
+    }
+  }
+  return count > 0 ? sqrt(sum / count) : 0;
+}
+
+static ModelFit fitOrder(const ZoneSeries &s, int order, double ambient, double maxDeadSec) {
+  ModelFit fit;
+  if (s.sampleSec <= 0) return fit;
+  double dt = s.sampleSec;
+  double maxLag = maxDeadSec / dt;
+  // Same samples for every candidate dead time
+  size_t first = (size_t)ceil(maxLag) + order;
+
+  double bestSse = 0, bestLag = 0;
+  double best[5];
+  bool found = false;
+  for (double lag = 0; lag <= maxLag + 1e-9; lag += FIT_DEAD_STEP) {
+    NormalEquations eq(0);
+    for (size_t g = 0; g < s.temp.size(); g++) {
+      const std::vector<double> &y = s.temp[g];
+      const std::vector<double> &u = s.duty[g];
+      for (size_t k = first; k + 1 < y.size(); k++) {
+        double x[5];
+        eq.n = regressors(y, u, k, lag, order, ambient, x);
+        eq.add(x, y[k + 1] - (isnan(ambient) ? 0 : ambient));
+      }
+    }
+    if (eq.count < 10) return fit;
+    double beta[5], sse;
+    if (!eq.solve(beta, sse)) continue;
+    if (!found || sse < bestSse) {
+      found = true;
+      bestSse = sse;
+      bestLag = lag;
+      memcpy(best, beta, sizeof(best));
+    }
+    fit.samples = eq.count;
+  }
+  if (!found) return fit;
+
+  // Continuous parameters
+  double poleSum = (order == 2) ? best[0] + best[1] : best[0];
+  double inputSum = (order == 2) ? best[2] + best[3] : best[1];
+  if (poleSum >= 1 || poleSum <= 0) return fit;
+  fit.gain = inputSum / (1 - poleSum);
+  fit.ambient = isnan(ambient) ? best[order == 2 ? 4 : 2] / (1 - poleSum) : ambient;
+  fit.deadTime = bestLag * dt;
+  if (order == 1) {
+    fit.tau = -dt / log(best[0]);
+  } else {
+    // z^2 - a1 z - a2: two real poles in (0, 1) for two lags
+    double disc = best[0] * best[0] + 4 * best[1];
+    if (disc < 0) return fit;
+    double p1 = (best[0] + sqrt(disc)) / 2, p2 = (best[0] - sqrt(disc)) / 2;
+    if (p1 <= 0 || p1 >= 1 || p2 <= 0 || p2 >= 1) return fit;
+    fit.tau = -dt / log(p1);
+    fit.tau2 = -dt / log(p2);
+  }
+  fit.rmsError = freeRunRms(s, best, bestLag, order, ambient, first);
+  fit.ok = true;
+  return fit;
+}
+
+ModelFit fitFopdt(const ZoneSeries &series, double ambient, double maxDeadSec) {
+  return fitOrder(series, 1, ambient, maxDeadSec);
+}
+
+ModelFit fitTwoNode(const ZoneSeries &series, double ambient, double maxDeadSec) {
+  return fitOrder(series, 2, ambient, maxDeadSec);
+}
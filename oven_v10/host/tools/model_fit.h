@@ -0,0 +1,63 @@
+#ifndef HOST_MODEL_FIT_H
+#define HOST_MODEL_FIT_H
+
+// =================================================================
+// THERMAL MODEL FIT
+// =================================================================
+// Identifies per-zone heating models from day logs (logger.cpp
+// columns): the input is the effective duty pid_<zone> / window, the
+// output live_<zone>. Any "live_X" column with a matching "pid_X" is a
+// zone, so logs of other zone counts fit too.
+//
+// Rows are resampled at the log interval (the median spacing), as the
+// loop's blocking relay switching stretches some intervals; a gap of
+// several intervals or a backward step starts a new segment, and no
+// regression term spans two segments. Both models are fitted as discrete ARX
+// models by least squares, the dead time by a search in steps of a
+// tenth of the interval (the fractional part interpolates the duty):
+//
+//   FOPDT     T[k+1] = a T[k] + b u(k - dead) + c
+//   2 nodes   T[k+1] = a1 T[k] + a2 T[k-1] + b1 u(k - dead) + b2 u(k - dead - 1) + c
+//
+// and converted to the continuous parameters of thermal_plant.h (gain
+// at full duty, time constants, ambient = c / (1 - a...)). With a
+// known ambient, c is fixed instead. rmsError is the free-run error of
+// the fitted model over the data (C), comparable across models.
+//
+// pid_ is the duty requested. SSR channels deliver it; on TPC relays
+// the power budget shifts on-time between windows and the blocking
+// switching delays stretch runs, so fit those from stretches where the
+// budget did not constrain (GET_POWER) or expect a biased gain.
+
+#include <math.h>
+#include <stdio.h>
+#include <string>
+#include <vector>
+
+struct ZoneSeries {
+  std::string zone;
+  double sampleSec = 0;                        // Row interval
+  std::vector<std::vector<double> > temp;      // Segments of evenly spaced samples
+  std::vector<std::vector<double> > duty;      // 0..1, same shape
+};
+
+struct ModelFit {
+  bool ok = false;
+  double gain = 0;       // C at full duty
+  double tau = 0;        // s (2 nodes: the slower one)
+  double tau2 = 0;       // s, 0 for FOPDT
+  double deadTime = 0;   // s
+  double ambient = 0;    // C
+  double rmsError = 0;   // C, free run
+  unsigned long samples = 0;
+};
+
+// Appends one log file's rows; 'windowMs' converts pid_ to duty. False
+// (and 'error' set) without a usable header.
+bool loadZoneSeries(FILE* in, unsigned long windowMs, std::vector<ZoneSeries> &zones, std::string &error);
+
+// 'ambient' NAN = estimate it; 'maxDeadSec' bounds the dead time search
+ModelFit fitFopdt(const ZoneSeries &series, double ambient = NAN, double maxDeadSec = 180);
+ModelFit fitTwoNode(const ZoneSeries &series, double ambient = NAN, double maxDeadSec = 180);
+
+#endif // HOST_MODEL_FIT_H
@@ -0,0 +1,143 @@
+#include "param_search.h"
+#include <math.h>
+#include <algorithm>
+#include <atomic>
+#include <thread>
+
+const char* const SWEEP_COST_NAMES[SWEEP_COST_COUNT] = {"overshoot", "settle_s", "cycles", "energy_kwh"};
+
+double sweepValue(const SweepDim &dim, double unit) {
+  double v = dim.lo + std::min(1.0, std::max(0.0, unit)) * (dim.hi - dim.lo);
+  return dim.integer ? floor(v + 0.5) : v;
+}
+
+void parallelFor(size_t count, unsigned threads, const std::function<void(size_t)> &fn) {
+  if (threads < 1) threads = 1;
+  if (threads > count) threads = (unsigned)count;
+  std::atomic<size_t> next(0);
+  auto worker = [&] {
+    for (size_t i = next++; i < count; i = next++) fn(i);
+  };
+  std::vector<std::thread> pool;
+  for (unsigned t = 1; t < threads; t++) pool.push_back(std::thread(worker));
+  worker();
+  for (size_t t = 0; t < pool.size(); t++) pool[t].join();
+}
+
+std::vector<std::vector<double> > unitGrid(const std::vector<int> &axisOf, int axes, int levels) {
+  std::vector<std::vector<double> > grid;
+  if (levels < 2) levels = 2;
+  std::vector<int> index(axes, 0);
+  while (true) {
+    std::vector<double> x(axisOf.size());
+    for (size_t d = 0; d < axisOf.size(); d++) x[d] = (double)index[axisOf[d]] / (levels - 1);
+    grid.push_back(x);
+    // Odometer over the axes
+    int a = 0;
+    while (a < axes && ++index[a] == levels) index[a++] = 0;
+    if (a == axes) break;
+  }
+  return grid;
+}
+
+static void clampUnit(std::vector<double> &x) {
+  for (size_t i = 0; i < x.size(); i++) x[i] = std::min(1.0, std::max(0.0, x[i]));
+}
+
+// x = c + t (c - w), clamped
+static std::vector<double> along(const std::vector<double> &c, const std::vector<double> &w, double t) {
+  std::vector<double> x(c.size());
+  for (size_t i = 0; i < c.size(); i++) x[i] = c[i] + t * (c[i] - w[i]);
+  clampUnit(x);
+  return x;
+}
+
+std::vector<double> nelderMead(const std::function<double(const std::vector<double> &)> &f,
+                               const std::vector<double> &start, double step, int maxEvals) {
+  const size_t n = start.size();
+  std::vector<std::vector<double> > v(n + 1, start);
+  clampUnit(v[0]);
+  for (size_t i = 0; i < n; i++) {
+    v[i + 1] = v[0];
+    // Step inwards at the upper edge, so the vertex stays distinct
+    v[i + 1][i] += (v[0][i] + step <= 1.0) ? step : -step;
+  }
+  std::vector<double> fv(n + 1);
+  int evals = 0;
+  for (size_t i = 0; i <= n; i++, evals++) fv[i] = f(v[i]);
+
+  std::vector<size_t> order(n + 1);
+  while (evals < maxEvals) {
+    for (size_t i = 0; i <= n; i++) order[i] = i;
+    std::sort(order.begin(), order.end(), [&](size_t a, size_t b) { return fv[a] < fv[b]; });
+    size_t best = order[0], worst = order[n], second = order[n - 1];
+
+    std::vector<double> centroid(n, 0.0);
+    for (size_t i = 0; i <= n; i++) {
+      if (i == worst) continue;
+      for (size_t d = 0; d < n; d++) centroid[d] += v[i][d] / n;
+    }
+
+    std::vector<double> r = along(centroid, v[worst], 1.0);
+    double fr = f(r);
+    evals++;
+    if (fr < fv[best]) {
+      std::vector<double> e = along(centroid, v[worst], 2.0);
+      double fe = f(e);
+      evals++;
+      if (fe < fr) { v[worst] = e; fv[worst] = fe; }
+      else { v[worst] = r; fv[worst] = fr; }
+      continue;
+    }
+    if (fr < fv[second]) {
+      v[worst] = r;
+      fv[worst] = fr;
+      continue;
+    }
+    // Contract towards the better of the worst vertex and its reflection
+    bool outside = fr < fv[worst];
+    std::vector<double> c = along(centroid, v[worst], outside ? 0.5 : -0.5);
+    double fc = f(c);
+    evals++;
+    if (fc < (outside ? fr : fv[worst])) {
+      v[worst] = c;
+      fv[worst] = fc;
+      continue;
+    }
+    // Shrink onto the best vertex
+    for (size_t i = 0; i <= n && evals < maxEvals; i++) {
+      if (i == best) continue;
+      for (size_t d = 0; d < n; d++) v[i][d] = v[best][d] + 0.5 * (v[i][d] - v[best][d]);
+      fv[i] = f(v[i]);
+      evals++;
+    }
+  }
+  size_t best = 0;
+  for (size_t i = 1; i <= n; i++) if (fv[i] < fv[best]) best = i;
+  return v[best];
+}
+
+bool dominates(const SweepPoint &a, const SweepPoint &b) {
+  bool better = false;
+  for (int c = 0; c < SWEEP_COST_COUNT; c++) {
+    if (a.cost[c] > b.cost[c]) return false;
+    if (a.cost[c] < b.cost[c]) better = true;
+  }
+  return better;
+}
+
+std::vector<size_t> paretoFront(const std::vector<SweepPoint> &points) {
+  std::vector<size_t> front;
+  for (size_t i = 0; i < points.size(); i++) {
+    bool keep = true;
+    for (size_t j = 0; j < points.size() && keep; j++) {
+      if (j != i && dominates(points[j], points[i])) keep = false;
+    }
+    // Equal costs: only the first copy
+    for (size_t k = 0; k < front.size() && keep; k++) {
+      if (std::equal(points[i].cost, points[i].cost + SWEEP_COST_COUNT, points[front[k]].cost)) keep = false;
+    }
+    if (keep) front.push_back(i);
+  }
+  return front;
+}
@@ -0,0 +1,58 @@
+#ifndef HOST_PARAM_SEARCH_H
+#define HOST_PARAM_SEARCH_H
+
+// =================================================================
+// PARAMETER SEARCH
+// =================================================================
+// The firmware-free half of the sweep optimizer (sweep_params.cpp):
+// a worker pool, a Nelder-Mead minimizer over the unit box and the
+// Pareto filter over the cost terms. Searches run on normalized
+// vectors (every dimension 0..1); SweepDim maps them to real values.
+
+#include <stddef.h>
+#include <functional>
+#include <string>
+#include <vector>
+
+// Cost terms, all minimized
+enum SweepCost {
+  COST_OVERSHOOT = 0, // C, worst zone
+  COST_SETTLE,        // s until READY with every zone settled
+  COST_CYCLES,        // Heater relay closings, all zones
+  COST_ENERGY,        // kWh
+  SWEEP_COST_COUNT
+};
+extern const char* const SWEEP_COST_NAMES[SWEEP_COST_COUNT];
+
+struct SweepDim {
+  std::string name;
+  double lo, hi;
+  bool integer; // Rounded, e.g. ms
+};
+
+struct SweepPoint {
+  std::vector<double> x; // Normalized
+  double cost[SWEEP_COST_COUNT];
+};
+
+double sweepValue(const SweepDim &dim, double unit);
+
+// Runs fn(0..count-1) on 'threads' workers, each index exactly once
+void parallelFor(size_t count, unsigned threads, const std::function<void(size_t)> &fn);
+
+// Every combination of 'levels' evenly spaced values (ends included)
+// on 'axes' grid axes; dimension d takes the value of axis axisOf[d],
+// so e.g. every zone's kp moves along one axis.
+std::vector<std::vector<double> > unitGrid(const std::vector<int> &axisOf, int axes, int levels);
+
+// Minimizes f from 'start' (initial simplex edge 'step'), clamping to
+// the unit box, within 'maxEvals' calls. Returns the best vertex.
+std::vector<double> nelderMead(const std::function<double(const std::vector<double> &)> &f,
+                               const std::vector<double> &start, double step, int maxEvals);
+
+// a no worse than b in every term and better in one
+bool dominates(const SweepPoint &a, const SweepPoint &b);
+// Indices of the points no other point dominates (duplicates kept once)
+std::vector<size_t> paretoFront(const std::vector<SweepPoint> &points);
+
+#endif // HOST_PARAM_SEARCH_H
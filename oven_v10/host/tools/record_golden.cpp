@@ -0,0 +1,345 @@
+// =================================================================
+// GOLDEN TRACE RECORDER
+// =================================================================
+// Runs the baseline QuickPID / calculateTpcState() (baseline_reference.h)
+// through fixed scenarios on the virtual clock and writes every call
+// with its inputs and results to <dir>/*.csv. test_golden_traces
+// replays the same calls against the current code.
+//
+//   record_golden <golden dir>
+//
+// PID traces:  t_ms,input,setpoint,op,a,b,c,ret,output
+//   new a=kp b=ki c=kd | mode a | limits a b | tunings a b c | pon a
+//   force a (write the output variable) | wrap a (ms until millis() wraps)
+//   compute (ret = Compute(), output after the call)
+// TPC traces:  t_ms,op,output,min_on,relay
+//   init (window starts now) | wrap (output = ms until wrap) | tpc
+//
+// t_ms is virtual time since the clock was reset, before any wrap
+// offset. Scenarios only change a PID's timing or a TPC request where
+// the current code is specified to match the baseline: computes land
+// exactly PID_COMPUTE_FREQ apart and requests change on the first call
+// of a window (see test_golden_traces.cpp for the deliberate changes).
+
+#include <Arduino.h>
+#include <vector>
+#include "baseline_reference.h"
+
+using baseline::QuickPID;
+
+static FILE* out = NULL;
+
+static void openTrace(const char* dir, const char* name, const char* header) {
+  char path[512];
+  snprintf(path, sizeof(path), "%s/%s", dir, name);
+  out = fopen(path, "w");
+  if (out == NULL) {
+    fprintf(stderr, "Cannot write %s\n", path);
+    exit(1);
+  }
+  fprintf(out, "%s\n", header);
+  hostResetClock();
+}
+
+static void closeTrace() {
+  fclose(out);
+  out = NULL;
+}
+
+// =================================================================
+// PID SCENARIOS
+// =================================================================
+
+const char* PID_HEADER = "t_ms,input,setpoint,op,a,b,c,ret,output";
+
+static double pidInput, pidOutput, pidSetpoint;
+
+static void pidRow(const char* op, double a = 0, double b = 0, double c = 0, int ret = 0) {
+  fprintf(out, "%llu,%.17g,%.17g,%s,%.17g,%.17g,%.17g,%d,%.17g\n",
+          (unsigned long long)(hostMicros() / 1000ULL), pidInput, pidSetpoint, op, a, b, c, ret, pidOutput);
+}
+
+// First-order heater: output 0..255 drives toward ambient + gain
+static void plantStep(double dtMs, double gain = 250.0, double tauMs = 20000.0) {
+  double target = 25.0 + gain * (pidOutput / 255.0);
+  pidInput += (target - pidInput) * (dtMs / tauMs);
+}
+
+static void pidNew(QuickPID* &pid, QuickPID &storage, double kp, double ki, double kd) {
+  pid = &storage;
+  pidRow("new", kp, ki, kd);
+}
+
+static void pidCompute(QuickPID &pid) {
+  bool ret = pid.Compute();
+  pidRow("compute", 0, 0, 0, ret ? 1 : 0);
+}
+
+static void pidMode(QuickPID &pid, int mode) {
+  pid.SetMode(mode);
+  pidRow("mode", mode);
+}
+
+static void pidLimits(QuickPID &pid, double lo, double hi) {
+  pid.SetOutputLimits(lo, hi);
+  pidRow("limits", lo, hi);
+}
+
+static void pidTunings(QuickPID &pid, double kp, double ki, double kd) {
+  pid.SetTunings(kp, ki, kd);
+  pidRow("tunings", kp, ki, kd);
+}
+
+static void pidPon(QuickPID &pid, int pon) {
+  pid.SetPOn(pon);
+  pidRow("pon", pon);
+}
+
+static void pidForce(double output) {
+  pidOutput = output;
+  pidRow("force", output);
+}
+
+// Loop at 'stepMs' for 'durationMs', computing and moving the plant
+static void pidRun(QuickPID &pid, unsigned long durationMs, unsigned long stepMs) {
+  for (unsigned long t = 0; t < durationMs; t += stepMs) {
+    pidCompute(pid);
+    plantStep(stepMs);
+    hostAdvanceMillis(stepMs);
+  }
+}
+
+static void resetPidVars(double input, double setpoint) {
+  pidInput = input;
+  pidSetpoint = setpoint;
+  pidOutput = 0;
+}
+
+// Setpoint step with P, I and D; integral saturates on the way up
+static void recordPidStep(const char* dir) {
+  openTrace(dir, "pid_step.csv", PID_HEADER);
+  resetPidVars(25.0, 25.0);
+  static QuickPID storage(&pidInput, &pidOutput, &pidSetpoint, 4.0, 0.05, 2.0, QuickPID::DIRECT);
+  QuickPID* pid;
+  pidNew(pid, storage, 4.0, 0.05, 2.0);
+  pidMode(*pid, QuickPID::AUTOMATIC);
+  pidRun(*pid, 2000, 50);
+  pidSetpoint = 180.0;
+  pidRun(*pid, 60000, 50);
+  pidSetpoint = 120.0;
+  pidRun(*pid, 30000, 25);
+  closeTrace();
+}
+
+// MANUAL holds the output; AUTOMATIC re-initializes iTerm from it
+// (clamped to the limits). Every MANUAL spell lasts at least one
+// sample time, so the baseline computes right at the switch as well.
+static void recordPidMode(const char* dir) {
+  openTrace(dir, "pid_mode.csv", PID_HEADER);
+  resetPidVars(30.0, 150.0);
+  static QuickPID storage(&pidInput, &pidOutput, &pidSetpoint, 2.0, 0.2, 0.5, QuickPID::DIRECT);
+  QuickPID* pid;
+  pidNew(pid, storage, 2.0, 0.2, 0.5);
+  // Compute() before AUTOMATIC does nothing
+  pidRun(*pid, 300, 50);
+  pidForce(40.0);
+  pidMode(*pid, QuickPID::AUTOMATIC);
+  pidRun(*pid, 10000, 50);
+  pidMode(*pid, QuickPID::MANUAL);
+  pidForce(200.0);
+  pidRun(*pid, 1000, 50);
+  pidSetpoint = 90.0;
+  pidMode(*pid, QuickPID::AUTOMATIC);
+  pidRun(*pid, 10000, 50);
+  // Re-selecting AUTOMATIC while in AUTOMATIC does not re-initialize
+  pidMode(*pid, QuickPID::AUTOMATIC);
+  pidRun(*pid, 2000, 50);
+  // Bumpless start from an output outside the limits is clamped
+  pidMode(*pid, QuickPID::MANUAL);
+  pidForce(400.0);
+  pidRun(*pid, 500, 50);
+  pidMode(*pid, QuickPID::AUTOMATIC);
+  pidRun(*pid, 5000, 50);
+  pidMode(*pid, QuickPID::MANUAL);
+  pidForce(-30.0);
+  pidRun(*pid, 200, 50);
+  pidMode(*pid, QuickPID::AUTOMATIC);
+  pidRun(*pid, 5000, 50);
+  closeTrace();
+}
+
+// Limits clamp output and iTerm in AUTOMATIC only; min >= max is ignored
+static void recordPidLimits(const char* dir) {
+  openTrace(dir, "pid_limits.csv", PID_HEADER);
+  resetPidVars(25.0, 200.0);
+  static QuickPID storage(&pidInput, &pidOutput, &pidSetpoint, 3.0, 0.5, 0.0, QuickPID::DIRECT);
+  QuickPID* pid;
+  pidNew(pid, storage, 3.0, 0.5, 0.0);
+  pidLimits(*pid, 0, 6000);
+  pidMode(*pid, QuickPID::AUTOMATIC);
+  pidRun(*pid, 8000, 50);
+  pidLimits(*pid, 0, 100);        // Cuts output and a wound-up iTerm
+  pidRun(*pid, 4000, 50);
+  pidLimits(*pid, 50, 50);        // Ignored
+  pidLimits(*pid, 80, 20);        // Ignored
+  pidRun(*pid, 1000, 50);
+  pidSetpoint = 20.0;
+  pidLimits(*pid, -100, 100);
+  pidRun(*pid, 6000, 50);
+  pidLimits(*pid, 10, 255);       // Raises a negative output
+  pidRun(*pid, 3000, 50);
+  pidMode(*pid, QuickPID::MANUAL);
+  pidForce(500.0);
+  pidLimits(*pid, 0, 255);        // MANUAL: output left alone
+  pidRun(*pid, 300, 50);
+  pidMode(*pid, QuickPID::AUTOMATIC);
+  pidRun(*pid, 3000, 50);
+  closeTrace();
+}
+
+// Proportional on measurement, tuning changes, negative gains rejected
+static void recordPidPonM(const char* dir) {
+  openTrace(dir, "pid_pon_m.csv", PID_HEADER);
+  resetPidVars(25.0, 160.0);
+  static QuickPID storage(&pidInput, &pidOutput, &pidSetpoint, 6.0, 0.3, 1.0, QuickPID::DIRECT);
+  QuickPID* pid;
+  pidNew(pid, storage, 6.0, 0.3, 1.0);
+  pidPon(*pid, QuickPID::P_ON_M);
+  pidMode(*pid, QuickPID::AUTOMATIC);
+  pidRun(*pid, 30000, 50);
+  pidTunings(*pid, 3.0, 0.1, 4.0);
+  pidRun(*pid, 10000, 50);
+  pidTunings(*pid, -1.0, 0.1, 0.0); // Ignored
+  pidSetpoint = 100.0;
+  pidRun(*pid, 10000, 50);
+  pidPon(*pid, QuickPID::P_ON_E);
+  pidRun(*pid, 10000, 50);
+  closeTrace();
+}
+
+// millis()/micros() wrap mid-run; the sample cadence must not notice
+static void recordPidWrap(const char* dir) {
+  openTrace(dir, "pid_wrap.csv", PID_HEADER);
+  resetPidVars(25.0, 120.0);
+  hostWrapClockIn(3000);
+  pidRow("wrap", 3000);
+  static QuickPID storage(&pidInput, &pidOutput, &pidSetpoint, 5.0, 0.1, 1.5, QuickPID::DIRECT);
+  QuickPID* pid;
+  pidNew(pid, storage, 5.0, 0.1, 1.5);
+  pidMode(*pid, QuickPID::AUTOMATIC);
+  pidRun(*pid, 8000, 25);
+  closeTrace();
+}
+
+// =================================================================
+// TPC SCENARIOS
+// =================================================================
+
+const char* TPC_HEADER = "t_ms,op,output,min_on,relay";
+
+static unsigned long tpcWindowStart = 0;
+
+static void tpcRow(const char* op, double output, unsigned long minOn, int relay) {
+  fprintf(out, "%llu,%s,%.17g,%lu,%d\n",
+          (unsigned long long)(hostMicros() / 1000ULL), op, output, minOn, relay);
+}
+
+static void tpcInit() {
+  tpcWindowStart = millis();
+  tpcRow("init", 0, 0, 0);
+}
+
+static void tpcWrap(unsigned long ms) {
+  hostWrapClockIn(ms);
+  tpcRow("wrap", ms, 0, 0);
+}
+
+// One loop pass: relay state for this output
+static void tpcCall(double output, unsigned long minOn) {
+  bool status = baseline::calculateTpcState(output, tpcWindowStart, minOn);
+  // The baseline returns the pin level; RELAY_ON is LOW
+  tpcRow("tpc", output, minOn, status == (bool)baseline::RELAY_ON ? 1 : 0);
+}
+
+struct TpcStep {
+  double output;       // Request from the first call of this window on
+  unsigned long minOn;
+};
+
+// Call every 'stepMs', switching to the next request whenever a call is
+// about to open a window; 'stallAt' inserts gaps (ms of virtual time)
+static void tpcRun(const std::vector<TpcStep> &steps, unsigned long stepMs,
+                   const std::vector<std::pair<size_t, unsigned long> > &stalls = {}) {
+  size_t index = 0;
+  size_t window = 0;
+  while (true) {
+    unsigned long now = millis();
+    if (now - tpcWindowStart >= (unsigned long)baseline::PID_WINDOW_SIZE) {
+      window++;
+      if (++index >= steps.size()) return;
+    }
+    tpcCall(steps[index].output, steps[index].minOn);
+    unsigned long advance = stepMs;
+    for (size_t i = 0; i < stalls.size(); i++) {
+      // Stall once, in the middle of the given window
+      if (stalls[i].first == window && now - tpcWindowStart == 3000) advance = stalls[i].second;
+    }
+    hostAdvanceMillis(advance);
+  }
+}
+
+// Window rollover across a range of duty values
+static void recordTpcWindow(const char* dir) {
+  openTrace(dir, "tpc_window.csv", TPC_HEADER);
+  tpcInit();
+  tpcRun({{0, 0}, {3000, 0}, {6000, 0}, {1200, 0}, {5900, 0}, {100, 0}, {2500, 0}, {0, 0}, {4800, 0}}, 50);
+  closeTrace();
+}
+
+// A stall shorter than two windows steps the window by one; a longer
+// one restarts it at the stalled call
+static void recordTpcStall(const char* dir) {
+  openTrace(dir, "tpc_stall.csv", TPC_HEADER);
+  tpcInit();
+  tpcRun({{2000, 0}, {2000, 0}, {4000, 0}, {4000, 0}, {1500, 0}, {1500, 0}, {3500, 0}, {3500, 0}}, 50,
+         {{1, 7000}, {3, 20000}, {5, 8950}});
+  closeTrace();
+}
+
+// Minimum actuation time: requests at, above and below it. Requests
+// are whole power slots (POWER_SLOT_MS); after a request below the
+// minimum only zero requests follow (see test).
+static void recordTpcMinOn(const char* dir) {
+  openTrace(dir, "tpc_min_on.csv", TPC_HEADER);
+  tpcInit();
+  tpcRun({{500, 500}, {1000, 500}, {5900, 500}, {6000, 500}, {6100, 500},
+          {500, 450}, {600, 450}, {0, 450}, {400, 450}, {0, 450}, {0, 450}}, 50);
+  closeTrace();
+}
+
+// millis() wraps in the middle of a window
+static void recordTpcWrap(const char* dir) {
+  openTrace(dir, "tpc_wrap.csv", TPC_HEADER);
+  tpcWrap(9000);
+  tpcInit();
+  tpcRun({{4000, 0}, {4000, 0}, {2500, 0}, {5000, 0}}, 50);
+  closeTrace();
+}
+
+int main(int argc, char** argv) {
+  if (argc != 2) {
+    fprintf(stderr, "usage: %s <golden dir>\n", argv[0]);
+    return 2;
+  }
+  const char* dir = argv[1];
+  recordPidStep(dir);
+  recordPidMode(dir);
+  recordPidLimits(dir);
+  recordPidPonM(dir);
+  recordPidWrap(dir);
+  recordTpcWindow(dir);
+  recordTpcStall(dir);
+  recordTpcMinOn(dir);
+  recordTpcWrap(dir);
+  return 0;
+}
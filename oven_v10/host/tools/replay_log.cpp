@@ -0,0 +1,55 @@
+// =================================================================
+// LOG REPLAY TOOL
+// =================================================================
+// Replays a day log against this firmware's control code (see
+// log_replay.h) and reports, per diffed column, how many rows the
+// replay disagrees with and by how much.
+//
+//   replay_log <YYYYMMDD.CSV or ovenlog.csv> [step_ms] [pid_tolerance] [max_kw] [max_heaters]
+//
+// max_kw / max_heaters: the oven's SET_POWER_BUDGET, if it has one.
+//
+// Output is CSV on stdout: column,rows,mismatches,max_error
+// A summary (rows, reseeds, rows/s) goes to stderr.
+
+#include <chrono>
+#include <stdio.h>
+#include <stdlib.h>
+#include "log_replay.h"
+
+int main(int argc, char** argv) {
+  if (argc < 2) {
+    fprintf(stderr, "usage: replay_log <log.csv> [step_ms] [pid_tolerance] [max_kw] [max_heaters]\n");
+    return 2;
+  }
+  ReplayOptions options;
+  if (argc > 2) options.stepMs = strtoul(argv[2], NULL, 10);
+  if (argc > 3) options.pidTolerance = strtod(argv[3], NULL);
+  if (argc > 4) options.maxKw = strtod(argv[4], NULL);
+  if (argc > 5) options.maxHeaters = (unsigned)strtoul(argv[5], NULL, 10);
+
+  FILE* in = fopen(argv[1], "r");
+  if (in == NULL) {
+    fprintf(stderr, "replay_log: cannot open %s\n", argv[1]);
+    return 1;
+  }
+  ReplayReport report;
+  std::string error;
+  std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+  bool ok = replayLog(in, options, report, error);
+  double sec = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+  fclose(in);
+  if (!ok) {
+    fprintf(stderr, "replay_log: %s: %s\n", argv[1], error.c_str());
+    return 1;
+  }
+
+  printf("column,rows,mismatches,max_error\n");
+  for (size_t i = 0; i < report.columns.size(); i++) {
+    const ReplayColumn &c = report.columns[i];
+    printf("%s,%lu,%lu,%.3f\n", c.name.c_str(), report.compared, c.mismatches, c.maxError);
+  }
+  fprintf(stderr, "replay_log: %lu rows, %lu compared, %lu reseeds, %.2f s (%.0f rows/s)\n",
+          report.rows, report.compared, report.reseeds, sec, sec > 0 ? report.rows / sec : 0);
+  return 0;
+}
@@ -0,0 +1,250 @@
+// =================================================================
+// PARAMETER SWEEP OPTIMIZER
+// =================================================================
+// Searches each zone's PID gains, minimum on-time and preheat tolerance
+// for the bake of bake_sim.h. The search is a grid on which every zone
+// takes the same values, then Nelder-Mead over all zones from the best
+// grid points under several weightings of the costs. The bakes run in
+// parallel, one simulation per worker. It prints the Pareto set of
+// every bake it ran.
+//
+// PID_WINDOW_SIZE is a build constant: the host build makes one binary
+// per window (sweep_params_w<ms>), and --merge combines their outputs.
+//
+//   sweep_params [--threads N] [--levels L] [--starts S] [--nm-evals E]
+//                [--minutes M] [--band C] [--plant zone,gain,tau,tau2,dead]... [--all]
+//   sweep_params --merge <sweep.csv>...
+//
+// Output is CSV on stdout:
+//   window,kp_<zone>,ki_<zone>,kd_<zone>,min_on_<zone>,tol_<zone>...,overshoot,settle_s,cycles,energy_kwh
+// --all prints every bake, not only the Pareto set.
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <algorithm>
+#include <chrono>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include "bake_sim.h"
+#include "param_search.h"
+
+const int DIMS_PER_ZONE = 5; // kp, ki, kd, min_on, tol
+const double NM_STEP = 0.15;
+
+// Relative weights of the costs for the Nelder-Mead runs: balanced,
+// then each term favoured in turn
+const double WEIGHTS[][SWEEP_COST_COUNT] = {
+  {1, 1, 1, 1}, {4, 1, 1, 1}, {1, 4, 1, 1}, {1, 1, 4, 1}, {1, 1, 1, 4},
+};
+const int WEIGHT_COUNT = sizeof(WEIGHTS) / sizeof(WEIGHTS[0]);
+
+// Gains are in ms of window, so their ranges follow the window
+static std::vector<SweepDim> sweepDims() {
+  const double w = PID_WINDOW_SIZE;
+  std::vector<SweepDim> dims;
+  for (uint8_t z = 0; z < ZONE_COUNT; z++) {
+    std::string zone = ZONE_TABLE[z].name;
+    dims.push_back({"kp_" + zone, 0.005 * w, 0.15 * w, false});
+    dims.push_back({"ki_" + zone, 0.0, 0.002 * w, false});
+    dims.push_back({"kd_" + zone, 0.0, 2.0 * w, false});
+    dims.push_back({"min_on_" + zone, 0.0, w / 2, true});
+    dims.push_back({"tol_" + zone, 0.5, 10.0, false});
+  }
+  return dims;
+}
+
+static BakeParams paramsFor(const std::vector<SweepDim> &dims, const std::vector<double> &x) {
+  BakeParams p = defaultBakeParams();
+  for (uint8_t z = 0; z < ZONE_COUNT; z++) {
+    const size_t d = z * DIMS_PER_ZONE;
+    p.kp[z] = sweepValue(dims[d], x[d]);
+    p.ki[z] = sweepValue(dims[d + 1], x[d + 1]);
+    p.kd[z] = sweepValue(dims[d + 2], x[d + 2]);
+    p.minOnMs[z] = (unsigned long)sweepValue(dims[d + 3], x[d + 3]);
+    p.preheatTolerance[z] = sweepValue(dims[d + 4], x[d + 4]);
+  }
+  return p;
+}
+
+static void printHeader(const std::vector<SweepDim> &dims) {
+  printf("window");
+  for (size_t d = 0; d < dims.size(); d++) printf(",%s", dims[d].name.c_str());
+  for (int c = 0; c < SWEEP_COST_COUNT; c++) printf(",%s", SWEEP_COST_NAMES[c]);
+  printf("\n");
+}
+
+static void printPoint(const std::vector<SweepDim> &dims, const SweepPoint &p) {
+  printf("%d", PID_WINDOW_SIZE);
+  for (size_t d = 0; d < dims.size(); d++) printf(",%.6g", sweepValue(dims[d], p.x[d]));
+  printf(",%.2f,%.1f,%.0f,%.4f\n", p.cost[COST_OVERSHOOT], p.cost[COST_SETTLE], p.cost[COST_CYCLES],
+         p.cost[COST_ENERGY]);
+}
+
+// --- Merge: Pareto set over the rows of several sweeps (same header) ---
+
+static int merge(int count, char** paths) {
+  std::string header;
+  std::vector<std::string> rows;
+  std::vector<SweepPoint> points;
+  for (int i = 0; i < count; i++) {
+    FILE* in = fopen(paths[i], "r");
+    if (in == NULL) {
+      fprintf(stderr, "sweep_params: cannot open %s\n", paths[i]);
+      return 1;
+    }
+    char line[4096];
+    bool first = true;
+    while (fgets(line, sizeof(line), in) != NULL) {
+      line[strcspn(line, "\r\n")] = '\0';
+      if (first) {
+        first = false;
+        if (header.empty()) header = line;
+        if (header != line) {
+          fprintf(stderr, "sweep_params: %s: different columns\n", paths[i]);
+          fclose(in);
+          return 1;
+        }
+        continue;
+      }
+      // Costs are the last columns
+      std::vector<double> values;
+      for (char* field = strtok(line, ","); field != NULL; field = strtok(NULL, ",")) values.push_back(strtod(field, NULL));
+      if (values.size() < (size_t)SWEEP_COST_COUNT) continue;
+      SweepPoint p;
+      for (int c = 0; c < SWEEP_COST_COUNT; c++) p.cost[c] = values[values.size() - SWEEP_COST_COUNT + c];
+      points.push_back(p);
+      std::string row;
+      for (size_t v = 0; v < values.size(); v++) {
+        char buf[32];
+        snprintf(buf, sizeof(buf), "%s%.6g", v > 0 ? "," : "", values[v]);
+        row += buf;
+      }
+      rows.push_back(row);
+    }
+    fclose(in);
+  }
+  printf("%s\n", header.c_str());
+  std::vector<size_t> front = paretoFront(points);
+  for (size_t i = 0; i < front.size(); i++) printf("%s\n", rows[front[i]].c_str());
+  return 0;
+}
+
+// --- Search ---
+
+struct Sweep {
+  BakeScenario scenario;
+  std::vector<SweepDim> dims;
+  std::mutex lock;
+  std::vector<SweepPoint> points; // Every bake run, any order
+
+  SweepPoint run(const std::vector<double> &x) {
+    SweepPoint p;
+    p.x = x;
+    simulateBake(scenario, paramsFor(dims, x), p.cost);
+    std::lock_guard<std::mutex> guard(lock);
+    points.push_back(p);
+    return p;
+  }
+};
+
+static double weighted(const SweepPoint &p, const double* weight, const double* scale) {
+  double sum = 0;
+  for (int c = 0; c < SWEEP_COST_COUNT; c++) sum += weight[c] * p.cost[c] / scale[c];
+  return sum;
+}
+
+static bool parsePlant(const char* text, BakeScenario &scenario) {
+  char zone[16];
+  PlantParams p;
+  if (sscanf(text, "%15[^,],%lf,%lf,%lf,%lf", zone, &p.gain, &p.tau, &p.tau2, &p.deadTime) != 5) return false;
+  for (uint8_t z = 0; z < ZONE_COUNT; z++) {
+    if (strcmp(zone, ZONE_TABLE[z].name) != 0) continue;
+    p.ambient = scenario.plant[z].ambient;
+    scenario.plant[z] = p;
+    return true;
+  }
+  return false;
+}
+
+int main(int argc, char** argv) {
+  if (argc > 1 && strcmp(argv[1], "--merge") == 0) return merge(argc - 2, argv + 2);
+
+  unsigned threads = std::max(1u, std::thread::hardware_concurrency());
+  int levels = 3, starts = 2 * WEIGHT_COUNT, nmEvals = 150;
+  bool all = false;
+  Sweep sweep;
+  sweep.scenario = defaultBakeScenario();
+  sweep.dims = sweepDims();
+  for (int i = 1; i < argc; i++) {
+    if (strcmp(argv[i], "--threads") == 0 && i + 1 < argc) threads = (unsigned)atoi(argv[++i]);
+    else if (strcmp(argv[i], "--levels") == 0 && i + 1 < argc) levels = atoi(argv[++i]);
+    else if (strcmp(argv[i], "--starts") == 0 && i + 1 < argc) starts = atoi(argv[++i]);
+    else if (strcmp(argv[i], "--nm-evals") == 0 && i + 1 < argc) nmEvals = atoi(argv[++i]);
+    else if (strcmp(argv[i], "--minutes") == 0 && i + 1 < argc) sweep.scenario.minutes = strtod(argv[++i], NULL);
+    else if (strcmp(argv[i], "--band") == 0 && i + 1 < argc) sweep.scenario.settleBand = strtod(argv[++i], NULL);
+    else if (strcmp(argv[i], "--all") == 0) all = true;
+    else if (strcmp(argv[i], "--plant") == 0 && i + 1 < argc && parsePlant(argv[i + 1], sweep.scenario)) i++;
+    else {
+      fprintf(stderr, "usage: sweep_params [--threads N] [--levels L] [--starts S] [--nm-evals E]\n"
+                      "                    [--minutes M] [--band C] [--plant zone,gain,tau,tau2,dead]... [--all]\n"
+                      "       sweep_params --merge <sweep.csv>...\n");
+      return 2;
+    }
+  }
+  if (levels < 2 || starts < 0 || threads < 1 || sweep.scenario.settleBand <= 0 || sweep.scenario.minutes <= 0
+      || sweep.scenario.minutes > MAX_HOLDING_MINUTES) {
+    fprintf(stderr, "sweep_params: option out of range\n");
+    return 2;
+  }
+  auto began = std::chrono::steady_clock::now();
+
+  // 1. Grid, zones alike
+  std::vector<int> axisOf;
+  for (size_t d = 0; d < sweep.dims.size(); d++) axisOf.push_back((int)(d % DIMS_PER_ZONE));
+  std::vector<std::vector<double> > grid = unitGrid(axisOf, DIMS_PER_ZONE, levels);
+  std::vector<SweepPoint> gridPoints(grid.size());
+  parallelFor(grid.size(), threads, [&](size_t i) { gridPoints[i] = sweep.run(grid[i]); });
+
+  // Costs are scaled by their grid median before weighting
+  double scale[SWEEP_COST_COUNT];
+  for (int c = 0; c < SWEEP_COST_COUNT; c++) {
+    std::vector<double> v;
+    for (size_t i = 0; i < gridPoints.size(); i++) v.push_back(gridPoints[i].cost[c]);
+    std::nth_element(v.begin(), v.begin() + v.size() / 2, v.end());
+    scale[c] = v[v.size() / 2] > 0 ? v[v.size() / 2] : 1.0;
+  }
+
+  // 2. Nelder-Mead over every zone's values, from the k-th best grid point of a weighting
+  parallelFor((size_t)starts, threads, [&](size_t r) {
+    const double* weight = WEIGHTS[r % WEIGHT_COUNT];
+    std::vector<size_t> order(gridPoints.size());
+    for (size_t i = 0; i < order.size(); i++) order[i] = i;
+    size_t k = std::min(order.size() - 1, r / WEIGHT_COUNT);
+    std::nth_element(order.begin(), order.begin() + k, order.end(), [&](size_t a, size_t b) {
+      return weighted(gridPoints[a], weight, scale) < weighted(gridPoints[b], weight, scale);
+    });
+    nelderMead([&](const std::vector<double> &x) { return weighted(sweep.run(x), weight, scale); },
+               gridPoints[order[k]].x, NM_STEP, nmEvals);
+  });
+
+  double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - began).count();
+  std::vector<size_t> front = paretoFront(sweep.points);
+  fprintf(stderr, "sweep_params: window %d ms, %zu bakes on %u threads in %.1f s, %zu on the Pareto set\n",
+          PID_WINDOW_SIZE, sweep.points.size(), threads, seconds, front.size());
+
+  printHeader(sweep.dims);
+  if (all) {
+    for (size_t i = 0; i < sweep.points.size(); i++) printPoint(sweep.dims, sweep.points[i]);
+  } else {
+    // Cheapest energy first
+    std::sort(front.begin(), front.end(), [&](size_t a, size_t b) {
+      return sweep.points[a].cost[COST_ENERGY] < sweep.points[b].cost[COST_ENERGY];
+    });
+    for (size_t i = 0; i < front.size(); i++) printPoint(sweep.dims, sweep.points[front[i]]);
+  }
+  return 0;
+}
@@ -0,0 +1,44 @@
+#include "thermal_plant.h"
+#include <math.h>
+
+ThermalPlant::ThermalPlant(const PlantParams &params, double stepSec)
+  : p(params), dt(stepSec), delayPos(0) {
+  size_t steps = (size_t)floor(p.deadTime / dt + 0.5);
+  delay.assign(steps, 0.0);
+  reset(p.ambient);
+}
+
+void ThermalPlant::reset(double celsius) {
+  probe = heater = celsius;
+  for (size_t i = 0; i < delay.size(); i++) delay[i] = 0.0;
+  delayPos = 0;
+  energy = 0;
+}
+
+void ThermalPlant::step(double u) {
+  if (u < 0) u = 0;
+  if (u > 1) u = 1;
+  energy += u * dt;
+
+  double acting = u;
+  if (!delay.empty()) {
+    acting = delay[delayPos];
+    delay[delayPos] = u;
+    delayPos = (delayPos + 1) % delay.size();
+  }
+
+  // Exact for u held over the step (zero-order hold)
+  double target = p.ambient + p.gain * acting;
+  if (p.tau2 > 0) {
+    double h0 = heater;
+    double a2 = exp(-dt / p.tau2);
+    heater = target + (h0 - target) * a2;
+    // Probe follows the heater node; heater treated as linear over the step
+    double a = exp(-dt / p.tau);
+    double mid = 0.5 * (h0 + heater);
+    probe = mid + (probe - mid) * a;
+  } else {
+    double a = exp(-dt / p.tau);
+    probe = target + (probe - target) * a;
+  }
+}
@@ -0,0 +1,53 @@
+#ifndef HOST_THERMAL_PLANT_H
+#define HOST_THERMAL_PLANT_H
+
+// =================================================================
+// THERMAL PLANT
+// =================================================================
+// One heated zone for closed-loop simulations of the firmware. The
+// heater duty u (0..1; a relay is 0 or 1) acts after 'deadTime' on
+//
+//   first order (FOPDT, tau2 = 0):  tau  dT/dt = ambient + gain u - T
+//   two nodes (tau2 > 0):           tau2 dH/dt = ambient + gain u - H
+//                                   tau  dT/dt = H - T
+//
+// so 'gain' is the steady rise at full duty, as in ThermalModel. H is
+// the element/mass between the heater and the probe. Plain state, no
+// globals: give every simulation its own plants.
+
+#include <stddef.h>
+#include <vector>
+
+struct PlantParams {
+  double gain = 400.0;     // Steady rise above ambient at full duty (C)
+  double tau = 300.0;      // Probe node time constant (s)
+  double tau2 = 0.0;       // Heater node time constant (s), 0 = first order
+  double deadTime = 10.0;  // Transport delay (s)
+  double ambient = 25.0;
+};
+
+class ThermalPlant {
+  public:
+    // 'stepSec' is the fixed step() interval the dead time is counted in
+    ThermalPlant(const PlantParams &params, double stepSec);
+
+    // Advance one step with duty u held over it
+    void step(double u);
+    double temp() const { return probe; }
+    // Start at 'celsius' in equilibrium, with no heat in flight
+    void reset(double celsius);
+    // Heat delivered so far in full-duty seconds (energy / heater power)
+    double dutySeconds() const { return energy; }
+
+    const PlantParams& params() const { return p; }
+
+  private:
+    PlantParams p;
+    double dt;
+    double probe, heater;
+    std::vector<double> delay; // Duty waiting out the dead time, ring
+    size_t delayPos;
+    double energy;
+};
+
+#endif // HOST_THERMAL_PLANT_H
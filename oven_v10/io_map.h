@@ -9,6 +9,7 @@
 const int TEMP_CS_PIN_ROD1      = 11;
 const int TEMP_CS_PIN_ROD_STEAM = 13;
 const int TEMP_CS_PIN_ROD2      = 12; 
+const int TEMP_CS_PIN_CHAMBER   = 7;  // Optional chamber-air probe (cascade)
 
 // Define CS Pin for SD Card
 const int SD_CS_PIN = 10;
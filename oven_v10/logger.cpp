@@ -3,30 +3,292 @@
 */
 #include "logger.h"
 #include "config.h"  
+#include "app.h"     // Needs sendToPort(), sendErrorToPort(), canSendToPort()
+#include "wallclock.h"
+#include "zone_mode.h" // Needs zoneModeName()
 #include <SPI.h>
 #include <SD.h>
 
 // Definitions
-const char* LOG_FILENAME = "ovenlog.csv";
+const char* LOG_DIR = "/LOGS";
+const char* LOG_INDEX_FILENAME = "/LOGS/INDEX.BIN";
+// Pruned copy of the index while it is rewritten (no rename on SD)
+const char* LOG_INDEX_TEMP_FILENAME = "/LOGS/INDEX.TMP";
 
-// --- EXTERNAL VARIABLES ---
-// Access the global 'settings' object defined in config.h
-extern PersistentSettings settings; 
+// Day files older than this are deleted on rotation
+const uint32_t LOG_RETENTION_DAYS = 90;
+// Add a checkpoint to the index at least this often (seconds)
+const uint32_t LOG_INDEX_INTERVAL_SEC = 900;
+// Day file parts: .CSV, then .CS1 .. .CS9 after header changes
+const uint8_t LOG_MAX_PARTS = 10;
+// Longest header line (about 330 characters with three zones)
+const size_t LOG_HEADER_SIZE = 96 + 140 * ZONE_COUNT;
 
-// Access the global 'currentTemps' array (Float, as per config.h)
-extern float currentTemps[3];
+// Download pacing
+const uint16_t LOG_CHUNK_SIZE = 128;           // Raw bytes per chunk (before base64)
+const unsigned long LOG_ACK_TIMEOUT_MS = 2000;
+const uint8_t LOG_MAX_RETRIES = 5;
+const uint8_t LOG_LIST_ENTRIES_PER_LOOP = 4;
 
-// Access the global 'relayStates'
-extern RelayStates relayStates;
+// --- LOGGER STATE ---
+// The day file stays open between rows; flush() commits each row so
+// we never pay for SD.open() seeking to EOF every 3 seconds.
+static File logFile;
+static bool sdReady = false;
+static uint32_t openFileDate = 0;
+static uint8_t openFilePart = 0;
+static OvenState lastLoggedState = IDLE;
+static uint32_t lastIndexTime = 0;   // Time of the last index entry, 0 = none
+static uint8_t indexSegment = 0;
 
-// Access the global 'currentState'
-extern OvenState currentState;
+// =================================================================
+// HELPERS
+// =================================================================
 
-extern double pidOutputRod1;
-extern double pidOutputRod2;
-extern double pidOutputSteam;
+// Column names follow ZONE_TABLE: set_<zone>..., live_<zone>...,
+// Kp/Ki/Kd/pid/sp/iterm/mode_<zone> per zone, rel_<zone>..., rel_valve
+const char* logHeader() {
+  static char header[LOG_HEADER_SIZE];
+  if (header[0] != '\0') return header;
 
-void initializeLogger() {
+  size_t n = snprintf(header, sizeof(header), "date,time,state");
+  for (uint8_t z = 0; z < ZONE_COUNT; z++) n += snprintf(header + n, sizeof(header) - n, ",set_%s", ZONE_TABLE[z].name);
+  for (uint8_t z = 0; z < ZONE_COUNT; z++) n += snprintf(header + n, sizeof(header) - n, ",live_%s", ZONE_TABLE[z].name);
+  const char* pidCols[7] = {",Kp_", ",Ki_", ",Kd_", ",pid_", ",sp_", ",iterm_", ",mode_"};
+  for (uint8_t z = 0; z < ZONE_COUNT; z++) {
+    for (uint8_t c = 0; c < 7; c++) n += snprintf(header + n, sizeof(header) - n, "%s%s", pidCols[c], ZONE_TABLE[z].name);
+  }
+  for (uint8_t z = 0; z < ZONE_COUNT; z++) n += snprintf(header + n, sizeof(header) - n, ",rel_%s", ZONE_TABLE[z].name);
+  snprintf(header + n, sizeof(header) - n, ",rel_valve");
+  return header;
+}
+
+// True if the file at 'path' starts with exactly this firmware's header line
+static bool logHeaderMatches(const char* path) {
+  File f = SD.open(path, FILE_READ);
+  if (!f) return false;
+  const char* header = logHeader();
+  size_t len = strlen(header);
+  bool match = true;
+  for (size_t i = 0; i < len && match; i++) match = (f.read() == (uint8_t)header[i]);
+  int end = f.read();
+  f.close();
+  return match && (end == '\r' || end == '\n');
+}
+
+static uint32_t dateKey(const DateTime &t) {
+  return (uint32_t)t.year() * 10000UL + t.month() * 100UL + t.day();
+}
+
+void logFileNameForDate(uint32_t fileDate, uint8_t part, char* buf, size_t len) {
+  if (part == 0) snprintf(buf, len, "%s/%08lu.CSV", LOG_DIR, (unsigned long)fileDate);
+  else snprintf(buf, len, "%s/%08lu.CS%u", LOG_DIR, (unsigned long)fileDate, (unsigned)part);
+}
+
+static void appendIndexEntry(const OvenController &oven, uint32_t unixTime, uint32_t offset, uint8_t event) {
+  File indexFile = SD.open(LOG_INDEX_FILENAME, FILE_WRITE);
+  if (!indexFile) {
+    Serial.println("Error opening log index for writing.");
+    return;
+  }
+  // Clock set back: times only rise within a segment
+  if (lastIndexTime != 0 && unixTime < lastIndexTime && indexSegment < 255) indexSegment++;
+  LogIndexEntry entry;
+  entry.unixTime = unixTime;
+  entry.fileDate = openFileDate;
+  entry.offset   = offset;
+  entry.state    = (uint8_t)oven.currentState;
+  entry.event    = event;
+  entry.part     = openFilePart;
+  entry.segment  = indexSegment;
+  indexFile.write((const uint8_t*)&entry, sizeof(entry));
+  indexFile.close();
+  lastIndexTime = unixTime;
+}
+
+static bool isBatchState(OvenState s) {
+  return s == PREHEATING || s == READY || s == RUNNING || s == ALARM_COMPLETION;
+}
+
+// Parse "YYYYMMDD.CSV" / "YYYYMMDD.CS1".."CS9" -> YYYYMMDD, 0 if the name does not match
+static uint32_t parseLogFileDate(const char* name) {
+  const char* base = strrchr(name, '/');
+  base = base ? base + 1 : name;
+  uint32_t date = 0;
+  for (int i = 0; i < 8; i++) {
+    if (base[i] < '0' || base[i] > '9') return 0;
+    date = date * 10 + (base[i] - '0');
+  }
+  if (strcasecmp(base + 8, ".CSV") == 0) return date;
+  bool part = strncasecmp(base + 8, ".CS", 3) == 0 && base[11] >= '1' && base[11] <= '9' && base[12] == '\0';
+  return part ? date : 0;
+}
+
+static bool readIndexEntry(File &indexFile, long index, LogIndexEntry &entry) {
+  indexFile.seek(index * sizeof(LogIndexEntry));
+  return indexFile.read(&entry, sizeof(entry)) == sizeof(entry);
+}
+
+// Copy 'from' to 'to' (replaced), leaving out entries for day files
+// before cutoffDate (0 = keep all) and renumbering the segments from 0.
+// Returns the entries dropped, -1 on error.
+static long copyIndex(const char* from, const char* to, uint32_t cutoffDate) {
+  File in = SD.open(from, FILE_READ);
+  if (!in) return -1;
+  SD.remove(to);
+  File out = SD.open(to, FILE_WRITE);
+  if (!out) {
+    in.close();
+    return -1;
+  }
+  long dropped = 0;
+  bool first = true;
+  uint8_t oldSegment = 0, newSegment = 0;
+  LogIndexEntry entry;
+  while (in.read(&entry, sizeof(entry)) == sizeof(entry)) {
+    if (entry.fileDate < cutoffDate) {
+      dropped++;
+      continue;
+    }
+    if (!first && entry.segment != oldSegment) newSegment++;
+    first = false;
+    oldSegment = entry.segment;
+    entry.segment = newSegment;
+    if (out.write((const uint8_t*)&entry, sizeof(entry)) != sizeof(entry)) dropped = -1;
+  }
+  in.close();
+  out.close();
+  return dropped;
+}
+
+// Rewrite the index without entries for day files before cutoffDate:
+// pruned copy first, then over the index. A copy left by a reset is
+// finished by recoverLogIndex().
+static void pruneLogIndex(uint32_t cutoffDate) {
+  long dropped = copyIndex(LOG_INDEX_FILENAME, LOG_INDEX_TEMP_FILENAME, cutoffDate);
+  if (dropped > 0) {
+    // On failure the copy stays for the next boot to restore
+    if (copyIndex(LOG_INDEX_TEMP_FILENAME, LOG_INDEX_FILENAME, 0) != 0) return;
+    Serial.print("Pruned log index entries: "); Serial.println(dropped);
+  }
+  SD.remove(LOG_INDEX_TEMP_FILENAME);
+}
+
+// Boot: finish an interrupted pruneLogIndex() (the index missing or
+// shorter than its pruned copy), then pick up where the index left off
+static void recoverLogIndex() {
+  if (SD.exists(LOG_INDEX_TEMP_FILENAME)) {
+    File temp = SD.open(LOG_INDEX_TEMP_FILENAME, FILE_READ);
+    File index = SD.open(LOG_INDEX_FILENAME, FILE_READ);
+    bool restore = temp && (!index || index.size() < temp.size());
+    if (temp) temp.close();
+    if (index) index.close();
+    if (restore) copyIndex(LOG_INDEX_TEMP_FILENAME, LOG_INDEX_FILENAME, 0);
+    SD.remove(LOG_INDEX_TEMP_FILENAME);
+  }
+
+  lastIndexTime = 0;
+  indexSegment = 0;
+  File indexFile = SD.open(LOG_INDEX_FILENAME, FILE_READ);
+  if (!indexFile) return;
+  LogIndexEntry last;
+  long count = (long)(indexFile.size() / sizeof(LogIndexEntry));
+  if (count > 0 && readIndexEntry(indexFile, count - 1, last)) {
+    lastIndexTime = last.unixTime;
+    indexSegment = last.segment;
+  }
+  indexFile.close();
+}
+
+void pruneLogsBefore(uint32_t cutoffDate) {
+  File dir = SD.open(LOG_DIR);
+  if (!dir) return;
+
+  char path[32];
+  bool pruned = false;
+  while (true) {
+    File entry = dir.openNextFile();
+    if (!entry) break;
+    uint32_t date = entry.isDirectory() ? 0 : parseLogFileDate(entry.name());
+    snprintf(path, sizeof(path), "%s/%s", LOG_DIR, entry.name());
+    entry.close();
+    if (date != 0 && date < cutoffDate && date != openFileDate) {
+      SD.remove(path);
+      Serial.print("Pruned log "); Serial.println(path);
+      pruned = true;
+    }
+  }
+  dir.close();
+
+  // Also drops entries an older firmware left for files already gone
+  LogIndexEntry first;
+  File indexFile = SD.open(LOG_INDEX_FILENAME, FILE_READ);
+  bool stale = indexFile && readIndexEntry(indexFile, 0, first) && first.fileDate < cutoffDate;
+  if (indexFile) indexFile.close();
+  if (pruned || stale) pruneLogIndex(cutoffDate);
+}
+
+// Card full: drop the single oldest day file that is not in use
+static bool pruneOldestLog() {
+  File dir = SD.open(LOG_DIR);
+  if (!dir) return false;
+
+  uint32_t oldest = 0;
+  while (true) {
+    File entry = dir.openNextFile();
+    if (!entry) break;
+    uint32_t date = entry.isDirectory() ? 0 : parseLogFileDate(entry.name());
+    entry.close();
+    if (date != 0 && date != openFileDate && (oldest == 0 || date < oldest)) oldest = date;
+  }
+  dir.close();
+
+  if (oldest == 0) return false;
+  pruneLogsBefore(oldest + 1);
+  return true;
+}
+
+// Close the current day file (if any) and open the one for 'now': the
+// first part that is new or already has this firmware's header
+static bool rotateLogFile(const OvenController &oven, const DateTime &now) {
+  if (logFile) logFile.close();
+
+  openFileDate = dateKey(now);
+  char path[32];
+  bool isNew = false;
+  uint8_t part = 0;
+  for (; part < LOG_MAX_PARTS; part++) {
+    logFileNameForDate(openFileDate, part, path, sizeof(path));
+    isNew = !SD.exists(path);
+    if (isNew || logHeaderMatches(path)) break;
+  }
+  if (part == LOG_MAX_PARTS) {
+    Serial.println("Every log file part for today has other columns, not logging.");
+    openFileDate = 0;
+    return false;
+  }
+  openFilePart = part;
+
+  logFile = SD.open(path, FILE_WRITE);
+  if (!logFile) {
+    Serial.println("Error opening log file for writing.");
+    openFileDate = 0;
+    return false;
+  }
+  if (isNew) {
+    logFile.println(logHeader());
+    logFile.flush();
+    Serial.print(part == 0 ? "Created new log file " : "Log columns changed, continuing in ");
+    Serial.println(path);
+  }
+  appendIndexEntry(oven, now.unixtime(), logFile.size(), LOG_EVENT_FILE_OPEN);
+
+  DateTime cutoff(now.unixtime() - LOG_RETENTION_DAYS * 86400UL);
+  pruneLogsBefore(dateKey(cutoff));
+  return true;
+}
+
+void initializeLogger(const OvenController &oven) {
   Serial.print("Initializing SD Card on CS Pin ");
   Serial.print(SD_CS_PIN);
   Serial.println("...");
@@ -37,23 +299,85 @@ void initializeLogger() {
   }
   Serial.println("SD Card Initialized.");
 
-  // Check if file exists. If NO, create it and write the NEW header.
-  if (!SD.exists(LOG_FILENAME)) {
-    File logFile = SD.open(LOG_FILENAME, FILE_WRITE);
-    if (logFile) {
-      // Header with 9 PID columns (3 per rod)
-      logFile.println("date,time,state,set_rod1,set_rod2,set_rod3,live_rod1,live_rod2,live_rod3,Kp_rod1,Ki_rod1,Kd_rod1,pid_rod1,Kp_rod2,Ki_rod2,Kd_rod2,pid_rod2,Kp_rod3,Ki_rod3,Kd_rod3,pid_rod3,rel_rod1,rel_rod2,rel_rod3,rel_valve");
-      logFile.close();
-      Serial.println("Created new log file with updated headers.");
+  if (!SD.exists(LOG_DIR)) SD.mkdir(LOG_DIR);
+  recoverLogIndex();
+  sdReady = true;
+  lastLoggedState = oven.currentState;
+  rotateLogFile(oven, wallClockNow());
+}
+
+bool findLogPosition(uint32_t unixTime, LogIndexEntry &entry) {
+  File indexFile = SD.open(LOG_INDEX_FILENAME, FILE_READ);
+  if (!indexFile) return false;
+
+  // Segments follow each other in the file, times rise within one.
+  // Newest first: the last entry with time <= unixTime in a segment
+  // whose span covers unixTime, else in the newest segment with one.
+  long end = (long)(indexFile.size() / sizeof(LogIndexEntry)) - 1;
+  bool found = false;
+  LogIndexEntry probe, last, match;
+  while (end >= 0) {
+    if (!readIndexEntry(indexFile, end, last)) break;
+
+    // First entry of the segment
+    long lo = 0, hi = end, begin = end;
+    while (lo <= hi) {
+      long mid = lo + (hi - lo) / 2;
+      if (!readIndexEntry(indexFile, mid, probe)) break;
+      if (probe.segment >= last.segment) {
+        begin = mid;
+        hi = mid - 1;
+      } else {
+        lo = mid + 1;
+      }
+    }
+
+    bool inSegment = false;
+    lo = begin;
+    hi = end;
+    while (lo <= hi) {
+      long mid = lo + (hi - lo) / 2;
+      if (!readIndexEntry(indexFile, mid, probe)) break;
+      if (probe.unixTime <= unixTime) {
+        match = probe;
+        inSegment = true;
+        lo = mid + 1;
+      } else {
+        hi = mid - 1;
+      }
     }
+    if (inSegment && (!found || unixTime <= last.unixTime)) {
+      entry = match;
+      found = true;
+      if (unixTime <= last.unixTime) break;
+    }
+    end = begin - 1;
   }
+  indexFile.close();
+  return found;
 }
 
-void logSystemData() {
-  File logFile = SD.open(LOG_FILENAME, FILE_WRITE);
-  
+void logSystemData(const OvenController &oven) {
+  if (!sdReady) return;
+
+  DateTime now = wallClockNow();
+  if (!logFile || dateKey(now) != openFileDate) {
+    if (!rotateLogFile(oven, now)) return;
+  }
+
   if (logFile) {
-    DateTime now = rtc.now();
+    // --- INDEX: batch boundaries, state transitions, checkpoints ---
+    uint32_t rowOffset = logFile.size();
+    if (oven.currentState != lastLoggedState) {
+      uint8_t event = LOG_EVENT_STATE_CHANGE;
+      if (isBatchState(oven.currentState) && !isBatchState(lastLoggedState)) event = LOG_EVENT_BATCH_START;
+      else if (oven.currentState == IDLE && isBatchState(lastLoggedState)) event = LOG_EVENT_BATCH_END;
+      appendIndexEntry(oven, now.unixtime(), rowOffset, event);
+      lastLoggedState = oven.currentState;
+    } else if (now.unixtime() - lastIndexTime >= LOG_INDEX_INTERVAL_SEC) {
+      appendIndexEntry(oven, now.unixtime(), rowOffset, LOG_EVENT_CHECKPOINT);
+    }
+
     char buf[20];
 
     // 1. Date (YYYY-MM-DD)
@@ -68,64 +392,234 @@ void logSystemData() {
 
     // 3. State
     String stateStr = "IDLE";
-    if (currentState == PREHEATING) stateStr = "PREHEAT";
-    else if (currentState == READY) stateStr = "READY";
-    else if (currentState == RUNNING) stateStr = "RUNNING";
-    else if (currentState == ALARM_COMPLETION) stateStr = "DONE";
-    else if (currentState == AWAITING_SCHEDULE) stateStr = "SCHED";
+    if (oven.currentState == PREHEATING) stateStr = "PREHEAT";
+    else if (oven.currentState == READY) stateStr = "READY";
+    else if (oven.currentState == RUNNING) stateStr = "RUNNING";
+    else if (oven.currentState == ALARM_COMPLETION) stateStr = "DONE";
+    else if (oven.currentState == AWAITING_SCHEDULE) stateStr = "SCHED";
     logFile.print(stateStr);
     logFile.print(",");
 
 
     // --- SET TEMPERATURES ---
-    logFile.print(settings.thresholds.rod1);
-    logFile.print(",");
-    logFile.print(settings.thresholds.rod2);
-    logFile.print(",");
-    logFile.print(settings.thresholds.rodSteam);
-    logFile.print(",");
+    for (uint8_t z = 0; z < ZONE_COUNT; z++) {
+      logFile.print(oven.settings.thresholds.zone[z]);
+      logFile.print(",");
+    }
 
     // --- LIVE TEMPERATURES ---
-    logFile.print(currentTemps[0]); // Rod 1
-    logFile.print(",");
-    logFile.print(currentTemps[2]); // Rod 2
-    logFile.print(",");
-    logFile.print(currentTemps[1]); // Rod 3 (Steam)
-    logFile.print(",");
+    for (uint8_t z = 0; z < ZONE_COUNT; z++) {
+      logFile.print(oven.zones.temp[z]);
+      logFile.print(",");
+    }
 
-    // --- PID PARAMETERS (ROD 1) ---
-    // Uses constants from config.h instead of QuickPID methods
-    logFile.print(ROD1_DEFAULT_KP); logFile.print(",");
-    logFile.print(ROD1_DEFAULT_KI); logFile.print(",");
-    logFile.print(ROD1_DEFAULT_KD); logFile.print(",");
-    logFile.print(pidOutputRod1); logFile.print(",");
-
-    // --- PID PARAMETERS (ROD 2) ---
-    logFile.print(ROD2_DEFAULT_KP); logFile.print(",");
-    logFile.print(ROD2_DEFAULT_KI); logFile.print(",");
-    logFile.print(ROD2_DEFAULT_KD); logFile.print(",");
-    logFile.print(pidOutputRod2); logFile.print(",");
-
-    // --- PID PARAMETERS (ROD 3 / STEAM) ---
-    logFile.print(STEAM_DEFAULT_KP); logFile.print(",");
-    logFile.print(STEAM_DEFAULT_KI); logFile.print(",");
-    logFile.print(STEAM_DEFAULT_KD); logFile.print(",");
-    logFile.print(pidOutputSteam); logFile.print(",");
+    // --- PID STATE (per zone) ---
+    // Gains actually in use, the setpoint the PID saw (cascade-adjusted)
+    // and its integral, so a row is enough to resume the controller
+    // offline and replay its decisions
+    for (uint8_t z = 0; z < ZONE_COUNT; z++) {
+      logFile.print(oven.zonePid[z].GetKp(), 4); logFile.print(",");
+      logFile.print(oven.zonePid[z].GetKi(), 4); logFile.print(",");
+      logFile.print(oven.zonePid[z].GetKd(), 4); logFile.print(",");
+      logFile.print((double)oven.zones.output[z]); logFile.print(",");
+      logFile.print((double)oven.zones.setpoint[z]); logFile.print(",");
+      logFile.print(oven.zonePid[z].GetIterm()); logFile.print(",");
+      logFile.print(zoneModeName((ZoneMode)oven.settings.zoneControl[z].mode)); logFile.print(",");
+    }
 
     // --- RELAY STATES ---
-    logFile.print(relayStates.rod1 ? "1" : "0");
-    logFile.print(",");
-    logFile.print(relayStates.rod2 ? "1" : "0");
-    logFile.print(",");
-    logFile.print(relayStates.rodSteam ? "1" : "0");
-    logFile.print(",");
+    for (uint8_t z = 0; z < ZONE_COUNT; z++) {
+      logFile.print(oven.relayStates.zone[z] ? "1" : "0");
+      logFile.print(",");
+    }
     
     // Valve (Last item, NO comma)
-    logFile.print(relayStates.valve ? "1" : "0");
+    logFile.print(oven.relayStates.valve ? "1" : "0");
 
     logFile.println(); // End Line
-    logFile.close();
-  } else {
-    Serial.println("Error opening log file for writing.");
+    logFile.flush();
+
+    // Short write means the card is full: free the oldest day and reopen
+    if (logFile.size() == rowOffset) {
+      Serial.println("Log write failed, pruning oldest log.");
+      if (pruneOldestLog()) rotateLogFile(oven, now);
+    }
+  }
+}
+
+// =================================================================
+// LOG DOWNLOAD
+// =================================================================
+
+// --- Transfer state (one list or read at a time) ---
+static Stream* listPort = NULL;
+static File listDir;
+static uint16_t listCount = 0;
+
+static Stream* readPort = NULL;
+static File readFile;
+static char readName[16];
+static uint32_t readOffset = 0;   // Next byte to send
+static uint32_t readEnd = 0;      // One past the last byte to send
+static uint32_t readStart = 0;
+static bool awaitingAck = false;
+static unsigned long lastChunkTime = 0;
+static uint8_t retries = 0;
+
+static uint32_t crc32(const uint8_t* data, size_t len) {
+  uint32_t crc = 0xFFFFFFFFUL;
+  for (size_t i = 0; i < len; i++) {
+    crc ^= data[i];
+    for (uint8_t b = 0; b < 8; b++) {
+      crc = (crc >> 1) ^ (0xEDB88320UL & (0 - (crc & 1)));
+    }
+  }
+  return ~crc;
+}
+
+static size_t base64Encode(const uint8_t* in, size_t len, char* out) {
+  static const char table[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+  size_t o = 0;
+  for (size_t i = 0; i < len; i += 3) {
+    uint32_t v = (uint32_t)in[i] << 16;
+    if (i + 1 < len) v |= (uint32_t)in[i + 1] << 8;
+    if (i + 2 < len) v |= in[i + 2];
+    out[o++] = table[(v >> 18) & 0x3F];
+    out[o++] = table[(v >> 12) & 0x3F];
+    out[o++] = (i + 1 < len) ? table[(v >> 6) & 0x3F] : '=';
+    out[o++] = (i + 2 < len) ? table[v & 0x3F] : '=';
   }
+  out[o] = '\0';
+  return o;
+}
+
+// "20261019.CSV" -> "/LOGS/20261019.CSV"; names with a '/' are used as-is
+static void resolveLogPath(const char* name, char* path, size_t len) {
+  if (strchr(name, '/') != NULL) snprintf(path, len, "%s", name);
+  else snprintf(path, len, "%s/%s", LOG_DIR, name);
+}
+
+void startLogList(Stream &port) {
+  if (listPort != NULL) listDir.close();
+  listDir = SD.open(LOG_DIR);
+  if (!listDir) {
+    sendErrorToPort(port, "Log directory not found");
+    listPort = NULL;
+    return;
+  }
+  listDir.rewindDirectory();
+  listPort = &port;
+  listCount = 0;
+}
+
+bool startLogRead(Stream &port, const char* name, uint32_t offset, uint32_t len) {
+  abortLogTransfer();
+  if (!sdReady || name == NULL) return false;
+
+  char path[32];
+  resolveLogPath(name, path, sizeof(path));
+  readFile = SD.open(path, FILE_READ);
+  if (!readFile) return false;
+
+  uint32_t size = readFile.size();
+  if (offset > size) offset = size;
+  // len 0 (or past EOF) reads to the size the file has right now
+  readEnd = (len == 0 || offset + len > size) ? size : offset + len;
+
+  snprintf(readName, sizeof(readName), "%s", strrchr(path, '/') + 1);
+  readPort = &port;
+  readStart = offset;
+  readOffset = offset;
+  awaitingAck = false;
+  retries = 0;
+  return true;
+}
+
+void acknowledgeLogChunk(uint32_t nextOffset) {
+  if (readPort == NULL) return;
+  if (nextOffset < readStart || nextOffset > readEnd) return;
+  readOffset = nextOffset;
+  awaitingAck = false;
+  retries = 0;
+}
+
+void abortLogTransfer() {
+  if (readPort != NULL) readFile.close();
+  readPort = NULL;
+  awaitingAck = false;
+}
+
+static void sendLogChunk() {
+  uint8_t data[LOG_CHUNK_SIZE];
+  uint32_t remaining = readEnd - readOffset;
+  uint16_t len = remaining < LOG_CHUNK_SIZE ? remaining : LOG_CHUNK_SIZE;
+
+  readFile.seek(readOffset);
+  int got = readFile.read(data, len);
+  if (got != len) {
+    sendErrorToPort(*readPort, "Log read failed");
+    abortLogTransfer();
+    return;
+  }
+
+  char encoded[((LOG_CHUNK_SIZE + 2) / 3) * 4 + 1];
+  base64Encode(data, len, encoded);
+
+  char frame[sizeof(encoded) + 96];
+  snprintf(frame, sizeof(frame),
+           "{\"chunk\":{\"file\":\"%s\",\"off\":%lu,\"len\":%u,\"crc\":\"%08lx\",\"data\":\"%s\"}}",
+           readName, (unsigned long)readOffset, len, (unsigned long)crc32(data, len), encoded);
+  sendToPort(*readPort, frame);
+
+  awaitingAck = true;
+  lastChunkTime = millis();
+}
+
+void serviceLogTransfer() {
+  // --- Directory listing ---
+  if (listPort != NULL) {
+    char line[64];
+    // The next entry is only taken once a line of any length fits
+    for (uint8_t n = 0; n < LOG_LIST_ENTRIES_PER_LOOP && canSendToPort(*listPort, sizeof(line)); n++) {
+      File entry = listDir.openNextFile();
+      if (!entry) {
+        snprintf(line, sizeof(line), "{\"log\":\"end\",\"count\":%u}", listCount);
+        sendToPort(*listPort, line);
+        listDir.close();
+        listPort = NULL;
+        break;
+      }
+      if (!entry.isDirectory()) {
+        snprintf(line, sizeof(line), "{\"log\":{\"name\":\"%s\",\"size\":%lu}}",
+                 entry.name(), (unsigned long)entry.size());
+        sendToPort(*listPort, line);
+        listCount++;
+      }
+      entry.close();
+    }
+  }
+
+  // --- Chunked read ---
+  if (readPort == NULL) return;
+
+  if (awaitingAck) {
+    if (millis() - lastChunkTime < LOG_ACK_TIMEOUT_MS) return;
+    if (++retries > LOG_MAX_RETRIES) {
+      sendErrorToPort(*readPort, "Log transfer timed out");
+      abortLogTransfer();
+      return;
+    }
+    awaitingAck = false; // Resend from the last acked offset
+  }
+
+  if (readOffset >= readEnd) {
+    char line[80];
+    snprintf(line, sizeof(line), "{\"log_read\":\"done\",\"file\":\"%s\",\"size\":%lu}",
+             readName, (unsigned long)readEnd);
+    sendToPort(*readPort, line);
+    abortLogTransfer();
+    return;
+  }
+
+  sendLogChunk();
 }
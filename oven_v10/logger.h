@@ -1,12 +1,82 @@
 #ifndef LOGGER_H
 #define LOGGER_H
 
-#include "config.h" 
+#include "config.h"
 
-// Initialize SD Card and write CSV header if new file
-void initializeLogger();
+// =================================================================
+// LOG INDEX
+// =================================================================
+// One CSV per day lives in LOG_DIR (e.g. /LOGS/20261019.CSV). When a
+// firmware with different columns opens a day file started by another,
+// it continues that day in 20261019.CS1 (then .CS2 .. .CS9) under its
+// own header instead of appending mismatched rows.
+// LOG_INDEX_FILENAME holds fixed-size records, appended in time order,
+// that map RTC time to a byte offset inside one of those files. A
+// clock set backwards starts a new segment: times rise within each
+// segment, and the search prefers the newest one. Pruning day files
+// rewrites the index without their entries.
+
+enum LogIndexEvent {
+  LOG_EVENT_FILE_OPEN    = 0, // First row of a new day file
+  LOG_EVENT_STATE_CHANGE = 1, // Oven state changed
+  LOG_EVENT_BATCH_START  = 2, // IDLE/SCHEDULED -> PREHEATING/RUNNING
+  LOG_EVENT_BATCH_END    = 3, // Back to IDLE
+  LOG_EVENT_CHECKPOINT   = 4  // Periodic marker (LOG_INDEX_INTERVAL_SEC)
+};
+
+struct LogIndexEntry {
+  uint32_t unixTime;  // RTC time of the row
+  uint32_t fileDate;  // YYYYMMDD -> data file name
+  uint32_t offset;    // Byte offset of the row inside that file
+  uint8_t  state;     // OvenState at this row
+  uint8_t  event;     // LogIndexEvent
+  uint8_t  part;      // Day file part: 0 = .CSV, n = .CSn
+  uint8_t  segment;   // Bumped when the clock went back (0 in older indexes)
+};
+
+// Initialize SD Card and open today's log file
+void initializeLogger(const OvenController &oven);
 
 // Write current metrics to SD Card
-void logSystemData();
+void logSystemData(const OvenController &oven);
+
+// Binary search the index for the last entry at or before unixTime:
+// in the newest segment whose span covers unixTime, else the newest
+// segment that has one. Returns false if the index is empty or
+// unixTime precedes every segment.
+bool findLogPosition(uint32_t unixTime, LogIndexEntry &entry);
+
+// Build "/LOGS/YYYYMMDD.CSV" (part 0) or "/LOGS/YYYYMMDD.CSn" for a given date
+void logFileNameForDate(uint32_t fileDate, uint8_t part, char* buf, size_t len);
+
+// The column header this firmware writes, without the line ending
+const char* logHeader();
+
+// Delete every day file dated before cutoffDate (YYYYMMDD) and their
+// index entries
+void pruneLogsBefore(uint32_t cutoffDate);
+
+// =================================================================
+// LOG DOWNLOAD
+// =================================================================
+// LOG_LIST  -> {"log":{"name":"20261019.CSV","size":N}} per file, then {"log":"end","count":N}
+// LOG_READ  {"file":"20261019.CSV","offset":0,"len":0}   (len 0 = to EOF)
+//           -> {"chunk":{"file":..,"off":N,"len":n,"crc":"%08lx","data":"<base64>"}}
+// LOG_ACK   {"offset":N} acknowledges everything before N. The next chunk
+//           is only sent after an ACK; an older offset resends from there.
+//           Unacked chunks are resent after LOG_ACK_TIMEOUT_MS.
+//           -> {"log_read":"done","file":..,"size":N} once offset reaches the end.
+// A dropped link resumes with a new LOG_READ at the last acked offset.
+// Both transfers are paced by serviceLogTransfer() from loop(); on
+// RS485 the frames go through the transmit queue (app.h), so a chunk
+// never waits for the wire. host/tools/log_download is a client.
+
+void startLogList(Stream &port);
+bool startLogRead(Stream &port, const char* name, uint32_t offset, uint32_t len);
+void acknowledgeLogChunk(uint32_t nextOffset);
+void abortLogTransfer();
+
+// Called every loop; sends at most one chunk / a few list entries
+void serviceLogTransfer();
 
-#endif // LOGGER_H
\ No newline at end of file
+#endif // LOGGER_H
@@ -0,0 +1,79 @@
+#include "output_mode.h"
+
+// Per-channel burst and short window state: oven.ssr (SsrOutputState)
+
+// Errors beyond a second of cycles are stale (long loop stall)
+const long BURST_ERROR_LIMIT = 1000L * (1000 / MAINS_CYCLE_MS);
+
+void resetSsrOutput(OvenController &oven, uint8_t channel) {
+  if (channel >= ZONE_COUNT) return;
+  SsrOutputState &ssr = oven.ssr;
+  ssr.lastCycle[channel] = millis() / MAINS_CYCLE_MS;
+  ssr.cycleOn[channel] = false;
+  ssr.burstError[channel] = 0;
+  ssr.windowResidualMs[channel] = 0;
+  ssr.windowStarted[channel] = false;
+}
+
+static bool updateBurst(SsrOutputState &ssr, uint8_t ch, unsigned long dutyPermille) {
+  unsigned long cycle = millis() / MAINS_CYCLE_MS;
+  if (cycle == ssr.lastCycle[ch]) return ssr.cycleOn[ch];
+
+  // Account for every cycle since the last decision, then pick the
+  // state that keeps the delivered cycles closest to the request
+  unsigned long elapsed = cycle - ssr.lastCycle[ch];
+  ssr.burstError[ch] += (long)elapsed * ((long)dutyPermille - (ssr.cycleOn[ch] ? 1000L : 0L));
+  if (ssr.burstError[ch] > BURST_ERROR_LIMIT) ssr.burstError[ch] = BURST_ERROR_LIMIT;
+  else if (ssr.burstError[ch] < -BURST_ERROR_LIMIT) ssr.burstError[ch] = -BURST_ERROR_LIMIT;
+
+  ssr.cycleOn[ch] = (ssr.burstError[ch] + (long)dutyPermille) >= 500L;
+  ssr.lastCycle[ch] = cycle;
+  return ssr.cycleOn[ch];
+}
+
+static bool updateShortWindow(SsrOutputState &ssr, uint8_t ch, unsigned long dutyPermille) {
+  unsigned long now = millis();
+  if (!ssr.windowStarted[ch] || now - ssr.windowStart[ch] >= SSR_WINDOW_MS) {
+    ssr.windowStart[ch] = ssr.windowStarted[ch] ? ssr.windowStart[ch] + SSR_WINDOW_MS : now;
+    if (now - ssr.windowStart[ch] >= SSR_WINDOW_MS) ssr.windowStart[ch] = now;
+    ssr.windowStarted[ch] = true;
+
+    // Whole cycles only; the rounding error is carried to the next window
+    long wanted = (long)(dutyPermille * SSR_WINDOW_MS / 1000UL) + ssr.windowResidualMs[ch];
+    long cycles = (wanted + (long)MAINS_CYCLE_MS / 2) / (long)MAINS_CYCLE_MS;
+    if (cycles < 0) cycles = 0;
+    if (cycles > (long)(SSR_WINDOW_MS / MAINS_CYCLE_MS)) cycles = SSR_WINDOW_MS / MAINS_CYCLE_MS;
+    ssr.windowOnMs[ch] = (unsigned long)cycles * MAINS_CYCLE_MS;
+    ssr.windowResidualMs[ch] = constrain(wanted - (long)ssr.windowOnMs[ch], -(long)SSR_WINDOW_MS, (long)SSR_WINDOW_MS);
+  }
+  return (now - ssr.windowStart[ch]) < ssr.windowOnMs[ch];
+}
+
+bool updateSsrOutput(OvenController &oven, uint8_t channel, OutputMode mode, unsigned long onTimeMs) {
+  if (channel >= ZONE_COUNT) return false;
+  if (onTimeMs > PID_WINDOW_SIZE) onTimeMs = PID_WINDOW_SIZE;
+  unsigned long dutyPermille = onTimeMs * 1000UL / PID_WINDOW_SIZE;
+
+  if (mode == OUTPUT_MODE_BURST) return updateBurst(oven.ssr, channel, dutyPermille);
+  if (mode == OUTPUT_MODE_SHORT_WINDOW) return updateShortWindow(oven.ssr, channel, dutyPermille);
+  return false;
+}
+
+OutputMode parseOutputMode(const char* name, bool &valid) {
+  valid = true;
+  if (name != NULL) {
+    if (strcmp(name, "tpc") == 0) return OUTPUT_MODE_TPC;
+    if (strcmp(name, "burst") == 0) return OUTPUT_MODE_BURST;
+    if (strcmp(name, "window") == 0) return OUTPUT_MODE_SHORT_WINDOW;
+  }
+  valid = false;
+  return OUTPUT_MODE_TPC;
+}
+
+const char* outputModeName(OutputMode mode) {
+  switch (mode) {
+    case OUTPUT_MODE_BURST:        return "burst";
+    case OUTPUT_MODE_SHORT_WINDOW: return "window";
+    default:                       return "tpc";
+  }
+}
@@ -0,0 +1,29 @@
+#ifndef OUTPUT_MODE_H
+#define OUTPUT_MODE_H
+
+#include "config.h"
+
+// =================================================================
+// HEATER OUTPUT MODES
+// =================================================================
+// TPC is the mechanical-relay path: one run per PID_WINDOW_SIZE window,
+// packed by the power budget. The SSR modes turn the same PID output
+// (0..PID_WINDOW_SIZE) into a duty and switch on mains-cycle boundaries.
+
+enum OutputMode {
+  OUTPUT_MODE_TPC          = 0, // Mechanical relay, PID_WINDOW_SIZE window
+  OUTPUT_MODE_BURST        = 1, // SSR, whole mains cycles spread by sigma-delta
+  OUTPUT_MODE_SHORT_WINDOW = 2  // SSR, SSR_WINDOW_MS window with dithered on-time
+};
+
+// Relay state for an SSR channel this loop. onTimeMs is the PID output
+// in ms of PID_WINDOW_SIZE.
+bool updateSsrOutput(OvenController &oven, uint8_t channel, OutputMode mode, unsigned long onTimeMs);
+
+// Forget accumulated dither (mode change)
+void resetSsrOutput(OvenController &oven, uint8_t channel);
+
+OutputMode parseOutputMode(const char* name, bool &valid);
+const char* outputModeName(OutputMode mode);
+
+#endif // OUTPUT_MODE_H
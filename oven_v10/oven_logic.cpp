@@ -1,184 +1,232 @@
 #include "oven_logic.h"
 #include "hal.h"       // Needs applyRelayStates()
 #include "drivers.h"   // Needs saveSettings()
+#include "recorder.h"  // Needs triggerRecorder(), recordControlSample()
+#include "wallclock.h" // Needs wallClockUnix()
+#include "autotune.h"  // Needs updateAutotune(), isAutotuneActive()
+#include "power_budget.h" // Needs updatePowerBudget()
+#include "output_mode.h"  // Needs updateSsrOutput()
+#include "zone_mode.h"    // Needs updateZoneOutput()
+#include "control_timer.h" // Needs takeControlTick()
+#include "profiler.h"      // Needs profileStart()
+#include "checkpoint.h"    // Needs resumeFromCheckpoint()
+#include "scheduler.h"     // Needs initializeScheduler()
+#include "preheat_model.h" // Needs notePreheatReached()
 
-// --- Global Timer Variables for TPC ---
-unsigned long windowStartTimeRod1 = 0;
-unsigned long windowStartTimeRod2 = 0;
-unsigned long windowStartTimeSteam = 0;
-
-// =================================================================
-// Direct OR PID
-// =================================================================
-#define PID_CTRL 1
-#define DIRECT_CTRL 0
-
-bool ctrl_Mode=1;
-
-#define RELAY_ON 1
-#define RELAY_OFF 0
-#define MIN_ACTUATION_TIME 2000
-
-//Decisional Limit Parametrization
-unsigned long MIN_ACTUATION_TIME_ROD_1 = 2000;
-unsigned long MIN_ACTUATION_TIME_ROD_2 = 1000;
-unsigned long MIN_ACTUATION_TIME_STEAM = 1000;
-//-----PREHEATING Temperature Tolerences-----
-unsigned int PREHEAT_TOLERANCE_ROD_1 = 3;
-unsigned int PREHEAT_TOLERANCE_ROD_2 = 3;
-unsigned int PREHEAT_TOLERANCE_STEAM = 3;
+// Per-zone actuation limits and preheat tolerances live in oven.settings.tuning
 
 // =================================================================
 // GENERIC HELPER FUNCTIONS
 // =================================================================
 
-void configurePid(QuickPID &pid, PidParams &params) {
+void applyPidParams(QuickPID &pid, const PidParams &params) {
   pid.SetTunings(params.kp, params.ki, params.kd);
+  pid.SetAntiWindup(params.tt);
+  pid.SetDerivativeFilter(params.n);
+  pid.SetSetpointWeights(params.b, params.c);
+}
+
+void applyGainSchedule(QuickPID &pid, const GainSchedule &schedule) {
+  pid.SetGainSchedule(schedule.points, schedule.count, schedule.onMeasurement);
+}
+
+void configurePid(QuickPID &pid, PidParams &params, GainSchedule &schedule) {
+  applyPidParams(pid, params);
+  applyGainSchedule(pid, schedule);
   pid.SetOutputLimits(0, PID_WINDOW_SIZE);
   pid.SetMode(QuickPID::AUTOMATIC);
 }
 
-bool calculateTpcState(double pidOutput, unsigned long &windowStartTime, unsigned long min_actuation_time) {
-  unsigned long now = millis();
-  unsigned long relay_status = 0;
-  if (now - windowStartTime >= PID_WINDOW_SIZE) {
-    windowStartTime += PID_WINDOW_SIZE;
-  }
-  if (now - windowStartTime >= PID_WINDOW_SIZE) {
-      windowStartTime = now;
-  }
-  if (pidOutput > (now - windowStartTime)){
-    if(pidOutput >= min_actuation_time){
-      relay_status=RELAY_ON;
-    }
-    else{ relay_status=RELAY_OFF;}
-  }
-  else{
-     relay_status=RELAY_OFF;
-  } 
-  return relay_status; 
+void configureCascade(OvenController &oven) {
+  // Period first: the gains are scaled to it
+  oven.pidChamber.SetSampleTime(CASCADE_COMPUTE_FREQ);
+  applyPidParams(oven.pidChamber, oven.settings.cascade.pid);
+  oven.pidChamber.SetOutputLimits(oven.settings.cascade.rodMin, oven.settings.cascade.rodMax);
+}
+
+unsigned long outputToOnTime(PidReal pidOutput) {
+  long onTime = (long)pidOutput;
+  return onTime > 0 ? (unsigned long)onTime : 0;
 }
 
 // =================================================================
 // LOGIC SUB-ROUTINES
 // =================================================================
 
-void updatePidInputs() {
-  pidInputRod1 = (double)currentTemps[0];
-  pidInputRod2 = (double)currentTemps[2]; 
-  pidInputSteam = (double)currentTemps[1];
+void updatePidInputs(OvenController &oven) {
+  for (uint8_t z = 0; z < ZONE_COUNT; z++) oven.zones.input[z] = (PidReal)oven.zones.temp[z];
+}
+
+// Outer loop: chamber air -> rod setpoint, at CASCADE_COMPUTE_FREQ.
+// Returns false when the rods should use their own thresholds (cascade
+// off, not heating, no chamber setpoint or a faulted probe). The
+// controller is then parked tracking those thresholds so that engaging
+// it again does not step the rod setpoints.
+bool updateCascade(OvenController &oven, bool heating) {
+  const CascadeSettings &cascade = oven.settings.cascade;
+  if (!heating || !cascade.enabled || cascade.chamberSetpoint <= 0 || isnan(oven.chamberTemp)) {
+    oven.pidChamber.SetMode(QuickPID::MANUAL);
+    double rodTarget = 0;
+    uint8_t cascadedZones = 0;
+    for (uint8_t z = 0; z < ZONE_COUNT; z++) {
+      if (ZONE_TABLE[z].cascaded) { rodTarget += oven.settings.thresholds.zone[z]; cascadedZones++; }
+    }
+    if (cascadedZones > 0) rodTarget /= cascadedZones;
+    oven.pidOutputChamber = (PidReal)constrain(rodTarget, cascade.rodMin, cascade.rodMax);
+    return false;
+  }
+
+  oven.pidInputChamber = (PidReal)oven.chamberTemp;
+  oven.pidSetpointChamber = (PidReal)cascade.chamberSetpoint;
+  // Rods start from the chamber setpoint; P/I add the offset the air needs
+  oven.pidChamber.SetFeedforward(oven.pidSetpointChamber);
+  oven.pidChamber.SetMode(QuickPID::AUTOMATIC);
+  oven.pidChamber.Compute();
+  return true;
 }
 
-void updatePidSetpoints() {
+void updatePidSetpoints(OvenController &oven) {
   // Set Points from LCD
 
-  double targetRod1 = 0;
-  double targetRod2 = 0;
-  double targetSteam = 0;
+  bool heating = (oven.currentState == PREHEATING || oven.currentState == READY || oven.currentState == RUNNING);
+  bool cascaded = updateCascade(oven, heating);
 
   // LOGIC: aim for Threshold 
-  if (currentState == PREHEATING || currentState == READY || currentState == RUNNING) {
-     targetRod1 = (double)settings.thresholds.rod1;
-     targetRod2 = (double)settings.thresholds.rod2;
-     targetSteam = (double)settings.thresholds.rodSteam;
-    //added  other rods conditions too
-     if (currentState == PREHEATING) {
-         if (pidInputRod1 >= (targetRod1 - PREHEAT_TOLERANCE_ROD_1) 
-          && pidInputRod2 >= (targetRod2 - PREHEAT_TOLERANCE_ROD_2) 
-          && pidInputSteam >= (targetSteam - PREHEAT_TOLERANCE_STEAM)) { 
-             preheatComplete = true; 
-         }
-     }
-  } 
-  
-  pidSetpointRod1 = targetRod1;
-  pidSetpointRod2 = targetRod2;
-  pidSetpointSteam = targetSteam;
+  bool allReady = true;
+  for (uint8_t z = 0; z < ZONE_COUNT; z++) {
+    PidReal target = PidReal(0);
+    if (heating) {
+      target = (PidReal)oven.settings.thresholds.zone[z];
+      if (cascaded && ZONE_TABLE[z].cascaded) target = oven.pidOutputChamber;
+    }
+    oven.zones.setpoint[z] = target;
+
+    // Cascaded zones are judged by the air they heat, below
+    if (cascaded && ZONE_TABLE[z].cascaded) continue;
+    if (oven.zones.input[z] < target - (PidReal)oven.settings.tuning[z].preheatTolerance) allReady = false;
+    else if (oven.currentState == PREHEATING) notePreheatReached(oven, z);
+  }
+  if (cascaded) {
+    if (oven.pidInputChamber < oven.pidSetpointChamber - (PidReal)oven.settings.chamberPreheatTolerance) allReady = false;
+    else if (oven.currentState == PREHEATING) notePreheatReached(oven, PREHEAT_CHAMBER);
+  }
+
+  if (oven.currentState == PREHEATING && allReady) oven.preheatComplete = true;
 }
 
-void computePids() {
-  pidRod1.Compute();
-  pidRod2.Compute();
-  pidSteam.Compute();
+// Steady-state duty that holds 'setpoint' per the zone model, in window ms
+PidReal feedforwardFor(const OvenController &oven, const ThermalModel &model, PidReal setpoint) {
+  if (model.gain <= 0 || setpoint <= PidReal(0)) return PidReal(0);
+  double duty = ((double)setpoint - oven.settings.ambientTemp) / model.gain;
+  if (duty <= 0) return PidReal(0);
+  if (duty > 1.0) duty = 1.0;
+  return (PidReal)(model.weight * duty * PID_WINDOW_SIZE);
 }
 
-void applyHeaterLogic() {
-  if (ctrl_Mode == PID_CTRL) {
-  relayStates.rod1     = calculateTpcState(pidOutputRod1, windowStartTimeRod1, MIN_ACTUATION_TIME_ROD_1);
-  relayStates.rod2     = calculateTpcState(pidOutputRod2, windowStartTimeRod2, MIN_ACTUATION_TIME_ROD_2);
-  relayStates.rodSteam = calculateTpcState(pidOutputSteam, windowStartTimeSteam, MIN_ACTUATION_TIME_STEAM);
+void updateFeedforward(OvenController &oven) {
+  for (uint8_t z = 0; z < ZONE_COUNT; z++) {
+    oven.zonePid[z].SetFeedforward(feedforwardFor(oven, oven.settings.model[z], oven.zones.setpoint[z]));
   }
-  else if (ctrl_Mode == DIRECT_CTRL){
-  // --- BANG-BANG MODE ---
-    // Rod 1
-    if (pidInputRod1 <= settings.thresholds.rod1 - 20) relayStates.rod1 = RELAY_ON;
-    else if (pidInputRod1 >= settings.thresholds.rod1)          relayStates.rod1 = RELAY_OFF;
-
-    // Rod 2
-    if (pidInputRod2 <= settings.thresholds.rod2 - 5) relayStates.rod2 = RELAY_ON;
-    else if (pidInputRod2 >= settings.thresholds.rod2)          relayStates.rod2 = RELAY_OFF;
-
-    // Rod Steam
-    if (pidInputSteam <= settings.thresholds.rodSteam - 5) relayStates.rodSteam = RELAY_ON;
-    else if (pidInputSteam >= settings.thresholds.rodSteam)          relayStates.rodSteam = RELAY_OFF;
+}
+
+void computePids(OvenController &oven) {
+  // Zone PIDs run on the timer tick, with the measured interval
+  if (!takeControlTick(oven)) return;
+  uint32_t t = profileStart();
+  for (uint8_t z = 0; z < ZONE_COUNT; z++) oven.zonePid[z].ComputeTick();
+  profileEnd(oven, PROF_PID, t);
+}
+
+void applyHeaterLogic(OvenController &oven) {
+  // PID, bang-bang or manual duty per zone, all as an on-time request
+  unsigned long onTime[ZONE_COUNT];
+  for (uint8_t i = 0; i < ZONE_COUNT; i++) onTime[i] = updateZoneOutput(oven, i);
+  unsigned long minOn[ZONE_COUNT];
+  for (uint8_t i = 0; i < ZONE_COUNT; i++) minOn[i] = oven.settings.tuning[i].minOnMs;
+
+  // Mechanical channels share the window packed under the power budget;
+  // SSR channels get the part of it where they may conduct
+  bool relayOn[ZONE_COUNT];
+  updatePowerBudget(oven, onTime, minOn, relayOn);
+  // A request that drops to zero (bang-bang reaching setpoint) cuts
+  // the planned run now instead of at the end of the window
+  for (uint8_t i = 0; i < ZONE_COUNT; i++) {
+    if (onTime[i] == 0) relayOn[i] = false;
   }
+
+  // SSR channels modulate on mains cycles inside that
+  for (uint8_t i = 0; i < ZONE_COUNT; i++) {
+    if (oven.settings.outputMode[i] != OUTPUT_MODE_TPC) {
+      bool on = updateSsrOutput(oven, i, (OutputMode)oven.settings.outputMode[i], onTime[i]);
+      relayOn[i] = relayOn[i] && on;
+    }
+  }
+  for (uint8_t i = 0; i < ZONE_COUNT; i++) oven.relayStates.zone[i] = relayOn[i];
 }
 
-void applyValveAndAuxLogic() {
+void applyValveAndAuxLogic(OvenController &oven) {
   unsigned long now = millis();
 
   // 1. Valve Logic (Manual Toggle with 20s Timeout)
   // ----------------------------------------------------
   
   // Check Timer: If manual override has been ON for > 20s, turn it OFF.
-  if (manualValveOverride && (now - steamValveOpenTime >= 20000UL)) {
-      manualValveOverride = false;
+  if (oven.manualValveOverride && (now - oven.steamValveOpenTime >= 20000UL)) {
+      oven.manualValveOverride = false;
       Serial.println("Valve Safety Timeout: 20s limit reached.");
+      triggerRecorder(oven, REC_TRIGGER_VALVE_TIMEOUT);
   }
   
   // Safety Check: Steam Rod must be > 160C (Updated)
-  bool isSteamTempSafe = (currentTemps[1] >= STEAM_SAFETY_THRESHOLD);
+  bool isSteamTempSafe = (STEAM_ZONE >= 0 && oven.zones.temp[STEAM_ZONE] >= STEAM_SAFETY_THRESHOLD);
   
   // Final Decision
-  if (manualValveOverride && isSteamTempSafe) {
-    relayStates.valve = true;
+  if (oven.manualValveOverride && isSteamTempSafe) {
+    oven.relayStates.valve = true;
   } else {
-    relayStates.valve = false;
+    oven.relayStates.valve = false;
   }
   // ----------------------------------------------------
 
   // 2. Aux Logic (Light/Alarm)
-  if (currentState == RUNNING) {
-    relayStates.light = true;
-    relayStates.alarm = false;
+  if (oven.currentState == RUNNING) {
+    oven.relayStates.light = true;
+    oven.relayStates.alarm = false;
   } 
-  else if (currentState == READY) {
-    relayStates.light = true;
+  else if (oven.currentState == READY) {
+    oven.relayStates.light = true;
     // Pulse Alarm: Beep for 500ms every 10 seconds
     if ((now % 10000UL) < 500UL) {
-      relayStates.alarm = true;
+      oven.relayStates.alarm = true;
     } else {
-      relayStates.alarm = false;
+      oven.relayStates.alarm = false;
     }
   }
-  else if (currentState == ALARM_COMPLETION) {
-    relayStates.light = true;
-    relayStates.alarm = true;
+  else if (oven.currentState == ALARM_COMPLETION) {
+    oven.relayStates.light = true;
+    oven.relayStates.alarm = true;
     
     // Force actuators OFF
-    relayStates.rod1 = false;
-    relayStates.rod2 = false;
-    relayStates.rodSteam = false;
-    relayStates.valve = false;
+    for (uint8_t z = 0; z < ZONE_COUNT; z++) oven.relayStates.zone[z] = false;
+    oven.relayStates.valve = false;
+  }
+}
+
+void checkFaultTriggers(OvenController &oven) {
+  for (uint8_t z = 0; z < ZONE_COUNT; z++) {
+    if (isnan(oven.zones.temp[z])) triggerRecorder(oven, REC_TRIGGER_SENSOR_FAULT);
+    else if (oven.zones.temp[z] > OVERTEMP_LIMIT) triggerRecorder(oven, REC_TRIGGER_OVERTEMP);
   }
+  if (oven.settings.cascade.enabled && isnan(oven.chamberTemp)) triggerRecorder(oven, REC_TRIGGER_SENSOR_FAULT);
 }
 
-void applySafetyOverrides() {
-  if (currentState == IDLE || currentState == AWAITING_SCHEDULE) {
-     relayStates.rod1 = false;
-     relayStates.rod2 = false;
-     relayStates.rodSteam = false;
-     relayStates.alarm = false;
+void applySafetyOverrides(OvenController &oven) {
+  if (oven.currentState == IDLE || oven.currentState == AWAITING_SCHEDULE) {
+     // A running autotune keeps its own zone live in IDLE
+     for (uint8_t z = 0; z < ZONE_COUNT; z++) {
+       if (!isAutotuneActive(oven, z)) oven.relayStates.zone[z] = false;
+     }
+     oven.relayStates.alarm = false;
   }
 }
 
@@ -186,74 +234,37 @@ void applySafetyOverrides() {
 // MAIN INTERFACE FUNCTIONS
 // =================================================================
 
-void initializeLogic() {
-  loadSettings();
-  configurePid(pidRod1, settings.rod1Pid);
-  configurePid(pidRod2, settings.rod2Pid);
-  configurePid(pidSteam, settings.rodSteamPid);
-
-  // --- STAGGERED START TIMES ---
-  // Offset each window by 1000ms to prevent simultaneous inrush current
-  unsigned long now = millis();
-  windowStartTimeRod1 = now;
-  windowStartTimeRod2 = now + 1000; 
-  windowStartTimeSteam = now + 2000;
-
-  if (settings.scheduledUnixTime != 0) {
-    currentState = AWAITING_SCHEDULE;
-  } else {
-    currentState = IDLE;
+void initializeLogic(OvenController &oven) {
+  loadSettings(oven);
+  for (uint8_t z = 0; z < ZONE_COUNT; z++) {
+    oven.zonePid[z].SetIO(&oven.zones.input[z], &oven.zones.output[z], &oven.zones.setpoint[z]);
+    configurePid(oven.zonePid[z], oven.settings.pid[z], oven.settings.gains[z]);
   }
-}
+  oven.pidChamber.SetIO(&oven.pidInputChamber, &oven.pidOutputChamber, &oven.pidSetpointChamber);
+  configureCascade(oven);
+  initializeZoneModes(oven);
+  initializeControlTimer(oven);
 
-void updateStateMachine() {
-  switch (currentState) {
-    case IDLE: break;
-      
-    case AWAITING_SCHEDULE:
-      if (settings.scheduledUnixTime != 0 && rtc.now().unixtime() >= settings.scheduledUnixTime) {
-        settings.scheduledUnixTime = 0; 
-        saveSettings();
-        currentState = PREHEATING;
-        preheatStartTime = millis(); 
-        preheatComplete = false;
-      }
-      break;
-      
-    case PREHEATING:
-      if (preheatComplete) {
-        currentState = READY;
-        holdingStartTime = millis(); 
-      }
-      break;
-
-    case READY:
-      if (millis() - holdingStartTime > (settings.holdingTimeMinutes * 60000UL)) {
-         currentState = IDLE;
-      }
-      break;
-      
-    case RUNNING:
-      if (millis() - recipeStartTime >= (settings.recipeTimeMinutes * 60000UL)) {
-        currentState = ALARM_COMPLETION;
-        alarmStartTime = millis();
-      }
-      break;
-        
-    case ALARM_COMPLETION:
-      if (millis() - alarmStartTime >= 30000UL) { 
-         currentState = IDLE;
-      }
-      break;
-  }
+  // One shared TPC window; the power budget spreads the heaters inside it
+  initializePowerBudget(oven);
+  for (uint8_t i = 0; i < ZONE_COUNT; i++) resetSsrOutput(oven, i);
+
+  // Boot in IDLE; an interrupted bake resumes, pending jobs make the
+  // first tick move on to AWAITING_SCHEDULE
+  initializeScheduler(oven);
+  resumeFromCheckpoint(oven);
 }
 
-void updateRelayLogic() {
-  updatePidInputs();
-  updatePidSetpoints();
-  computePids();
-  applyHeaterLogic();
-  applyValveAndAuxLogic();
-  applySafetyOverrides(); 
-  applyRelayStates(); 
+void updateRelayLogic(OvenController &oven) {
+  updatePidInputs(oven);
+  checkFaultTriggers(oven);
+  updatePidSetpoints(oven);
+  updateFeedforward(oven);
+  computePids(oven);
+  updateAutotune(oven);
+  applyHeaterLogic(oven);
+  applyValveAndAuxLogic(oven);
+  applySafetyOverrides(oven); 
+  recordControlSample(oven);
+  applyRelayStates(oven); 
 }
\ No newline at end of file
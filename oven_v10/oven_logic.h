@@ -8,12 +8,19 @@
 // =================================================================
 
 // Called once at setup
-void initializeLogic();
-
-// Called every loop to handle state transitions (IDLE -> PREHEAT -> READY -> RUNNING)
-void updateStateMachine();
+void initializeLogic(OvenController &oven);
 
 // Called every loop to calculate PID and set Relays
-void updateRelayLogic();
+void updateRelayLogic(OvenController &oven);
+
+// Push gains and structure (anti-windup, filter, weights) into a controller
+void applyPidParams(QuickPID &pid, const PidParams &params);
+void applyGainSchedule(QuickPID &pid, const GainSchedule &schedule);
+
+// Clamped PID output -> whole ms of on-time for this window
+unsigned long outputToOnTime(PidReal pidOutput);
+
+// Re-apply oven.settings.cascade to the chamber-air outer loop
+void configureCascade(OvenController &oven);
 
 #endif // OVEN_LOGIC_H
\ No newline at end of file
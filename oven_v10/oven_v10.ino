@@ -7,41 +7,79 @@
 #include "config.h"
 #include "app.h"
 #include "oven_logic.h"
+#include "state_machine.h"
+#include "checkpoint.h"
 #include "hal.h"
 #include "drivers.h"
 #include "logger.h" // <--- NEW INCLUDE
+#include "recorder.h"
+#include "wallclock.h"
+#include "profiler.h"
+
+// The controller: settings, PIDs, state machine and every module's state
+OvenController oven;
 
 void setup() {
+  initializeProfiler(oven);
   initializeCommunication();
   initializePins();
   initializeSensors();
   setHardcodedTime();
+  initializeWallClock();
   
   // Initialize SD Logger (Pin 10)
-  initializeLogger(); // <--- NEW INITIALIZATION
+  initializeLogger(oven); // <--- NEW INITIALIZATION
   
-  initializeLogic();
+  initializeLogic(oven);
   Serial.println("Initialization complete. PID Controller Running.");
 }
 
 void loop() {
+  uint32_t loopStart = profileStart();
+  uint32_t t;
+
+  // 0. Keep the cached wall clock disciplined by the RTC
+  updateWallClock();
+
   // 1. Handle Commands (Settings updates, etc.)
-  handleIncomingCommands();
+  t = profileStart();
+  handleIncomingCommands(oven);
+  profileEnd(oven, PROF_COMMANDS, t);
 
   // 2. State Machine Logic
-  updateStateMachine();
+  t = profileStart();
+  updateStateMachine(oven);
+  profileEnd(oven, PROF_STATE, t);
+  updateCheckpoint(oven);         // Bake progress for power-loss resume
   
   // 3. Sensor Reading & Logging (Slow, e.g., every 3 seconds)
-  if (isStatusUpdateDue()) {
-    readTemperatureSensors(); // Updates currentTemps[]
-    sendStatusUpdate();       // Sends JSON to Serial/App
+  if (isStatusUpdateDue(oven)) {
+    t = profileStart();
+    readTemperatureSensors(oven); // Updates oven.zones.temp[]
+    profileEnd(oven, PROF_SENSORS, t);
+
+    t = profileStart();
+    sendStatusUpdate(oven);   // Sends JSON to Serial/App
+    profileEnd(oven, PROF_STATUS, t);
     
-    logSystemData();          // <--- NEW: Log metrics to SD Card
+    t = profileStart();
+    logSystemData(oven);      // <--- NEW: Log metrics to SD Card
+    profileEnd(oven, PROF_LOG, t);
     
-    printDebugInfo();   
+    printDebugInfo(oven);   
   }
 
   // 4. Relay Logic & PID (FAST - Must run every loop)
   // This manages the Time Proportioned Control windows.
-  updateRelayLogic();
+  t = profileStart();
+  updateRelayLogic(oven);
+  profileEnd(oven, PROF_RELAY, t);
+
+  // 5. Pending flight recorder dump / log download / schedule list / RS485 output (a little per pass)
+  serviceRecorderDump(oven);
+  serviceLogTransfer();
+  serviceScheduleList(oven);
+  serviceTransmitQueue();
+
+  profileEnd(oven, PROF_LOOP, loopStart);
 }
\ No newline at end of file
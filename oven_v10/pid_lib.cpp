@@ -1,114 +1,391 @@
-#include "pid_lib.h"
-#include "config.h"
-//Library reference for study: http://brettbeauregard.com/blog/2011/04/improving-the-beginners-pid-introduction/
-QuickPID::QuickPID(double* input, double* output, double* setpoint, double kp, double ki, double kd, int controllerDirection) {
-  myOutput = output;
-  myInput = input;
-  mySetpoint = setpoint;
-  inAuto = false;
-  
-  // Default to Standard PID
-  pOnE = true;
-
-  QuickPID::SetOutputLimits(0, 255); // Default PWM limits
-  controllerDirection = controllerDirection;
-  QuickPID::SetTunings(kp, ki, kd);
-  
-  lastTime = millis() - PID_COMPUTE_FREQ;
-}
-
-bool QuickPID::Compute() {
-  if (!inAuto) return false;
-  
-  unsigned long now = millis();
-  unsigned long timeChange = (now - lastTime);
-  
-  if (timeChange >= PID_COMPUTE_FREQ) { // Compute every x ms
-    // Inputs
-    double input = *myInput;
-    double error = *mySetpoint - input;
-    // Derivative DonM
-    double dInput = (input - lastInput);
-    // --- INTEGRAL & PROPORTIONAL CALCULATION ---
-    if (pOnE) {
-        // Standard PID: iTerm only holds Integral
-        iTerm += (ki * error);
-    } else {
-        // PonM: iTerm holds Integral MINUS Proportional change
-        // This effectively moves the P term into the storage
-        iTerm += (ki * error - kp * dInput);
-    }
-    if (iTerm > outMax) iTerm = outMax;
-    else if (iTerm < outMin) iTerm = outMin;
-    
-    // --- FINAL OUTPUT CALCULATION ---
-    double output;
-    if (pOnE) {
-        // Standard: P + I - D
-        output = kp * error + iTerm - kd * dInput;
-    } else {
-        // PonM: (I - P_accumulated) - D
-        // Since P is already inside iTerm, we just subtract D
-        output = iTerm - kd * dInput;
-    }
-    
-    // Clamp Output
-    if (output > outMax) output = outMax;
-    else if (output < outMin) output = outMin;
-    
-    *myOutput = output;
-    
-    // Save history
-    lastInput = input;
-    lastTime = now;
-    return true;
-  }
-  return false;
-}
-
-void QuickPID::SetTunings(double Kp, double Ki, double Kd) {
-  if (Kp < 0 || Ki < 0 || Kd < 0) return;
-  
-  dispKp = Kp; dispKi = Ki; dispKd = Kd;
-  
-  double SampleTimeInSec = (double)PID_COMPUTE_FREQ / 1000.0;
-  kp = Kp;
-  ki = Ki * SampleTimeInSec;
-  kd = Kd / SampleTimeInSec;
-  
-  if (controllerDirection == REVERSE) {
-    kp = (0 - kp);
-    ki = (0 - ki);
-    kd = (0 - kd);
-  }
-}
-// output clamping
-void QuickPID::SetOutputLimits(double Min, double Max) {
-  if (Min >= Max) return;
-  outMin = Min;
-  outMax = Max;
-  
-  if (inAuto) {
-    if (*myOutput > outMax) *myOutput = outMax;
-    else if (*myOutput < outMin) *myOutput = outMin;
-    
-    if (iTerm > outMax) iTerm = outMax;
-    else if (iTerm < outMin) iTerm = outMin;
-  }
-}
-
-void QuickPID::SetPOn(int pOn) {
-   pOnE = (pOn == P_ON_E);
-}
-
-void QuickPID::SetMode(int Mode) {
-  bool newAuto = (Mode == AUTOMATIC);
-  if (newAuto && !inAuto) {
-    // Initialize
-    iTerm = *myOutput;
-    lastInput = *myInput;
-    if (iTerm > outMax) iTerm = outMax;
-    else if (iTerm < outMin) iTerm = outMin;
-  }
-  inAuto = newAuto;
-}
\ No newline at end of file
+#include "pid_lib.h"
+#include "config.h"
+//Library reference for study: http://brettbeauregard.com/blog/2011/04/improving-the-beginners-pid-introduction/
+
+// =================================================================
+// Fix16
+// =================================================================
+
+int32_t Fix16::fromReal(double v) {
+  double scaled = v * 65536.0;
+  if (scaled >= (double)INT32_MAX) return INT32_MAX;
+  if (scaled <= -(double)INT32_MAX) return -INT32_MAX;
+  return (int32_t)(scaled < 0 ? scaled - 0.5 : scaled + 0.5);
+}
+
+Fix16 Fix16::operator/(Fix16 o) const {
+  if (o.raw == 0) return fromRaw(raw >= 0 ? INT32_MAX : -INT32_MAX);
+  return fromRaw(saturate(((int64_t)raw << 16) / o.raw));
+}
+
+// =================================================================
+// BasicQuickPID<T>
+// =================================================================
+
+template <typename T>
+BasicQuickPID<T>::BasicQuickPID(T* input, T* output, T* setpoint, double kp, double ki, double kd, int controllerDirection) {
+  myOutput = output;
+  myInput = input;
+  mySetpoint = setpoint;
+  inAuto = false;
+
+  // Default to Standard PID
+  pOnE = true;
+  dispTt = 0; dispN = 0;
+  kt = T(0); tfOverH = T(0);
+  spWeightP = T(1); spWeightD = T(0);
+  iTerm = T(0); dTerm = T(0); feedforward = T(0);
+  gainCount = 0; scheduleOnInput = false;
+  sampleTimeMs = PID_COMPUTE_FREQ;
+
+  BasicQuickPID::SetOutputLimits(0, 255); // Default PWM limits
+  this->controllerDirection = controllerDirection;
+  BasicQuickPID::SetTunings(kp, ki, kd);
+
+  lastTime = micros() - sampleTimeMs * 1000UL;
+  lastDtUs = 0;
+}
+
+template <typename T>
+BasicQuickPID<T>::BasicQuickPID() : BasicQuickPID(NULL, NULL, NULL, 0, 0, 0, DIRECT) {}
+
+template <typename T>
+void BasicQuickPID<T>::SetIO(T* input, T* output, T* setpoint) {
+  myInput = input;
+  myOutput = output;
+  mySetpoint = setpoint;
+}
+
+// Longest interval Step() integrates at once, in sample times. A
+// longer gap (loop stall) is treated as this long.
+static const unsigned long PID_MAX_DT_RATIO = 50;
+
+// num / den in T without overflowing Fix16 on the way
+template <typename T>
+static T makeRatio(unsigned long num, unsigned long den) {
+  return T(num) / T(den);
+}
+
+template <>
+Fix16 makeRatio<Fix16>(unsigned long num, unsigned long den) {
+  return Fix16::fromRaw((int32_t)(((int64_t)num << 16) / den));
+}
+
+template <typename T>
+bool BasicQuickPID<T>::Compute() {
+  if (!inAuto) return false;
+
+  unsigned long now = micros();
+  unsigned long timeChange = (now - lastTime);
+
+  if (timeChange >= sampleTimeMs * 1000UL) { // Compute every x ms
+    Step(now, timeChange);
+    return true;
+  }
+  return false;
+}
+
+template <typename T>
+bool BasicQuickPID<T>::ComputeTick() {
+  if (!inAuto) return false;
+  unsigned long now = micros();
+  Step(now, now - lastTime);
+  return true;
+}
+
+template <typename T>
+void BasicQuickPID<T>::Step(unsigned long now, unsigned long dtUs) {
+    // Inputs
+    T input = *myInput;
+    T setpoint = *mySetpoint;
+    T error = setpoint - input;
+    // Derivative DonM
+    T dInput = (input - lastInput);
+
+    if (gainCount > 0) ScheduleGains(scheduleOnInput ? input : setpoint, spWeightP * setpoint - input);
+
+    // ki/kd/kt are scaled for one sample time; rescale them by the
+    // interval that actually elapsed (ratio 1 when on time)
+    unsigned long sampleUs = sampleTimeMs * 1000UL;
+    if (dtUs > sampleUs * PID_MAX_DT_RATIO) dtUs = sampleUs * PID_MAX_DT_RATIO;
+    if (dtUs == 0) dtUs = 1;
+    T ratio = makeRatio<T>(dtUs, sampleUs);
+    T kiDt = ki * ratio;
+    T kdDt = (kd == T(0)) ? T(0) : kd / ratio;
+    T ktDt = kt * ratio;
+    if (ktDt > T(1)) ktDt = T(1);
+    // Tf / (Tf + dt) of the derivative filter, 0 when unfiltered
+    T dAlpha = (tfOverH == T(0)) ? T(0) : tfOverH / (tfOverH + ratio);
+
+    // --- DERIVATIVE on (c*sp - y), first-order filtered ---
+    // dAlpha = 0 reduces this to the plain -kd * dInput
+    T dChange = spWeightD * (setpoint - lastSetpoint) - dInput;
+    dTerm = dAlpha * dTerm + (T(1) - dAlpha) * kdDt * dChange;
+
+    T output;
+    if (pOnE && kt != T(0)) {
+        // Back-calculation: feed the saturation excess back into iTerm
+        // so it unwinds with time constant Tt instead of sitting at the clamp
+        T v = kp * (spWeightP * setpoint - input) + iTerm + dTerm + feedforward;
+        output = v;
+        if (output > outMax) output = outMax;
+        else if (output < outMin) output = outMin;
+        iTerm += kiDt * error + ktDt * (output - v);
+    } else {
+        // --- INTEGRAL & PROPORTIONAL CALCULATION ---
+        T pTerm = T(0);
+        if (pOnE) {
+            // Standard PID: iTerm only holds Integral
+            pTerm = kp * (spWeightP * setpoint - input);
+            iTerm += (kiDt * error);
+        } else {
+            // PonM: iTerm holds Integral MINUS Proportional change
+            // This effectively moves the P term into the storage
+            iTerm += (kiDt * error - kp * dInput);
+        }
+        ClampIterm(pTerm);
+
+        // --- FINAL OUTPUT CALCULATION ---
+        if (pOnE) {
+            // Standard: P(b) + I + D
+            output = pTerm + iTerm + dTerm + feedforward;
+        } else {
+            // PonM: (I - P_accumulated) + D
+            // Since P is already inside iTerm, we just add D
+            output = iTerm + dTerm + feedforward;
+        }
+
+        // Clamp Output
+        if (output > outMax) output = outMax;
+        else if (output < outMin) output = outMin;
+    }
+
+    *myOutput = output;
+
+    // Save history
+    lastInput = input;
+    lastSetpoint = setpoint;
+    lastTime = now;
+    lastDtUs = dtUs;
+}
+
+template <typename T>
+void BasicQuickPID<T>::SetTunings(double Kp, double Ki, double Kd) {
+  if (Kp < 0 || Ki < 0 || Kd < 0) return;
+
+  dispKp = Kp; dispKi = Ki; dispKd = Kd;
+
+  // Scaled in double, converted once to the compute type
+  double SampleTimeInSec = (double)sampleTimeMs / 1000.0;
+  double sKp = Kp;
+  double sKi = Ki * SampleTimeInSec;
+  double sKd = Kd / SampleTimeInSec;
+
+  if (controllerDirection == REVERSE) {
+    sKp = (0 - sKp);
+    sKi = (0 - sKi);
+    sKd = (0 - sKd);
+  }
+  kp = T(sKp);
+  ki = T(sKi);
+  kd = T(sKd);
+  UpdateFilterCoefficient();
+}
+
+// Rescale the stored gains to the new period
+template <typename T>
+void BasicQuickPID<T>::SetSampleTime(unsigned long ms) {
+  if (ms == 0) return;
+  sampleTimeMs = ms;
+  SetTunings(dispKp, dispKi, dispKd);
+  SetAntiWindup(dispTt);
+}
+
+template <typename T>
+void BasicQuickPID<T>::SetAntiWindup(double Tt) {
+  if (Tt < 0) return;
+  dispTt = Tt;
+  double SampleTimeInSec = (double)sampleTimeMs / 1000.0;
+  // Tracking faster than one sample would overshoot the correction
+  kt = (Tt == 0) ? T(0) : T(Tt < SampleTimeInSec ? 1.0 : SampleTimeInSec / Tt);
+}
+
+template <typename T>
+void BasicQuickPID<T>::SetDerivativeFilter(double N) {
+  if (N < 0) return;
+  dispN = N;
+  UpdateFilterCoefficient();
+}
+
+template <typename T>
+void BasicQuickPID<T>::SetSetpointWeights(double b, double c) {
+  if (b < 0 || c < 0) return;
+  spWeightP = T(b);
+  spWeightD = T(c);
+}
+
+template <typename T>
+void BasicQuickPID<T>::SetGainSchedule(const GainPoint* points, uint8_t count, bool onInput) {
+  if (count > PID_MAX_GAIN_POINTS) count = PID_MAX_GAIN_POINTS;
+  scheduleOnInput = onInput;
+
+  double SampleTimeInSec = (double)sampleTimeMs / 1000.0;
+  double sign = (controllerDirection == REVERSE) ? -1.0 : 1.0;
+  for (uint8_t i = 0; i < count; i++) {
+    gainTemp[i] = T(points[i].temp);
+    gainKp[i] = T(sign * points[i].kp);
+    gainKi[i] = T(sign * points[i].ki * SampleTimeInSec);
+    gainKd[i] = T(sign * points[i].kd / SampleTimeInSec);
+    double span = (i + 1 < count) ? points[i + 1].temp - points[i].temp : 0;
+    gainInvSpan[i] = T(span > 0 ? 1.0 / span : 0.0);
+  }
+  gainCount = count;
+
+  // Back to the fixed gains
+  if (count == 0) SetTunings(dispKp, dispKi, dispKd);
+}
+
+// Interpolate the gains at x. iTerm absorbs the change in P so the
+// output does not step when kp moves (ki/kd only act on increments).
+template <typename T>
+void BasicQuickPID<T>::ScheduleGains(T x, T pWeighted) {
+  uint8_t i = 0;
+  while (i + 1 < gainCount && x >= gainTemp[i + 1]) i++;
+
+  T newKp = gainKp[i], newKi = gainKi[i], newKd = gainKd[i];
+  if (i + 1 < gainCount && x > gainTemp[i]) {
+    T frac = (x - gainTemp[i]) * gainInvSpan[i];
+    newKp = newKp + frac * (gainKp[i + 1] - gainKp[i]);
+    newKi = newKi + frac * (gainKi[i + 1] - gainKi[i]);
+    newKd = newKd + frac * (gainKd[i + 1] - gainKd[i]);
+  }
+
+  if (pOnE) iTerm += (kp - newKp) * pWeighted;
+  kp = newKp;
+  ki = newKi;
+  kd = newKd;
+}
+
+template <typename T>
+double BasicQuickPID<T>::GetKp() const {
+  double v = (double)kp;
+  return (controllerDirection == REVERSE) ? -v : v;
+}
+
+template <typename T>
+double BasicQuickPID<T>::GetKi() const {
+  double v = (double)ki * 1000.0 / (double)sampleTimeMs;
+  return (controllerDirection == REVERSE) ? -v : v;
+}
+
+template <typename T>
+double BasicQuickPID<T>::GetKd() const {
+  double v = (double)kd * (double)sampleTimeMs / 1000.0;
+  return (controllerDirection == REVERSE) ? -v : v;
+}
+
+template <typename T>
+void BasicQuickPID<T>::SetFeedforward(T ff) {
+  feedforward = ff;
+}
+
+// Tf = Td / N with Td = Kd / Kp
+template <typename T>
+void BasicQuickPID<T>::UpdateFilterCoefficient() {
+  if (dispN <= 0 || dispKp <= 0 || dispKd <= 0) {
+    tfOverH = T(0);
+    return;
+  }
+  double SampleTimeInSec = (double)sampleTimeMs / 1000.0;
+  double tf = (dispKd / dispKp) / dispN;
+  tfOverH = T(tf / SampleTimeInSec);
+}
+// output clamping
+template <typename T>
+void BasicQuickPID<T>::SetOutputLimits(double Min, double Max) {
+  if (Min >= Max) return;
+  outMin = T(Min);
+  outMax = T(Max);
+
+  if (inAuto) {
+    if (*myOutput > outMax) *myOutput = outMax;
+    else if (*myOutput < outMin) *myOutput = outMin;
+
+    if (iTerm > outMax) iTerm = outMax;
+    else if (iTerm < outMin) iTerm = outMin;
+  }
+}
+
+template <typename T>
+void BasicQuickPID<T>::SetPOn(int pOn) {
+   pOnE = (pOn == P_ON_E);
+}
+
+template <typename T>
+void BasicQuickPID<T>::SetMode(int Mode) {
+  bool newAuto = (Mode == AUTOMATIC);
+  if (newAuto && !inAuto) {
+    // Initialize (feedforward is already part of the current output)
+    iTerm = *myOutput - feedforward;
+    dTerm = T(0);
+    lastInput = *myInput;
+    lastSetpoint = *mySetpoint;
+    // The first interval is one sample, not the time spent in MANUAL
+    lastTime = micros() - sampleTimeMs * 1000UL;
+    if (iTerm > outMax) iTerm = outMax;
+    else if (iTerm < outMin) iTerm = outMin;
+  }
+  inAuto = newAuto;
+}
+
+// iTerm stays in [outMin, outMax] widened by the P term, so P + I can
+// sit anywhere in the output range: a large error at a manual -> auto
+// handover needs an iTerm past the limit to hold the seeded duty
+template <typename T>
+void BasicQuickPID<T>::ClampIterm(T pTerm) {
+  T lo = outMin;
+  T hi = outMax;
+  if (pTerm > T(0)) lo = lo - pTerm;
+  else hi = hi - pTerm;
+  if (iTerm > hi) iTerm = hi;
+  else if (iTerm < lo) iTerm = lo;
+}
+
+template <typename T>
+void BasicQuickPID<T>::SeedOutput(T output) {
+  T input = *myInput;
+  T setpoint = *mySetpoint;
+  // PonM already carries P inside iTerm
+  T pTerm = pOnE ? kp * (spWeightP * setpoint - input) : T(0);
+  T held = output - feedforward - pTerm;
+  // A duty at a limit is held by any iTerm past it: keep the plain
+  // clamp then, and go outside it only when P alone is past a limit
+  iTerm = held;
+  ClampIterm(T(0));
+  T resumed = pTerm + iTerm + feedforward;
+  if (resumed > outMax) resumed = outMax;
+  else if (resumed < outMin) resumed = outMin;
+  if (resumed != output) {
+    iTerm = held;
+    ClampIterm(pTerm);
+  }
+  dTerm = T(0);
+  lastInput = input;
+  lastSetpoint = setpoint;
+  *myOutput = output;
+}
+
+template <typename T>
+void BasicQuickPID<T>::SeedIterm(T iterm) {
+  iTerm = iterm;
+  if (iTerm > outMax) iTerm = outMax;
+  else if (iTerm < outMin) iTerm = outMin;
+  dTerm = T(0);
+  lastInput = *myInput;
+  lastSetpoint = *mySetpoint;
+}
+
+// All backends are built so they can be compared on the same sources
+template class BasicQuickPID<double>;
+template class BasicQuickPID<float>;
+template class BasicQuickPID<Fix16>;
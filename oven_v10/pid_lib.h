@@ -1,46 +1,195 @@
-#ifndef PID_LIB_H
-#define PID_LIB_H
-
-#include <Arduino.h>
-
-class QuickPID {
-  public:
-    QuickPID(double* input, double* output, double* setpoint, double kp, double ki, double kd, int controllerDirection);
-    
-    // Configuration
-    void SetMode(int mode); // AUTOMATIC = 1, MANUAL = 0
-    void SetOutputLimits(double min, double max);
-    void SetTunings(double kp, double ki, double kd);
-    void SetPOn(int pOn);
-    
-    // Calculation (call this frequently)
-    bool Compute();
-
-    // Constants
-    static const int AUTOMATIC = 1;
-    static const int MANUAL    = 0;
-    static const int DIRECT    = 0;
-    static const int REVERSE   = 1;
-
-    static const int P_ON_E    = 1; // Proportional on Error (Default)
-    static const int P_ON_M    = 0; // Proportional on Measurement
-
-  private:
-    double dispKp, dispKi, dispKd;
-    double kp, ki, kd;
-    int controllerDirection;
-    
-    double *myInput;
-    double *myOutput;
-    double *mySetpoint;
-    
-    double iTerm, lastInput;
-    
-    unsigned long lastTime;
-    double outMin, outMax;
-    bool inAuto;
-    // Tracker for the mode
-    bool pOnE;
-};
-
-#endif
\ No newline at end of file
+#ifndef PID_LIB_H
+#define PID_LIB_H
+
+#include <Arduino.h>
+
+// =================================================================
+// Q16.16 FIXED POINT
+// =================================================================
+// Saturating signed fixed point for the FPU-less Cortex-M3.
+// Range is about +/-32768 with a resolution of 1/65536.
+
+class Fix16 {
+  public:
+    Fix16() : raw(0) {}
+    explicit Fix16(int v)           : raw(saturate((int64_t)v << 16)) {}
+    explicit Fix16(unsigned int v)  : raw(saturate((int64_t)v << 16)) {}
+    explicit Fix16(long v)          : raw(saturate((int64_t)v << 16)) {}
+    explicit Fix16(unsigned long v) : raw(saturate((int64_t)v << 16)) {}
+    explicit Fix16(float v)         : raw(fromReal((double)v)) {}
+    explicit Fix16(double v)        : raw(fromReal(v)) {}
+
+    static Fix16 fromRaw(int32_t r) { Fix16 f; f.raw = r; return f; }
+
+    explicit operator double() const { return (double)raw / 65536.0; }
+    explicit operator float()  const { return (float)raw / 65536.0f; }
+    explicit operator long()   const { return raw / 65536; } // Truncates toward zero like a double cast
+
+    Fix16 operator+(Fix16 o) const { return fromRaw(saturate((int64_t)raw + o.raw)); }
+    Fix16 operator-(Fix16 o) const { return fromRaw(saturate((int64_t)raw - o.raw)); }
+    Fix16 operator*(Fix16 o) const { return fromRaw(saturate(((int64_t)raw * o.raw) >> 16)); }
+    Fix16 operator/(Fix16 o) const;
+    Fix16 operator-() const { return fromRaw(saturate(-(int64_t)raw)); }
+    Fix16& operator+=(Fix16 o) { return *this = *this + o; }
+    Fix16& operator-=(Fix16 o) { return *this = *this - o; }
+
+    bool operator< (Fix16 o) const { return raw <  o.raw; }
+    bool operator> (Fix16 o) const { return raw >  o.raw; }
+    bool operator<=(Fix16 o) const { return raw <= o.raw; }
+    bool operator>=(Fix16 o) const { return raw >= o.raw; }
+    bool operator==(Fix16 o) const { return raw == o.raw; }
+    bool operator!=(Fix16 o) const { return raw != o.raw; }
+
+    int32_t raw;
+
+  private:
+    static int32_t saturate(int64_t v) {
+      if (v > INT32_MAX) return INT32_MAX;
+      if (v < -INT32_MAX) return -INT32_MAX;
+      return (int32_t)v;
+    }
+    static int32_t fromReal(double v);
+};
+
+// =================================================================
+// GAIN SCHEDULE
+// =================================================================
+// One gain set at a temperature. A controller with a schedule
+// interpolates linearly between points (sorted by temp) and holds the
+// end values outside the table.
+
+struct GainPoint {
+  double temp;
+  double kp;
+  double ki;
+  double kd;
+};
+
+const uint8_t PID_MAX_GAIN_POINTS = 4;
+
+// =================================================================
+// PID CONTROLLER
+// =================================================================
+// Templated on the numeric type used inside Compute(). Instantiated
+// for double (reference), float and Fix16 in pid_lib.cpp. Tunings are
+// always passed as double since they are only set from the slow path.
+
+template <typename T>
+class BasicQuickPID {
+  public:
+    BasicQuickPID(T* input, T* output, T* setpoint, double kp, double ki, double kd, int controllerDirection);
+    // For arrays of controllers: DIRECT, zero gains, attach with SetIO()
+    BasicQuickPID();
+
+    // Process variables (must be set before SetMode(AUTOMATIC))
+    void SetIO(T* input, T* output, T* setpoint);
+
+    // Configuration
+    void SetMode(int mode); // AUTOMATIC = 1, MANUAL = 0
+    void SetOutputLimits(double min, double max);
+    void SetTunings(double kp, double ki, double kd);
+    void SetPOn(int pOn);
+    // Compute() period in ms (default PID_COMPUTE_FREQ). Call before
+    // SetGainSchedule(), whose table is scaled to the period in use.
+    void SetSampleTime(unsigned long ms);
+    // Back-calculation tracking time constant in seconds (0 = clamp iTerm only, P_ON_E only)
+    void SetAntiWindup(double tt);
+    // Derivative low-pass with time constant Td/N (0 = unfiltered)
+    void SetDerivativeFilter(double n);
+    // 2-DOF weights: P acts on b*sp - y, D on c*sp - y (P_ON_E only)
+    void SetSetpointWeights(double b, double c);
+    // Interpolate gains by setpoint (or input) on every Compute(); count 0
+    // returns to the fixed SetTunings() gains. The derivative filter keeps
+    // using the fixed Kd/Kp ratio.
+    void SetGainSchedule(const GainPoint* points, uint8_t count, bool onInput);
+    // Added to P + I + D before clamping (e.g. model steady-state duty)
+    void SetFeedforward(T ff);
+
+    // Bumpless manual -> auto transfer: seed iTerm so the next Compute()
+    // continues from 'output' at the current input and setpoint
+    void SeedOutput(T output);
+    // Resume from a logged state (GetIterm()) at the current input and
+    // setpoint; the output follows on the next Compute()
+    void SeedIterm(T iterm);
+
+    // Calculation (call this frequently). Runs once sampleTime has
+    // elapsed; ki/kd are scaled by the interval actually measured.
+    bool Compute();
+    // Same, but runs now: for callers driven by their own fixed-rate tick
+    bool ComputeTick();
+    // Interval used by the last compute (us)
+    unsigned long GetLastDt() const { return lastDtUs; }
+
+    // Gains in use (after scheduling), in SetTunings() units
+    double GetKp() const;
+    double GetKi() const;
+    double GetKd() const;
+    double GetIterm() const { return (double)iTerm; }
+    int GetMode() const { return inAuto ? AUTOMATIC : MANUAL; }
+
+    // Constants
+    static const int AUTOMATIC = 1;
+    static const int MANUAL    = 0;
+    static const int DIRECT    = 0;
+    static const int REVERSE   = 1;
+
+    static const int P_ON_E    = 1; // Proportional on Error (Default)
+    static const int P_ON_M    = 0; // Proportional on Measurement
+
+  private:
+    void UpdateFilterCoefficient();
+    void ScheduleGains(T x, T pWeighted);
+    void Step(unsigned long now, unsigned long dtUs);
+    void ClampIterm(T pTerm);
+
+    double dispKp, dispKi, dispKd;
+    double dispTt, dispN;
+    T kp, ki, kd;
+    T kt;          // h / Tt, 0 when back-calculation is off
+    T tfOverH;     // Derivative filter Tf / h, 0 = unfiltered
+    T spWeightP, spWeightD;
+    int controllerDirection;
+
+    // Gain schedule, scaled like kp/ki/kd
+    uint8_t gainCount;
+    bool scheduleOnInput;
+    T gainTemp[PID_MAX_GAIN_POINTS];
+    T gainInvSpan[PID_MAX_GAIN_POINTS]; // 1 / (temp[i+1] - temp[i])
+    T gainKp[PID_MAX_GAIN_POINTS], gainKi[PID_MAX_GAIN_POINTS], gainKd[PID_MAX_GAIN_POINTS];
+
+    T *myInput;
+    T *myOutput;
+    T *mySetpoint;
+
+    T iTerm, dTerm, lastInput, lastSetpoint;
+    T feedforward;
+
+    unsigned long lastTime;   // micros() of the last compute
+    unsigned long lastDtUs;
+    unsigned long sampleTimeMs;
+    T outMin, outMax;
+    bool inAuto;
+    // Tracker for the mode
+    bool pOnE;
+};
+
+// --- Numeric backend used by the oven controllers ---
+#define PID_BACKEND_DOUBLE 0
+#define PID_BACKEND_FLOAT  1
+#define PID_BACKEND_FIX16  2
+
+#ifndef PID_BACKEND
+#define PID_BACKEND PID_BACKEND_DOUBLE
+#endif
+
+#if PID_BACKEND == PID_BACKEND_FIX16
+typedef Fix16 PidReal;
+#elif PID_BACKEND == PID_BACKEND_FLOAT
+typedef float PidReal;
+#else
+typedef double PidReal;
+#endif
+
+typedef BasicQuickPID<PidReal> QuickPID;
+
+#endif
@@ -0,0 +1,191 @@
+#include "power_budget.h"
+#include "output_mode.h" // Needs OUTPUT_MODE_TPC
+
+const uint8_t POWER_SLOTS = PID_WINDOW_SIZE / POWER_SLOT_MS;
+static_assert(PID_WINDOW_SIZE % POWER_SLOT_MS == 0, "PID_WINDOW_SIZE must be a multiple of POWER_SLOT_MS");
+static_assert(PID_WINDOW_SIZE / POWER_SLOT_MS <= 255, "Too many power slots per window");
+
+void initializePowerBudget(OvenController &oven) {
+  PowerBudgetState &b = oven.budget;
+  b.windowStartTime = millis();
+  b.windowPlanned = false;
+  for (uint8_t i = 0; i < ZONE_COUNT; i++) {
+    b.runStart[i] = b.runLength[i] = 0;
+    b.carryMs[i] = 0;
+    b.lastRequestMs[i] = 0;
+    b.stats.deferredMs[i] = 0;
+  }
+  b.stats.windows = 0;
+  b.stats.constrainedWindows = 0;
+}
+
+// Longest run of slots from 'from' on (earliest first) where channel
+// ch still fits, capped at 'wanted'. Returns the run length, start in 'start'.
+static uint8_t findRun(uint8_t ch, uint8_t wanted, const PowerLimits &limits, const float loadKw[],
+                       const uint8_t loadCount[], uint8_t from, uint8_t &start) {
+  uint8_t bestStart = from, bestLen = 0;
+  uint8_t s = from;
+  while (s < POWER_SLOTS && bestLen < wanted) {
+    uint8_t len = 0;
+    while (s + len < POWER_SLOTS && len < wanted
+           && (limits.maxKw <= 0 || loadKw[s + len] + ZONE_TABLE[ch].powerKw <= limits.maxKw)
+           && (limits.maxHeaters == 0 || loadCount[s + len] < limits.maxHeaters)) {
+      len++;
+    }
+    if (len > bestLen) { bestLen = len; bestStart = s; }
+    s += len + 1;
+  }
+  start = bestStart;
+  return bestLen;
+}
+
+static void reserveRun(uint8_t ch, uint8_t start, uint8_t len, float loadKw[], uint8_t loadCount[]) {
+  for (uint8_t s = start; s < start + len; s++) {
+    loadKw[s] += ZONE_TABLE[ch].powerKw;
+    loadCount[s]++;
+  }
+}
+
+static void planWindow(PowerBudgetState &b, const PowerLimits &limits, const bool ssr[],
+                       const unsigned long requestMs[], const unsigned long minOnMs[]) {
+  float loadKw[POWER_SLOTS];
+  uint8_t loadCount[POWER_SLOTS];
+  for (uint8_t s = 0; s < POWER_SLOTS; s++) { loadKw[s] = 0; loadCount[s] = 0; }
+  bool constrained = false;
+
+  // SSR channels go first: they may conduct in any mains cycle, so one
+  // that is on at all holds its rating for the whole window. If the
+  // supply cannot carry it, it may only conduct in the run that fits.
+  for (uint8_t ch = 0; ch < ZONE_COUNT; ch++) {
+    if (!ssr[ch]) continue;
+    b.carryMs[ch] = 0;
+    b.runStart[ch] = 0;
+    b.runLength[ch] = 0;
+    if (requestMs[ch] == 0) continue;
+    uint8_t start;
+    uint8_t len = findRun(ch, POWER_SLOTS, limits, loadKw, loadCount, 0, start);
+    if (len < POWER_SLOTS) {
+      constrained = true;
+      b.stats.deferredMs[ch] += requestMs[ch] * (POWER_SLOTS - len) / POWER_SLOTS;
+    }
+    b.runStart[ch] = start;
+    b.runLength[ch] = len;
+    reserveRun(ch, start, len, loadKw, loadCount);
+  }
+
+  // TPC requests including last window's shortfall, in slots (rounded)
+  uint8_t wanted[ZONE_COUNT];
+  uint8_t order[ZONE_COUNT];
+  unsigned long backlog[ZONE_COUNT];
+  for (uint8_t i = 0; i < ZONE_COUNT; i++) {
+    backlog[i] = b.carryMs[i];
+    unsigned long ms = ssr[i] ? 0 : requestMs[i] + b.carryMs[i];
+    if (ms > PID_WINDOW_SIZE) ms = PID_WINDOW_SIZE;
+    b.carryMs[i] = ms;
+    wanted[i] = (ms + POWER_SLOT_MS / 2) / POWER_SLOT_MS;
+    order[i] = i;
+  }
+
+  // Channels cut last window go first so overload rotates instead of
+  // starving one heater; then largest request first, as it is the hardest to fit
+  for (uint8_t i = 1; i < ZONE_COUNT; i++) {
+    uint8_t key = order[i];
+    int j = i - 1;
+    while (j >= 0 && (backlog[order[j]] < backlog[key]
+                      || (backlog[order[j]] == backlog[key] && wanted[order[j]] < wanted[key]))) {
+      order[j + 1] = order[j];
+      j--;
+    }
+    order[j + 1] = key;
+  }
+
+  for (uint8_t k = 0; k < ZONE_COUNT; k++) {
+    uint8_t ch = order[k];
+    if (ssr[ch]) continue;
+    b.runStart[ch] = 0;
+    b.runLength[ch] = 0;
+
+    // Below the minimum actuation time: keep accumulating instead of switching
+    if (b.carryMs[ch] < minOnMs[ch] || wanted[ch] == 0) continue;
+
+    uint8_t start;
+    uint8_t len = findRun(ch, wanted[ch], limits, loadKw, loadCount, 0, start);
+    if (len < wanted[ch]) constrained = true;
+    if ((unsigned long)len * POWER_SLOT_MS < minOnMs[ch]) len = 0;
+
+    b.runStart[ch] = start;
+    b.runLength[ch] = len;
+    reserveRun(ch, start, len, loadKw, loadCount);
+
+    unsigned long grantedMs = (unsigned long)len * POWER_SLOT_MS;
+    unsigned long shortfall = b.carryMs[ch] > grantedMs ? b.carryMs[ch] - grantedMs : 0;
+    if (len < wanted[ch]) b.stats.deferredMs[ch] += shortfall;
+    b.carryMs[ch] = shortfall;
+  }
+
+  b.stats.windows++;
+  if (constrained) b.stats.constrainedWindows++;
+}
+
+// A channel whose request rose from zero after the plan gets a run in
+// the slots left, in whatever capacity the planned runs leave: the
+// relay answers now, as it did before the budget, instead of at the
+// next window. Its duty this window counts against its carry.
+static void planLateRun(PowerBudgetState &b, const PowerLimits &limits, const bool ssr[], uint8_t ch,
+                        uint8_t slot, unsigned long requestMs, unsigned long minOnMs) {
+  float loadKw[POWER_SLOTS];
+  uint8_t loadCount[POWER_SLOTS];
+  for (uint8_t s = 0; s < POWER_SLOTS; s++) { loadKw[s] = 0; loadCount[s] = 0; }
+  for (uint8_t i = 0; i < ZONE_COUNT; i++) {
+    if (i != ch) reserveRun(i, b.runStart[i], b.runLength[i], loadKw, loadCount);
+  }
+
+  unsigned long ms = ssr[ch] ? PID_WINDOW_SIZE : requestMs;
+  uint8_t wanted = (ms + POWER_SLOT_MS / 2) / POWER_SLOT_MS;
+  uint8_t start;
+  uint8_t len = findRun(ch, wanted, limits, loadKw, loadCount, slot, start);
+  if (!ssr[ch] && (unsigned long)len * POWER_SLOT_MS < minOnMs) return;
+  if (len == 0) return;
+
+  b.runStart[ch] = start;
+  b.runLength[ch] = len;
+  if (ssr[ch]) return;
+  unsigned long grantedMs = (unsigned long)len * POWER_SLOT_MS;
+  b.carryMs[ch] = b.carryMs[ch] > grantedMs ? b.carryMs[ch] - grantedMs : 0;
+}
+
+void updatePowerBudget(OvenController &oven, const unsigned long requestMs[], const unsigned long minOnMs[], bool relayOn[]) {
+  PowerBudgetState &b = oven.budget;
+  unsigned long now = millis();
+
+  // Same catch-up as the old per-channel windows: step one window,
+  // or restart from now after a long stall
+  if (now - b.windowStartTime >= PID_WINDOW_SIZE) {
+    b.windowStartTime += PID_WINDOW_SIZE;
+    b.windowPlanned = false;
+  }
+  if (now - b.windowStartTime >= PID_WINDOW_SIZE) {
+    b.windowStartTime = now;
+  }
+  bool ssr[ZONE_COUNT];
+  for (uint8_t i = 0; i < ZONE_COUNT; i++) ssr[i] = oven.settings.outputMode[i] != OUTPUT_MODE_TPC;
+  bool planned = !b.windowPlanned;
+  if (planned) {
+    planWindow(b, oven.settings.power, ssr, requestMs, minOnMs);
+    b.windowPlanned = true;
+  }
+
+  uint8_t slot = (now - b.windowStartTime) / POWER_SLOT_MS;
+  for (uint8_t i = 0; i < ZONE_COUNT; i++) {
+    bool rose = !planned && b.lastRequestMs[i] == 0 && requestMs[i] > 0;
+    b.lastRequestMs[i] = requestMs[i];
+    if (rose && slot >= b.runStart[i] + b.runLength[i]) {
+      planLateRun(b, oven.settings.power, ssr, i, slot, requestMs[i], minOnMs[i]);
+    }
+    relayOn[i] = (slot >= b.runStart[i] && slot < b.runStart[i] + b.runLength[i]);
+  }
+}
+
+const PowerBudgetStats& getPowerBudgetStats(const OvenController &oven) {
+  return oven.budget.stats;
+}
@@ -0,0 +1,38 @@
+#ifndef POWER_BUDGET_H
+#define POWER_BUDGET_H
+
+#include "config.h"
+
+// =================================================================
+// HEATER POWER BUDGET
+// =================================================================
+// All heater channels share one TPC window. At each window start the
+// requested on-times are packed into the window as single contiguous
+// runs (one switch-on per relay per window) so that the concurrent
+// load never exceeds the installer's limits (oven.settings.power; 0 =
+// no limit, the default). Time that does not fit is carried into the
+// next window, capped at one window, so each channel's duty is
+// preserved within one window.
+//
+// SSR channels (output_mode.h) switch on mains cycles anywhere in the
+// window, so one with a request holds its full rating for the window
+// and the mechanical runs are packed around it. Under a limit an SSR
+// that does not fit may only conduct in the run that does (the rest
+// of its request is lost, counted as deferred).
+//
+// A channel whose request rises from zero mid-window (a bang-bang or
+// PID zone coming on) is not left for the next plan: it gets a run in
+// the window's remaining slots, as far as the planned runs leave room.
+// State and statistics: oven.budget (PowerBudgetState, config.h).
+
+// Called once at setup
+void initializePowerBudget(OvenController &oven);
+
+// Called every loop. requestMs: on-time each channel wants this window;
+// minOnMs: shortest TPC run worth switching. Writes each TPC channel's
+// relay state, and for SSR channels whether they may conduct now.
+void updatePowerBudget(OvenController &oven, const unsigned long requestMs[], const unsigned long minOnMs[], bool relayOn[]);
+
+const PowerBudgetStats& getPowerBudgetStats(const OvenController &oven);
+
+#endif // POWER_BUDGET_H
@@ -0,0 +1,96 @@
+#include "preheat_model.h"
+#include "drivers.h"   // Needs saveSettings()
+#include "scheduler.h" // Needs invalidateScheduledStart()
+
+// The current preheat is timed in oven.preheatLearning
+
+static float slotTemp(const OvenController &oven, uint8_t slot) {
+  return (slot == PREHEAT_CHAMBER) ? oven.chamberTemp : oven.zones.temp[slot];
+}
+
+static float &slotRate(OvenController &oven, uint8_t slot) {
+  PreheatModel &model = oven.settings.preheat;
+  return (slot == PREHEAT_CHAMBER) ? model.chamberRate : model.rate[slot];
+}
+
+static float slotRate(const OvenController &oven, uint8_t slot) {
+  const PreheatModel &model = oven.settings.preheat;
+  return (slot == PREHEAT_CHAMBER) ? model.chamberRate : model.rate[slot];
+}
+
+// Same condition as updateCascade() uses, readable outside a bake
+static bool chamberLeads(const OvenController &oven) {
+  const CascadeSettings &cascade = oven.settings.cascade;
+  return cascade.enabled && cascade.chamberSetpoint > 0 && !isnan(oven.chamberTemp);
+}
+
+static float minutesToBand(const OvenController &oven, uint8_t slot, float band) {
+  float temp = slotTemp(oven, slot);
+  if (isnan(temp)) temp = oven.settings.ambientTemp; // Dead probe: assume cold
+  float rate = slotRate(oven, slot);
+  if (rate <= 0) rate = PREHEAT_DEFAULT_RATE;
+  return (temp < band) ? (band - temp) / rate : 0;
+}
+
+void beginPreheatLearning(OvenController &oven) {
+  PreheatLearningState &p = oven.preheatLearning;
+  p.startMs = millis();
+  for (uint8_t s = 0; s < PREHEAT_SLOTS; s++) {
+    p.startTemp[s] = slotTemp(oven, s);
+    p.reached[s] = false;
+  }
+}
+
+void notePreheatReached(OvenController &oven, uint8_t slot) {
+  PreheatLearningState &p = oven.preheatLearning;
+  if (slot >= PREHEAT_SLOTS || p.reached[slot]) return;
+  p.reached[slot] = true;
+  p.reachedMs[slot] = millis();
+  p.reachedTemp[slot] = slotTemp(oven, slot);
+}
+
+void learnPreheat(OvenController &oven) {
+  const PreheatLearningState &p = oven.preheatLearning;
+  bool learned = false;
+  for (uint8_t s = 0; s < PREHEAT_SLOTS; s++) {
+    if (!p.reached[s]) continue;
+    float rise = p.reachedTemp[s] - p.startTemp[s];
+    float minutes = (p.reachedMs[s] - p.startMs) / 60000.0f;
+    // Started warm, or a probe dropped out: nothing to learn
+    if (isnan(rise) || rise < PREHEAT_LEARN_MIN_RISE || minutes <= 0) continue;
+
+    float sample = rise / minutes;
+    float &rate = slotRate(oven, s);
+    rate = (rate <= 0) ? sample : rate + PREHEAT_LEARN_WEIGHT * (sample - rate);
+    learned = true;
+  }
+  if (learned) {
+    oven.settings.preheat.samples++;
+    invalidateScheduledStart(oven);
+    saveSettings(oven);
+  }
+}
+
+uint32_t predictPreheatSec(const OvenController &oven, const int thresholds[ZONE_COUNT]) {
+  bool cascaded = chamberLeads(oven);
+  float longest = 0;
+  for (uint8_t z = 0; z < ZONE_COUNT; z++) {
+    // Cascaded zones are judged by the air they heat, below
+    if (cascaded && ZONE_TABLE[z].cascaded) continue;
+    float band = thresholds[z] - (float)oven.settings.tuning[z].preheatTolerance;
+    float minutes = minutesToBand(oven, z, band);
+    if (minutes > longest) longest = minutes;
+  }
+  if (cascaded) {
+    float band = oven.settings.cascade.chamberSetpoint - (float)oven.settings.chamberPreheatTolerance;
+    float minutes = minutesToBand(oven, PREHEAT_CHAMBER, band);
+    if (minutes > longest) longest = minutes;
+  }
+  float seconds = longest * 60.0f;
+  return (seconds >= PREHEAT_MAX_LEAD_SEC) ? PREHEAT_MAX_LEAD_SEC : (uint32_t)seconds;
+}
+
+void resetPreheatModel(OvenController &oven) {
+  for (uint8_t s = 0; s < PREHEAT_SLOTS; s++) slotRate(oven, s) = 0;
+  oven.settings.preheat.samples = 0;
+}
@@ -0,0 +1,38 @@
+#ifndef PREHEAT_MODEL_H
+#define PREHEAT_MODEL_H
+
+#include "config.h"
+
+// =================================================================
+// PREHEAT PREDICTION
+// =================================================================
+// Each zone (and the cascade chamber probe) learns its average heating
+// rate in C/min from start temperature to its preheat band, as an EWMA
+// over completed preheats (PREHEATING -> READY). A zone that reaches
+// its band early is timed to that moment, not to the slowest zone.
+// A prediction is the slowest participating zone's (band - current
+// temperature) / rate; unlearned zones use PREHEAT_DEFAULT_RATE.
+//
+// SET_PREHEAT_MODEL {"margin":300} (s added to ready-by leads), {"reset":true}
+// GET_PREHEAT_MODEL -> {"preheat":{"rod1":C/min,...,"chamber":C/min,"samples":N,"margin":s}}
+
+// Slots are the zones and then PREHEAT_CHAMBER (config.h).
+
+// Called by the state machine when a preheat starts
+void beginPreheatLearning(OvenController &oven);
+
+// Called from updatePidSetpoints() while PREHEATING for each zone, or
+// PREHEAT_CHAMBER, that is inside its preheat band; the first call counts
+void notePreheatReached(OvenController &oven, uint8_t slot);
+
+// Called on PREHEATING -> READY: fold this preheat into the rates
+void learnPreheat(OvenController &oven);
+
+// Seconds from now until a preheat to 'thresholds' would complete,
+// capped at PREHEAT_MAX_LEAD_SEC. No margin.
+uint32_t predictPreheatSec(const OvenController &oven, const int thresholds[ZONE_COUNT]);
+
+// Forget the learned rates
+void resetPreheatModel(OvenController &oven);
+
+#endif // PREHEAT_MODEL_H
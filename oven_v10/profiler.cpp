@@ -0,0 +1,66 @@
+#include "profiler.h"
+
+static const char* const SECTION_NAMES[PROF_COUNT] = {
+  "loop", "commands", "state", "sensors", "status", "log", "relay", "pid"
+};
+
+#if defined(ARDUINO_ARCH_SAM)
+
+static const uint32_t PROFILE_CLOCK_HZ = VARIANT_MCK;
+
+void initializeProfiler(OvenController &oven) {
+  CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+  DWT->CYCCNT = 0;
+  DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+  resetProfileStats(oven);
+}
+
+uint32_t profileStart() {
+  return DWT->CYCCNT;
+}
+
+#else
+
+// No cycle counter: count microseconds and report them as 1 MHz cycles
+static const uint32_t PROFILE_CLOCK_HZ = 1000000UL;
+
+void initializeProfiler(OvenController &oven) {
+  resetProfileStats(oven);
+}
+
+uint32_t profileStart() {
+  return micros();
+}
+
+#endif
+
+void profileEnd(OvenController &oven, ProfileSection section, uint32_t start) {
+  uint32_t cycles = profileStart() - start;
+  ProfileStats &s = oven.profile[section];
+  s.count++;
+  s.totalCycles += cycles;
+  if (cycles < s.minCycles) s.minCycles = cycles;
+  if (cycles > s.maxCycles) s.maxCycles = cycles;
+}
+
+const ProfileStats& getProfileStats(const OvenController &oven, ProfileSection section) {
+  return oven.profile[section];
+}
+
+const char* profileSectionName(ProfileSection section) {
+  return SECTION_NAMES[section];
+}
+
+uint64_t profileCyclesToNs(uint32_t cycles) {
+  return (uint64_t)cycles * 1000000000ULL / PROFILE_CLOCK_HZ;
+}
+
+void resetProfileStats(OvenController &oven) {
+  for (uint8_t i = 0; i < PROF_COUNT; i++) {
+    ProfileStats &s = oven.profile[i];
+    s.count = 0;
+    s.minCycles = UINT32_MAX;
+    s.maxCycles = 0;
+    s.totalCycles = 0;
+  }
+}
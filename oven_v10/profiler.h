@@ -0,0 +1,28 @@
+#ifndef PROFILER_H
+#define PROFILER_H
+
+#include "config.h"
+
+// =================================================================
+// HOT PATH PROFILER
+// =================================================================
+// Times the per-loop paths with the Cortex-M3 DWT cycle counter
+// (one MCK cycle, 11.9 ns). Host builds fall back to micros().
+// Read with GET_PROFILE; {"reset": true} starts a new baseline.
+// Sections and statistics: ProfileSection, oven.profile (config.h).
+
+// Enable the cycle counter (setup, first thing)
+void initializeProfiler(OvenController &oven);
+
+// Cycle stamp; pass it to profileEnd() when the section is done
+uint32_t profileStart();
+void profileEnd(OvenController &oven, ProfileSection section, uint32_t start);
+
+const ProfileStats& getProfileStats(const OvenController &oven, ProfileSection section);
+const char* profileSectionName(ProfileSection section);
+// 64-bit: a loop pass with relay switching delays runs past the 4.29 s
+// a uint32_t of ns holds
+uint64_t profileCyclesToNs(uint32_t cycles);
+void resetProfileStats(OvenController &oven);
+
+#endif // PROFILER_H
@@ -0,0 +1,143 @@
+#include "recorder.h"
+#include "app.h"   // Needs sendToPort(), canSendToPort()
+
+static const char* triggerName(RecorderTrigger t) {
+  switch (t) {
+    case REC_TRIGGER_MANUAL:        return "MANUAL";
+    case REC_TRIGGER_VALVE_TIMEOUT: return "VALVE_TIMEOUT";
+    case REC_TRIGGER_SENSOR_FAULT:  return "SENSOR_FAULT";
+    case REC_TRIGGER_OVERTEMP:      return "OVERTEMP";
+    default:                        return "NONE";
+  }
+}
+
+static int16_t toDeci(double value) {
+  if (isnan(value)) return INT16_MIN;
+  double scaled = value * 10.0;
+  if (scaled > 32767.0) return 32767;
+  if (scaled < -32767.0) return -32767;
+  return (int16_t)scaled;
+}
+
+static uint16_t toWindowMs(double value) {
+  if (value <= 0) return 0;
+  if (value >= 65535.0) return 65535;
+  return (uint16_t)value;
+}
+
+void recordControlSample(OvenController &oven) {
+  RecorderState &rec = oven.recorder;
+  if (rec.frozen) return;
+
+  unsigned long now = millis();
+  if (now - rec.lastSampleTime < RECORDER_SAMPLE_INTERVAL) return;
+  rec.lastSampleTime = now;
+
+  RecorderSample &s = rec.samples[rec.head];
+  s.timeMs = now;
+  s.relayBits = 0;
+  for (uint8_t z = 0; z < ZONE_COUNT; z++) {
+    s.input[z] = toDeci((double)oven.zones.input[z]);
+    s.setpoint[z] = toDeci((double)oven.zones.setpoint[z]);
+    s.output[z] = toWindowMs((double)oven.zones.output[z]);
+    if (oven.relayStates.zone[z]) s.relayBits |= (1 << z);
+  }
+  s.relayBits |= (oven.relayStates.valve ? 1 << ZONE_COUNT : 0)
+              |  (oven.relayStates.light ? 1 << (ZONE_COUNT + 1) : 0)
+              |  (oven.relayStates.alarm ? 1 << (ZONE_COUNT + 2) : 0);
+  s.state = (uint8_t)oven.currentState;
+
+  rec.head = (rec.head + 1) % RECORDER_CAPACITY;
+  if (rec.count < RECORDER_CAPACITY) rec.count++;
+
+  if (rec.trigger != REC_TRIGGER_NONE) {
+    if (rec.postTriggerLeft == 0 || --rec.postTriggerLeft == 0) {
+      rec.frozen = true;
+      Serial.print("Recorder frozen: "); Serial.println(triggerName(rec.trigger));
+    }
+  }
+}
+
+void triggerRecorder(OvenController &oven, RecorderTrigger reason) {
+  RecorderState &rec = oven.recorder;
+  if (rec.trigger != REC_TRIGGER_NONE || rec.frozen) return;
+  rec.trigger = reason;
+  rec.postTriggerLeft = RECORDER_POST_TRIGGER_SAMPLES;
+  Serial.print("Recorder triggered: "); Serial.println(triggerName(reason));
+}
+
+void rearmRecorder(OvenController &oven) {
+  RecorderState &rec = oven.recorder;
+  rec.head = 0;
+  rec.count = 0;
+  rec.postTriggerLeft = 0;
+  rec.trigger = REC_TRIGGER_NONE;
+  rec.frozen = false;
+}
+
+bool isRecorderFrozen(const OvenController &oven) {
+  return oven.recorder.frozen;
+}
+
+void startRecorderDump(OvenController &oven, Stream &port) {
+  RecorderState &rec = oven.recorder;
+  // On-demand dump: freeze now and resume recording once it is sent.
+  // A fault capture stays frozen until explicitly re-armed.
+  rec.rearmAfterDump = false;
+  if (!rec.frozen) {
+    if (rec.trigger == REC_TRIGGER_NONE) {
+      rec.trigger = REC_TRIGGER_MANUAL;
+      rec.rearmAfterDump = true;
+    }
+    rec.frozen = true;
+  }
+
+  rec.dumpPort = &port;
+  rec.dumpIndex = 0;
+
+  // t_ms,state,in_<zone>...,sp_<zone>...,out_<zone>...,relays
+  String cols = "t_ms,state";
+  const char* prefixes[3] = {",in_", ",sp_", ",out_"};
+  for (uint8_t p = 0; p < 3; p++) {
+    for (uint8_t z = 0; z < ZONE_COUNT; z++) { cols += prefixes[p]; cols += ZONE_TABLE[z].name; }
+  }
+  cols += ",relays";
+
+  StaticJsonDocument<192> doc;
+  JsonObject info = doc.createNestedObject("recorder");
+  info["trigger"] = triggerName(rec.trigger);
+  info["samples"] = rec.count;
+  info["interval"] = RECORDER_SAMPLE_INTERVAL;
+  info["scale"] = 10;
+  info["cols"] = cols;
+  String output;
+  serializeJson(doc, output);
+  sendToPort(port, output);
+}
+
+void serviceRecorderDump(OvenController &oven) {
+  RecorderState &rec = oven.recorder;
+  if (rec.dumpPort == NULL) return;
+
+  // Oldest sample first; a few rows per loop, and on RS485 only those
+  // the transmit queue has room for, so relays keep switching
+  uint16_t oldest = (rec.head + RECORDER_CAPACITY - rec.count) % RECORDER_CAPACITY;
+  char row[24 + 21 * ZONE_COUNT];
+  for (uint8_t n = 0; n < RECORDER_DUMP_ROWS_PER_LOOP && rec.dumpIndex < rec.count; n++, rec.dumpIndex++) {
+    const RecorderSample &s = rec.samples[(oldest + rec.dumpIndex) % RECORDER_CAPACITY];
+    int len = snprintf(row, sizeof(row), "%lu,%u", (unsigned long)s.timeMs, s.state);
+    for (uint8_t z = 0; z < ZONE_COUNT; z++) len += snprintf(row + len, sizeof(row) - len, ",%d", s.input[z]);
+    for (uint8_t z = 0; z < ZONE_COUNT; z++) len += snprintf(row + len, sizeof(row) - len, ",%d", s.setpoint[z]);
+    for (uint8_t z = 0; z < ZONE_COUNT; z++) len += snprintf(row + len, sizeof(row) - len, ",%u", s.output[z]);
+    len += snprintf(row + len, sizeof(row) - len, ",%u", s.relayBits);
+    if (!canSendToPort(*rec.dumpPort, len)) return;
+    sendToPort(*rec.dumpPort, row);
+  }
+
+  const char* end = "{\"recorder\":\"end\"}";
+  if (rec.dumpIndex >= rec.count && canSendToPort(*rec.dumpPort, strlen(end))) {
+    sendToPort(*rec.dumpPort, end);
+    rec.dumpPort = NULL;
+    if (rec.rearmAfterDump) rearmRecorder(oven);
+  }
+}
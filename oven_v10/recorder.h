@@ -0,0 +1,31 @@
+#ifndef RECORDER_H
+#define RECORDER_H
+
+#include "config.h"
+
+// =================================================================
+// FLIGHT RECORDER
+// =================================================================
+// Circular RAM buffer of every PID tick. Stops overwriting a short
+// while after a trigger so the lead-up to a fault survives for
+// DUMP_RECORDER. Buffer and cursor: oven.recorder (RecorderState,
+// config.h).
+
+// Called every loop; samples at most every RECORDER_SAMPLE_INTERVAL ms
+void recordControlSample(OvenController &oven);
+
+// Start the post-trigger countdown (ignored if already triggered)
+void triggerRecorder(OvenController &oven, RecorderTrigger reason);
+
+// Clear the buffer and resume recording
+void rearmRecorder(OvenController &oven);
+
+bool isRecorderFrozen(const OvenController &oven);
+
+// Begin streaming the frozen buffer to 'port' (freezes it if armed)
+void startRecorderDump(OvenController &oven, Stream &port);
+
+// Called every loop; sends a few rows of a pending dump
+void serviceRecorderDump(OvenController &oven);
+
+#endif // RECORDER_H
@@ -0,0 +1,255 @@
+#include "scheduler.h"
+#include "drivers.h"   // Needs saveSettings()
+#include "wallclock.h" // Needs wallClockUnix()
+#include "preheat_model.h" // Needs predictPreheatSec()
+
+const uint32_t SECONDS_PER_DAY = 86400UL;
+
+// =================================================================
+// HEAP
+// =================================================================
+
+static void swapJobs(ScheduledJob &a, ScheduledJob &b) {
+  ScheduledJob t = a;
+  a = b;
+  b = t;
+}
+
+static void siftUp(JobQueue &q, uint8_t i) {
+  ScheduledJob* jobs = q.jobs;
+  while (i > 0) {
+    uint8_t parent = (i - 1) / 2;
+    if (jobs[parent].startUnix <= jobs[i].startUnix) break;
+    swapJobs(jobs[parent], jobs[i]);
+    i = parent;
+  }
+}
+
+static void siftDown(JobQueue &q, uint8_t i) {
+  while (true) {
+    uint8_t smallest = i;
+    uint8_t left = 2 * i + 1, right = 2 * i + 2;
+    if (left < q.count && q.jobs[left].startUnix < q.jobs[smallest].startUnix) smallest = left;
+    if (right < q.count && q.jobs[right].startUnix < q.jobs[smallest].startUnix) smallest = right;
+    if (smallest == i) return;
+    swapJobs(q.jobs[i], q.jobs[smallest]);
+    i = smallest;
+  }
+}
+
+static void heapify(JobQueue &q) {
+  for (int i = q.count / 2 - 1; i >= 0; i--) siftDown(q, (uint8_t)i);
+}
+
+// Remove the entry at i and restore the heap
+static void removeAt(JobQueue &q, uint8_t i) {
+  q.count--;
+  if (i == q.count) return;
+  q.jobs[i] = q.jobs[q.count];
+  siftDown(q, i);
+  siftUp(q, i);
+}
+
+static bool repeats(const ScheduledJob &job) {
+  return (job.repeatDays & JOB_WEEKDAY_MASK) != 0;
+}
+
+static void pushJob(JobQueue &q, const ScheduledJob &job) {
+  q.jobs[q.count] = job;
+  siftUp(q, q.count);
+  q.count++;
+}
+
+// The heap orders the stored times. A ready-by job starts its predicted
+// lead before that, and the lead moves with the temperatures, so only
+// those can come before the head. The result is cached: every queue
+// change drops it, and otherwise the leads are re-predicted every
+// SCHEDULE_REFRESH_SEC (or when the clock is set back).
+static int8_t nextJobIndex(const OvenController &oven) {
+  SchedulerState &cache = oven.scheduler;
+  uint32_t now = wallClockUnix();
+  if (cache.valid && now >= cache.refreshedUnix && now - cache.refreshedUnix < SCHEDULE_REFRESH_SEC) {
+    return cache.nextIndex;
+  }
+
+  const JobQueue &q = oven.settings.schedule;
+  int8_t best = -1;
+  uint32_t bestStart = 0;
+  if (q.count > 0) {
+    best = 0;
+    bestStart = scheduledJobStart(oven, q.jobs[0]);
+  }
+  for (uint8_t i = 1; i < q.count; i++) {
+    if ((q.jobs[i].repeatDays & JOB_READY_BY) == 0) continue;
+    uint32_t start = scheduledJobStart(oven, q.jobs[i]);
+    if (start < bestStart) {
+      best = (int8_t)i;
+      bestStart = start;
+    }
+  }
+  cache.valid = true;
+  cache.nextIndex = best;
+  cache.nextStart = bestStart;
+  cache.refreshedUnix = now;
+  return best;
+}
+
+// =================================================================
+// FUNCTIONS
+// =================================================================
+
+uint32_t nextOccurrence(uint8_t repeatDays, uint16_t startMinute, uint32_t after) {
+  if ((repeatDays & JOB_WEEKDAY_MASK) == 0) return 0;
+  uint32_t day = after / SECONDS_PER_DAY;
+  // Today and the next seven days cover every weekday once past 'after'
+  for (uint8_t i = 0; i <= 7; i++, day++) {
+    uint8_t weekday = (uint8_t)((day + 4) % 7); // 1970-01-01 was a Thursday
+    uint32_t start = day * SECONDS_PER_DAY + startMinute * 60UL;
+    if ((repeatDays & (1 << weekday)) && start > after) return start;
+  }
+  return 0;
+}
+
+void initializeScheduler(OvenController &oven) {
+  JobQueue &q = oven.settings.schedule;
+  bool changed = false;
+  if (q.count > MAX_SCHEDULED_JOBS) {
+    q.count = 0;
+    changed = true;
+  }
+  // A repeat missed by more than the resume outage limit (oven was
+  // off) waits for its next occurrence instead of starting late
+  uint32_t now = wallClockUnix();
+  for (uint8_t i = 0; i < q.count; i++) {
+    ScheduledJob &job = q.jobs[i];
+    if (repeats(job) && now > job.startUnix && now - job.startUnix > oven.settings.resume.maxOutageSec) {
+      job.startUnix = nextOccurrence(job.repeatDays, job.startMinute, now);
+      changed = true;
+    }
+  }
+  // Rebuild in case the stored order is off
+  heapify(q);
+  invalidateScheduledStart(oven);
+
+  // The original single start time becomes a one-shot job
+  if (oven.settings._legacyScheduledUnixTime != 0) {
+    ScheduledJob job = makeJobFromSettings(oven);
+    job.startUnix = oven.settings._legacyScheduledUnixTime;
+    addScheduledJob(oven, job);
+    oven.settings._legacyScheduledUnixTime = 0;
+    changed = true;
+  }
+  if (changed) saveSettings(oven);
+}
+
+ScheduledJob makeJobFromSettings(const OvenController &oven) {
+  ScheduledJob job;
+  memset(&job, 0, sizeof(job));
+  for (uint8_t z = 0; z < ZONE_COUNT; z++) job.thresholds[z] = oven.settings.thresholds.zone[z];
+  job.recipeTimeMinutes = oven.settings.recipeTimeMinutes;
+  job.holdingTimeMinutes = oven.settings.holdingTimeMinutes;
+  return job;
+}
+
+bool addScheduledJob(OvenController &oven, ScheduledJob &job) {
+  JobQueue &q = oven.settings.schedule;
+  if (q.count >= MAX_SCHEDULED_JOBS) return false;
+  job.id = q.nextId++;
+  if (q.nextId == 0) q.nextId = 1;
+  pushJob(q, job);
+  invalidateScheduledStart(oven);
+  return true;
+}
+
+bool cancelScheduledJob(OvenController &oven, uint32_t id) {
+  JobQueue &q = oven.settings.schedule;
+  for (uint8_t i = 0; i < q.count; i++) {
+    if (q.jobs[i].id == id) {
+      removeAt(q, i);
+      invalidateScheduledStart(oven);
+      return true;
+    }
+  }
+  return false;
+}
+
+void cancelAllScheduledJobs(OvenController &oven) {
+  oven.settings.schedule.count = 0;
+  invalidateScheduledStart(oven);
+}
+
+void cancelOneShotJobs(OvenController &oven) {
+  JobQueue &q = oven.settings.schedule;
+  uint8_t kept = 0;
+  for (uint8_t i = 0; i < q.count; i++) {
+    if (repeats(q.jobs[i])) q.jobs[kept++] = q.jobs[i];
+  }
+  q.count = kept;
+  heapify(q);
+  invalidateScheduledStart(oven);
+}
+
+void invalidateScheduledStart(OvenController &oven) {
+  oven.scheduler.valid = false;
+}
+
+bool hasScheduledJobs(const OvenController &oven) {
+  return oven.settings.schedule.count > 0;
+}
+
+uint32_t scheduledJobStart(const OvenController &oven, const ScheduledJob &job) {
+  if ((job.repeatDays & JOB_READY_BY) == 0) return job.startUnix;
+  uint32_t lead = predictPreheatSec(oven, job.thresholds) + oven.settings.preheat.marginSec;
+  if (lead > PREHEAT_MAX_LEAD_SEC) lead = PREHEAT_MAX_LEAD_SEC;
+  return (job.startUnix > lead) ? job.startUnix - lead : 0;
+}
+
+uint32_t nextScheduledStart(const OvenController &oven) {
+  int8_t i = nextJobIndex(oven);
+  return (i >= 0) ? oven.scheduler.nextStart : 0;
+}
+
+uint32_t nextScheduledReady(const OvenController &oven) {
+  int8_t i = nextJobIndex(oven);
+  if (i < 0) return 0;
+  const ScheduledJob &job = oven.settings.schedule.jobs[i];
+  if (job.repeatDays & JOB_READY_BY) return job.startUnix;
+  return job.startUnix + predictPreheatSec(oven, job.thresholds);
+}
+
+bool isScheduledJobDue(const OvenController &oven) {
+  return hasScheduledJobs(oven) && wallClockUnix() >= nextScheduledStart(oven);
+}
+
+bool takeDueJob(OvenController &oven, ScheduledJob &job) {
+  JobQueue &q = oven.settings.schedule;
+  int8_t i = nextJobIndex(oven);
+  if (i < 0 || wallClockUnix() < oven.scheduler.nextStart) return false;
+  job = q.jobs[i];
+  removeAt(q, (uint8_t)i);
+  invalidateScheduledStart(oven);
+
+  if (repeats(job)) {
+    // A ready-by job is taken before its READY time; don't repeat that one
+    uint32_t after = wallClockUnix();
+    if (job.startUnix > after) after = job.startUnix;
+    ScheduledJob next = job;
+    next.startUnix = nextOccurrence(job.repeatDays, job.startMinute, after);
+    if (next.startUnix != 0) pushJob(q, next);
+  }
+  return true;
+}
+
+uint8_t listScheduledJobs(const OvenController &oven, ScheduledJob* out) {
+  const JobQueue &q = oven.settings.schedule;
+  // Insertion sort of at most MAX_SCHEDULED_JOBS entries
+  for (uint8_t i = 0; i < q.count; i++) {
+    uint8_t j = i;
+    while (j > 0 && out[j - 1].startUnix > q.jobs[i].startUnix) {
+      out[j] = out[j - 1];
+      j--;
+    }
+    out[j] = q.jobs[i];
+  }
+  return q.count;
+}
@@ -0,0 +1,61 @@
+#ifndef SCHEDULER_H
+#define SCHEDULER_H
+
+#include "config.h"
+
+// =================================================================
+// SCHEDULED BAKES
+// =================================================================
+// Pending bakes live in oven.settings.schedule, a min-heap on start
+// time. A job is either one-shot (start time) or repeats on a set of
+// weekdays at a fixed minute of the day, in the RTC's local time.
+// With JOB_READY_BY that time is when the oven should be READY, and
+// the job starts the predicted preheat (preheat_model.h) plus margin
+// earlier, re-predicted from the live temperatures until it starts.
+// Callers persist changes with saveSettings().
+//
+// SCHEDULE_ADD    {"start":unix} or {"days":[1,2,3,4,5],"at":270}
+//                 ready-by: {"ready":unix} or {"days":[...],"ready_at":330}
+//                 plus optional recipe: zone thresholds, "time", "holding"
+//                 (defaults: the current settings) -> {"status":"ok","id":N}
+// SCHEDULE_LIST   -> {"job":{...}} per job in stored-time order, then {"job":"end","count":N}
+// SCHEDULE_CANCEL {"id":N} or {"all":true}
+
+// Called once at setup, after loadSettings(). Repeats missed by more
+// than resume.maxOutageSec move on to their next occurrence.
+void initializeScheduler(OvenController &oven);
+
+// Job with the recipe currently in settings and no start yet
+ScheduledJob makeJobFromSettings(const OvenController &oven);
+
+// Add a job (id assigned here). False if the queue is full.
+bool addScheduledJob(OvenController &oven, ScheduledJob &job);
+bool cancelScheduledJob(OvenController &oven, uint32_t id);
+void cancelAllScheduledJobs(OvenController &oven);
+// Drop the one-shot jobs (legacy single-schedule semantics)
+void cancelOneShotJobs(OvenController &oven);
+// The next job and its start are cached (re-predicted every
+// SCHEDULE_REFRESH_SEC); the functions above drop the cache, call this
+// after changing anything else the prediction uses (preheat model)
+void invalidateScheduledStart(OvenController &oven);
+
+bool hasScheduledJobs(const OvenController &oven);
+bool isScheduledJobDue(const OvenController &oven);
+// Start time of the next job, 0 if none
+uint32_t nextScheduledStart(const OvenController &oven);
+// When the next job should be READY (predicted unless ready-by), 0 if none
+uint32_t nextScheduledReady(const OvenController &oven);
+// Start time of 'job', with the predicted lead for ready-by jobs
+uint32_t scheduledJobStart(const OvenController &oven, const ScheduledJob &job);
+
+// Pop the due head into 'job'; a repeating job goes back in at its
+// next occurrence. False if nothing is due.
+bool takeDueJob(OvenController &oven, ScheduledJob &job);
+
+// First start strictly after 'after' for a weekday mask / minute of day
+uint32_t nextOccurrence(uint8_t repeatDays, uint16_t startMinute, uint32_t after);
+
+// Copy of the queue sorted by start time, returns the count
+uint8_t listScheduledJobs(const OvenController &oven, ScheduledJob* out);
+
+#endif // SCHEDULER_H
@@ -0,0 +1,230 @@
+#include "state_machine.h"
+#include "app.h"       // Needs requestStatusUpdate()
+#include "drivers.h"   // Needs saveSettings()
+#include "wallclock.h" // Needs wallClockUnix()
+#include "scheduler.h" // Needs takeDueJob()
+#include "preheat_model.h" // Needs beginPreheatLearning(), learnPreheat()
+#include "autotune.h"  // Needs isAutotuneRunning()
+
+// Matches any current state in a table row
+const int8_t ANY_STATE = -1;
+
+// How long the completion alarm sounds before returning to IDLE
+const unsigned long ALARM_DURATION_MS = 30000UL;
+
+// =================================================================
+// GUARDS
+// =================================================================
+
+static bool jobsPending(OvenController &oven) {
+  return hasScheduledJobs(oven);
+}
+
+static bool noJobsPending(OvenController &oven) {
+  return !hasScheduledJobs(oven);
+}
+
+// A due job waits for a running autotune to finish or abort
+static bool jobDue(OvenController &oven) {
+  return isScheduledJobDue(oven) && !isAutotuneRunning(oven);
+}
+
+static bool preheatDone(OvenController &oven) {
+  return oven.preheatComplete;
+}
+
+static bool holdingExpired(OvenController &oven) {
+  return millis() - oven.holdingStartTime > (oven.settings.holdingTimeMinutes * 60000UL);
+}
+
+static bool recipeDone(OvenController &oven) {
+  return millis() - oven.recipeStartTime >= (oven.settings.recipeTimeMinutes * 60000UL);
+}
+
+static bool alarmDone(OvenController &oven) {
+  return millis() - oven.alarmStartTime >= ALARM_DURATION_MS;
+}
+
+// --- Power-loss resume target (oven.machine), set by resumeOvenState() ---
+static bool resumingPreheat(OvenController &oven) { return oven.machine.resumeState == PREHEATING; }
+static bool resumingRecipe(OvenController &oven)  { return oven.machine.resumeState == RUNNING; }
+static bool resumingHolding(OvenController &oven) { return oven.machine.resumeState == READY; }
+
+// =================================================================
+// ACTIONS
+// =================================================================
+
+static void startPreheat(OvenController &oven) {
+  oven.preheatStartTime = millis();
+  oven.preheatComplete = false;
+  beginPreheatLearning(oven);
+}
+
+// Operator preheat: one-shot jobs go, as the single schedule used to
+static void startManualPreheat(OvenController &oven) {
+  cancelOneShotJobs(oven);
+  saveSettings(oven);
+  startPreheat(oven);
+}
+
+// Load the due job's recipe and preheat for it
+static void startScheduledJob(OvenController &oven) {
+  ScheduledJob job;
+  if (takeDueJob(oven, job)) {
+    for (uint8_t z = 0; z < ZONE_COUNT; z++) oven.settings.thresholds.zone[z] = job.thresholds[z];
+    oven.settings.recipeTimeMinutes = job.recipeTimeMinutes;
+    oven.settings.holdingTimeMinutes = job.holdingTimeMinutes;
+    saveSettings(oven);
+  }
+  startPreheat(oven);
+}
+
+// Preheat done: time it for the ready-by predictions
+static void startHolding(OvenController &oven) {
+  learnPreheat(oven);
+  oven.holdingStartTime = millis();
+}
+
+static void startRecipe(OvenController &oven) {
+  oven.recipeStartTime = millis();
+}
+
+static void startAlarm(OvenController &oven) {
+  oven.alarmStartTime = millis();
+}
+
+// Resume actions back-date the timers by the time already done.
+// A scheduled bake left the queue when it started.
+static void resumePreheat(OvenController &oven) {
+  oven.preheatStartTime = millis();
+  oven.preheatComplete = false;
+  beginPreheatLearning(oven);
+}
+
+static void resumeRecipe(OvenController &oven) {
+  oven.recipeStartTime = millis() - oven.machine.resumeElapsedMs;
+}
+
+static void resumeHolding(OvenController &oven) {
+  oven.holdingStartTime = millis() - oven.machine.resumeElapsedMs;
+}
+
+// One-shot jobs go, as the single schedule used to; repeats stay
+static void stopOven(OvenController &oven) {
+  cancelOneShotJobs(oven);
+  oven.manualControlActive = false;
+  oven.manualValveOverride = false;
+  saveSettings(oven);
+}
+
+// =================================================================
+// TRANSITION TABLE
+// =================================================================
+// First matching row wins. Commands work from any state, as they
+// always have; timed rows only fire from their own state.
+
+struct Transition {
+  int8_t from;      // OvenState or ANY_STATE
+  OvenEvent event;
+  bool (*guard)(OvenController &oven);  // NULL = always
+  void (*action)(OvenController &oven); // NULL = none
+  OvenState to;
+};
+
+static const Transition TRANSITIONS[] = {
+  { ANY_STATE,         OVEN_EV_START_PREHEAT, NULL,            startManualPreheat, PREHEATING        },
+  { ANY_STATE,         OVEN_EV_RUN_RECIPE,    NULL,            startRecipe,        RUNNING           },
+  { ANY_STATE,         OVEN_EV_STOP,          NULL,            stopOven,           IDLE              },
+  { IDLE,              OVEN_EV_TICK,          jobsPending,     NULL,               AWAITING_SCHEDULE },
+  { AWAITING_SCHEDULE, OVEN_EV_TICK,          noJobsPending,   NULL,               IDLE              },
+  { AWAITING_SCHEDULE, OVEN_EV_TICK,          jobDue,          startScheduledJob,  PREHEATING        },
+  { PREHEATING,        OVEN_EV_TICK,          preheatDone,     startHolding,       READY             },
+  { READY,             OVEN_EV_TICK,          holdingExpired,  NULL,               IDLE              },
+  { RUNNING,           OVEN_EV_TICK,          recipeDone,      startAlarm,         ALARM_COMPLETION  },
+  { ALARM_COMPLETION,  OVEN_EV_TICK,          alarmDone,       NULL,               IDLE              },
+  { IDLE,              OVEN_EV_RESUME,        resumingPreheat, resumePreheat,      PREHEATING        },
+  { IDLE,              OVEN_EV_RESUME,        resumingRecipe,  resumeRecipe,       RUNNING           },
+  { IDLE,              OVEN_EV_RESUME,        resumingHolding, resumeHolding,      READY             },
+};
+const uint8_t TRANSITION_COUNT = sizeof(TRANSITIONS) / sizeof(TRANSITIONS[0]);
+static_assert(TRANSITION_COUNT == OVEN_TRANSITION_ROWS, "Update OVEN_TRANSITION_ROWS with the table");
+
+static const char* const STATE_NAMES[] = {
+  "IDLE", "PREHEATING", "READY", "RUNNING", "SCHEDULED", "DONE"
+};
+
+static const char* const EVENT_NAMES[OVEN_EV_COUNT] = {
+  "start_preheat", "run_recipe", "stop", "resume", "tick"
+};
+
+// Take the first row that matches and whose guard passes
+static void dispatch(OvenController &oven, OvenEvent event) {
+  for (uint8_t i = 0; i < TRANSITION_COUNT; i++) {
+    const Transition &t = TRANSITIONS[i];
+    if (t.event != event) continue;
+    if (t.from != ANY_STATE && t.from != (int8_t)oven.currentState) continue;
+    if (t.guard != NULL && !t.guard(oven)) continue;
+
+    if (t.action != NULL) t.action(oven);
+    oven.currentState = t.to;
+    oven.machine.takenCount[i]++;
+    oven.machine.takenUnix[i] = wallClockUnix();
+    requestStatusUpdate(oven);
+    return;
+  }
+}
+
+bool postOvenEvent(OvenController &oven, OvenEvent event) {
+  StateMachineState &m = oven.machine;
+  if (m.queueLength >= OVEN_EVENT_QUEUE_SIZE) {
+    m.droppedEvents++;
+    return false;
+  }
+  m.queue[(m.queueHead + m.queueLength) % OVEN_EVENT_QUEUE_SIZE] = event;
+  m.queueLength++;
+  return true;
+}
+
+void updateStateMachine(OvenController &oven) {
+  StateMachineState &m = oven.machine;
+  while (m.queueLength > 0) {
+    OvenEvent event = m.queue[m.queueHead];
+    m.queueHead = (m.queueHead + 1) % OVEN_EVENT_QUEUE_SIZE;
+    m.queueLength--;
+    dispatch(oven, event);
+  }
+  dispatch(oven, OVEN_EV_TICK);
+}
+
+void resumeOvenState(OvenController &oven, OvenState state, unsigned long elapsedMs) {
+  oven.machine.resumeState = state;
+  oven.machine.resumeElapsedMs = elapsedMs;
+  postOvenEvent(oven, OVEN_EV_RESUME);
+}
+
+const char* ovenStateName(OvenState state) {
+  return ((unsigned)state < sizeof(STATE_NAMES) / sizeof(STATE_NAMES[0])) ? STATE_NAMES[state] : "IDLE";
+}
+
+const char* ovenEventName(OvenEvent event) {
+  return ((unsigned)event < OVEN_EV_COUNT) ? EVENT_NAMES[event] : "?";
+}
+
+uint8_t getTransitionCount() {
+  return TRANSITION_COUNT;
+}
+
+TransitionInfo getTransitionInfo(const OvenController &oven, uint8_t row) {
+  TransitionInfo info = {ANY_STATE, OVEN_EV_TICK, IDLE, 0, 0};
+  if (row >= TRANSITION_COUNT) return info;
+  info.from = TRANSITIONS[row].from;
+  info.event = TRANSITIONS[row].event;
+  info.to = TRANSITIONS[row].to;
+  info.count = oven.machine.takenCount[row];
+  info.lastUnix = oven.machine.takenUnix[row];
+  return info;
+}
+
+uint32_t getDroppedOvenEvents(const OvenController &oven) {
+  return oven.machine.droppedEvents;
+}
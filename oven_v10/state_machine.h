@@ -0,0 +1,46 @@
+#ifndef STATE_MACHINE_H
+#define STATE_MACHINE_H
+
+#include "config.h"
+
+// =================================================================
+// OVEN STATE MACHINE
+// =================================================================
+// oven.currentState only changes here, through a transition table
+// (state x event -> guard, action, next state). Commands post events
+// to a bounded queue; updateStateMachine() drains it and then offers
+// OVEN_EV_TICK, which carries the timed transitions (job queue
+// pending/empty/due, preheat done, holding/recipe/alarm timers)
+// behind guards. IDLE with jobs pending is AWAITING_SCHEDULE.
+// Every transition pushes a status update on the same loop pass.
+// Events and the queue: OvenEvent, oven.machine (config.h).
+
+// Queue an event for the next updateStateMachine(). False if the
+// queue is full (the event is dropped and counted).
+bool postOvenEvent(OvenController &oven, OvenEvent event);
+
+// Called every loop, right after the commands
+void updateStateMachine(OvenController &oven);
+
+// Re-enter a bake interrupted by a power loss: 'state' with
+// 'elapsedMs' of its recipe/holding time already done. Boot only.
+void resumeOvenState(OvenController &oven, OvenState state, unsigned long elapsedMs);
+
+// Status string of a state ("IDLE", "PREHEATING", ...)
+const char* ovenStateName(OvenState state);
+const char* ovenEventName(OvenEvent event);
+
+// Per-row statistics of the transition table
+struct TransitionInfo {
+  int8_t from;          // OvenState, -1 = any state
+  OvenEvent event;
+  OvenState to;
+  uint32_t count;       // Times taken since boot
+  uint32_t lastUnix;    // Wall clock of the last time, 0 = never
+};
+
+uint8_t getTransitionCount();
+TransitionInfo getTransitionInfo(const OvenController &oven, uint8_t row);
+uint32_t getDroppedOvenEvents(const OvenController &oven);
+
+#endif // STATE_MACHINE_H
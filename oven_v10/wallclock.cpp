@@ -0,0 +1,81 @@
+#include "wallclock.h"
+
+// Resync against the RTC this often
+const unsigned long WALLCLOCK_RESYNC_MS = 600000UL;
+// Only estimate drift once the baseline is long enough that the RTC's
+// 1 s resolution is small against it (1 h -> +/-278 ppm worst case, shrinking)
+const unsigned long WALLCLOCK_MIN_DRIFT_BASELINE_MS = 3600000UL;
+// Re-anchor well before millis() wraps (49.7 days) or ms offsets overflow a long
+const unsigned long WALLCLOCK_MAX_BASELINE_MS = 20UL * 86400000UL;
+// Larger disagreement means the RTC was set: drop the baseline
+const long WALLCLOCK_STEP_THRESHOLD_MS = 1500;
+const int32_t WALLCLOCK_MAX_DRIFT_PPM = 500;
+
+// Anchor: RTC second read at anchorMillis. The RTC only reports whole
+// seconds, so the anchor is placed mid-second (+500 ms).
+static uint32_t anchorUnix = 0;
+static unsigned long anchorMillis = 0;
+static unsigned long lastResync = 0;
+static int32_t driftPpm = 0;
+
+// Milliseconds since the anchor, corrected for drift
+static uint32_t correctedElapsed(unsigned long nowMs) {
+  uint32_t elapsed = nowMs - anchorMillis;
+  int64_t correction = ((int64_t)elapsed * driftPpm) / 1000000LL;
+  return (uint32_t)((int64_t)elapsed + correction);
+}
+
+static void anchorTo(uint32_t unixTime, unsigned long nowMs) {
+  anchorUnix = unixTime;
+  anchorMillis = nowMs;
+  lastResync = nowMs;
+}
+
+void initializeWallClock() {
+  anchorTo(rtc.now().unixtime(), millis());
+  driftPpm = 0;
+}
+
+void resyncWallClock() {
+  anchorTo(rtc.now().unixtime(), millis());
+}
+
+void updateWallClock() {
+  unsigned long nowMs = millis();
+  if (nowMs - lastResync < WALLCLOCK_RESYNC_MS) return;
+  lastResync = nowMs;
+
+  uint32_t rtcUnix = rtc.now().unixtime();
+  uint32_t elapsed = nowMs - anchorMillis;
+
+  // Compare in ms relative to the anchor to stay inside 32 bits
+  long rtcElapsedMs = (long)(rtcUnix - anchorUnix) * 1000L;
+  long predictedMs = (long)correctedElapsed(nowMs);
+  long error = rtcElapsedMs - predictedMs;
+
+  if (error > WALLCLOCK_STEP_THRESHOLD_MS || error < -WALLCLOCK_STEP_THRESHOLD_MS
+      || elapsed >= WALLCLOCK_MAX_BASELINE_MS) {
+    // RTC was stepped (or baseline too long): start over, keep the drift estimate
+    anchorTo(rtcUnix, nowMs);
+    return;
+  }
+
+  if (elapsed >= WALLCLOCK_MIN_DRIFT_BASELINE_MS) {
+    int64_t ppm = ((int64_t)(rtcElapsedMs - (long)elapsed) * 1000000LL) / (int64_t)elapsed;
+    if (ppm > WALLCLOCK_MAX_DRIFT_PPM) ppm = WALLCLOCK_MAX_DRIFT_PPM;
+    else if (ppm < -WALLCLOCK_MAX_DRIFT_PPM) ppm = -WALLCLOCK_MAX_DRIFT_PPM;
+    driftPpm = (int32_t)ppm;
+  }
+}
+
+uint32_t wallClockUnix() {
+  return anchorUnix + (correctedElapsed(millis()) + 500UL) / 1000UL;
+}
+
+DateTime wallClockNow() {
+  return DateTime(wallClockUnix());
+}
+
+int32_t wallClockDriftPpm() {
+  return driftPpm;
+}
@@ -0,0 +1,28 @@
+#ifndef WALLCLOCK_H
+#define WALLCLOCK_H
+
+#include "config.h"
+
+// =================================================================
+// SOFTWARE WALL CLOCK
+// =================================================================
+// Reads the DS3231 once, then extrapolates from millis() with a
+// drift correction. Queries cost a few multiplies instead of an I2C
+// transaction; updateWallClock() resyncs every WALLCLOCK_RESYNC_MS.
+
+// Called once at setup, after the RTC has been initialized
+void initializeWallClock();
+
+// Called every loop; reads the RTC only when a resync is due
+void updateWallClock();
+
+// Re-anchor to the RTC immediately (call after rtc.adjust())
+void resyncWallClock();
+
+uint32_t wallClockUnix();
+DateTime wallClockNow();
+
+// Estimated millis() drift against the RTC, parts per million
+int32_t wallClockDriftPpm();
+
+#endif // WALLCLOCK_H
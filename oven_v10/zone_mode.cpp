@@ -0,0 +1,90 @@
+#include "zone_mode.h"
+#include "oven_logic.h"   // Needs outputToOnTime()
+#include "autotune.h"     // Needs isAutotuneActive()
+
+// Bang-bang relay state and the time of the last duty average update
+// are in oven.zoneModes
+
+void initializeZoneModes(OvenController &oven) {
+  for (uint8_t z = 0; z < ZONE_COUNT; z++) {
+    oven.zoneModes.bangOn[z] = false;
+    oven.zoneModes.lastUpdate[z] = millis();
+    // Nothing is running yet, so there is nothing to transfer from
+    if (oven.settings.zoneControl[z].mode != ZONE_MODE_PID) oven.zonePid[z].SetMode(QuickPID::MANUAL);
+  }
+}
+
+void setZoneMode(OvenController &oven, uint8_t zone, ZoneMode mode) {
+  if (zone >= ZONE_COUNT) return;
+  PidReal duty = oven.zones.output[zone];
+
+  if (mode == ZONE_MODE_PID) {
+    oven.zonePid[zone].SetMode(QuickPID::AUTOMATIC);
+    // Without a setpoint (IDLE) a P-compensated seed would leave a
+    // stale integral for the next preheat; plain SetMode() is enough
+    if (oven.zones.setpoint[zone] > PidReal(0)) oven.zonePid[zone].SeedOutput(duty);
+  } else {
+    oven.zonePid[zone].SetMode(QuickPID::MANUAL);
+    oven.zones.output[zone] = duty;
+  }
+  oven.zoneModes.bangOn[zone] = duty >= (PidReal)(PID_WINDOW_SIZE / 2);
+  oven.zoneModes.lastUpdate[zone] = millis();
+  oven.settings.zoneControl[zone].mode = mode;
+}
+
+double zoneEffectiveDuty(const OvenController &oven, uint8_t zone) {
+  if (zone >= ZONE_COUNT) return 0;
+  return (double)oven.zones.output[zone] / PID_WINDOW_SIZE;
+}
+
+unsigned long updateZoneOutput(OvenController &oven, uint8_t zone) {
+  const ZoneControl &ctrl = oven.settings.zoneControl[zone];
+  bool &bangOn = oven.zoneModes.bangOn[zone];
+  unsigned long now = millis();
+  unsigned long dt = now - oven.zoneModes.lastUpdate[zone];
+  oven.zoneModes.lastUpdate[zone] = now;
+
+  // The relay experiment drives the output itself
+  if (ctrl.mode == ZONE_MODE_PID || isAutotuneActive(oven, zone)) {
+    return outputToOnTime(oven.zones.output[zone]);
+  }
+
+  if (ctrl.mode == ZONE_MODE_MANUAL) {
+    oven.zones.output[zone] = (PidReal)(constrain(ctrl.manualDuty, 0.0, 1.0) * PID_WINDOW_SIZE);
+    return outputToOnTime(oven.zones.output[zone]);
+  }
+
+  // --- BANG-BANG ---
+  PidReal input = oven.zones.input[zone];
+  PidReal setpoint = oven.zones.setpoint[zone];
+  if (input <= setpoint - (PidReal)ctrl.hysteresis) bangOn = true;
+  else if (input >= setpoint) bangOn = false;
+
+  // Average the relay over about one window to track the effective duty
+  double alpha = (double)dt / PID_WINDOW_SIZE;
+  if (alpha > 1.0) alpha = 1.0;
+  double target = bangOn ? PID_WINDOW_SIZE : 0;
+  double duty = (double)oven.zones.output[zone];
+  oven.zones.output[zone] = (PidReal)(duty + alpha * (target - duty));
+
+  return bangOn ? PID_WINDOW_SIZE : 0;
+}
+
+ZoneMode parseZoneMode(const char* name, bool &valid) {
+  valid = true;
+  if (name != NULL) {
+    if (strcmp(name, "pid") == 0) return ZONE_MODE_PID;
+    if (strcmp(name, "bang") == 0) return ZONE_MODE_BANG_BANG;
+    if (strcmp(name, "manual") == 0) return ZONE_MODE_MANUAL;
+  }
+  valid = false;
+  return ZONE_MODE_PID;
+}
+
+const char* zoneModeName(ZoneMode mode) {
+  switch (mode) {
+    case ZONE_MODE_BANG_BANG: return "bang";
+    case ZONE_MODE_MANUAL:    return "manual";
+    default:                  return "pid";
+  }
+}
@@ -0,0 +1,36 @@
+#ifndef ZONE_MODE_H
+#define ZONE_MODE_H
+
+#include "config.h"
+
+// =================================================================
+// ZONE CONTROL MODES
+// =================================================================
+// Each heater zone runs one of three control laws. All of them end in
+// an on-time (ms of PID_WINDOW_SIZE) for the output stage, and the
+// zone's PID output variable always holds the duty the zone is
+// effectively applying, so a mode change can pick up from it.
+
+enum ZoneMode {
+  ZONE_MODE_PID       = 0, // QuickPID, TPC/SSR output
+  ZONE_MODE_BANG_BANG = 1, // On below setpoint - hysteresis, off at setpoint
+  ZONE_MODE_MANUAL    = 2  // Fixed duty (oven.settings.zoneControl[].manualDuty)
+};
+
+// Put every zone in its persisted mode (setup, after the PIDs)
+void initializeZoneModes(OvenController &oven);
+
+// Bumpless switch: the new mode starts from the zone's current
+// effective duty (PID iTerm is seeded from it)
+void setZoneMode(OvenController &oven, uint8_t zone, ZoneMode mode);
+
+// Effective duty of a zone, 0..1
+double zoneEffectiveDuty(const OvenController &oven, uint8_t zone);
+
+// Called every loop after the PIDs. Returns the zone's on-time request.
+unsigned long updateZoneOutput(OvenController &oven, uint8_t zone);
+
+ZoneMode parseZoneMode(const char* name, bool &valid);
+const char* zoneModeName(ZoneMode mode);
+
+#endif // ZONE_MODE_H